@@ -0,0 +1,37 @@
+"""lookahead: panda_predispensed, solution batched into wells ahead of their experiment
+
+Revision ID: 5b2e9c4f7a13
+Revises: d55e0781076d
+Create Date: 2026-10-16 14:03:27.518220
+
+"""
+from typing import Sequence, Union
+
+from alembic import op
+import sqlalchemy as sa
+
+
+# revision identifiers, used by Alembic.
+revision: str = '5b2e9c4f7a13'
+down_revision: Union[str, Sequence[str], None] = 'd55e0781076d'
+branch_labels: Union[str, Sequence[str], None] = None
+depends_on: Union[str, Sequence[str], None] = None
+
+
+def upgrade():
+    insp = sa.inspect(op.get_bind())
+    if "panda_predispensed" not in insp.get_table_names():
+        op.create_table(
+            "panda_predispensed",
+            # MySQL needs a length on every VARCHAR key
+            sa.Column("plate_id", sa.Integer, primary_key=True),
+            sa.Column("well_id", sa.String(8), primary_key=True),
+            sa.Column("solution", sa.String(255), primary_key=True),
+            sa.Column("volume", sa.Float),
+        )
+
+
+def downgrade():
+    insp = sa.inspect(op.get_bind())
+    if "panda_predispensed" in insp.get_table_names():
+        op.drop_table("panda_predispensed")
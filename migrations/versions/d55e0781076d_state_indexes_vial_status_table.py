@@ -0,0 +1,129 @@
+"""state lookups: add experiment/status indexes, panda_vial_status as a table
+
+Revision ID: d55e0781076d
+Revises: 86100ae61dd8
+Create Date: 2026-10-16 09:12:41.208113
+
+"""
+from typing import Sequence, Union
+
+from alembic import op
+import sqlalchemy as sa
+
+
+# revision identifiers, used by Alembic.
+revision: str = 'd55e0781076d'
+down_revision: Union[str, Sequence[str], None] = '86100ae61dd8'
+branch_labels: Union[str, Sequence[str], None] = None
+depends_on: Union[str, Sequence[str], None] = None
+
+# (index name, table, columns)
+INDEXES = [
+    ("ix_experiment_parameters_experiment", "panda_experiment_parameters",
+     ["experiment_id", "parameter_name"]),
+    ("ix_experiment_results_experiment", "panda_experiment_results",
+     ["experiment_id", "result_type"]),
+    ("ix_well_hx_experiment", "panda_well_hx", ["experiment_id"]),
+    ("ix_well_hx_status", "panda_well_hx", ["status", "plate_id"]),
+    ("ix_vials_position_updated", "panda_vials", ["position", "updated"]),
+    ("ix_vials_unit_active", "panda_vials", ["panda_unit_id", "active", "position"]),
+]
+
+# MySQL can only index a TEXT column by a prefix of this many characters
+INDEX_PREFIX_LENGTH = 64
+
+VIAL_STATUS_COLUMNS = [
+    # MySQL needs a length on every VARCHAR, and on keys in particular
+    sa.Column("position", sa.String(64), primary_key=True),
+    sa.Column("id", sa.Integer),
+    sa.Column("category", sa.Integer),
+    sa.Column("viscosity_cp", sa.Float),
+    sa.Column("concentration", sa.Float),
+    sa.Column("density", sa.Float),
+    sa.Column("active", sa.Integer),
+    sa.Column("updated", sa.String(64)),
+    sa.Column("coordinates", sa.Text),
+    sa.Column("base_thickness", sa.Float),
+    sa.Column("height", sa.Float),
+    sa.Column("top", sa.Float),
+    sa.Column("bottom", sa.Float),
+    sa.Column("name", sa.String(255)),
+    sa.Column("radius", sa.Float),
+    sa.Column("volume", sa.Float),
+    sa.Column("capacity", sa.Float),
+    sa.Column("contamination", sa.Integer),
+    sa.Column("dead_volume", sa.Float),
+    sa.Column("volume_height", sa.Float),
+    sa.Column("contents", sa.Text),
+    sa.Column("panda_unit_id", sa.Integer),
+]
+
+# The newest row per position, as the panda_vial_status view selected it
+NEWEST_VIALS = """
+    SELECT {columns}
+      FROM (SELECT *,
+                   ROW_NUMBER() OVER (PARTITION BY position
+                                      ORDER BY updated DESC, id DESC) AS rn
+              FROM panda_vials)
+     WHERE rn = 1
+"""
+
+
+def _text_prefix_lengths(insp, table, columns):
+    """Index prefix lengths for the columns MySQL stores as TEXT"""
+    types = {c["name"]: c["type"] for c in insp.get_columns(table)}
+    return {
+        column: INDEX_PREFIX_LENGTH
+        for column in columns
+        if isinstance(types.get(column), sa.String) and types[column].length is None
+    }
+
+
+def upgrade():
+    bind = op.get_bind()
+    insp = sa.inspect(bind)
+    tables = set(insp.get_table_names())
+
+    for name, table, columns in INDEXES:
+        if table in tables and name not in {
+            i["name"] for i in insp.get_indexes(table)
+        }:
+            # mysql_length is ignored by the other dialects
+            op.create_index(
+                name,
+                table,
+                columns,
+                mysql_length=_text_prefix_lengths(insp, table, columns),
+            )
+
+    # panda_vial_status: ranked view over all vial history -> current-state table,
+    # kept up to date by the application on every panda_vials write
+    if "panda_vials" in tables:
+        if "panda_vial_status" in insp.get_view_names():
+            op.execute("DROP VIEW panda_vial_status;")
+        if "panda_vial_status" not in tables:
+            op.create_table("panda_vial_status", *VIAL_STATUS_COLUMNS)
+        columns = ", ".join(c.name for c in VIAL_STATUS_COLUMNS)
+        op.execute("DELETE FROM panda_vial_status;")
+        op.execute(
+            f"INSERT INTO panda_vial_status ({columns}) "
+            + NEWEST_VIALS.format(columns=columns)
+        )
+
+
+def downgrade():
+    bind = op.get_bind()
+    insp = sa.inspect(bind)
+    tables = set(insp.get_table_names())
+
+    if "panda_vial_status" in tables:
+        op.drop_table("panda_vial_status")
+        columns = ", ".join(c.name for c in VIAL_STATUS_COLUMNS)
+        op.execute(
+            "CREATE VIEW panda_vial_status AS "
+            + NEWEST_VIALS.format(columns=columns)
+        )
+
+    for name, table, _ in INDEXES:
+        if table in tables and name in {i["name"] for i in insp.get_indexes(table)}:
+            op.drop_index(name, table_name=table)
@@ -36,6 +36,9 @@ from .contact_angle_led_detect import (
     process_z_stack_then_measure,
     extract_z_mm_from_name,
     detect_droplet_center,
+    select_best_focus_frame,
+    StreamingFocusScorer,
+    FramePrep,
 )
 
 from .contact_angle_predict_ca_regression_model import (
@@ -75,6 +78,9 @@ __all__ = [
     "process_z_stack_then_measure",
     "extract_z_mm_from_name",
     "detect_droplet_center",
+    "select_best_focus_frame",
+    "StreamingFocusScorer",
+    "FramePrep",
     # Model training
     "train_model",
     "build_pipeline",
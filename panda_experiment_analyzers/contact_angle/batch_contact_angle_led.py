@@ -5,6 +5,9 @@ import csv
 import os
 import re
 import argparse
+import time
+from concurrent.futures import ProcessPoolExecutor, as_completed
+from dataclasses import dataclass
 from typing import Dict, List, Tuple, Optional
 
 from .contact_angle_led_detect import process_z_stack_then_measure, extract_z_mm_from_name, process_image
@@ -70,6 +73,251 @@ def group_images_into_stacks(image_paths: List[str]) -> Dict[str, List[str]]:
         stacks.setdefault(key, []).append(p)
     return stacks
 
+# Common header for both modes (FocusScore/ChosenZ_mm will be blank in --all_images mode)
+HEADER = [
+    "StackKey",
+    "ChosenImage",
+    "ChosenZ_mm",
+    "FocusScore",
+    "s_red_px",
+    "s_blue_px",
+    "Red1_Y", "Red1_X", "Red1_H", "Red1_S", "Red1_V",
+    "Red2_Y", "Red2_X", "Red2_H", "Red2_S", "Red2_V",
+    "Blue1_Y", "Blue1_X", "Blue1_H", "Blue1_S", "Blue1_V",
+    "Blue2_Y", "Blue2_X", "Blue2_H", "Blue2_S", "Blue2_V",
+    "DropletCenter_X", "DropletCenter_Y",
+    "DropletCenter_to_ImageCenter_px",
+    "RedMethod", "BlueMethod", "DropletMethod",
+    "ProcessSeconds",
+]
+
+@dataclass
+class StackJob:
+    """One unit of work: a z-stack (or a single image in --all_images mode)"""
+    stack_key: str
+    paths: List[str]
+    single_image: bool = False
+
+@dataclass
+class StackResult:
+    stack_key: str
+    row: Optional[list]
+    message: str
+    seconds: float
+
+def sort_stack_paths(paths: List[str]) -> List[str]:
+    """Sort by parsed Z so logs read nicely, unparseable names last"""
+    decorated = []
+    for p in paths:
+        z = extract_z_mm_from_name(p)
+        z_sort = z if z is not None else float("inf")
+        decorated.append((z_sort, p))
+    decorated.sort(key=lambda t: t[0])
+    return [p for _, p in decorated]
+
+def build_jobs(images: List[str], all_images: bool = False) -> List[StackJob]:
+    """Stack-level work items in a deterministic (sorted) order"""
+    if all_images:
+        return [
+            StackJob(os.path.splitext(os.path.basename(p))[0], [p], single_image=True)
+            for p in sorted(images)
+        ]
+    stacks = group_images_into_stacks(images)
+    return [StackJob(key, sort_stack_paths(stacks[key])) for key in sorted(stacks)]
+
+def _center_distance(image_path: str, droplet_center: dict) -> str:
+    """Distance (pixels) from droplet center to image center"""
+    img = cv2.imread(image_path)
+    H, W = img.shape[:2] if img is not None else (None, None)
+    if H is not None and W is not None and "x" in droplet_center and "y" in droplet_center:
+        icx, icy = W / 2.0, H / 2.0
+        dx = float(droplet_center["x"]) - icx
+        dy = float(droplet_center["y"]) - icy
+        return f"{math.hypot(dx, dy):.3f}"
+    return ""
+
+def _result_row(stack_key: str, chosen_path: str, score: str, results: dict) -> list:
+    chosen_name = os.path.basename(chosen_path)
+    chosen_z = extract_z_mm_from_name(chosen_name)
+    red_dist = results["s_red_px"]
+    blue_dist = results["s_blue_px"]
+    hsv_red1 = results["hsv_red1"]; hsv_red2 = results["hsv_red2"]
+    hsv_blue1 = results["hsv_blue1"]; hsv_blue2 = results["hsv_blue2"]
+    droplet_center = results.get("droplet_center", {})
+    red_m  = results.get("red_detection_method", "")
+    blue_m = results.get("blue_detection_method", "")
+    drop_m = results.get("droplet_detection_method", "")
+    return [
+        stack_key,
+        chosen_name,
+        f"{chosen_z}" if chosen_z is not None else "",
+        score,
+        f"{red_dist:.3f}",
+        f"{blue_dist:.3f}",
+        hsv_red1["y"], hsv_red1["x"], hsv_red1["h"], hsv_red1["s"], hsv_red1["v"],
+        hsv_red2["y"], hsv_red2["x"], hsv_red2["h"], hsv_red2["s"], hsv_red2["v"],
+        hsv_blue1["y"], hsv_blue1["x"], hsv_blue1["h"], hsv_blue1["s"], hsv_blue1["v"],
+        hsv_blue2["y"], hsv_blue2["x"], hsv_blue2["h"], hsv_blue2["s"], hsv_blue2["v"],
+        droplet_center.get("x", ""), droplet_center.get("y", ""),
+        _center_distance(chosen_path, droplet_center),
+        red_m, blue_m, drop_m,
+    ]
+
+def measure_job(
+    job: StackJob,
+    debug: bool = False,
+    output_folder: Optional[str] = None,
+    expect_red_sep: float = 80.0,
+    red_sep_tol: float = 30.0,
+    params_path: Optional[str] = None,
+) -> StackResult:
+    """
+    Measure one stack (or image) and return its CSV row. Runs in a worker
+    process, so it never raises: failures come back as a row of None.
+    """
+    start = time.perf_counter()
+    try:
+        if job.single_image:
+            # every image individually, no z-stack, ignore params
+            p = job.paths[0]
+            results = process_image(
+                p,
+                output_csv=None,
+                debug=debug,
+                debug_folder=output_folder,
+                params=None,
+                params_path=None,
+            )
+            row = _result_row(job.stack_key, p, "", results)
+            message = f"[OK] {os.path.basename(p)}: Red={results['s_red_px']:.2f}  Blue={results['s_blue_px']:.2f}"
+        else:
+            results = process_z_stack_then_measure(
+                job.paths,
+                output_csv=None,              # CSV handled by the caller
+                debug=debug,
+                debug_folder=output_folder,
+                expect_red_sep=expect_red_sep,
+                red_sep_tol=red_sep_tol,
+                params_path=params_path
+            )
+            chosen_path = results.get("chosen_best_focus_image", results["image_path"])
+
+            # focus score for the chosen image
+            score = ""
+            for item in results.get("focus_ranking", []):
+                # os.path.samefile may fail across drives; fallback to basename match if needed:
+                try:
+                    same = os.path.samefile(item["path"], chosen_path)
+                except Exception:
+                    same = (os.path.basename(item["path"]) == os.path.basename(chosen_path))
+                if same:
+                    score = f'{item["score"]:.3f}'
+                    break
+            row = _result_row(job.stack_key, chosen_path, score, results)
+            message = (
+                f"[OK] {job.stack_key}: picked {row[1]} (z={row[2]}, score={score})  "
+                f"Red={results['s_red_px']:.2f}  Blue={results['s_blue_px']:.2f}"
+            )
+    except Exception as e:
+        row = None
+        if job.single_image:
+            message = f"[ERROR] Failed on image '{job.paths[0]}': {e}"
+        else:
+            message = f"[ERROR] Failed on stack '{job.stack_key}' with {len(job.paths)} images: {e}"
+    seconds = time.perf_counter() - start
+    if row is not None:
+        row.append(f"{seconds:.3f}")
+    return StackResult(job.stack_key, row, message, seconds)
+
+def read_completed_stacks(output_csv: str) -> set:
+    """
+    StackKeys already written to an existing output CSV.
+
+    Raises ValueError if the file was written with other columns than HEADER,
+    since rows appended to it would not line up with its header.
+    """
+    if not os.path.exists(output_csv):
+        return set()
+    with open(output_csv, newline="") as f:
+        reader = csv.reader(f)
+        header = next(reader, None)
+        if header is None:
+            return set()
+        if header != HEADER:
+            raise ValueError(
+                f"Cannot resume: {output_csv} has columns {header}, expected {HEADER}. "
+                "Move it aside or run without --resume."
+            )
+        key = HEADER.index("StackKey")
+        return {row[key] for row in reader if len(row) > key and row[key]}
+
+def _init_worker():
+    # One OpenCV thread per process, the pool provides the parallelism
+    cv2.setNumThreads(1)
+
+def run_batch(
+    jobs: List[StackJob],
+    output_csv: str,
+    workers: int = 1,
+    resume: bool = False,
+    **measure_kwargs,
+) -> List[StackResult]:
+    """
+    Measure jobs on a process pool and write their rows to output_csv.
+
+    Rows are written in job order whatever order the workers finish in, and
+    the file is flushed after every row so an interrupted run can be resumed.
+    With resume, stacks already present in output_csv are skipped and new
+    rows are appended. Failed stacks are not written, so a resumed run
+    retries them.
+
+    Returns the results of the jobs that ran, in job order.
+    """
+    done = read_completed_stacks(output_csv) if resume else set()
+    pending = [job for job in jobs if job.stack_key not in done]
+    if done:
+        print(f"Resuming: {len(jobs) - len(pending)} of {len(jobs)} stacks already in {os.path.basename(output_csv)}.")
+
+    append = resume and os.path.exists(output_csv) and os.path.getsize(output_csv) > 0
+    results: List[StackResult] = []
+    start = time.perf_counter()
+    with open(output_csv, "a" if append else "w", newline="") as f:
+        writer = csv.writer(f)
+        if not append:
+            writer.writerow(HEADER)
+            f.flush()
+
+        def _write(result: StackResult):
+            print(result.message)
+            if result.row is not None:
+                writer.writerow(result.row)
+                f.flush()
+            results.append(result)
+
+        if workers <= 1:
+            for job in pending:
+                _write(measure_job(job, **measure_kwargs))
+        else:
+            with ProcessPoolExecutor(max_workers=workers, initializer=_init_worker) as pool:
+                futures = {
+                    pool.submit(measure_job, job, **measure_kwargs): index
+                    for index, job in enumerate(pending)
+                }
+                # hold finished stacks until every earlier one is written
+                finished: Dict[int, StackResult] = {}
+                next_index = 0
+                for future in as_completed(futures):
+                    finished[futures[future]] = future.result()
+                    while next_index in finished:
+                        _write(finished.pop(next_index))
+                        next_index += 1
+
+    elapsed = time.perf_counter() - start
+    ok = sum(1 for r in results if r.row is not None)
+    rate = len(results) / elapsed if elapsed > 0 else 0.0
+    print(f"Processed {len(results)} stacks ({ok} ok) in {elapsed:.1f} s, {rate:.2f} stacks/s with {workers} worker(s).")
+    return results
+
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(description="Batch process Z-stacks: auto-pick in-focus frame, then measure LED distances.")
     parser.add_argument("input_folder", help="Path to folder containing images")
@@ -81,14 +329,13 @@ if __name__ == "__main__":
     parser.add_argument("--params_path", type=str, help="Path to led_params.json")
     parser.add_argument("--all_images", action="store_true", help="Process each image individually (skip z-stack focus selection). Ignores --params_path."
 )
+    parser.add_argument("--workers", type=int, default=os.cpu_count() or 1, help="Worker processes (1 = process in this process)")
+    parser.add_argument("--resume", action="store_true", help="Skip stacks already in output.csv and append the rest")
 
     args = parser.parse_args()
 
     input_folder = args.input_folder
     output_folder = args.output_folder
-    debug = args.debug
-    expect_red_sep = args.expect_red_sep
-    red_sep_tol = args.red_sep_tol
 
     os.makedirs(output_folder, exist_ok=True)
     
@@ -104,167 +351,20 @@ if __name__ == "__main__":
 
     output_csv = os.path.join(output_folder, "output.csv")
 
-    # Common header for both modes (FocusScore/ChosenZ_mm will be blank in --all_images mode)
-    HEADER = [
-        "StackKey",
-        "ChosenImage",
-        "ChosenZ_mm",
-        "FocusScore",
-        "s_red_px",
-        "s_blue_px",
-        "Red1_Y", "Red1_X", "Red1_H", "Red1_S", "Red1_V",
-        "Red2_Y", "Red2_X", "Red2_H", "Red2_S", "Red2_V",
-        "Blue1_Y", "Blue1_X", "Blue1_H", "Blue1_S", "Blue1_V",
-        "Blue2_Y", "Blue2_X", "Blue2_H", "Blue2_S", "Blue2_V",
-        "DropletCenter_X", "DropletCenter_Y",
-        "DropletCenter_to_ImageCenter_px",
-        "RedMethod", "BlueMethod", "DropletMethod"
-    ]
-
-    with open(output_csv, "w", newline="") as f:
-        writer = csv.writer(f)
-        writer.writerow(HEADER)
-
-        if args.all_images:
-            # --- Simple pass: every image individually, no z-stack, ignore params ---
-            images_sorted = sorted(images)
-            print(f"Processing {len(images_sorted)} images individually (no z-stack).")
+    jobs = build_jobs(images, all_images=args.all_images)
+    if args.all_images:
+        print(f"Processing {len(jobs)} images individually (no z-stack).")
+    else:
+        print(f"Found {len(jobs)} stacks.")
 
-            for p in images_sorted:
-                try:
-                    res = process_image(
-                        p,
-                        output_csv=None,
-                        debug=debug,
-                        debug_folder=output_folder,
-                        params=None,         # <-- ignore params
-                        params_path=None,    # <-- ignore params file
-                    )
-
-                    img_name = os.path.basename(p)
-                    chosen_z = extract_z_mm_from_name(img_name)
-                    red_dist = res["s_red_px"]
-                    blue_dist = res["s_blue_px"]
-                    hsv_red1 = res["hsv_red1"]; hsv_red2 = res["hsv_red2"]
-                    hsv_blue1 = res["hsv_blue1"]; hsv_blue2 = res["hsv_blue2"]
-                    droplet_center = res.get("droplet_center", {})
-                    red_m  = res.get("red_detection_method", "")
-                    blue_m = res.get("blue_detection_method", "")
-                    drop_m = res.get("droplet_detection_method", "")
-                                        
-                    img = cv2.imread(p)
-                    H, W = img.shape[:2] if img is not None else (None, None)
-
-                    # Compute distance (pixels) from droplet center to image center
-                    if H is not None and W is not None and "x" in droplet_center and "y" in droplet_center:
-                        icx, icy = W / 2.0, H / 2.0
-                        dx = float(droplet_center["x"]) - icx
-                        dy = float(droplet_center["y"]) - icy
-                        center_dist = f"{math.hypot(dx, dy):.3f}"
-                    else:
-                        center_dist = ""
-
-                    row = [
-                        # StackKey: use base filename as a simple key in this mode
-                        os.path.splitext(img_name)[0],
-                        img_name,
-                        f"{chosen_z}" if chosen_z is not None else "",
-                        "",  # FocusScore blank in all-images mode
-                        f"{red_dist:.3f}",
-                        f"{blue_dist:.3f}",
-                        hsv_red1["y"], hsv_red1["x"], hsv_red1["h"], hsv_red1["s"], hsv_red1["v"],
-                        hsv_red2["y"], hsv_red2["x"], hsv_red2["h"], hsv_red2["s"], hsv_red2["v"],
-                        hsv_blue1["y"], hsv_blue1["x"], hsv_blue1["h"], hsv_blue1["s"], hsv_blue1["v"],
-                        hsv_blue2["y"], hsv_blue2["x"], hsv_blue2["h"], hsv_blue2["s"], hsv_blue2["v"],
-                        droplet_center.get("x", ""), droplet_center.get("y", ""),
-                        center_dist,
-                        red_m, blue_m, drop_m,
-                    ]
-                    writer.writerow(row)
-                    print(f"[OK] {img_name}: Red={red_dist:.2f}  Blue={blue_dist:.2f}")
-
-                except Exception as e:
-                    print(f"[ERROR] Failed on image '{p}': {e}")
-
-        else:
-            # --- Original z-stack mode ---
-            stacks = group_images_into_stacks(images)
-            print(f"Found {len(stacks)} stacks.")
-
-            for stack_key, paths in stacks.items():
-                # sort by parsed Z so logs read nicely
-                decorated = []
-                for p in paths:
-                    z = extract_z_mm_from_name(p)
-                    z_sort = z if z is not None else float("inf")
-                    decorated.append((z_sort, p))
-                decorated.sort(key=lambda t: t[0])
-                sorted_paths = [p for _, p in decorated]
-
-                try:
-                    results = process_z_stack_then_measure(
-                        sorted_paths,
-                        output_csv=None,              # CSV handled here
-                        debug=debug,
-                        debug_folder=output_folder,
-                        expect_red_sep=expect_red_sep,
-                        red_sep_tol=red_sep_tol,
-                        params_path=args.params_path
-                    )
-
-                    chosen_path = results.get("chosen_best_focus_image", results["image_path"])
-                    chosen_name = os.path.basename(chosen_path)
-                    chosen_z = extract_z_mm_from_name(chosen_name)
-
-                    # focus score for the chosen image
-                    score = ""
-                    fr = results.get("focus_ranking", [])
-                    for item in fr:
-                        # os.path.samefile may fail across drives; fallback to basename match if needed:
-                        try:
-                            same = os.path.samefile(item["path"], chosen_path)
-                        except Exception:
-                            same = (os.path.basename(item["path"]) == os.path.basename(chosen_path))
-                        if same:
-                            score = f'{item["score"]:.3f}'
-                            break
-
-                    red_dist = results["s_red_px"]
-                    blue_dist = results["s_blue_px"]
-                    hsv_red1 = results["hsv_red1"]; hsv_red2 = results["hsv_red2"]
-                    hsv_blue1 = results["hsv_blue1"]; hsv_blue2 = results["hsv_blue2"]
-                    droplet_center = results.get("droplet_center", {})
-                    red_m  = results.get("red_detection_method", "")
-                    blue_m = results.get("blue_detection_method", "")
-                    drop_m = results.get("droplet_detection_method", "")
-                    img = cv2.imread(chosen_path)
-                    H, W = img.shape[:2] if img is not None else (None, None)
-
-                    if H is not None and W is not None and "x" in droplet_center and "y" in droplet_center:
-                        icx, icy = W / 2.0, H / 2.0
-                        dx = float(droplet_center["x"]) - icx
-                        dy = float(droplet_center["y"]) - icy
-                        center_dist = f"{math.hypot(dx, dy):.3f}"
-                    else:
-                        center_dist = ""
-
-                    row = [
-                        stack_key,
-                        chosen_name,
-                        f"{chosen_z}" if chosen_z is not None else "",
-                        score,
-                        f"{red_dist:.3f}",
-                        f"{blue_dist:.3f}",
-                        hsv_red1["y"], hsv_red1["x"], hsv_red1["h"], hsv_red1["s"], hsv_red1["v"],
-                        hsv_red2["y"], hsv_red2["x"], hsv_red2["h"], hsv_red2["s"], hsv_red2["v"],
-                        hsv_blue1["y"], hsv_blue1["x"], hsv_blue1["h"], hsv_blue1["s"], hsv_blue1["v"],
-                        hsv_blue2["y"], hsv_blue2["x"], hsv_blue2["h"], hsv_blue2["s"], hsv_blue2["v"],
-                        droplet_center.get("x", ""), droplet_center.get("y", ""),
-                        center_dist,
-                        red_m, blue_m, drop_m,
-                    ]
-                    writer.writerow(row)
-                    print(f"[OK] {stack_key}: picked {chosen_name} (z={chosen_z}, score={score})  Red={red_dist:.2f}  Blue={blue_dist:.2f}")
-
-                except Exception as e:
-                    print(f"[ERROR] Failed on stack '{stack_key}' with {len(paths)} images: {e}")
+    run_batch(
+        jobs,
+        output_csv,
+        workers=args.workers,
+        resume=args.resume,
+        debug=args.debug,
+        output_folder=output_folder,
+        expect_red_sep=args.expect_red_sep,
+        red_sep_tol=args.red_sep_tol,
+        params_path=None if args.all_images else args.params_path,
+    )
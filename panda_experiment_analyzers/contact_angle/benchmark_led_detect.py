@@ -0,0 +1,108 @@
+"""
+Per-frame latency of the LED detectors.
+
+Runs focus scoring, both specular detectors and process_image on one image,
+first with a fresh FramePrep per detector (each detector redoes the gray/HSV,
+CLAHE, DoG, masks and contours, as before the detectors shared them) and then
+with one FramePrep shared by all of them, and prints the median time of each
+stage in milliseconds.
+
+    python -m panda_experiment_analyzers.contact_angle.benchmark_led_detect images/test.tiff --repeats 20
+"""
+
+import argparse
+import os
+import statistics
+import time
+
+import cv2
+
+from .contact_angle_led_detect import (
+    FramePrep,
+    detect_led_pairs_robust,
+    detect_led_pairs_specular_no_color,
+    process_image,
+    score_focus_image,
+)
+
+DEFAULT_IMAGE = os.path.join(
+    os.path.dirname(__file__), "..", "..", "images", "test.tiff"
+)
+
+
+def _timed(fn):
+    t0 = time.perf_counter()
+    try:
+        fn()
+    except ValueError:
+        # a frame the detector rejects still costs the same work, keep timing it
+        pass
+    return (time.perf_counter() - t0) * 1000.0
+
+
+def run_frame(image, image_path, shared: bool) -> dict:
+    """Time each stage on one frame, returns {stage: ms}"""
+
+    def prep():
+        return shared_prep if shared else FramePrep(image)
+
+    shared_prep = FramePrep(image)
+    timings = {}
+    timings["focus"] = _timed(lambda: score_focus_image(image, prep=prep()))
+
+    center_prep = prep()
+    try:
+        center, _, _ = center_prep.droplet()
+    except ValueError:
+        center = (image.shape[1] // 2, image.shape[0] // 2)
+
+    def robust():
+        p = prep()
+        detect_led_pairs_robust(image, p.hsv, p.gray, center, prep=p)
+
+    def specular():
+        p = prep()
+        detect_led_pairs_specular_no_color(image, p.gray, center, prep=p)
+
+    timings["robust"] = _timed(robust)
+    timings["specular"] = _timed(specular)
+    timings["process_image"] = _timed(
+        lambda: process_image(image_path, params={"detection": {"ignore_color": True}}, prep=prep())
+    )
+    timings["frame"] = sum(timings.values())
+    return timings
+
+
+def benchmark(image_path: str, repeats: int = 10) -> dict:
+    """Median per-stage ms for the separate and shared runs: {"separate": {...}, "shared": {...}}"""
+    image = cv2.imread(image_path)
+    if image is None:
+        raise ValueError(f"Could not read image at {image_path}")
+    # warm up OpenCV's lazy initialisation before timing
+    run_frame(image, image_path, shared=True)
+
+    report = {}
+    for mode in ("separate", "shared"):
+        runs = [run_frame(image, image_path, shared=(mode == "shared")) for _ in range(repeats)]
+        report[mode] = {stage: statistics.median(r[stage] for r in runs) for stage in runs[0]}
+    return report
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Per-frame latency of the LED detectors")
+    parser.add_argument("image", nargs="?", default=DEFAULT_IMAGE, help="Image to time (default: images/test.tiff)")
+    parser.add_argument("--repeats", type=int, default=10, help="Timed runs per mode")
+    args = parser.parse_args()
+
+    report = benchmark(args.image, args.repeats)
+    h, w = cv2.imread(args.image).shape[:2]
+    print(f"{os.path.basename(args.image)} ({w}x{h}), median of {args.repeats} runs, ms")
+    print(f"{'stage':<15}{'separate':>10}{'shared':>10}")
+    for stage in report["separate"]:
+        print(f"{stage:<15}{report['separate'][stage]:>10.1f}{report['shared'][stage]:>10.1f}")
+    speedup = report["separate"]["frame"] / max(report["shared"]["frame"], 1e-9)
+    print(f"Per-frame speedup with a shared FramePrep: {speedup:.2f}x")
+
+
+if __name__ == "__main__":
+    main()
@@ -67,7 +67,6 @@ import cv2
 import numpy as np
 import csv
 import os
-from itertools import combinations
 import scipy.signal
 import matplotlib
 matplotlib.use('Agg')  # Use non-interactive backend for matplotlib
@@ -75,6 +74,8 @@ import matplotlib.pyplot as plt
 import math
 import re
 import json
+import threading
+from concurrent.futures import ThreadPoolExecutor
 from typing import Optional, List, Tuple, Dict, Any
 
 # Placeholder stubs for missing functions (implement or import as needed)
@@ -91,36 +92,186 @@ def dog_response(v, sigma_small=1.5, sigma_big=3.5):
     return cv2.subtract(g1, g2)
 
 def color_likelihood_h(hsv_img, target_h, tol=18, sat_min=10):
-    h = hsv_img[:,:,0]
-    s = hsv_img[:,:,1]
-    mask = ((np.abs(h.astype(int)-target_h) <= tol) & (s >= sat_min)).astype(np.uint8)*255
-    return mask
-
-def build_droplet_ring_mask(shape, center, r_in, r_out):
-    H, W = shape[:2]
-    Y, X = np.ogrid[:H, :W]
-    dist = np.sqrt((X-center[0])**2 + (Y-center[1])**2)
+    # |h - target_h| <= tol and s >= sat_min, as one inRange pass
+    lower = np.array([max(0, target_h - tol), sat_min, 0], np.uint8)
+    upper = np.array([min(255, target_h + tol), 255, 255], np.uint8)
+    return cv2.inRange(hsv_img, lower, upper)
+
+def build_droplet_ring_mask(shape, center, r_in, r_out, dist=None):
+    if dist is None:
+        H, W = shape[:2]
+        Y, X = np.ogrid[:H, :W]
+        dist = np.sqrt((X-center[0])**2 + (Y-center[1])**2)
     mask = ((dist >= r_in) & (dist <= r_out)).astype(np.uint8)*255
     return mask
 
-def conn_comp_candidates(bw, min_area=4, max_area=400):
+def find_blobs(bw):
+    """
+    Outer contours of a binary image with their area and centroid as arrays.
+    cx/cy are -1 where the contour has no moment area (m00 == 0).
+    """
     cnts, _ = cv2.findContours(bw, cv2.RETR_EXTERNAL, cv2.CHAIN_APPROX_SIMPLE)
-    cands = []
-    for c in cnts:
-        a = cv2.contourArea(c)
-        if not (min_area <= a <= max_area):
-            continue
+    n = len(cnts)
+    area = np.zeros(n); cx = np.full(n, -1, np.int64); cy = np.full(n, -1, np.int64)
+    for k, c in enumerate(cnts):
+        area[k] = cv2.contourArea(c)
         M = cv2.moments(c)
-        if M["m00"] == 0: continue
-        cx = int(M["m10"]/M["m00"])
-        cy = int(M["m01"]/M["m00"])
-        per = cv2.arcLength(c, True)
-        compact = 0.0
-        if a > 0 and per > 0:
-            circ = (per*per)/(4.0*np.pi*a)
-            compact = 1.0/max(circ, 1e-6)
-        cands.append({"cx":cx, "cy":cy, "compact":compact})
-    return cands
+        if M["m00"] != 0:
+            cx[k] = int(M["m10"]/M["m00"])
+            cy[k] = int(M["m01"]/M["m00"])
+    return {"contours": cnts, "area": area, "cx": cx, "cy": cy, "has_centroid": cx >= 0}
+
+def _compactness_of(contour, area):
+    per = cv2.arcLength(contour, True)
+    if area > 0 and per > 0:
+        circ = (per*per)/(4.0*np.pi*area)
+        return 1.0/max(circ, 1e-6)
+    return 0.0
+
+def conn_comp_candidates(bw, min_area=4, max_area=400, blobs=None):
+    if blobs is None:
+        blobs = find_blobs(bw)
+    keep = (blobs["area"] >= min_area) & (blobs["area"] <= max_area) & blobs["has_centroid"]
+    return [
+        {"cx": int(blobs["cx"][k]), "cy": int(blobs["cy"][k]),
+         "compact": _compactness_of(blobs["contours"][k], blobs["area"][k])}
+        for k in np.flatnonzero(keep)
+    ]
+
+def norm255(img):
+    a, b = float(img.min()), float(img.max())
+    if b - a < 1e-6: return np.zeros_like(img, np.uint8)
+    return ((img - a) * (255.0/(b-a))).astype(np.uint8)
+
+def pair_geometry(points):
+    """
+    Every unordered pair of points, in itertools.combinations order.
+    Returns (i, j, dx, dy, sep): index arrays and |dx|, |dy|, distance per pair.
+    """
+    pts = np.asarray(points, dtype=np.int64).reshape(-1, 2)
+    i, j = np.triu_indices(len(pts), k=1)
+    d = np.abs(pts[i] - pts[j])
+    return i, j, d[:, 0], d[:, 1], np.hypot(d[:, 0], d[:, 1])
+
+def pick_best_pair(points, i, j, score, valid=None):
+    """Highest scoring valid pair as ((x1,y1),(x2,y2)), first one on ties; None if no pair is valid"""
+    if valid is not None:
+        score = np.where(valid, score, -np.inf)
+    if score.size == 0 or not np.isfinite(score).any():
+        return None
+    k = int(np.argmax(score))
+    p1, p2 = points[i[k]], points[j[k]]
+    return (int(p1[0]), int(p1[1])), (int(p2[0]), int(p2[1]))
+
+class FramePrep:
+    """
+    Intermediate images of one BGR frame (gray, HSV, CLAHE-V, DoG, top-hat,
+    inRange masks, contours, droplet center), each computed on first use.
+
+    Pass one FramePrep to the detectors that look at the same frame so the
+    work is done once per frame rather than once per detector:
+
+        prep = FramePrep(cv2.imread(path))
+        focus = score_focus_image(prep.image, prep=prep)
+        results = process_image(path, prep=prep)
+    """
+
+    def __init__(self, image, gray=None, hsv=None):
+        if image.ndim == 2:
+            image = cv2.cvtColor(image, cv2.COLOR_GRAY2BGR)
+        self.image = image
+        self._cache = {}
+        if gray is not None: self._cache["gray"] = gray
+        if hsv is not None: self._cache["hsv"] = hsv
+
+    @classmethod
+    def from_path(cls, image_path):
+        image = cv2.imread(image_path)
+        if image is None:
+            raise ValueError(f"Could not read image at {image_path}")
+        return cls(image)
+
+    def _get(self, key, build):
+        if key not in self._cache:
+            self._cache[key] = build()
+        return self._cache[key]
+
+    def has(self, key) -> bool:
+        return key in self._cache
+
+    @property
+    def gray(self):
+        return self._get("gray", lambda: cv2.cvtColor(self.image, cv2.COLOR_BGR2GRAY))
+
+    @property
+    def hsv(self):
+        return self._get("hsv", lambda: cv2.cvtColor(self.image, cv2.COLOR_BGR2HSV))
+
+    @property
+    def hsv_norm(self):
+        return self._get("hsv_norm", lambda: clahe_on_v(self.hsv))
+
+    @property
+    def v_clahe(self):
+        return self.hsv_norm[:,:,2]
+
+    def dog(self, sigma_small=1.5, sigma_big=3.5):
+        return self._get(("dog", sigma_small, sigma_big), lambda: dog_response(self.v_clahe, sigma_small, sigma_big))
+
+    def dog_n(self, sigma_small=1.5, sigma_big=3.5):
+        return self._get(("dog_n", sigma_small, sigma_big), lambda: norm255(self.dog(sigma_small, sigma_big)))
+
+    @property
+    def tophat(self):
+        se = cv2.getStructuringElement(cv2.MORPH_ELLIPSE, (9,9))
+        return self._get("tophat", lambda: cv2.morphologyEx(self.v_clahe, cv2.MORPH_TOPHAT, se))
+
+    @property
+    def tophat_n(self):
+        return self._get("tophat_n", lambda: norm255(self.tophat))
+
+    def mask(self, lower, upper):
+        """cv2.inRange of the HSV frame"""
+        lower = np.asarray(lower, np.uint8); upper = np.asarray(upper, np.uint8)
+        key = ("mask", lower.tobytes(), upper.tobytes())
+        return self._get(key, lambda: cv2.inRange(self.hsv, lower, upper))
+
+    def color_likelihood(self, target_h, tol=18, sat_min=10):
+        # CLAHE only touches V, so the raw HSV hue/saturation are the same
+        return self.mask(
+            [max(0, target_h - tol), sat_min, 0], [min(255, target_h + tol), 255, 255]
+        )
+
+    def blobs(self, bw):
+        """find_blobs of a binary image, cached while the same array is passed in"""
+        key = ("blobs", id(bw))
+        entry = self._cache.get(key)
+        if entry is None or entry[0] is not bw:
+            entry = (bw, find_blobs(bw))
+            self._cache[key] = entry
+        return entry[1]
+
+    def center_distance(self, center):
+        """Per-pixel distance to center"""
+        def build():
+            H, W = self.gray.shape[:2]
+            Y, X = np.ogrid[:H, :W]
+            return np.sqrt((X-center[0])**2 + (Y-center[1])**2)
+        return self._get(("dist", int(center[0]), int(center[1])), build)
+
+    def ring(self, center, r_in, r_out):
+        return self._get(
+            ("ring", int(center[0]), int(center[1]), r_in, r_out),
+            lambda: build_droplet_ring_mask(self.gray.shape, center, r_in, r_out, self.center_distance(center)),
+        )
+
+    def droplet(self, debug_folder=None, img_basename=""):
+        """detect_droplet_center on the gray frame; failures are not cached"""
+        if "droplet" not in self._cache:
+            self._cache["droplet"] = detect_droplet_center(
+                self.gray, debug_folder=debug_folder, img_basename=img_basename
+            )
+        return self._cache["droplet"]
 
 # Fix type hints for compatibility
 def load_led_params(params_path: Optional[str]):
@@ -190,28 +341,25 @@ def score_led_focus_for_frame(
     search_radius: int = 100,
     expect_red_sep: float = 80.0,
     red_sep_tol: float = 30.0,
+    prep: Optional[FramePrep] = None,
 ) -> dict:
     """
     Returns a dict with:
       score (float): higher = better focus for LED reflections
       details (dict): per-spot metrics and geometry info for logging
       picks (dict): chosen red/blue pairs [(x,y), (x,y)] if available
+    Pass the frame's FramePrep to reuse its gray image and mask contours.
     """
-    gray = cv2.cvtColor(image, cv2.COLOR_BGR2GRAY)
+    if prep is None:
+        prep = FramePrep(image)
+    gray = prep.gray
     cx0, cy0 = droplet_center
 
     def _components(mask):
-        cnts, _ = cv2.findContours(mask, cv2.RETR_EXTERNAL, cv2.CHAIN_APPROX_SIMPLE)
+        b = prep.blobs(mask)
         # limit to search_radius around droplet center
-        kept = []
-        for c in cnts:
-            M = cv2.moments(c)
-            if M["m00"] == 0: 
-                continue
-            cx = int(M["m10"]/M["m00"]); cy = int(M["m01"]/M["m00"])
-            if np.hypot(cx-cx0, cy-cy0) <= search_radius:
-                kept.append((c, (cx,cy)))
-        return kept
+        near = b["has_centroid"] & (np.hypot(b["cx"]-cx0, b["cy"]-cy0) <= search_radius)
+        return [(b["contours"][k], (int(b["cx"][k]), int(b["cy"][k]))) for k in np.flatnonzero(near)]
 
     def _rank_two_spots(components):
         # Rank by composite spot score (sharpness + contrast + compactness)
@@ -321,75 +469,228 @@ def score_led_focus_for_frame(
         }
     }
 
-def select_best_focus_frame(
-    image_paths: list[str],
-    debug_folder: str | None = None,
+FOCUS_RED_LOWER = np.array([150, 0, 200]); FOCUS_RED_UPPER = np.array([170, 255, 255])
+FOCUS_BLUE_LOWER = np.array([85, 10, 200]); FOCUS_BLUE_UPPER = np.array([100, 255, 255])
+
+def score_focus_image(
+    img: np.ndarray,
     expect_red_sep: float = 80.0,
-    red_sep_tol: float = 30.0
-) -> tuple[str, dict]:
+    red_sep_tol: float = 30.0,
+    debug_folder: str | None = None,
+    img_basename: str = "",
+    prep: FramePrep | None = None,
+) -> dict | None:
     """
-    Returns (best_image_path, log_dict)
+    Focus score of one BGR frame, or None when no droplet is found.
+    Returns the score_led_focus_for_frame dict.
     """
-    scored = []
-    os.makedirs(debug_folder, exist_ok=True) if debug_folder else None
-
-    for p in image_paths:
-        img = cv2.imread(p)
-        if img is None:
-            continue
-        gray = cv2.cvtColor(img, cv2.COLOR_BGR2GRAY)
-        base = os.path.splitext(os.path.basename(p))[0]
+    if prep is None:
+        prep = FramePrep(img)
+    try:
+        droplet_center, _, _ = prep.droplet(debug_folder=debug_folder, img_basename=img_basename)
+    except Exception:
+        # no droplet = unscored
+        return None
 
-        try:
-            droplet_center, _, _ = detect_droplet_center(gray, debug_folder=debug_folder, img_basename=base)
-        except Exception:
-            # no droplet = unscored
-            continue
+    red_mask = prep.mask(FOCUS_RED_LOWER, FOCUS_RED_UPPER)
+    blue_mask = prep.mask(FOCUS_BLUE_LOWER, FOCUS_BLUE_UPPER)
 
-        hsv = cv2.cvtColor(img, cv2.COLOR_BGR2HSV)
-        red_lower = np.array([150, 0, 200]); red_upper = np.array([170, 255, 255])
-        blue_lower = np.array([85, 10, 200]); blue_upper = np.array([100, 255, 255])
-        red_mask = cv2.inRange(hsv, red_lower, red_upper)
-        blue_mask = cv2.inRange(hsv, blue_lower, blue_upper)
+    return score_led_focus_for_frame(
+        prep.image, droplet_center, red_mask, blue_mask,
+        search_radius=100,
+        expect_red_sep=expect_red_sep, red_sep_tol=red_sep_tol,
+        prep=prep
+    )
 
-        s = score_led_focus_for_frame(
-            img, droplet_center, red_mask, blue_mask,
-            search_radius=100,
-            expect_red_sep=expect_red_sep, red_sep_tol=red_sep_tol
-        )
-        z = extract_z_mm_from_name(p)
-        scored.append({
-            "path": p,
-            "z_mm": z,
-            "score": s["score"],
-            "red_sep": s["details"]["red_sep"],
-            "blue_sep": s["details"]["blue_sep"],
-        })
-
-    if not scored:
-        raise RuntimeError("No frames could be scored for focus.")
+class StreamingFocusScorer:
+    """
+    Scores z-stack frames one at a time as they are acquired.
+
+    Keeps a running best and reports when the focus curve has peaked: the best
+    score is followed by `patience` frames that are all at least `min_drop`
+    below it (frames without a droplet count as below). The acquisition can
+    stop there, and the chosen frame is known when the stack finishes.
+
+    add() scores on the caller's thread. submit() scores on a single worker
+    thread so a capture loop is not held up. peaked only reflects the frames
+    scored so far; peak_reached() waits for the submitted ones first. Call
+    finish() before reading the result, and reset() before the next stack.
+
+        scorer = StreamingFocusScorer()
+        for frame, z in sweep:
+            scorer.submit(frame, z_mm=z, name=f"z{z}")
+            if scorer.peak_reached():
+                break
+        best = scorer.finish()
+    """
 
-    scored.sort(key=lambda d: d["score"], reverse=True)
-    best = scored[0]
+    def __init__(
+        self,
+        expect_red_sep: float = 80.0,
+        red_sep_tol: float = 30.0,
+        patience: int = 2,
+        min_drop: float = 0.5,
+        min_frames: int = 3,
+        debug_folder: str | None = None,
+    ):
+        self.expect_red_sep = expect_red_sep
+        self.red_sep_tol = red_sep_tol
+        self.patience = patience
+        self.min_drop = min_drop
+        self.min_frames = min_frames
+        self.debug_folder = debug_folder
+        self.scored: list[dict] = []
+        self.frames_seen = 0
+        self.best: dict | None = None
+        # FramePrep of the best frame, so measuring it does not redo the shared work
+        self.best_prep: FramePrep | None = None
+        self._frames_since_best = 0
+        self._lock = threading.Lock()
+        self._pool = None
+        self._pending = []
+        self._submitted = 0
+
+    @property
+    def peaked(self) -> bool:
+        with self._lock:
+            return (
+                self.best is not None
+                and self.frames_seen >= self.min_frames
+                and self._frames_since_best >= self.patience
+            )
 
-    # Optional: write a per-stack CSV log
-    if debug_folder:
+    def peak_reached(self) -> bool:
+        """Wait for the submitted frames to be scored, then report whether the focus has peaked"""
+        self._wait_pending()
+        return self.peaked
+
+    def reset(self):
+        """Forget the frames of the previous stack"""
+        self._wait_pending()
+        with self._lock:
+            self.scored = []
+            self.frames_seen = 0
+            self.best = None
+            self.best_prep = None
+            self._frames_since_best = 0
+        self._submitted = 0
+
+    def _wait_pending(self):
+        pending, self._pending = self._pending, []
+        for future in pending:
+            future.result()
+
+    def add(self, image: np.ndarray, z_mm: float | None = None, name: str | None = None, index: int | None = None) -> dict | None:
+        """Score one BGR frame and update the running best. Returns its row, None if unscored."""
+        with self._lock:
+            if index is None:
+                index = self.frames_seen
+            self.frames_seen += 1
+        prep = FramePrep(image)
+        s = score_focus_image(
+            image, self.expect_red_sep, self.red_sep_tol,
+            debug_folder=self.debug_folder, img_basename=name or f"frame_{index}",
+            prep=prep
+        )
+        row = None
+        if s is not None:
+            row = {
+                "index": index,
+                "path": name,
+                "z_mm": z_mm,
+                "score": s["score"],
+                "red_sep": s["details"]["red_sep"],
+                "blue_sep": s["details"]["blue_sep"],
+                "image": image,
+            }
+        with self._lock:
+            if row is not None:
+                self.scored.append(row)
+            if row is not None and (self.best is None or row["score"] > self.best["score"]):
+                self.best = row
+                self.best_prep = prep
+                self._frames_since_best = 0
+            elif self.best is not None and (row is None or row["score"] <= self.best["score"] - self.min_drop):
+                self._frames_since_best += 1
+            elif self.best is not None:
+                # within min_drop of the best: the curve has not clearly turned over
+                self._frames_since_best = 0
+        return row
+
+    def submit(self, image: np.ndarray, z_mm: float | None = None, name: str | None = None):
+        """Score a frame on the scorer's worker thread, frames are scored in order"""
+        if self._pool is None:
+            self._pool = ThreadPoolExecutor(max_workers=1, thread_name_prefix="focus-scorer")
+        index = self._submitted
+        self._submitted += 1
+        self._pending.append(self._pool.submit(self.add, image, z_mm, name, index))
+
+    def finish(self) -> dict | None:
+        """Wait for submitted frames and return the best row, None if no frame could be scored"""
+        self._wait_pending()
+        if self._pool is not None:
+            self._pool.shutdown(wait=True)
+            self._pool = None
+        return self.best
+
+    def ranked(self) -> list[dict]:
+        """Scored frames, best first, without the images"""
+        rows = [{k: v for k, v in row.items() if k != "image"} for row in self.scored]
+        return sorted(rows, key=lambda d: d["score"], reverse=True)
+
+    def write_log(self, debug_folder: str | None = None):
+        """Append the ranking to focus_scores.csv in the debug folder"""
+        debug_folder = debug_folder or self.debug_folder
+        if not debug_folder:
+            return
         out_csv = os.path.join(debug_folder, "focus_scores.csv")
         header = not os.path.exists(out_csv)
         with open(out_csv, "a", newline="") as f:
             w = csv.writer(f)
             if header:
                 w.writerow(["image_name","z_mm","score","red_sep","blue_sep"])
-            for row in scored:
+            for row in self.ranked():
                 w.writerow([
-                    os.path.basename(row["path"]), 
+                    os.path.basename(row["path"]) if row["path"] else f"frame_{row['index']}",
                     f"{row['z_mm']}" if row["z_mm"] is not None else "",
                     f"{row['score']:.3f}",
                     f"{row['red_sep']:.1f}" if row["red_sep"] else "",
                     f"{row['blue_sep']:.1f}" if row["blue_sep"] else "",
                 ])
 
-    return best["path"], {"ranked": scored}
+def select_best_focus_frame(
+    image_paths: list[str],
+    debug_folder: str | None = None,
+    expect_red_sep: float = 80.0,
+    red_sep_tol: float = 30.0
+) -> tuple[str, dict]:
+    """
+    Returns (best_image_path, log_dict). log_dict["prep"] is the FramePrep of
+    the best frame, for process_image(best_image_path, prep=...).
+    """
+    os.makedirs(debug_folder, exist_ok=True) if debug_folder else None
+    scorer = StreamingFocusScorer(
+        expect_red_sep=expect_red_sep, red_sep_tol=red_sep_tol, debug_folder=debug_folder
+    )
+
+    for p in image_paths:
+        img = cv2.imread(p)
+        if img is None:
+            continue
+        base = os.path.splitext(os.path.basename(p))[0]
+        row = scorer.add(img, z_mm=extract_z_mm_from_name(p), name=base)
+        if row is not None:
+            # keep the full path for the caller, the log uses the basename
+            row["path"] = p
+            row.pop("image")
+
+    if scorer.best is None:
+        raise RuntimeError("No frames could be scored for focus.")
+
+    # Optional: write a per-stack CSV log
+    scorer.write_log()
+
+    return scorer.best["path"], {"ranked": scorer.ranked(), "prep": scorer.best_prep}
 
 def detect_led_pairs_specular_no_color(
     image_bgr,
@@ -402,7 +703,8 @@ def detect_led_pairs_specular_no_color(
     red_expected_sep=80.0,
     red_sep_tol=35.0,
     debug_folder=None,
-    base_name=""
+    base_name="",
+    prep=None
 ):
     """
     Color-agnostic LED finder:
@@ -413,46 +715,33 @@ def detect_led_pairs_specular_no_color(
       - Ring mask (donut) around droplet to avoid rim/center
       - Pair by geometry: horizontal ≈ blue, vertical ≈ red
     """
+    if prep is None:
+        prep = FramePrep(image_bgr, gray=gray)
     H, W = gray.shape[:2]
     cx, cy = droplet_center
 
     # intensity (V-like) with CLAHE
-    v = cv2.cvtColor(image_bgr, cv2.COLOR_BGR2HSV)[:,:,2]
-    clahe = cv2.createCLAHE(clipLimit=2.0, tileGridSize=(8,8))
-    v2 = clahe.apply(v)
+    v2 = prep.v_clahe
 
     # DoG & top-hat
-    g1 = cv2.GaussianBlur(v2, (0,0), 1.8)
-    g2 = cv2.GaussianBlur(v2, (0,0), 4.2)
-    dog = cv2.subtract(g1, g2)
-    se = cv2.getStructuringElement(cv2.MORPH_ELLIPSE, (9,9))
-    tophat = cv2.morphologyEx(v2, cv2.MORPH_TOPHAT, se)
+    dog_n = prep.dog_n(1.8, 4.2)
+    top_n = prep.tophat_n
 
     # "whiteness" (achromaticity): bright & R≈G≈B
-    bgr = image_bgr.astype(np.float32)
-    mean_rgb = bgr.mean(axis=2) + 1e-6
-    std_rgb = bgr.std(axis=2)
-    achroma = (1.0 - (std_rgb / mean_rgb))  # high when achromatic
+    # per-pixel channel mean/std on split planes, much faster than reducing over axis=2
+    b, g, r = [c.astype(np.float32) for c in cv2.split(image_bgr)]
+    mean_rgb = (b + g + r) / np.float32(3)
+    std_rgb = np.sqrt(((b - mean_rgb)**2 + (g - mean_rgb)**2 + (r - mean_rgb)**2) / np.float32(3))
+    achroma = (1.0 - (std_rgb / (mean_rgb + 1e-6)))  # high when achromatic
     achroma = np.clip(achroma, 0, 1) * (v2.astype(np.float32)/255.0)  # favor bright achromatic
     achroma = (achroma*255).astype(np.uint8)
-
-    # normalize helper
-    def n255(x):
-        a, b = float(x.min()), float(x.max())
-        if b - a < 1e-6: return np.zeros_like(x, np.uint8)
-        return ((x - a) * (255.0/(b-a))).astype(np.uint8)
-
-    dog_n = n255(dog)
-    top_n = n255(tophat)
-    ach_n = n255(achroma)
+    ach_n = norm255(achroma)
 
     # ring (donut) ROI around the droplet
     R = int(max(30, 0.9*search_radius_px))
     r_in  = max(5, int(inner_ring_frac * R))
     r_out = min(int(outer_ring_frac * R), int(search_radius_px))
-    Y, X = np.ogrid[:H, :W]
-    dist = np.sqrt((X-cx)**2 + (Y-cy)**2)
-    ring = ((dist >= r_in) & (dist <= r_out)).astype(np.uint8)*255
+    ring = prep.ring(droplet_center, r_in, r_out)
 
     # combined score map (no color)
     score = cv2.min(255, (0.5*dog_n + 0.3*top_n + 0.2*ach_n)).astype(np.uint8)
@@ -465,21 +754,9 @@ def detect_led_pairs_specular_no_color(
     bw = cv2.morphologyEx(bw, cv2.MORPH_CLOSE, cv2.getStructuringElement(cv2.MORPH_ELLIPSE,(3,3)), 1)
 
     # connected components to candidates
-    cnts, _ = cv2.findContours(bw, cv2.RETR_EXTERNAL, cv2.CHAIN_APPROX_SIMPLE)
     cands = []
-    for c in cnts:
-        a = cv2.contourArea(c)
-        if a < 4 or a > 400:  # adjust if your dots are bigger/smaller
-            continue
-        M = cv2.moments(c)
-        if M["m00"] == 0: 
-            continue
-        px, py = int(M["m10"]/M["m00"]), int(M["m01"]/M["m00"])
-        per = cv2.arcLength(c, True)
-        compact = 0.0
-        if a > 0 and per > 0:
-            circ = (per*per)/(4.0*np.pi*a)
-            compact = 1.0/max(circ, 1e-6)
+    for d in conn_comp_candidates(bw, min_area=4, max_area=400):  # adjust if your dots are bigger/smaller
+        px, py = d["cx"], d["cy"]
 
         # local contrast
         y0,y1 = max(0,py-8), min(H,py+9)
@@ -489,7 +766,7 @@ def detect_led_pairs_specular_no_color(
         if patch.size:
             lc = float(np.percentile(patch,95) - np.median(patch))
 
-        s = float(0.45*dog_n[py,px] + 0.25*top_n[py,px] + 0.20*lc + 0.10*(255.0*compact))
+        s = float(0.45*dog_n[py,px] + 0.25*top_n[py,px] + 0.20*lc + 0.10*(255.0*d["compact"]))
         cands.append({"pt":(px,py), "score":s})
 
     # keep strongest few
@@ -497,36 +774,23 @@ def detect_led_pairs_specular_no_color(
     if len(cands) < 2:
         return None, None, {"why":"<2 candidates", "r_in":r_in, "r_out":r_out}
 
-    # pair scoring
-    def euclid(p,q): return float(np.hypot(p[0]-q[0], p[1]-q[1]))
+    # pair scoring over every candidate pair at once
+    pts = np.array([c["pt"] for c in cands], dtype=np.int64)
+    spot = np.array([c["score"] for c in cands])
+    i, j, dx, dy, sep = pair_geometry(pts)
 
     # choose horizontal pair (≈blue): large dx, sep in range, midpoint near droplet center
-    best_blue=None; best_bs=-1e9
-    for i in range(len(cands)):
-        for j in range(i+1, len(cands)):
-            p1, p2 = cands[i]["pt"], cands[j]["pt"]
-            dx, dy = abs(p1[0]-p2[0]), abs(p1[1]-p2[1])
-            sep = euclid(p1,p2)
-            if not (blue_sep_range[0] <= sep <= blue_sep_range[1]): continue
-            mid = ((p1[0]+p2[0])//2, (p1[1]+p2[1])//2)
-            mid_d = euclid(mid, (cx,cy))
-            horiz = max(0.0, dx - dy)
-            s = cands[i]["score"] + cands[j]["score"] + 0.7*horiz - 0.05*mid_d
-            if s > best_bs:
-                best_bs = s; best_blue = (p1,p2)
+    mid = (pts[i] + pts[j]) // 2
+    mid_d = np.hypot(mid[:, 0] - cx, mid[:, 1] - cy)
+    horiz = np.maximum(0.0, dx - dy)
+    blue_s = spot[i] + spot[j] + 0.7*horiz - 0.05*mid_d
+    best_blue = pick_best_pair(pts, i, j, blue_s, (blue_sep_range[0] <= sep) & (sep <= blue_sep_range[1]))
 
     # choose vertical pair (≈red): large dy, sep ~ expected
-    best_red=None; best_rs=-1e9
-    for i in range(len(cands)):
-        for j in range(i+1, len(cands)):
-            p1, p2 = cands[i]["pt"], cands[j]["pt"]
-            dx, dy = abs(p1[0]-p2[0]), abs(p1[1]-p2[1])
-            sep = euclid(p1,p2)
-            if abs(sep - red_expected_sep) > red_sep_tol: continue
-            vert = max(0.0, dy - dx)
-            s = cands[i]["score"] + cands[j]["score"] + 0.8*vert - 0.25*abs(sep - red_expected_sep)
-            if s > best_rs:
-                best_rs = s; best_red = (p1,p2)
+    sep_err = np.abs(sep - red_expected_sep)
+    vert = np.maximum(0.0, dy - dx)
+    red_s = spot[i] + spot[j] + 0.8*vert - 0.25*sep_err
+    best_red = pick_best_pair(pts, i, j, red_s, sep_err <= red_sep_tol)
 
     return best_red, best_blue, {"r_in":r_in, "r_out":r_out, "N":len(cands)}
 
@@ -547,6 +811,7 @@ def detect_led_pairs_robust(
     red_sep_tol=35.0,
     debug_folder=None,
     base_name="",
+    prep=None,
 ):
     """
     Specular-highlight driven detector:
@@ -554,13 +819,15 @@ def detect_led_pairs_robust(
     - Color likelihood for red/blue
     - Candidate scoring: DoG + local contrast + compactness + color
     - Pair scoring: geometry + symmetry
+    Pass the frame's FramePrep to share CLAHE/DoG/top-hat/masks with the other detectors.
     """
+    if prep is None:
+        prep = FramePrep(image_bgr, gray=gray, hsv=hsv_img)
     cx, cy = droplet_center
     H, W = gray.shape[:2]
 
     # 1) normalize brightness
-    hsv_norm = clahe_on_v(hsv_img)
-    v = hsv_norm[:,:,2]
+    v = prep.v_clahe
 
     # 2) estimate droplet radius from search_radius if none
     R = droplet_radius_estimate
@@ -571,33 +838,23 @@ def detect_led_pairs_robust(
     # 3) ring ROI to avoid rim & center
     r_in  = max(5, int(inner_ring_frac * R))
     r_out = min(int(outer_ring_frac * R), int(search_radius_px))
-    ring_mask = build_droplet_ring_mask(gray.shape, droplet_center, r_in, r_out)
+    ring_mask = prep.ring(droplet_center, r_in, r_out)
+    in_ring = ring_mask > 0
 
-    # 4) feature maps
-    dog = dog_response(v, sigma_small=1.5, sigma_big=3.5)
-    # local contrast via morphological white top-hat (spots over background)
-    se = cv2.getStructuringElement(cv2.MORPH_ELLIPSE, (9,9))
-    tophat = cv2.morphologyEx(v, cv2.MORPH_TOPHAT, se)
+    # 4) feature maps: DoG and white top-hat (spots over background), normalized to 0..255
+    dog_n = prep.dog_n(1.5, 3.5)
+    top_n = prep.tophat_n
 
     # color likelihoods (OpenCV hue 0..179)
-    red_like  = color_likelihood_h(hsv_norm, target_h=160, tol=18, sat_min=10)
-    blue_like = color_likelihood_h(hsv_norm, target_h=92,  tol=18, sat_min=10)
+    red_like  = prep.color_likelihood(target_h=160, tol=18, sat_min=10)
+    blue_like = prep.color_likelihood(target_h=92,  tol=18, sat_min=10)
 
     # 5) build red/blue candidate maps, constrain to ring
-    def norm255(img):
-        a,b = float(img.min()), float(img.max())
-        if b-a < 1e-6: return np.zeros_like(img, np.uint8)
-        return ((img - a)*(255.0/(b-a))).astype(np.uint8)
-
-    dog_n   = norm255(dog)
-    top_n   = norm255(tophat)
-
-    red_score_map  = cv2.min(255, (0.6*dog_n + 0.4*top_n)).astype(np.uint8)
-    blue_score_map = cv2.min(255, (0.6*dog_n + 0.4*top_n)).astype(np.uint8)
+    spot_map = cv2.min(255, (0.6*dog_n + 0.4*top_n)).astype(np.uint8)
 
     # weight by color likelihood
-    red_score_map  = cv2.multiply(red_score_map,  red_like,  scale=1/255.0)
-    blue_score_map = cv2.multiply(blue_score_map, blue_like, scale=1/255.0)
+    red_score_map  = cv2.multiply(spot_map, red_like,  scale=1/255.0)
+    blue_score_map = cv2.multiply(spot_map, blue_like, scale=1/255.0)
 
     # apply ring mask
     red_score_map  = cv2.bitwise_and(red_score_map,  red_score_map,  mask=ring_mask)
@@ -606,7 +863,7 @@ def detect_led_pairs_robust(
     # 6) threshold adaptively to get components
     def thresh_and_candidates(score_map):
         # threshold at high percentile to keep only strong spots
-        t = np.percentile(score_map[ring_mask>0], 96) if np.any(ring_mask>0) else 200
+        t = np.percentile(score_map[in_ring], 96) if np.any(in_ring) else 200
         _, bw = cv2.threshold(score_map, int(t), 255, cv2.THRESH_BINARY)
         # small dilate then erode to merge tiny bits a touch
         kern = cv2.getStructuringElement(cv2.MORPH_ELLIPSE, (3,3))
@@ -652,41 +909,28 @@ def detect_led_pairs_robust(
     if len(red_top) < 1 and len(blue_top) < 2:
         return None, None, {"why": "no strong candidates"}
 
-    # 8) pair selection with geometry constraints
-    def euclid(p,q): return float(np.hypot(p[0]-q[0], p[1]-q[1]))
+    # 8) pair selection with geometry constraints, all pairs of a color at once
+    def points_and_scores(top):
+        pts = np.array([(d["cx"], d["cy"]) for d in top], dtype=np.int64).reshape(-1, 2)
+        return pts, np.array([d["score"] for d in top])
 
     # try blue first (should be roughly horizontal wrt red midpoint later)
-    best_blue=None; best_blue_s=-1e9
-    for i in range(len(blue_top)):
-        for j in range(i+1, len(blue_top)):
-            p1=(blue_top[i]["cx"], blue_top[i]["cy"])
-            p2=(blue_top[j]["cx"], blue_top[j]["cy"])
-            dx, dy = abs(p1[0]-p2[0]), abs(p1[1]-p2[1])
-            sep = euclid(p1,p2)
-            if not (blue_sep_range[0] <= sep <= blue_sep_range[1]):
-                continue
-            # midpoint should be near droplet center
-            mid=((p1[0]+p2[0])//2, (p1[1]+p2[1])//2)
-            mid_d = euclid(mid, (cx,cy))
-            horiz = max(0.0, dx - dy)
-            pair_score = (blue_top[i]["score"] + blue_top[j]["score"]) + 0.5*horiz - 0.05*mid_d
-            if pair_score > best_blue_s:
-                best_blue_s = pair_score; best_blue = (p1,p2)
+    pts, spot = points_and_scores(blue_top)
+    i, j, dx, dy, sep = pair_geometry(pts)
+    # midpoint should be near droplet center
+    mid = (pts[i] + pts[j]) // 2
+    mid_d = np.hypot(mid[:, 0] - cx, mid[:, 1] - cy)
+    horiz = np.maximum(0.0, dx - dy)
+    pair_score = (spot[i] + spot[j]) + 0.5*horiz - 0.05*mid_d
+    best_blue = pick_best_pair(pts, i, j, pair_score, (blue_sep_range[0] <= sep) & (sep <= blue_sep_range[1]))
 
     # red: mostly vertical; use expected separation
-    best_red=None; best_red_s=-1e9
-    for i in range(len(red_top)):
-        for j in range(i+1, len(red_top)):
-            p1=(red_top[i]["cx"], red_top[i]["cy"])
-            p2=(red_top[j]["cx"], red_top[j]["cy"])
-            dx, dy = abs(p1[0]-p2[0]), abs(p1[1]-p2[1])
-            sep = euclid(p1,p2)
-            if abs(sep - red_expected_sep) > red_sep_tol:
-                continue
-            vert = max(0.0, dy - dx)
-            pair_score = (red_top[i]["score"] + red_top[j]["score"]) + 0.7*vert - 0.2*abs(sep - red_expected_sep)
-            if pair_score > best_red_s:
-                best_red_s = pair_score; best_red = (p1,p2)
+    pts, spot = points_and_scores(red_top)
+    i, j, dx, dy, sep = pair_geometry(pts)
+    sep_err = np.abs(sep - red_expected_sep)
+    vert = np.maximum(0.0, dy - dx)
+    pair_score = (spot[i] + spot[j]) + 0.7*vert - 0.2*sep_err
+    best_red = pick_best_pair(pts, i, j, pair_score, sep_err <= red_sep_tol)
 
     # If one color missing, try to infer using the other
     if best_red is None and best_blue is not None:
@@ -764,23 +1008,23 @@ def merge_close_centroids(centroids, distance_threshold=10):
     if not centroids:
         return []
 
+    pts = np.asarray(centroids, dtype=float)
+    diff = pts[:, None, :] - pts[None, :, :]
+    close = np.sqrt((diff**2).sum(axis=2)) < distance_threshold
+
     merged = []
-    used = set()
+    used = np.zeros(len(pts), dtype=bool)
 
-    for i, c1 in enumerate(centroids):
-        if i in used:
+    # greedy in input order: each unused centroid takes the unused ones after it that are close
+    for i in range(len(pts)):
+        if used[i]:
             continue
-        cluster = [c1]
-        for j, c2 in enumerate(centroids):
-            if j <= i or j in used:
-                continue
-            if np.linalg.norm(np.array(c1) - np.array(c2)) < distance_threshold:
-                cluster.append(c2)
-                used.add(j)
-        used.add(i)
-        avg_x = int(np.mean([pt[0] for pt in cluster]))
-        avg_y = int(np.mean([pt[1] for pt in cluster]))
-        merged.append((avg_x, avg_y))
+        members = close[i] & ~used
+        members[:i] = False
+        members[i] = True
+        used |= members
+        cluster = pts[members]
+        merged.append((int(np.mean(cluster[:, 0])), int(np.mean(cluster[:, 1]))))
 
     return merged
 
@@ -790,8 +1034,16 @@ def process_image(
     debug=False,
     debug_folder=None,
     params: Optional[dict] = None,
-    params_path: Optional[str] = None
+    params_path: Optional[str] = None,
+    prep: Optional[FramePrep] = None
 ):
+    """
+    Measure the red and blue LED separations in one image.
+
+    prep is the image's FramePrep when the caller already has one (e.g. from
+    focus scoring); the image is then not read again and the intermediate
+    images already computed are reused.
+    """
     # ----------------------------
     # 0) Load params (if provided)
     # ----------------------------
@@ -849,7 +1101,8 @@ def process_image(
     if debug_folder and os.path.exists(debug_folder):
         debug_patterns = [
             f"{base_name}_debug.jpg",
-            f"{base_name}_hough_circle.jpg",
+            # a droplet found earlier on this prep already wrote this one for this run
+            *([] if prep is not None and prep.has("droplet") else [f"{base_name}_hough_circle.jpg"]),
             f"{base_name}_contour_fallback.jpg",
             f"{base_name}_red_profile_debug.png",
             f"{base_name}_fallback_debug.csv",
@@ -868,16 +1121,16 @@ def process_image(
     # ----------------------------
     # 2) Load + basic conversions
     # ----------------------------
-    image = cv2.imread(image_path)
-    if image is None:
-        raise ValueError(f"Could not read image at {image_path}")
+    if prep is None:
+        prep = FramePrep.from_path(image_path)
+    image = prep.image
 
     try:
-        hsv_img = cv2.cvtColor(image, cv2.COLOR_BGR2HSV)
+        hsv_img = prep.hsv
     except Exception as e:
         raise ValueError(f"Failed to convert image to HSV: {e}")
 
-    gray = cv2.cvtColor(image, cv2.COLOR_BGR2GRAY)
+    gray = prep.gray
     vis_image = image.copy()
 
         # If a YOLO weights path is given in params, try it first
@@ -898,7 +1151,6 @@ def process_image(
                 # draw & pack results
                 vis_image = draw_points(image, red_pair, blue_pair)
                 # fill your 'results' dict and return early
-                hsv_img = cv2.cvtColor(image, cv2.COLOR_BGR2HSV)
                 def hsv_at(p):
                     h,s,v = hsv_img[p[1], p[0]]; return {"x":p[0], "y":p[1], "h":int(h), "s":int(s), "v":int(v)}
                 debug_img_path = os.path.join(debug_folder, f"{os.path.splitext(os.path.basename(image_path))[0]}_debug.jpg") if debug_folder else None
@@ -930,8 +1182,8 @@ def process_image(
     # ----------------------------
     # 3) Droplet center
     # ----------------------------
-    droplet_center, _, droplet_detection_method = detect_droplet_center(
-        gray, debug_folder=debug_folder, img_basename=base_name
+    droplet_center, _, droplet_detection_method = prep.droplet(
+        debug_folder=debug_folder, img_basename=base_name
     )
 
     #----------------------------
@@ -963,7 +1215,8 @@ def process_image(
             red_expected_sep=red_expected_sep,
             red_sep_tol=red_sep_tol,
             debug_folder=debug_folder,
-            base_name=base_name
+            base_name=base_name,
+            prep=prep
         )
         if red_pair2 is not None and blue_pair2 is not None:
             red_pair = red_pair2
@@ -983,53 +1236,33 @@ def process_image(
     # ----------------------------
     # 4) Masks (use learned HSV) – still useful for debug/overlay
     # ----------------------------
-    red_mask  = cv2.inRange(hsv_img, red_lower,  red_upper)
-    blue_mask = cv2.inRange(hsv_img, blue_lower, blue_upper)
+    red_mask  = prep.mask(red_lower,  red_upper)
+    blue_mask = prep.mask(blue_lower, blue_upper)
 
     # ----------------------------
     # 5) Helpers
     # ----------------------------
     def get_centroids(mask, min_area, max_area=np.inf, center=None, radius=None):
-        contours, _ = cv2.findContours(mask, cv2.RETR_EXTERNAL, cv2.CHAIN_APPROX_SIMPLE)
-        centroids = []
-        for cnt in contours:
-            area = cv2.contourArea(cnt)
-            if not (min_area <= area <= max_area):
-                continue
-            M = cv2.moments(cnt)
-            if M["m00"] == 0:
-                continue
-            cx, cy = int(M["m10"] / M["m00"]), int(M["m01"] / M["m00"])
-            if center is not None and radius is not None:
-                if np.hypot(cx - center[0], cy - center[1]) > radius:
-                    continue
-            centroids.append((cx, cy))
-        return centroids
+        b = prep.blobs(mask)
+        keep = (b["area"] >= min_area) & (b["area"] <= max_area) & b["has_centroid"]
+        if center is not None and radius is not None:
+            keep &= np.hypot(b["cx"] - center[0], b["cy"] - center[1]) <= radius
+        return [(int(b["cx"][k]), int(b["cy"][k])) for k in np.flatnonzero(keep)]
 
     def best_aligned_pair(centroids, direction="vertical"):
-        best_pair, best_score = None, -np.inf
-        for p1, p2 in combinations(centroids, 2):
-            dx, dy = abs(p1[0] - p2[0]), abs(p1[1] - p2[1])
-            score = dy - dx if direction == "vertical" else dx - dy
-            if score > best_score:
-                best_score, best_pair = score, (p1, p2)
-        return best_pair
+        i, j, dx, dy, _ = pair_geometry(centroids)
+        score = dy - dx if direction == "vertical" else dx - dy
+        return pick_best_pair(centroids, i, j, score)
 
     def midpoint(p1, p2):
         return ((p1[0] + p2[0]) // 2, (p1[1] + p2[1]) // 2)
 
     def best_blue_pair_aligned_with_red(centroids, red_mid, tol):
-        best_pair, best_score = None, -np.inf
-        for p1, p2 in combinations(centroids, 2):
-            dx, dy = abs(p1[0] - p2[0]), abs(p1[1] - p2[1])
-            mid_x, mid_y = (p1[0] + p2[0]) / 2, (p1[1] + p2[1]) / 2
-            dist_to_red = np.hypot(mid_x - red_mid[0], mid_y - red_mid[1])
-            if dist_to_red > tol:
-                continue
-            score = dx - dy - dist_to_red
-            if score > best_score:
-                best_score, best_pair = score, (p1, p2)
-        return best_pair
+        i, j, dx, dy, _ = pair_geometry(centroids)
+        pts = np.asarray(centroids, dtype=np.int64).reshape(-1, 2)
+        mid = (pts[i] + pts[j]) / 2
+        dist_to_red = np.hypot(mid[:, 0] - red_mid[0], mid[:, 1] - red_mid[1])
+        return pick_best_pair(centroids, i, j, dx - dy - dist_to_red, dist_to_red <= tol)
 
     def euclidean(p1, p2):
         return float(np.hypot(p1[0] - p2[0], p1[1] - p2[1]))
@@ -1294,7 +1527,7 @@ def process_z_stack_then_measure(
     )
     # Now run your existing detector on the chosen image
     results = process_image(best_path, output_csv=output_csv, debug=debug, debug_folder=debug_folder,
-                             params=params, params_path=params_path)
+                             params=params, params_path=params_path, prep=log["prep"])
     results["chosen_best_focus_image"] = best_path
     results["focus_ranking"] = log["ranked"]
     return results
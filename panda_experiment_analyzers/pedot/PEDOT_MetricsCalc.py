@@ -5,9 +5,10 @@ the deposition efficiency, and the electrochromic efficiency."""
 import math
 import re
 
-import pandas as pd
 from scipy.integrate import trapezoid
 
+from panda_lib.hardware.potentiostat_data import load_echem_data
+
 from .pedot_classes import RequiredData, PEDOTMetrics, RawMetrics
 
 
@@ -25,28 +26,9 @@ def calc_charge(deposition_file):
     # Read in the text file
     if deposition_file is None:
         return None
-    df = pd.read_csv(
-        deposition_file,
-        sep=" ",
-        header=None,
-        names=[
-            "Time",
-            "Vf",
-            "Vu",
-            "Im",
-            "Q",
-            "Vsig",
-            "Ach",
-            "IERange",
-            "Over",
-            "StopTest",
-        ],
-    )
+    df = load_echem_data(deposition_file, "CA", columns=["Time", "Im"])
     # Calculate the charge passed by integrating the current over time using the trapezoidal rule
-    df_copy = df.copy()
-    df_copy["Im"] = df_copy["Im"].apply(modify_function)
-
-    charge = trapezoid(df_copy["Im"], df_copy["Time"])
+    charge = trapezoid(modify_function(df["Im"]), df["Time"])
     return charge
 
 
@@ -54,24 +36,7 @@ def calc_capacitance(cv_file):
     """Calculate metric for capacitance using CV by finding the area enclosed by the CV curve."""
     if cv_file is None:
         return None
-    df = pd.read_csv(
-        cv_file,
-        sep=" ",
-        header=None,
-        names=[
-            "Time",
-            "Vf",
-            "Vu",
-            "Im",
-            "Vsig",
-            "Ach",
-            "IERange",
-            "Overload",
-            "StopTest",
-            "Cycle",
-            "Ach2",
-        ],
-    )
+    df = load_echem_data(cv_file, "CV", columns=["Vf", "Im", "Cycle"])
     df = df.dropna(subset=["Cycle"])
     df["Cycle"] = df["Cycle"].astype(int)
     df_second_cycle = df[df["Cycle"] == 1].copy()
@@ -80,7 +45,7 @@ def calc_capacitance(cv_file):
         print("No second cycle found")
         return None
 
-    df_second_cycle["Im_mod"] = df_second_cycle["Im"].apply(modify_function)
+    df_second_cycle["Im_mod"] = modify_function(df_second_cycle["Im"])
 
     min_current = df_second_cycle["Im_mod"].min()
     df_second_cycle["Im_shifted"] = df_second_cycle["Im_mod"] - min_current + 0.0001
@@ -101,26 +66,8 @@ def calc_bleach_charge(bleach_file):
     """Calculate the charge passed during bleaching using text file for bleaching"""
     if bleach_file is None:
         return None
-    df = pd.read_csv(
-        bleach_file,
-        sep=" ",
-        header=None,
-        names=[
-            "Time",
-            "Vf",
-            "Vu",
-            "Im",
-            "Q",
-            "Vsig",
-            "Ach",
-            "IERange",
-            "Over",
-            "StopTest",
-        ],
-    )
-    df_copy = df.copy()
-    df_copy["Im"] = df_copy["Im"].apply(modify_function)
-    bleach_charge = abs(trapezoid(df_copy["Im"], df_copy["Time"]))
+    df = load_echem_data(bleach_file, "CA", columns=["Time", "Im"])
+    bleach_charge = abs(trapezoid(modify_function(df["Im"]), df["Time"]))
     return bleach_charge
 
 
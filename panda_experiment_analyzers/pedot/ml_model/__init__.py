@@ -1,4 +1,26 @@
 # package the pedot ML model
-from .pedot_ml_analyzer_v8 import main as pedot_model
+from panda_shared.config.config_tools import get_config_boolean
 
-__all__ = ["pedot_model"]
+from .pedot_ml_analyzer_v8 import main as pedot_model_v8
+
+
+def pedot_model(model_base_path, contourplots_path, experiment_id: int = 0):
+    """
+    Run the PEDOT ML model.
+
+    This is the v8 model unless [OPTIONS] pedot_incremental_model is set, which
+    opts into v9's warm-start updates (see PEDOTOptimizer.update_model). Both
+    return the same tuple.
+    """
+    if get_config_boolean("OPTIONS", "pedot_incremental_model", default=False):
+        from .pedot_ml_analyzer_v9 import main as pedot_model_v9
+
+        return pedot_model_v9(
+            model_base_path, contourplots_path, experiment_id=experiment_id
+        )
+    return pedot_model_v8(
+        model_base_path, contourplots_path, experiment_id=experiment_id
+    )
+
+
+__all__ = ["pedot_model", "pedot_model_v8"]
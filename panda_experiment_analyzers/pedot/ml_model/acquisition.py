@@ -0,0 +1,254 @@
+"""
+Chunked acquisition scoring for PEDOT candidate points.
+
+Scoring every Latin Hypercube candidate in one GP call (18 concentrations x
+50,000 points) builds the whole cross-covariance at once, so peak memory grows
+with the candidate count. CandidateScorer instead:
+1. Evaluates the acquisition function on fixed-size chunks of candidates
+2. Keeps only the running top-k candidates between chunks
+3. Collects the contour-plot slice (all points at the best concentration) in
+   the same pass, so the full score arrays are never kept or re-masked
+
+Peak memory is set by chunk_size rather than by the number of candidates, and
+the torch thread count can be pinned with num_threads.
+"""
+
+from contextlib import contextmanager
+from dataclasses import dataclass
+from typing import Callable, Dict, Iterator, List, Optional
+
+import gpytorch
+import numpy as np
+import torch
+
+# Candidates per GP call. Memory per call is roughly chunk_size x n_train floats.
+DEFAULT_CHUNK_SIZE = 16384
+
+Acquisition = Callable[[np.ndarray], Dict[str, np.ndarray]]
+
+
+def expected_improvement(
+    model: gpytorch.models.ExactGP,
+    likelihood: gpytorch.likelihoods.Likelihood,
+    current_best: float,
+) -> Acquisition:
+    """
+    Expected Improvement over current_best as a chunk acquisition function.
+
+    Args:
+        model: Trained GP model
+        likelihood: Model likelihood
+        current_best: Best observed response
+
+    Returns:
+        Function mapping scaled candidates (n, 3) to {"ei", "mean", "std_dev"} arrays
+    """
+    model.eval()
+    likelihood.eval()
+    normal = torch.distributions.Normal(0, 1)
+
+    def acquisition(chunk: np.ndarray) -> Dict[str, np.ndarray]:
+        x = torch.as_tensor(chunk, dtype=torch.float32)
+        with torch.no_grad(), gpytorch.settings.fast_pred_var():
+            predictions = likelihood(model(x))
+            mean = predictions.mean
+            std_dev = predictions.stddev
+            z = (mean - current_best) / std_dev
+            ei = (mean - current_best) * normal.cdf(z) + std_dev * normal.log_prob(
+                z
+            ).exp()
+        return {"ei": ei.numpy(), "mean": mean.numpy(), "std_dev": std_dev.numpy()}
+
+    return acquisition
+
+
+@contextmanager
+def torch_threads(num_threads: Optional[int]) -> Iterator[None]:
+    """Run the block with torch limited to num_threads, None keeps the current setting"""
+    if not num_threads:
+        yield
+        return
+    previous = torch.get_num_threads()
+    torch.set_num_threads(num_threads)
+    try:
+        yield
+    finally:
+        torch.set_num_threads(previous)
+
+
+@dataclass
+class CandidateSlice:
+    """
+    Every scored candidate at one concentration, for the contour plots.
+
+    Attributes:
+        concentration: Scaled concentration of the slice
+        points: Scaled candidates (n, 3)
+        values: Acquisition outputs for those candidates, by name
+    """
+
+    concentration: float
+    points: np.ndarray
+    values: Dict[str, np.ndarray]
+
+
+@dataclass
+class CandidateScores:
+    """
+    Result of one scoring pass.
+
+    Attributes:
+        indices: Top-k candidate indices into the scored array, best first
+        points: Top-k scaled candidates (k, 3)
+        values: Acquisition outputs for the top-k, by name
+        best_slice: All candidates at the best candidate's concentration
+        n_scored: Number of candidates scored
+    """
+
+    indices: np.ndarray
+    points: np.ndarray
+    values: Dict[str, np.ndarray]
+    best_slice: Optional[CandidateSlice] = None
+    n_scored: int = 0
+
+    @property
+    def best_point(self) -> np.ndarray:
+        return self.points[0]
+
+    def best(self, name: str) -> float:
+        """Acquisition output `name` at the best candidate"""
+        return float(self.values[name][0])
+
+
+def _top_k(rank: np.ndarray, k: int) -> np.ndarray:
+    """Indices of the k largest values, lowest index first among ties, unordered"""
+    if k >= len(rank):
+        return np.arange(len(rank))
+    threshold = np.partition(rank, len(rank) - k)[len(rank) - k]
+    above = np.flatnonzero(rank > threshold)
+    ties = np.flatnonzero(rank == threshold)[: k - len(above)]
+    return np.concatenate([above, ties])
+
+
+@dataclass
+class CandidateScorer:
+    """
+    Scores candidates in chunks with a streaming top-k.
+
+    Candidates are expected grouped by concentration, as generate_candidates
+    returns them: once a concentration stops appearing, its slice is dropped
+    unless it holds the best candidate.
+
+    Attributes:
+        chunk_size: Candidates per acquisition call
+        top_k: Number of best candidates to keep
+        num_threads: Torch threads while scoring, None to leave unchanged
+        rank_by: Acquisition output to rank by
+        slice_column: Candidate column the contour slices are grouped by
+        keep_best_slice: Whether to collect the best concentration's slice
+    """
+
+    chunk_size: int = DEFAULT_CHUNK_SIZE
+    top_k: int = 1
+    num_threads: Optional[int] = None
+    rank_by: str = "ei"
+    slice_column: int = 2
+    keep_best_slice: bool = True
+
+    def __post_init__(self):
+        if self.chunk_size < 1:
+            raise ValueError("chunk_size must be positive")
+        if self.top_k < 1:
+            raise ValueError("top_k must be positive")
+
+    def score(
+        self, candidates: np.ndarray, acquisition: Acquisition
+    ) -> CandidateScores:
+        """
+        Score all candidates and keep the top-k and the best slice.
+
+        Args:
+            candidates: Scaled candidates (n, 3)
+            acquisition: Function mapping a chunk to named arrays, one value per row
+
+        Returns:
+            CandidateScores for the pass
+        """
+        if len(candidates) == 0:
+            raise ValueError("No candidates to score")
+
+        top_index = np.empty(0, dtype=np.int64)
+        top_rank = np.empty(0)
+        top_values: Dict[str, np.ndarray] = {}
+        slices: Dict[float, List[Dict[str, np.ndarray]]] = {}
+
+        with torch_threads(self.num_threads):
+            for start in range(0, len(candidates), self.chunk_size):
+                chunk = candidates[start : start + self.chunk_size]
+                values = acquisition(chunk)
+                # NaN scores (e.g. zero predicted variance) never rank
+                rank = np.asarray(values[self.rank_by], dtype=float)
+                rank = np.where(np.isnan(rank), -np.inf, rank)
+
+                # merge the chunk's top-k into the running top-k, earliest index first on ties
+                local = _top_k(rank, self.top_k)
+                merged_index = np.concatenate([top_index, local + start])
+                merged_rank = np.concatenate([top_rank, rank[local]])
+                order = np.lexsort((merged_index, -merged_rank))[: self.top_k]
+                for name, array in values.items():
+                    previous = top_values.get(name, np.empty(0, dtype=array.dtype))
+                    top_values[name] = np.concatenate([previous, array[local]])[order]
+                top_index = merged_index[order]
+                top_rank = merged_rank[order]
+
+                if self.keep_best_slice:
+                    self._collect_slices(
+                        slices,
+                        chunk,
+                        values,
+                        candidates[top_index[0], self.slice_column],
+                    )
+
+        best_slice = None
+        if self.keep_best_slice:
+            best_slice = self._build_slice(
+                slices, candidates[top_index[0], self.slice_column]
+            )
+
+        return CandidateScores(
+            indices=top_index,
+            points=candidates[top_index],
+            values=top_values,
+            best_slice=best_slice,
+            n_scored=len(candidates),
+        )
+
+    def _collect_slices(
+        self,
+        slices: Dict[float, List[Dict[str, np.ndarray]]],
+        chunk: np.ndarray,
+        values: Dict[str, np.ndarray],
+        best_key: float,
+    ) -> None:
+        """Append the chunk to its concentrations' slices, drop finished slices not holding the best"""
+        keys, inverse = np.unique(chunk[:, self.slice_column], return_inverse=True)
+        for group, key in enumerate(keys):
+            rows = inverse == group
+            part = {name: array[rows] for name, array in values.items()}
+            part["points"] = chunk[rows]
+            slices.setdefault(float(key), []).append(part)
+        in_chunk = set(keys.tolist())
+        for key in list(slices):
+            if key not in in_chunk and key != best_key:
+                del slices[key]
+
+    @staticmethod
+    def _build_slice(
+        slices: Dict[float, List[Dict[str, np.ndarray]]], key: float
+    ) -> Optional[CandidateSlice]:
+        parts = slices.get(float(key))
+        if not parts:
+            return None
+        joined = {name: np.concatenate([p[name] for p in parts]) for name in parts[0]}
+        points = joined.pop("points")
+        return CandidateSlice(concentration=float(key), points=points, values=joined)
@@ -15,9 +15,10 @@ Author: Harley Quinn
 Date: 2024-05-02
 """
 
+import hashlib
 import math
 import os
-from dataclasses import dataclass
+from dataclasses import dataclass, field
 from pathlib import Path
 from typing import Any, Dict, List, Optional, Sequence, Tuple
 
@@ -47,6 +48,13 @@ from panda_lib.experiments.results import (
 # Ensure Intel MKL operations are permitted (required for some PyTorch operations)
 os.environ["KMP_DUPLICATE_LIB_OK"] = "TRUE"
 
+from .acquisition import (
+    DEFAULT_CHUNK_SIZE,
+    CandidateScorer,
+    CandidateScores,
+    CandidateSlice,
+    expected_improvement,
+)
 from .exceptions import ModelLoadError, ModelSaveError, ParameterValidationError
 from .logger_config import setup_logger
 from .visualization import PEDOTVisualizer
@@ -177,6 +185,78 @@ class PEDOTParameters:
         self.validate()
 
 
+@dataclass
+class ModelUpdatePolicy:
+    """
+    When an analyzer run warm-starts from the last checkpoint and when it retrains fully.
+
+    A warm start loads the last checkpoint's hyperparameters, conditions the GP
+    on all rows (the new rows are simply folded in) and runs a short fine-tune.
+    A full retrain is the leave-one-out training of every row and runs when:
+    - full_retrain_every updates have passed since the last full retrain
+    - the new rows drift from the checkpoint's predictions: the mean |z| of
+      their prediction errors exceeds drift_threshold
+    - the checkpoint cannot be matched to the training data (no row count,
+      fewer rows than before, or earlier rows changed)
+    """
+
+    full_retrain_every: int = 10
+    drift_threshold: float = 3.0
+    warm_start_iterations: int = 50
+    full_iterations: int = 500
+
+    def validate(self) -> None:
+        """Validate policy values."""
+        if self.full_retrain_every < 1:
+            raise ParameterValidationError("full_retrain_every must be positive")
+        if self.drift_threshold <= 0:
+            raise ParameterValidationError("drift_threshold must be positive")
+        if self.warm_start_iterations < 0:
+            raise ParameterValidationError("warm_start_iterations must not be negative")
+        if self.full_iterations < 1:
+            raise ParameterValidationError("full_iterations must be positive")
+
+    def __post_init__(self):
+        """Validate policy after initialization."""
+        self.validate()
+
+
+@dataclass
+class ModelUpdate:
+    """
+    Outcome of PEDOTOptimizer.update_model.
+
+    Attributes:
+        model: Updated model, conditioned on all training rows
+        likelihood: Model likelihood
+        optimizer: Optimizer to store with the checkpoint
+        mode: "warm" or "full"
+        reason: Why a full retrain ran, empty for warm starts
+        rmse: Leave-one-out RMSE for a full retrain; for a warm start, RMSE of
+            the new rows as predicted before they were folded in (training RMSE
+            when there are no new rows)
+        n_new_rows: Rows added since the checkpoint
+        metadata: Checkpoint metadata to save with the model
+    """
+
+    model: PEDOTGaussianProcess
+    likelihood: gpytorch.likelihoods.GaussianLikelihood
+    optimizer: torch.optim.Optimizer
+    mode: str
+    reason: str
+    rmse: float
+    n_new_rows: int
+    metadata: Dict[str, Any] = field(default_factory=dict)
+
+
+def data_fingerprint(train_x: torch.Tensor, train_y: torch.Tensor) -> str:
+    """Hash of the training rows, used to tell whether earlier rows changed"""
+    digest = hashlib.sha1()
+    digest.update(train_x.detach().cpu().numpy().astype(np.float32).tobytes())
+    digest.update(train_y.detach().cpu().numpy().astype(np.float32).tobytes())
+    return digest.hexdigest()
+
+
 class PEDOTOptimizer:
     """
     The main optimization engine for PEDOT deposition.
@@ -202,6 +282,8 @@ class PEDOTOptimizer:
         model_base_path: str,
         contourplots_path: str,
         params: Optional[PEDOTParameters] = None,
+        scorer: Optional[CandidateScorer] = None,
+        update_policy: Optional[ModelUpdatePolicy] = None,
     ):
         """
         Initialize the PEDOT optimizer.
@@ -210,6 +292,8 @@ class PEDOTOptimizer:
             model_base_path: Path to save/load model checkpoints
             contourplots_path: Path to save visualization plots
             params: Optional configuration parameters for PEDOT optimization
+            scorer: Optional candidate scorer (chunk size, top-k, thread count)
+            update_policy: Optional warm-start / full retrain policy for update_model
         """
         if not Path(model_base_path).parent.exists():
             raise ParameterValidationError(
@@ -222,6 +306,8 @@ class PEDOTOptimizer:
         self.model_base_path = model_base_path
         self.contourplots_path = contourplots_path
         self.params = params or PEDOTParameters()
+        self.scorer = scorer or CandidateScorer()
+        self.update_policy = update_policy or ModelUpdatePolicy()
         self.visualizer = PEDOTVisualizer()
         logger.info("PEDOTOptimizer initialized successfully")
 
@@ -289,6 +375,22 @@ class PEDOTOptimizer:
             - Model likelihood
             - Learning rate
         """
+        counter, saved_state = self._read_checkpoint()
+
+        try:
+            model, likelihood = self._model_from_state(saved_state, train_x, train_y)
+            lr = saved_state["learning_rate"]
+
+            logger.info(f"Successfully loaded model (iteration {counter})")
+            return model, likelihood, lr
+
+        except Exception as e:
+            msg = f"Error loading model: {str(e)}"
+            logger.error(msg)
+            raise ModelLoadError(msg) from e
+
+    def _read_checkpoint(self) -> Tuple[int, Dict[str, Any]]:
+        """Read and validate the current checkpoint, returns (iteration, saved state)."""
         counter = model_iteration()
         load_filename = f"{self.model_base_path}_{counter}.pth"
 
@@ -302,21 +404,22 @@ class PEDOTOptimizer:
         try:
             saved_state = torch.load(load_filename)
             self._validate_saved_state(saved_state)
-
-            likelihood = gpytorch.likelihoods.GaussianLikelihood()
-            model = PEDOTGaussianProcess(train_x, train_y, likelihood)
-
-            model.load_state_dict(saved_state["model_state_dict"])
-            likelihood.load_state_dict(saved_state["likelihood_state_dict"])
-            lr = saved_state["learning_rate"]
-
-            logger.info(f"Successfully loaded model (iteration {counter})")
-            return model, likelihood, lr
-
         except Exception as e:
             msg = f"Error loading model: {str(e)}"
             logger.error(msg)
             raise ModelLoadError(msg) from e
+        return counter, saved_state
+
+    @staticmethod
+    def _model_from_state(
+        saved_state: Dict[str, Any], train_x: torch.Tensor, train_y: torch.Tensor
+    ) -> Tuple[PEDOTGaussianProcess, gpytorch.likelihoods.GaussianLikelihood]:
+        """Build a model on train_x/train_y with the checkpoint's hyperparameters."""
+        likelihood = gpytorch.likelihoods.GaussianLikelihood()
+        model = PEDOTGaussianProcess(train_x, train_y, likelihood)
+        model.load_state_dict(saved_state["model_state_dict"])
+        likelihood.load_state_dict(saved_state["likelihood_state_dict"])
+        return model, likelihood
 
     def _validate_saved_state(self, state: Dict[str, Any]) -> None:
         """Validate saved state dictionary."""
@@ -333,7 +436,10 @@ class PEDOTOptimizer:
             )
 
     def save_model(
-        self, model: PEDOTGaussianProcess, optimizer: torch.optim.Optimizer
+        self,
+        model: PEDOTGaussianProcess,
+        optimizer: torch.optim.Optimizer,
+        metadata: Optional[Dict[str, Any]] = None,
     ) -> Tuple[str, int]:
         """
         Save model state to disk and increment model counter.
@@ -341,6 +447,7 @@ class PEDOTOptimizer:
         Args:
             model: Trained model to save
             optimizer: Optimizer used during training
+            metadata: Extra checkpoint entries, e.g. ModelUpdate.metadata
 
         Returns:
             Tuple containing:
@@ -359,6 +466,7 @@ class PEDOTOptimizer:
                 "optimizer_state_dict": optimizer.state_dict(),
                 "likelihood_state_dict": model.likelihood.state_dict(),
                 "learning_rate": optimizer.param_groups[0]["lr"],
+                **(metadata or {}),
             }
 
             # Create backup of previous model if it exists
@@ -384,6 +492,7 @@ class PEDOTOptimizer:
         train_y: torch.Tensor,
         n_iterations: int = 500,
         learning_rate: float = 0.1,
+        optimizer: Optional[torch.optim.Optimizer] = None,
     ) -> Tuple[PEDOTGaussianProcess, float]:
         """
         Train the model using existing experimental data:
@@ -404,6 +513,7 @@ class PEDOTOptimizer:
             train_y: Training target data
             n_iterations: Number of training iterations
             learning_rate: Initial learning rate
+            optimizer: Optional optimizer to train with, e.g. to save it afterwards
 
         Returns:
             Tuple containing:
@@ -419,7 +529,8 @@ class PEDOTOptimizer:
         model.train()
         likelihood.train()
 
-        optimizer = torch.optim.Adam(model.parameters(), lr=learning_rate)
+        if optimizer is None:
+            optimizer = torch.optim.Adam(model.parameters(), lr=learning_rate)
         mll = gpytorch.mlls.ExactMarginalLogLikelihood(likelihood, model)
 
         # Training loop with adaptive learning rate
@@ -451,6 +562,239 @@ class PEDOTOptimizer:
         logger.info(f"Training completed. Final RMSE: {rmse.item():.4f}")
         return model, rmse.item()
 
+    def update_model(
+        self,
+        train_x: torch.Tensor,
+        train_y: torch.Tensor,
+        policy: Optional[ModelUpdatePolicy] = None,
+    ) -> ModelUpdate:
+        """
+        Bring the model up to date with the training data.
+
+        Rows are expected in insertion order, so the rows after the
+        checkpoint's row count are the new ones. Warm-starts from the last
+        checkpoint unless the policy calls for a full retrain (see
+        ModelUpdatePolicy).
+
+        Args:
+            train_x: Scaled inputs of every training row
+            train_y: Responses of every training row
+            policy: Update policy, defaults to the optimizer's
+
+        Returns:
+            ModelUpdate with the updated model and the checkpoint metadata to save
+        """
+        policy = policy or self.update_policy
+        n_rows = len(train_y)
+
+        try:
+            counter, saved_state = self._read_checkpoint()
+        except ModelLoadError:
+            counter, saved_state = None, None
+
+        reason = ""
+        n_previous = None if saved_state is None else saved_state.get("n_train_rows")
+        updates_since_full = (
+            0 if saved_state is None else saved_state.get("updates_since_full", 0)
+        )
+        if saved_state is None:
+            reason = "no checkpoint to warm-start from"
+        elif n_previous is None:
+            reason = "checkpoint has no training row count"
+        elif n_previous > n_rows:
+            reason = f"training data shrank from {n_previous} to {n_rows} rows"
+        elif saved_state.get("data_fingerprint") != data_fingerprint(
+            train_x[:n_previous], train_y[:n_previous]
+        ):
+            reason = "earlier training rows changed"
+        elif updates_since_full + 1 >= policy.full_retrain_every:
+            reason = f"scheduled after {updates_since_full} warm starts"
+
+        drift, new_rmse = 0.0, None
+        if not reason and n_rows > n_previous:
+            model, likelihood = self._model_from_state(
+                saved_state, train_x[:n_previous], train_y[:n_previous]
+            )
+            drift, new_rmse = self.new_row_drift(
+                model, likelihood, train_x[n_previous:], train_y[n_previous:]
+            )
+            if drift > policy.drift_threshold:
+                reason = f"new rows drifted (mean |z| {drift:.2f})"
+
+        metadata = {
+            "n_train_rows": n_rows,
+            "data_fingerprint": data_fingerprint(train_x, train_y),
+        }
+
+        if reason:
+            logger.info(f"Full retrain on {n_rows} rows: {reason}")
+            model, likelihood, optimizer, rmse = self._full_retrain(
+                saved_state, train_x, train_y, policy.full_iterations
+            )
+            metadata["updates_since_full"] = 0
+            return ModelUpdate(
+                model=model,
+                likelihood=likelihood,
+                optimizer=optimizer,
+                mode="full",
+                reason=reason,
+                rmse=rmse,
+                n_new_rows=n_rows if n_previous is None else n_rows - n_previous,
+                metadata=metadata,
+            )
+
+        # Warm start: cached hyperparameters conditioned on every row, short fine-tune
+        model, likelihood = self._model_from_state(saved_state, train_x, train_y)
+        lr = saved_state["learning_rate"]
+        optimizer = torch.optim.Adam(model.parameters(), lr=lr)
+        if "optimizer_state_dict" in saved_state:
+            try:
+                optimizer.load_state_dict(saved_state["optimizer_state_dict"])
+            except ValueError:
+                logger.warning(
+                    "Checkpoint optimizer state does not match, starting fresh"
+                )
+        train_rmse = None
+        if policy.warm_start_iterations:
+            model, train_rmse = self.train_model(
+                model,
+                likelihood,
+                train_x,
+                train_y,
+                n_iterations=policy.warm_start_iterations,
+                learning_rate=lr,
+                optimizer=optimizer,
+            )
+        if new_rmse is None:
+            new_rmse = (
+                train_rmse
+                if train_rmse is not None
+                else self._train_rmse(model, train_x, train_y)
+            )
+        metadata["updates_since_full"] = updates_since_full + 1
+        logger.info(
+            f"Warm start from iteration {counter}: folded in {n_rows - n_previous} "
+            f"new rows (mean |z| {drift:.2f})"
+        )
+        return ModelUpdate(
+            model=model,
+            likelihood=likelihood,
+            optimizer=optimizer,
+            mode="warm",
+            reason="",
+            rmse=new_rmse,
+            n_new_rows=n_rows - n_previous,
+            metadata=metadata,
+        )
+
+    def new_row_drift(
+        self,
+        model: PEDOTGaussianProcess,
+        likelihood: gpytorch.likelihoods.GaussianLikelihood,
+        new_x: torch.Tensor,
+        new_y: torch.Tensor,
+    ) -> Tuple[float, float]:
+        """
+        How far new rows fall from the model's predictions.
+
+        Args:
+            model: Model conditioned on the rows it was trained with
+            likelihood: Model likelihood
+            new_x: Scaled inputs of the new rows
+            new_y: Responses of the new rows
+
+        Returns:
+            Tuple containing:
+            - Mean |z| of the prediction errors, in predictive standard deviations
+            - RMSE of the predictions
+        """
+        model.eval()
+        likelihood.eval()
+        with torch.no_grad(), gpytorch.settings.fast_pred_var():
+            predictions = likelihood(model(new_x))
+            error = new_y - predictions.mean
+            z = error / predictions.stddev
+        return z.abs().mean().item(), torch.sqrt(torch.mean(error**2)).item()
+
+    def _full_retrain(
+        self,
+        saved_state: Optional[Dict[str, Any]],
+        train_x: torch.Tensor,
+        train_y: torch.Tensor,
+        n_iterations: int,
+    ) -> Tuple[
+        PEDOTGaussianProcess,
+        gpytorch.likelihoods.GaussianLikelihood,
+        torch.optim.Optimizer,
+        float,
+    ]:
+        """
+        Leave-one-out training from the checkpoint (or default) hyperparameters,
+        then a final fit on every row.
+
+        Returns:
+            Tuple containing:
+            - Model trained on every row
+            - Its likelihood
+            - Its optimizer
+            - Leave-one-out RMSE
+        """
+        lr = saved_state["learning_rate"] if saved_state is not None else 0.1
+
+        def fresh_model(x, y):
+            if saved_state is not None:
+                return self._model_from_state(saved_state, x, y)
+            likelihood = gpytorch.likelihoods.GaussianLikelihood()
+            return PEDOTGaussianProcess(x, y, likelihood), likelihood
+
+        n_data = len(train_y)
+        predictions = np.zeros(n_data)
+        previous_rmse = float("inf")
+        for i in tqdm(range(n_data), desc="Leave-one-out"):
+            keep = torch.arange(n_data) != i
+            model, likelihood = fresh_model(train_x[keep], train_y[keep])
+            model, _ = self.train_model(
+                model,
+                likelihood,
+                train_x[keep],
+                train_y[keep],
+                n_iterations=n_iterations,
+                learning_rate=lr,
+            )
+            likelihood.eval()
+            with torch.no_grad(), gpytorch.settings.fast_pred_var():
+                predictions[i] = likelihood(model(train_x[i : i + 1])).mean.item()
+
+            # Same learning rate schedule across folds as before
+            fold_rmse = abs(predictions[i] - train_y[i].item())
+            lr = lr * 0.95 if fold_rmse < previous_rmse else lr * 1.05
+            previous_rmse = fold_rmse
+
+        rmse = float(np.sqrt(mean_squared_error(train_y.numpy(), predictions)))
+
+        model, likelihood = fresh_model(train_x, train_y)
+        optimizer = torch.optim.Adam(model.parameters(), lr=lr)
+        model, _ = self.train_model(
+            model,
+            likelihood,
+            train_x,
+            train_y,
+            n_iterations=n_iterations,
+            learning_rate=lr,
+            optimizer=optimizer,
+        )
+        logger.info(f"Full retrain complete. Leave-one-out RMSE: {rmse:.4f}")
+        return model, likelihood, optimizer, rmse
+
+    @staticmethod
+    def _train_rmse(
+        model: PEDOTGaussianProcess, train_x: torch.Tensor, train_y: torch.Tensor
+    ) -> float:
+        model.eval()
+        with torch.no_grad():
+            predictions = model(train_x).mean
+        return torch.sqrt(torch.mean((predictions - train_y) ** 2)).item()
+
     def perform_cross_validation(
         self,
         data: np.ndarray,
@@ -586,6 +930,56 @@ class PEDOTOptimizer:
 
         return self.visualizer.save_plots(fig, save_path)
 
+    def plot_and_save_slice(
+        self,
+        candidate_slice: CandidateSlice,
+        save_path: str,
+        concentration: Optional[float] = None,
+    ) -> Tuple[Path, ...]:
+        """Plot and save the contour slice collected by score_candidates."""
+        fig = self.visualizer.create_contour_plots(
+            voltage_values=candidate_slice.points[:, 0],
+            time_values=candidate_slice.points[:, 1],
+            ei_values=candidate_slice.values["ei"],
+            std_dev_values=candidate_slice.values["std_dev"],
+            mean_values=candidate_slice.values["mean"],
+            concentration=(
+                candidate_slice.concentration
+                if concentration is None
+                else concentration
+            ),
+        )
+
+        return self.visualizer.save_plots(fig, save_path)
+
+    def score_candidates(
+        self,
+        model: PEDOTGaussianProcess,
+        likelihood: gpytorch.likelihoods.GaussianLikelihood,
+        current_best: float,
+        candidates: np.ndarray,
+    ) -> CandidateScores:
+        """
+        Score candidates by Expected Improvement in chunks.
+
+        Args:
+            model: Trained model
+            likelihood: Model likelihood
+            current_best: Current best observed performance
+            candidates: Scaled candidate points (n, 3)
+
+        Returns:
+            Top candidates by EI and the contour slice at the best concentration
+        """
+        scores = self.scorer.score(
+            candidates, expected_improvement(model, likelihood, current_best)
+        )
+        logger.info(
+            f"Scored {scores.n_scored} candidates in chunks of {self.scorer.chunk_size}, "
+            f"best EI {scores.best('ei'):.4f}"
+        )
+        return scores
+
     def optimize_parameters(
         self,
         model: PEDOTGaussianProcess,
@@ -608,32 +1002,13 @@ class PEDOTOptimizer:
             - Predicted mean performance
             - Predicted uncertainty
         """
-        model.eval()
-        likelihood.eval()
-
         # Generate candidate points using Latin Hypercube Sampling
         candidates = self.generate_candidates(num_candidates)
-        candidates_tensor = torch.tensor(candidates, dtype=torch.float32)
-
-        # Calculate Expected Improvement
-        with torch.no_grad(), gpytorch.settings.fast_pred_var():
-            predictions = likelihood(model(candidates_tensor))
-            mean = predictions.mean
-            std = predictions.stddev
 
-            # Expected Improvement calculation
-            z = (mean - current_best) / std
-            ei = (mean - current_best) * torch.distributions.Normal(0, 1).cdf(
-                z
-            ) + std * torch.distributions.Normal(0, 1).log_prob(z).exp()
+        # Expected Improvement, scored in chunks
+        scores = self.score_candidates(model, likelihood, current_best, candidates)
 
-            # Find best candidate
-            best_idx = torch.argmax(ei)
-            best_candidate = candidates[best_idx]
-            predicted_mean = mean[best_idx].item()
-            predicted_std = std[best_idx].item()
-
-        return best_candidate, predicted_mean, predicted_std
+        return scores.best_point, scores.best("mean"), scores.best("std_dev")
 
     def generate_candidates(
         self, num_points: int, concentrations: Optional[Sequence[float]] = None
@@ -739,6 +1114,9 @@ def main(
     model_base_path: str,
     contourplots_path: str,
     experiment_id: int = 0,
+    chunk_size: int = DEFAULT_CHUNK_SIZE,
+    num_threads: Optional[int] = None,
+    update_policy: Optional[ModelUpdatePolicy] = None,
 ) -> Tuple[float, float, float, float, float, str, int]:
     """
     Main execution function for PEDOT parameter optimization.
@@ -747,6 +1125,9 @@ def main(
         model_base_path: Path to save/load model checkpoints
         contourplots_path: Path to save visualization plots
         experiment_id: Unique identifier for the experiment
+        chunk_size: Candidates scored per GP call, bounds peak memory
+        num_threads: Torch threads for candidate scoring, None to leave unchanged
+        update_policy: When to warm-start and when to retrain fully
 
     Returns:
         Tuple containing:
@@ -758,7 +1139,12 @@ def main(
         - Path to generated contour plots
         - Model iteration ID
     """
-    optimizer = PEDOTOptimizer(model_base_path, contourplots_path)
+    optimizer = PEDOTOptimizer(
+        model_base_path,
+        contourplots_path,
+        scorer=CandidateScorer(chunk_size=chunk_size, top_k=5, num_threads=num_threads),
+        update_policy=update_policy,
+    )
 
     # Load and preprocess training data
     data_df = select_ml_training_data()
@@ -769,92 +1155,19 @@ def main(
 
     original_data = np.stack((voltage, time, concentration), axis=1)
 
-    n_data = len(response)
-    predictions = np.zeros(n_data)
-    actuals = np.zeros(n_data)
-    best_validation_rmse = float("inf")
-    # best_model = None
-    previous_rmse = float("inf")
-
-    for i in tqdm(range(n_data)):
-        train_indices = list(set(range(n_data)) - {i})
-        test_index = i
-
-        x_train, y_train = original_data[train_indices], response[train_indices]
-        x_test, y_test = (
-            original_data[test_index : test_index + 1],
-            response[test_index : test_index + 1],
-        )
-
-        # Scale inputs
-        x_train_scaled = optimizer.scale_inputs(
-            x_train,
-            voltage_bounds=(0.6, 1.8),
-            time_bounds=(1, 200),
-            concentration_bounds=(0.01, 0.1),
-            voltage_target=(0, 1),
-            time_target=(0, 1),
-            concentration_target=(0, 1),
-        )
-        x_test_scaled = optimizer.scale_inputs(
-            x_test,
-            voltage_bounds=(0.6, 1.8),
-            time_bounds=(1, 200),
-            concentration_bounds=(0.01, 0.1),
-            voltage_target=(0, 1),
-            time_target=(0, 1),
-            concentration_target=(0, 1),
-        )
-
-        # Convert to PyTorch tensors
-        train_x = torch.tensor(x_train_scaled, dtype=torch.float32)
-        train_y = torch.tensor(y_train, dtype=torch.float32)
-        test_x = torch.tensor(x_test_scaled, dtype=torch.float32)
-        test_y = torch.tensor(y_test, dtype=torch.float32)
-
-        # Set hyperparameters and call model
-        # likelihood = gpytorch.likelihoods.GaussianLikelihood(noise=torch.tensor(noise))
-        # model = GPModel(train_x, train_y, likelihood, lengthscale=lengthscale, outputscale=outputscale)
-        model, likelihood, lr = optimizer.load_model(model_base_path, train_x, train_y)
-
-        alg_optimizer = torch.optim.Adam(model.parameters(), lr=lr)
-
-        # Train the model on the training set
-        optimizer.train_model(
-            model, likelihood, alg_optimizer, train_x, train_y, training_iter=500
-        )
-
-        # Evaluate on the test set
-        model.eval()
-        likelihood.eval()
-        with torch.no_grad(), gpytorch.settings.fast_pred_var():
-            observed_pred = likelihood(model(test_x))
-            pred = observed_pred.mean.numpy()
-            rmse = np.sqrt(mean_squared_error(test_y.numpy(), pred))
-            if rmse < best_validation_rmse:
-                best_validation_rmse = rmse
-                # best_model = model.state_dict()
-
-        if rmse < previous_rmse:
-            lr *= 0.95
-        else:
-            lr *= 1.05
-        for param_group in alg_optimizer.param_groups:
-            param_group["lr"] = lr
-
-        previous_rmse = rmse
-
-        if pred.size == 1:
-            predictions[i] = pred.item()
-        else:
-            raise ValueError("Prediction `pred` is not a single value as expected.")
-
-        actuals[i] = y_test[0]
-
-    rmse = np.sqrt(mean_squared_error(actuals, predictions))
-    print(f"RMSE: {rmse}")
+    # Warm-start from the last checkpoint, or retrain fully on schedule or drift
+    train_x = torch.tensor(optimizer.scale_inputs(original_data), dtype=torch.float32)
+    train_y = torch.tensor(response, dtype=torch.float32)
+    update = optimizer.update_model(train_x, train_y)
+    model, likelihood = update.model, update.likelihood
+    rmse = update.rmse
+    print(
+        f"Model update: {update.mode}"
+        + (f" ({update.reason})" if update.reason else "")
+        + f", {update.n_new_rows} new rows, RMSE: {rmse}"
+    )
 
-    _, model_id = optimizer.save_model(model, alg_optimizer, model_base_path)
+    _, model_id = optimizer.save_model(model, update.optimizer, update.metadata)
 
     model.eval()
     likelihood.eval()
@@ -882,33 +1195,17 @@ def main(
     ]
     num_points = 50000
     test_points_scaled = optimizer.generate_candidates(num_points, concentrations)
-    test_x_scaled = torch.tensor(test_points_scaled, dtype=torch.float32)
     current_best_response = train_y.max().item()
 
-    def expected_improvement(model, test_points_scaled, current_best, likelihood):
-        with torch.no_grad(), gpytorch.settings.fast_pred_var():
-            observed_pred = likelihood(model(test_points_scaled))
-            mean = observed_pred.mean
-            std_dev = observed_pred.stddev
-            z = (mean - current_best) / std_dev
-            ei = (mean - current_best) * torch.distributions.Normal(0, 1).cdf(
-                z
-            ) + std_dev * torch.distributions.Normal(0, 1).log_prob(z).exp()
-            return ei.numpy(), std_dev.numpy(), mean.numpy()
-
-    ei, std_dev, mean = expected_improvement(
-        model, test_x_scaled, current_best_response, likelihood
+    # EI over all candidates in chunks; also collects the contour slice at the best concentration
+    scores = optimizer.score_candidates(
+        model, likelihood, current_best_response, test_points_scaled
     )
-    best_point_index = np.argmax(ei)
-    best_test_point = test_points_scaled[best_point_index]
-
-    with torch.no_grad(), gpytorch.settings.fast_pred_var():
-        best_test_point_tensor = torch.tensor(
-            best_test_point, dtype=torch.float32
-        ).unsqueeze(0)  # Add batch dimension
-        predicted_distribution = likelihood(model(best_test_point_tensor))
-        predicted_mean = predicted_distribution.mean.item()
-        predicted_stddev = predicted_distribution.stddev.item()
+    best_test_point = scores.best_point
+    predicted_mean = scores.best("mean")
+    predicted_stddev = scores.best("std_dev")
+    for rank, (point, ei_value) in enumerate(zip(scores.points, scores.values["ei"])):
+        logger.debug(f"Candidate {rank + 1}: {point} EI={ei_value:.4f}")
     print("Best Test Point in scalar values:", best_test_point)
     best_test_point_original = optimizer.convert_parameters(best_test_point)
 
@@ -942,28 +1239,13 @@ def main(
     )
 
     insert_best_test_point(df)
-    mask = np.isclose(
-        test_points_scaled[:, 2], test_points_scaled[best_point_index, 2], rtol=1e-3
-    )
-
-    voltage_values = test_points_scaled[mask, 0]
-    time_values = test_points_scaled[mask, 1]
-    ei_values = ei[mask]
-    std_dev_values = std_dev[mask]
-    mean_values = mean[mask]
-    fig = optimizer.visualizer.create_contour_plots(
-        voltage_values=voltage_values,
-        time_values=time_values,
-        ei_values=ei_values,
-        std_dev_values=std_dev_values,
-        mean_values=mean_values,
-        concentration=edot_concentration,
-    )
 
     contourplots_filename = get_next_filename(
         contourplots_path, extensions=["svg", "png"]
     )
-    paths = optimizer.visualizer.save_plots(fig, contourplots_filename)
+    paths = optimizer.plot_and_save_slice(
+        scores.best_slice, contourplots_filename, concentration=edot_concentration
+    )
     plot_path = str(paths[1])  # Use PNG path for database
 
     # Save the results to results
@@ -299,7 +299,8 @@ def select_ml_training_data() -> pd.DataFrame:
         pd.DataFrame: The training data.
     """
     session = SessionLocal()
-    result = session.query(MlPedotTrainingData).all()
+    # insertion order, so incremental model updates can tell which rows are new
+    result = session.query(MlPedotTrainingData).order_by(MlPedotTrainingData.id).all()
     session.close()
     df = pd.DataFrame([entry.to_dict() for entry in result])
     return df
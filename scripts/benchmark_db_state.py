@@ -0,0 +1,251 @@
+#!/usr/bin/env python3
+"""
+benchmark_db_state.py
+
+Times the state lookups the scheduler and vessel code make against a SQLite
+database holding a long campaign history, with and without the indexes and
+the panda_vial_status table added in migration d55e0781076d:
+
+- before: no experiment/status indexes, panda_vial_status is the ROW_NUMBER
+          view over every panda_vials row
+- after:  indexes on experiment_id/status, panda_vial_status is a table kept
+          current on each panda_vials write
+
+For each lookup it prints the median time in milliseconds, followed by the
+per-write cost of keeping panda_vial_status current.
+"""
+
+import argparse
+import statistics
+import time
+
+import sqlalchemy as sa
+
+from panda_lib.sql_tools.models import (
+    Base,
+    ExperimentParameters,
+    ExperimentResults,
+    Experiments,
+    Vials,
+    VialStatus,
+    WellModel,
+)
+from panda_lib.sql_tools.models.vials import refresh_vial_status
+
+INDEXED_TABLES = (ExperimentParameters, ExperimentResults, WellModel, Vials)
+
+# The panda_vial_status view the table replaced
+NEWEST_VIALS_VIEW = """
+CREATE VIEW panda_vial_status AS
+    SELECT *
+      FROM (SELECT *,
+                   ROW_NUMBER() OVER (PARTITION BY position
+                                      ORDER BY updated DESC, id DESC) AS rn
+              FROM panda_vials)
+     WHERE rn = 1
+"""
+
+LOOKUPS = {
+    "experiment parameters": (
+        "SELECT parameter_name, parameter_value FROM panda_experiment_parameters "
+        "WHERE experiment_id = :experiment_id"
+    ),
+    "experiment results": (
+        "SELECT result_type, result_value FROM panda_experiment_results "
+        "WHERE experiment_id = :experiment_id"
+    ),
+    "well of experiment": (
+        "SELECT plate_id, well_id, status FROM panda_well_hx "
+        "WHERE experiment_id = :experiment_id"
+    ),
+    "new wells on plate": (
+        "SELECT well_id FROM panda_well_hx WHERE status = 'new' AND plate_id = :plate"
+    ),
+    "current vials": "SELECT position, volume FROM panda_vial_status",
+    "current vial": ("SELECT volume FROM panda_vial_status WHERE position = :position"),
+}
+
+
+def populate(
+    engine: sa.Engine, experiments: int, positions: int, versions: int
+) -> None:
+    """A campaign history: experiments with parameters, results and wells, and
+    `versions` rows of vial history per position"""
+    coordinates = {"x": 0, "y": 0, "z": 0}
+    with engine.begin() as conn:
+        conn.execute(
+            Experiments.__table__.insert(),
+            [{"experiment_id": e, "project_id": 1} for e in range(experiments)],
+        )
+        conn.execute(
+            ExperimentParameters.__table__.insert(),
+            [
+                {
+                    "experiment_id": e,
+                    "parameter_name": f"param_{p}",
+                    "parameter_value": str(p),
+                }
+                for e in range(experiments)
+                for p in range(10)
+            ],
+        )
+        conn.execute(
+            ExperimentResults.__table__.insert(),
+            [
+                {
+                    "experiment_id": e,
+                    "result_type": f"result_{r}",
+                    "result_value": str(r),
+                    "context": "",
+                }
+                for e in range(experiments)
+                for r in range(3)
+            ],
+        )
+        conn.execute(
+            WellModel.__table__.insert(),
+            [
+                {
+                    "plate_id": e // 96,
+                    "well_id": f"W{e % 96}",
+                    "name": f"W{e % 96}",
+                    "experiment_id": e,
+                    "project_id": 1,
+                    "status": "complete" if e < experiments - 96 else "new",
+                    "coordinates": coordinates,
+                    "base_thickness": 1,
+                    "height": 6,
+                }
+                for e in range(experiments)
+            ],
+        )
+        conn.execute(
+            Vials.__table__.insert(),
+            [
+                {
+                    "position": f"s{p}",
+                    "category": 0,
+                    "name": f"solution_{p}",
+                    "contents": {},
+                    "viscosity_cp": 1,
+                    "concentration": 1,
+                    "density": 1,
+                    "coordinates": coordinates,
+                    "base_thickness": 1,
+                    "height": 57,
+                    "volume": 20000 - v,
+                    "panda_unit_id": 1,
+                    "updated": f"2026-01-01 00:00:{v:06d}",
+                }
+                for v in range(versions)
+                for p in range(positions)
+            ],
+        )
+        refresh_vial_status(conn, [f"s{p}" for p in range(positions)])
+
+
+def to_before(engine: sa.Engine) -> None:
+    """Drop the indexes and put the ranked view back in place of the table"""
+    with engine.begin() as conn:
+        for model in INDEXED_TABLES:
+            for index in model.__table__.indexes:
+                index.drop(conn)
+        VialStatus.__table__.drop(conn)
+        conn.exec_driver_sql(NEWEST_VIALS_VIEW)
+
+
+def _median_ms(conn, sql: str, params: dict, repeats: int) -> float:
+    statement = sa.text(sql)
+    times = []
+    for _ in range(repeats):
+        t0 = time.perf_counter()
+        conn.execute(statement, params).fetchall()
+        times.append((time.perf_counter() - t0) * 1000.0)
+    return statistics.median(times)
+
+
+def time_lookups(engine: sa.Engine, experiments: int, repeats: int) -> dict:
+    params = {
+        "experiment_id": experiments // 2,
+        "plate": (experiments - 1) // 96,
+        "position": "s0",
+    }
+    with engine.connect() as conn:
+        return {
+            name: _median_ms(conn, sql, params, repeats)
+            for name, sql in LOOKUPS.items()
+        }
+
+
+def time_vial_writes(engine: sa.Engine, writes: int) -> tuple:
+    """Median ms per panda_vials insert, without and with the status refresh"""
+    row = {
+        "position": "s0",
+        "category": 0,
+        "name": "solution_0",
+        "contents": {},
+        "coordinates": {"x": 0, "y": 0, "z": 0},
+        "base_thickness": 1,
+        "height": 57,
+        "viscosity_cp": 1,
+        "concentration": 1,
+        "density": 1,
+        "volume": 1000,
+        "panda_unit_id": 1,
+        "updated": "2099-01-01 00:00:00",
+    }
+    plain, refreshed = [], []
+    with engine.connect() as conn:
+        for _ in range(writes):
+            t0 = time.perf_counter()
+            conn.execute(Vials.__table__.insert(), row)
+            plain.append((time.perf_counter() - t0) * 1000.0)
+
+            t0 = time.perf_counter()
+            conn.execute(Vials.__table__.insert(), row)
+            refresh_vial_status(conn, ["s0"])
+            refreshed.append((time.perf_counter() - t0) * 1000.0)
+        conn.rollback()
+    return statistics.median(plain), statistics.median(refreshed)
+
+
+def benchmark(
+    experiments: int = 10000,
+    positions: int = 20,
+    versions: int = 2000,
+    repeats: int = 20,
+    writes: int = 50,
+) -> dict:
+    """{"after": {lookup: ms}, "before": {lookup: ms}, "writes": (plain, refreshed)}"""
+    engine = sa.create_engine("sqlite://")
+    Base.metadata.create_all(engine)
+    populate(engine, experiments, positions, versions)
+
+    report = {"after": time_lookups(engine, experiments, repeats)}
+    report["writes"] = time_vial_writes(engine, writes)
+    to_before(engine)
+    report["before"] = time_lookups(engine, experiments, repeats)
+    return report
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Time database state lookups")
+    parser.add_argument("--experiments", type=int, default=10000)
+    parser.add_argument("--positions", type=int, default=20, help="Vial positions")
+    parser.add_argument(
+        "--versions", type=int, default=2000, help="History rows per vial position"
+    )
+    parser.add_argument("--repeats", type=int, default=20, help="Timed reads each")
+    args = parser.parse_args()
+
+    report = benchmark(args.experiments, args.positions, args.versions, args.repeats)
+    print(f"{'lookup':<24}{'before ms':>12}{'after ms':>12}{'speedup':>10}")
+    for name in LOOKUPS:
+        before, after = report["before"][name], report["after"][name]
+        print(f"{name:<24}{before:>12.3f}{after:>12.3f}{before / after:>9.1f}x")
+    plain, refreshed = report["writes"]
+    print(f"\nvial insert: {plain:.3f} ms, with status refresh: {refreshed:.3f} ms")
+
+
+if __name__ == "__main__":
+    main()
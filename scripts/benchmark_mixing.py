@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+"""
+benchmark_mixing.py
+
+Times the vial mixing solvers on the transfers a campaign makes:
+- single: one vial already at the target concentration
+- pair:   the target sits between two vials
+- ilp:    the volume needs three vials, so MixingSolver runs the ILP
+
+For each case it prints the median time per solve in milliseconds for
+solve_vials_ilp, solve_multisolute_mix (one species), MixingSolver on a cold
+cache and MixingSolver on a warm cache.
+"""
+
+import argparse
+import statistics
+import time
+
+from panda_lib.mixing import MixingSolver
+from panda_lib.utilities import solve_multisolute_mix, solve_vials_ilp
+
+# name: (vial concentrations by position, total volume uL, target concentration)
+CASES = {
+    "single": ({"S1": 0.5, "S2": 1.0, "S3": 1.0}, 120.0, 1.0),
+    "pair": ({"S1": 0.5, "S2": 1.0, "S3": 2.0}, 150.0, 1.25),
+    "ilp": ({"S1": 1.0, "S2": 2.0, "S3": 3.0}, 700.0, 2.2),
+}
+
+
+def _median_ms(fn, repeats: int) -> float:
+    times = []
+    for _ in range(repeats):
+        t0 = time.perf_counter()
+        fn()
+        times.append((time.perf_counter() - t0) * 1000.0)
+    return statistics.median(times)
+
+
+def benchmark(repeats: int = 10) -> dict:
+    """Median ms per solve: {case: {solver: ms}}"""
+    report = {}
+    for name, (vials, v_total, c_target) in CASES.items():
+        composition = {p: {"solute": c} for p, c in vials.items()}
+        warm = MixingSolver()
+        warm.solve(vials, v_total, c_target)
+        report[name] = {
+            "solve_vials_ilp": _median_ms(
+                lambda: solve_vials_ilp(vials, v_total, c_target), repeats
+            ),
+            "solve_multisolute_mix": _median_ms(
+                lambda: solve_multisolute_mix(
+                    composition, v_total, {"solute": c_target}, max_vol=300.0
+                ),
+                repeats,
+            ),
+            "MixingSolver cold": _median_ms(
+                lambda: MixingSolver().solve(vials, v_total, c_target), repeats
+            ),
+            "MixingSolver warm": _median_ms(
+                lambda: warm.solve(vials, v_total, c_target), repeats
+            ),
+        }
+    return report
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Time the vial mixing solvers")
+    parser.add_argument("--repeats", type=int, default=10, help="Timed solves each")
+    args = parser.parse_args()
+
+    report = benchmark(args.repeats)
+    solvers = list(next(iter(report.values())))
+    print(f"{'case':<8}" + "".join(f"{s:>24}" for s in solvers))
+    for name, timings in report.items():
+        print(f"{name:<8}" + "".join(f"{timings[s]:>24.3f}" for s in solvers))
+
+
+if __name__ == "__main__":
+    main()
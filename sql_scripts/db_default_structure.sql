@@ -210,6 +210,18 @@ CREATE TABLE IF NOT EXISTS panda_potentiostat_techniques (
 );
 
 
+-- Table: panda_predispensed
+DROP TABLE IF EXISTS panda_predispensed;
+
+CREATE TABLE IF NOT EXISTS panda_predispensed (
+    plate_id INTEGER      NOT NULL,
+    well_id  VARCHAR (8)  NOT NULL,
+    solution VARCHAR (255) NOT NULL,
+    volume   REAL,
+    PRIMARY KEY (plate_id, well_id, solution)
+);
+
+
 -- Table: panda_projects
 DROP TABLE IF EXISTS panda_projects;
 
@@ -374,6 +386,40 @@ INSERT INTO panda_vial_hx (id, position, contents, viscosity_cp, concentration,
 INSERT INTO panda_vial_hx (id, position, contents, viscosity_cp, concentration, density, category, radius, height, depth, name, volume, capacity, contamination, vial_coordinates, updated, wall_thickness) VALUES (7687, 'w6', '{}', 0.0, NULL, 0.0, 1, 14, 57, -73, 'waste', 1000.0, 20000, 0, '{"x": -50, "y": -205, "z_top": -17.0, "z_bottom": -74}', '2024-11-26 02:37:22.457', 1.0);
 INSERT INTO panda_vial_hx (id, position, contents, viscosity_cp, concentration, density, category, radius, height, depth, name, volume, capacity, contamination, vial_coordinates, updated, wall_thickness) VALUES (7688, 'w7', '{}', 0.0, NULL, 0.0, 1, 14, 57, -73, 'waste', 1000.0, 20000, 0, '{"x": -50, "y": -238, "z_top": -17.0, "z_bottom": -74}', '2024-11-26 02:37:22.457', 1.0);
 
+-- Table: panda_vial_status
+DROP VIEW IF EXISTS panda_vial_status;
+DROP TABLE IF EXISTS panda_vial_status;
+
+CREATE TABLE IF NOT EXISTS panda_vial_status (
+    id               INTEGER,
+    position         TEXT    PRIMARY KEY,
+    contents         TEXT,
+    viscosity_cp     REAL,
+    concentration    REAL,
+    density          REAL,
+    category         INTEGER,
+    radius           INTEGER,
+    height           INTEGER,
+    depth            INTEGER,
+    name             TEXT,
+    volume           REAL,
+    capacity         INTEGER,
+    contamination    INTEGER,
+    vial_coordinates TEXT,
+    updated          TEXT,
+    wall_thickness   REAL
+);
+
+INSERT INTO panda_vial_status
+    SELECT v1.*
+      FROM panda_vial_hx v1
+     WHERE v1.id = (SELECT v2.id
+                      FROM panda_vial_hx v2
+                     WHERE v2.position = v1.position
+                     ORDER BY v2.updated DESC,
+                              v2.id DESC
+                     LIMIT 1);
+
 -- Table: panda_well_hx
 DROP TABLE IF EXISTS panda_well_hx;
 
@@ -422,6 +468,15 @@ CREATE TABLE IF NOT EXISTS panda_wellplates (
 
 INSERT INTO panda_wellplates (id, type_id, current, a1_x, a1_y, orientation, rows, cols, z_bottom, z_top, echem_height, image_height) VALUES (999, 4, 0, -222.5, -78, 0, 'ABCDEFGH', '12', -71, -65, -72.5, -50.0);
 
+-- Index: idx_parameters_experiment
+DROP INDEX IF EXISTS idx_parameters_experiment;
+
+CREATE INDEX IF NOT EXISTS idx_parameters_experiment ON panda_experiment_parameters (
+    experiment_id,
+    parameter_name
+);
+
+
 -- Index: idx_unique_active
 DROP INDEX IF EXISTS idx_unique_active;
 
@@ -448,6 +503,15 @@ CREATE INDEX IF NOT EXISTS idx_vials_position ON panda_vial_hx (
 );
 
 
+-- Index: idx_vials_position_updated
+DROP INDEX IF EXISTS idx_vials_position_updated;
+
+CREATE INDEX IF NOT EXISTS idx_vials_position_updated ON panda_vial_hx (
+    position,
+    updated
+);
+
+
 -- Index: idx_vials_updated
 DROP INDEX IF EXISTS idx_vials_updated;
 
@@ -456,6 +520,23 @@ CREATE INDEX IF NOT EXISTS idx_vials_updated ON panda_vial_hx (
 );
 
 
+-- Index: idx_well_hx_experiment
+DROP INDEX IF EXISTS idx_well_hx_experiment;
+
+CREATE INDEX IF NOT EXISTS idx_well_hx_experiment ON panda_well_hx (
+    experiment_id
+);
+
+
+-- Index: idx_well_hx_status
+DROP INDEX IF EXISTS idx_well_hx_status;
+
+CREATE INDEX IF NOT EXISTS idx_well_hx_status ON panda_well_hx (
+    status,
+    plate_id
+);
+
+
 -- Index: msg_id_index
 DROP INDEX IF EXISTS msg_id_index;
 
@@ -641,6 +722,72 @@ BEGIN
 END;
 
 
+-- Trigger: vial_status_delete
+DROP TRIGGER IF EXISTS vial_status_delete;
+CREATE TRIGGER IF NOT EXISTS vial_status_delete
+                       AFTER DELETE
+                          ON panda_vial_hx
+                    FOR EACH ROW
+BEGIN
+    DELETE FROM panda_vial_status
+          WHERE position = OLD.position;
+    INSERT INTO panda_vial_status
+         SELECT *
+           FROM panda_vial_hx
+          WHERE id = (SELECT id
+                   FROM panda_vial_hx
+                  WHERE position = OLD.position
+                  ORDER BY updated DESC,
+                           id DESC
+                  LIMIT 1);
+END;
+
+
+-- Trigger: vial_status_insert
+DROP TRIGGER IF EXISTS vial_status_insert;
+CREATE TRIGGER IF NOT EXISTS vial_status_insert
+                       AFTER INSERT
+                          ON panda_vial_hx
+                    FOR EACH ROW
+BEGIN
+    INSERT OR REPLACE INTO panda_vial_status
+         SELECT *
+           FROM panda_vial_hx
+          WHERE id = (SELECT id
+                   FROM panda_vial_hx
+                  WHERE position = NEW.position
+                  ORDER BY updated DESC,
+                           id DESC
+                  LIMIT 1);
+END;
+
+
+-- Trigger: vial_status_update
+DROP TRIGGER IF EXISTS vial_status_update;
+CREATE TRIGGER IF NOT EXISTS vial_status_update
+                       AFTER UPDATE
+                          ON panda_vial_hx
+                    FOR EACH ROW
+BEGIN
+    DELETE FROM panda_vial_status
+          WHERE position IN (OLD.position, NEW.position);
+    INSERT OR REPLACE INTO panda_vial_status
+         SELECT *
+           FROM panda_vial_hx
+          WHERE id IN ((SELECT id
+                   FROM panda_vial_hx
+                  WHERE position = OLD.position
+                  ORDER BY updated DESC,
+                           id DESC
+                  LIMIT 1), (SELECT id
+                   FROM panda_vial_hx
+                  WHERE position = NEW.position
+                  ORDER BY updated DESC,
+                           id DESC
+                  LIMIT 1));
+END;
+
+
 -- View: panda_experiment_params
 DROP VIEW IF EXISTS panda_experiment_params;
 CREATE VIEW IF NOT EXISTS panda_experiment_params AS
@@ -747,20 +894,6 @@ CREATE VIEW IF NOT EXISTS panda_queue AS
               a.experiment_id ASC;
 
 
--- View: panda_vial_status
-DROP VIEW IF EXISTS panda_vial_status;
-CREATE VIEW IF NOT EXISTS panda_vial_status AS
-    SELECT v1.*
-      FROM panda_vial_hx v1
-           LEFT JOIN
-           panda_vial_hx v2 ON v1.position = v2.position AND 
-                               (v1.updated < v2.updated OR 
-                                (v1.updated = v2.updated AND 
-                                 v1.id < v2.id) ) 
-     WHERE v2.id IS NULL
-     ORDER BY v1.position ASC;
-
-
 -- View: panda_well_status
 DROP VIEW IF EXISTS panda_well_status;
 CREATE VIEW IF NOT EXISTS panda_well_status AS
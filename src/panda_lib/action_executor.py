@@ -0,0 +1,240 @@
+"""
+Resource-aware execution of protocol steps.
+
+Protocol functions normally call one action after another, so the potentiostat
+sits idle while the gantry travels and the gantry sits idle while the camera
+saves an image. The ActionExecutor lets a protocol submit steps together with
+the hardware each one uses. Steps run as soon as every resource they need is
+free:
+
+- each resource is a lane, and steps on a lane run one at a time in the order
+  they were submitted, so two steps never drive the same hardware at once;
+- steps on different lanes overlap;
+- a step can also wait for earlier steps with ``after``.
+
+Example, rinsing the electrode while the previous image is saved and
+annotated::
+
+    with ActionExecutor() as executor:
+        save = executor.submit([Resource.CAMERA], save_and_annotate, image)
+        rinse = executor.submit(
+            [Resource.MILL, Resource.PUMP], rinse_electrode, toolkit
+        )
+        executor.wait(save, rinse)
+
+Declare every resource a step touches. On the OT2 pipette the stepper is driven
+through the Arduino, so pipette steps there need both PUMP and ARDUINO.
+"""
+
+import enum
+import logging
+import threading
+from collections import deque
+from concurrent.futures import Future, ThreadPoolExecutor
+from typing import Any, Callable, Dict, Iterable, List, Optional, Sequence, Union
+
+logger = logging.getLogger("panda")
+
+
+class Resource(enum.Enum):
+    """The physical resources a protocol step can use"""
+
+    MILL = "mill"
+    PUMP = "pump"
+    ARDUINO = "arduino"
+    POTENTIOSTAT = "potentiostat"
+    CAMERA = "camera"
+
+
+class ExecutorAborted(Exception):
+    """Raised for steps that did not run because an earlier step failed"""
+
+    def __init__(self, label: str, cause: BaseException):
+        self.label = label
+        self.cause = cause
+        self.message = f"Step {label} was not run because a step failed: {cause}"
+        super().__init__(self.message)
+
+
+class _Step:
+    def __init__(
+        self,
+        label: str,
+        resources: List[Resource],
+        after: Sequence[Future],
+        function: Callable,
+        args: tuple,
+        kwargs: dict,
+    ):
+        self.label = label
+        self.resources = resources
+        self.after = list(after)
+        self.function = function
+        self.args = args
+        self.kwargs = kwargs
+        self.future: Future = Future()
+
+
+class ActionExecutor:
+    """Runs protocol steps on one lane per hardware resource.
+
+    Attributes:
+        failure (BaseException | None): The first exception raised by a step.
+            Once set, steps that have not started yet fail with ExecutorAborted
+            until drain is called.
+    """
+
+    def __init__(self, max_workers: Optional[int] = None):
+        self._pool = ThreadPoolExecutor(
+            max_workers=max_workers or len(Resource),
+            thread_name_prefix="panda-action",
+        )
+        self._lanes: Dict[Resource, deque] = {
+            resource: deque() for resource in Resource
+        }
+        self._condition = threading.Condition()
+        self._steps = 0
+        self.failure: Optional[BaseException] = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.shutdown(wait=True)
+
+    def submit(
+        self,
+        resources: Iterable[Union[Resource, str]],
+        function: Callable,
+        *args,
+        after: Sequence[Future] = (),
+        label: Optional[str] = None,
+        **kwargs,
+    ) -> Future:
+        """
+        Queue a step that needs the given resources.
+
+        Args:
+            resources: The resources the step uses, as Resource members or their values.
+            function: The step, called as function(*args, **kwargs).
+            after: Futures of earlier steps that must finish first.
+            label: A name for logs, defaults to the function name.
+
+        Returns:
+            Future: Resolves to the step's return value.
+        """
+        lanes = sorted(
+            {Resource(resource) for resource in resources}, key=list(Resource).index
+        )
+        with self._condition:
+            self._steps += 1
+            step = _Step(
+                label or f"{getattr(function, '__name__', 'step')}#{self._steps}",
+                lanes,
+                after,
+                function,
+                args,
+                kwargs,
+            )
+            # Joining every lane under the lock keeps the lanes in one global order,
+            # so the oldest waiting step is always first on all of its lanes
+            for lane in lanes:
+                self._lanes[lane].append(step)
+        logger.debug(
+            "Queued %s on %s", step.label, ", ".join(lane.value for lane in lanes)
+        )
+        for future in step.after:
+            future.add_done_callback(self._notify)
+        self._pool.submit(self._run, step)
+        return step.future
+
+    def run(
+        self,
+        resources: Iterable[Union[Resource, str]],
+        function: Callable,
+        *args,
+        **kwargs,
+    ) -> Any:
+        """Submit a step and block until it has finished"""
+        return self.submit(resources, function, *args, **kwargs).result()
+
+    def wait(self, *futures: Future) -> List[Any]:
+        """Wait for the given steps and return their results, raising the first failure"""
+        return [future.result() for future in futures]
+
+    def drain(self, timeout: Optional[float] = None) -> Optional[BaseException]:
+        """
+        Wait for every queued step to finish, then clear the failure latch.
+
+        Call at the start of each experiment so a step that failed in an
+        earlier one does not abort the steps of the next.
+
+        Returns:
+            BaseException | None: The failure that was cleared, if any.
+
+        Raises:
+            TimeoutError: If steps are still queued after timeout seconds.
+        """
+        with self._condition:
+            idle = self._condition.wait_for(
+                lambda: not any(self._lanes.values()), timeout
+            )
+            if not idle:
+                raise TimeoutError("Steps are still running on the executor")
+            failure, self.failure = self.failure, None
+        return failure
+
+    def shutdown(self, wait: bool = True):
+        """Stop accepting steps, optionally waiting for the queued ones to finish"""
+        self._pool.shutdown(wait=wait)
+
+    def _ready(self, step: _Step) -> bool:
+        return all(self._lanes[lane][0] is step for lane in step.resources) and all(
+            future.done() for future in step.after
+        )
+
+    def _notify(self, _future: Optional[Future] = None):
+        with self._condition:
+            self._condition.notify_all()
+
+    def _release(self, step: _Step):
+        """Leave the step's lanes once its future is resolved"""
+        with self._condition:
+            for lane in step.resources:
+                self._lanes[lane].remove(step)
+            self._condition.notify_all()
+
+    def _run(self, step: _Step):
+        with self._condition:
+            self._condition.wait_for(lambda: self._ready(step))
+            failure = self.failure
+
+        if failure is None:
+            failure = next(
+                (
+                    future.exception()
+                    for future in step.after
+                    if future.exception() is not None
+                ),
+                None,
+            )
+        if failure is not None:
+            step.future.set_exception(ExecutorAborted(step.label, failure))
+            self._release(step)
+            return
+
+        logger.debug("Starting %s", step.label)
+        try:
+            result = step.function(*step.args, **step.kwargs)
+        except BaseException as error:  # pylint: disable=broad-except
+            logger.error("Step %s failed: %s", step.label, error)
+            with self._condition:
+                if self.failure is None:
+                    self.failure = error
+            step.future.set_exception(error)
+            self._release(step)
+            return
+
+        logger.debug("Finished %s", step.label)
+        step.future.set_result(result)
+        self._release(step)
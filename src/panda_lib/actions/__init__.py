@@ -1,3 +1,5 @@
+from panda_lib.action_executor import ActionExecutor, ExecutorAborted, Resource
+
 from .actions_pedot import (
     chrono_amp_edot_bleaching,
     chrono_amp_edot_coloring,
@@ -16,7 +18,14 @@ from .electrochemistry import (
     perform_cyclic_voltammetry,
 )
 from .imaging import capture_new_image, image_well
-from .movement import capping_sequence, decapping_sequence, move_to_vial, move_to_well
+from .movement import (
+    capping_sequence,
+    decapping_sequence,
+    move_through_targets,
+    move_to_vial,
+    move_to_well,
+    vessel_target,
+)
 from .pipetting import (
     clear_well,
     flush_pipette,
@@ -24,6 +33,7 @@ from .pipetting import (
     purge_pipette,
     rinse_well,
     transfer,
+    batched_transfer,
     contact_angle_transfer,
     volume_correction,
 )
@@ -31,6 +41,10 @@ from .vessel_handling import _handle_source_vessels, solution_selector, waste_se
 from .delay_timer import delay_timer as delay
 
 __all__ = [
+    # From panda_lib.action_executor
+    "ActionExecutor",
+    "ExecutorAborted",
+    "Resource",
     # From .actions_pedot
     "chrono_amp_edot_bleaching",
     "chrono_amp_edot_coloring",
@@ -52,8 +66,10 @@ __all__ = [
     # From .movement
     "capping_sequence",
     "decapping_sequence",
+    "move_through_targets",
     "move_to_vial",
     "move_to_well",
+    "vessel_target",
     # From .pipetting
     "clear_well",
     "flush_pipette",
@@ -61,6 +77,7 @@ __all__ = [
     "purge_pipette",
     "rinse_well",
     "transfer",
+    "batched_transfer",
     "contact_angle_transfer",
     "volume_correction",
     # From .vessel_handling
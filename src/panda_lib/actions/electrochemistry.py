@@ -2,7 +2,7 @@ import logging
 import os
 from logging import Logger
 from pathlib import Path
-from typing import Optional, Tuple
+from typing import Optional, Sequence, Tuple
 
 from panda_shared.config.config_tools import (
     ConfigParserError,
@@ -18,6 +18,7 @@ from ..exceptions import (  # noqa: E402
     CAFailure,
     CVFailure,
     DepositionFailure,
+    OCPAborted,
     OCPError,
     OCPFailure,
 )
@@ -25,6 +26,7 @@ from ..experiments.experiment_types import (  # noqa: E402
     EchemExperimentBase,
     ExperimentStatus,
 )
+from ..hardware.ocp_monitor import DEFAULT_OCP_RULES, OCPMonitor, OCPRule  # noqa: E402
 from ..labware.wellplates import Well  # noqa: E402
 from ..toolkit import Toolkit  # noqa: E402
 
@@ -99,20 +101,31 @@ def open_circuit_potential(
     file_tag: str,
     exp: Optional[EchemExperimentBase] = None,
     testing: bool = False,
+    rules: Sequence[OCPRule] = DEFAULT_OCP_RULES,
 ) -> Tuple[bool, float]:
     """Perform open circuit potential measurement sequence.
 
+    Samples are checked against `rules` while the OCP runs, and the run is
+    stopped as soon as one trips (e.g. a shorted or out-of-solution electrode).
+
     Parameters
     ----------
     file_tag : str
         Additional identifier for output files
     exp : EchemExperimentBase
         Experiment parameters and configuration
+    rules : Sequence[OCPRule]
+        Early-abort rules, empty to always run the full OCP
 
     Returns
     -------
     float
         The final open circuit potential voltage
+
+    Raises
+    ------
+    OCPAborted
+        A rule stopped the run; carries the reason and last voltage
     """
     # well = "test"
     # experiment = "test"
@@ -157,8 +170,30 @@ def open_circuit_potential(
                 f"Unsupported potentiostat model: {PSTAT}. Supported models are 'gamry' and 'emstat'."
             )
 
-        pstat.OCP(params)  # OCP
+        monitor = OCPMonitor(rules) if rules else None
+        pstat.OCP(params, on_sample=monitor)  # OCP
         pstat.activecheck()
+        if monitor is not None and monitor.aborted:
+            # Record the partial run first, nothing below may keep it out of
+            # the results
+            if exp:
+                try:
+                    exp.results.set_ocp_file(
+                        base_filename, False, monitor.last_voltage, file_tag
+                    )
+                except OSError as error:
+                    logger.error(
+                        "Aborted OCP data %s could not be read: %s",
+                        base_filename,
+                        error,
+                    )
+            logger.error(
+                "OCP of well %s aborted after %.2f s: %s",
+                well,
+                monitor.abort_time,
+                monitor.reason,
+            )
+            raise OCPAborted("OCP", monitor.reason, monitor.last_voltage)
         ocp_pass, ocp_final_voltage = pstat.check_vf_range(base_filename)
         exp.results.set_ocp_file(base_filename, ocp_pass, ocp_final_voltage, file_tag)
         logger.info(
@@ -219,10 +254,14 @@ def ocp_check(
             second_z_cord_feed=100,
         )
 
-        passed, potential = ocp(
-            file_tag=file_tag,
-            exp=exp,
-        )
+        try:
+            passed, potential = ocp(
+                file_tag=file_tag,
+                exp=exp,
+            )
+        except OCPAborted as e:
+            # stopped early by a streaming rule, handled like a failed OCP
+            passed, potential = False, e.voltage
 
         if not passed:
             if (
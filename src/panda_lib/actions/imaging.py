@@ -3,7 +3,7 @@ import logging
 from pathlib import Path
 from typing import Optional
 
-from PIL import Image
+import numpy as np
 
 from panda_lib.experiments.experiment_types import (
     EchemExperimentBase,
@@ -11,9 +11,10 @@ from panda_lib.experiments.experiment_types import (
 )
 from panda_lib.hardware.grbl_cnc_mill import Instruments
 from panda_lib.hardware.imaging import (
-    add_data_zone,
+    ZStackAcquisition,
     capture_new_image,
     image_filepath_generator,
+    z_planes,
 )
 from panda_lib.toolkit import Toolkit
 from panda_shared.config.config_tools import (
@@ -53,12 +54,21 @@ logger = logging.getLogger("panda")
 testing_logging = logging.getLogger("panda")
 
 
+def to_bgr(frame, camera) -> np.ndarray:
+    """A captured frame in the BGR channel order OpenCV expects"""
+    frame = np.asarray(frame)
+    if frame.ndim == 3 and getattr(camera, "color_order", "RGB") == "RGB":
+        return frame[..., ::-1]
+    return frame
+
+
 def image_well(
     toolkit: Toolkit,
     experiment: Optional[EchemExperimentBase] = None,
     image_label: Optional[str] = None,
     curvature_image: bool = False,
     add_datazone: bool = False,
+    focus_scorer=None,
 ) -> None:
     """Move to and capture an image of a well.
 
@@ -72,11 +82,19 @@ def image_well(
         Description of the experimental step for file naming
     curvature_image : bool, optional
         Whether to use curvature lighting, by default False
+    focus_scorer : optional
+        Scores curvature frames as they are captured, for example a
+        contact_angle_led_detect.StreamingFocusScorer passed in by the
+        protocol. Anything with reset(), submit(frame, z_mm, name),
+        peak_reached() and finish() will do. It is reset before the sweep,
+        and the sweep stops once the focus curve has peaked.
 
     Notes
     -----
     - Images are saved to configured data directory
     - Two images are saved: raw and with data zone overlay
+    - Frames are saved by toolkit.image_writer in the background, the gantry
+      moves on as soon as the exposure completes
     - Failed image capture will not halt experiment execution
     """
     if toolkit.camera is None:
@@ -97,78 +115,94 @@ def image_well(
 
         if TESTING:
             Path(filepath).touch()
+            experiment.results.append_image_file(filepath, context=image_label)
 
         else:
             if curvature_image:
                 logger.debug("Moving camera above well %s", well_id)
                 if well_id != "test":
-                    x = experiment.well.well_data.x
-                    y = experiment.well.well_data.y
-                    z_start = toolkit.wellplate.plate_data.image_height
-                    num_steps = int(2.0 / 0.2) + 1  # 11 steps: 0, -0.2, ..., -2.0
-
-                    # Define brightness levels and associated functions
-                    brightness_levels = [
-                        ("50", toolkit.arduino.ca_lights_on_50),
-                    ]
-
-                    for i in range(num_steps):
-                        z = round(z_start + i * 0.2, 2)
-                        toolkit.mill.safe_move(
-                            x_coord=x,
-                            y_coord=y,
-                            z_coord=z,
-                            tool=Instruments.LENS,
+                    # 11 planes: image_height, +0.2, ..., +2.0
+                    planes = z_planes(
+                        toolkit.wellplate.plate_data.image_height, 0.2, 11
+                    )
+                    brightness_label = "50"
+                    base_label = str(image_label) if image_label else ""
+
+                    def z_label_for(z: float) -> str:
+                        # replace . with - to avoid file extension confusion
+                        z_str = f"{z:.2f}".replace(".", "-")
+                        return f"{base_label}_z{z_str}mm_b{brightness_label}"
+
+                    def score_plane(plane) -> bool:
+                        focus_scorer.submit(
+                            to_bgr(plane.frame, toolkit.camera),
+                            z_mm=plane.measured_z,
+                            name=z_label_for(plane.target_z),
                         )
+                        return focus_scorer.peak_reached()
+
+                    if focus_scorer is not None:
+                        # A reused scorer must not carry over the last well's peak
+                        focus_scorer.reset()
+
+                    stack = ZStackAcquisition(
+                        toolkit.mill, toolkit.camera_session, logger=logger
+                    ).acquire(
+                        experiment.well.well_data.x,
+                        experiment.well.well_data.y,
+                        planes,
+                        tool=Instruments.LENS,
+                        lights_on=toolkit.arduino.ca_lights_on_50,
+                        lights_off=toolkit.arduino.lights_off,
+                        on_frame=score_plane if focus_scorer is not None else None,
+                    )
+                    if focus_scorer is not None:
+                        best = focus_scorer.finish()
+                        logger.info(
+                            "Best focus of well %s: %s",
+                            well_id,
+                            best["path"] if best else "none",
+                        )
+                    if stack.stopped_early:
+                        logger.debug(
+                            "Focus peaked, stopped after %s of %s planes",
+                            len(stack),
+                            len(planes),
+                        )
+                    elif len(stack) < len(planes):
+                        logger.error(
+                            "Captured %s of %s curvature planes of well %s, missed %s",
+                            len(stack),
+                            len(planes),
+                            well_id,
+                            stack.missed,
+                        )
+
+                    for plane in stack:
+                        z_label = z_label_for(plane.target_z)
 
-                        for brightness_label, brightness_func in brightness_levels:
-                            success = brightness_func()
-                            if not success:
-                                logger.warning(
-                                    "Failed to set curvature lights to %s%% brightness",
-                                    brightness_label,
-                                )
-                                continue
-
-                            base_label = str(image_label) if image_label else ""
-
-                            z_str = f"{z:.2f}".replace(
-                                ".", "-"
-                            )  # replace . with p to avoid file extension confusion
-                            z_label = f"{base_label}_z{z_str}mm_b{brightness_label}"
-
-                            filepath_z = image_filepath_generator(
-                                exp_id,
-                                pjct_id,
-                                cmpgn_id,
-                                well_id,
-                                z_label,
-                                PATH_TO_DATA,
-                            )
-                            logger.debug(
-                                "Capturing image of well %s at Z=%.2f, brightness=%s%%",
-                                experiment.well_id,
-                                z,
-                                brightness_label,
-                            )
-                            filepath_result, result = capture_new_image(
-                                save=True,
-                                num_images=1,
-                                file_name=filepath_z,
-                                logger=logger,
-                            )
-                            toolkit.arduino.lights_off()
-
-                            if not result:
-                                logger.error(
-                                    "Failed to capture image at Z=%.2f, brightness=%s%%",
-                                    z,
-                                    brightness_label,
-                                )
-                                continue
-                            experiment.results.append_image_file(
-                                filepath_result, context=z_label
-                            )
+                        filepath_z = image_filepath_generator(
+                            exp_id,
+                            pjct_id,
+                            cmpgn_id,
+                            well_id,
+                            z_label,
+                            PATH_TO_DATA,
+                        )
+                        logger.debug(
+                            "Saving image of well %s at Z=%.2f (measured %.3f)",
+                            well_id,
+                            plane.target_z,
+                            plane.measured_z,
+                        )
+                        toolkit.image_writer.submit(
+                            plane.frame,
+                            filepath_z,
+                            toolkit.camera_session,
+                            experiment=experiment,
+                            context=z_label,
+                            add_datazone=add_datazone,
+                        )
                 else:
                     pass
 
@@ -186,34 +220,21 @@ def image_well(
                 time.sleep(0.2)
                 toolkit.arduino.white_lights_on5()
                 logger.debug("Capturing image of well %s", experiment.well_id)
-                filepath, result = capture_new_image(
-                    save=True,
-                    num_images=1,
-                    file_name=filepath,
-                    logger=logger,
-                )
+                frame = toolkit.camera_session.capture()
                 toolkit.arduino.lights_off()
 
-                if not result:
+                if frame is None:
                     raise ImageFailure("Failed to capture image")
-
-            if add_datazone:
-                dz_filename = filepath.stem + "_dz" + filepath.suffix
-                dz_filepath = filepath.with_name(dz_filename)
-
-                img: Image = add_data_zone(
+                toolkit.image_writer.submit(
+                    frame,
+                    filepath,
+                    toolkit.camera_session,
                     experiment=experiment,
-                    image=Image.open(filepath),
                     context=image_label,
-                )
-                img.save(dz_filepath)
-                experiment.results.append_image_file(
-                    dz_filepath, context=image_label + "_dz"
+                    add_datazone=add_datazone,
                 )
         logger.debug("Image of well %s captured", experiment.well_id)
 
-        experiment.results.append_image_file(filepath, context=image_label)
-
     except ImageFailure as e:
         logger.exception("Failed to image well %s. Error %s occured", well_id, e)
         # raise ImageCaputreFailure(instructions.well_id) from e
@@ -1,10 +1,11 @@
-import asyncio
 import logging
 from logging import Logger
 from pathlib import Path
-import time
+from typing import Callable, List, Optional, Union
 
+from panda_lib.hardware.capper import CapHandler, CapStateCache
 from panda_lib.hardware.gantry_interface import PandaMill as Mill
+from panda_lib.hardware.grbl_cnc_mill import MotionPlan, MotionPlanner, PlannerTarget
 from panda_shared.config.config_tools import (
     ConfigParserError,
     read_config,
@@ -40,6 +41,9 @@ except ConfigParserError as e:
 logger = logging.getLogger("panda")
 testing_logging = logging.getLogger("panda")
 
+# Which vials are uncapped and whose cap the decapper holds
+cap_states = CapStateCache()
+
 
 def move_to_well(
     well: Well,
@@ -293,142 +297,118 @@ def move_electrode_to_vial_bottom(
     logger.info(f"Moved electrode to vial {vial}")
 
 
-def decapping_sequence(
-    mill: Mill, target_coords: Coordinates, ard_link: ArduinoLink
-) -> None:
-    """Execute vial decapping sequence with retry and manual fallback."""
+def vessel_target(
+    vessel: Union[Vial, Well],
+    tool: str,
+    z: Optional[float] = None,
+    z_offset: float = 0.0,
+) -> PlannerTarget:
+    """Build a motion planner target for a vial, well, tip or rinse station.
 
-    def check_line_break() -> bool:
-        unit_version = config.getfloat("PANDA", "version")
-        if unit_version > 1.0:
-            return asyncio.run(ard_link.async_line_break())
-        else:
-            return True  # Assume success for legacy units
+    Parameters
+    ----------
+    vessel : Union[Vial, Well]
+        Anything with x, y, top and name attributes
+    tool : str
+        The tool that should arrive at the vessel
+    z : float, optional
+        Absolute Z to move to, by default the vessel top
+    z_offset : float, optional
+        Additional Z-axis offset, by default 0.0
+    """
+    z = vessel.top if z is None else z
+    return PlannerTarget(
+        coordinates=Coordinates(vessel.x, vessel.y, z + z_offset),
+        tool=tool,
+        label=str(vessel.name),
+        payload=vessel,
+    )
 
-    mill.safe_move(target_coords.x, target_coords.y, target_coords.z, tool="decapper")
-    time.sleep(0.5)  # Short pause to settle after move
 
-    ard_link.no_cap()
-    time.sleep(1.0)  # Wait for decapper to engage
+def move_through_targets(
+    targets: List[PlannerTarget],
+    mill: Mill,
+    logger: Logger,
+    optimize_order: bool = False,
+    on_arrival: Optional[Callable[[PlannerTarget], None]] = None,
+    travel_height: Optional[float] = None,
+) -> MotionPlan:
+    """Visit a batch of targets along one planned path.
 
-    mill.move_to_position(
-        target_coords.x,
-        target_coords.y,
-        0,
-        tool="decapper",
-    )
-    time.sleep(1.0)  # Wait for motion to complete before checking sensor
-
-    for attempt in range(3):
-        if check_line_break():
-            return  # Success
-        elif attempt == 0:
-            # Retry once
-            print("[WARNING] Cap not detected. Retrying decapping...")
-            time.sleep(1.0)
-            mill.safe_move(
-                target_coords.x, target_coords.y, target_coords.z, tool="decapper"
-            )
-            time.sleep(0.5)
-            ard_link.no_cap()
-            time.sleep(1.0)
-            mill.move_to_position(target_coords.x, target_coords.y, 0, tool="decapper")
-            time.sleep(1.0)
-            if check_line_break():
-                return  # Success
-        else:
-            # Final failure
-
-            mill.safe_move(
-                target_coords.x, target_coords.y, target_coords.z, tool="decapper"
-            )
-            time.sleep(0.5)
-            ard_link.no_cap()
-            time.sleep(1.0)
-            mill.move_to_position(target_coords.x, target_coords.y, 0, tool="decapper")
-            time.sleep(1.0)
-
-            if not check_line_break():
-                raise ValueError("Cap still not detected.")
+    Parameters
+    ----------
+    targets : List[PlannerTarget]
+        Tool-tagged targets, e.g. from vessel_target
+    mill : Mill
+        The mill controller object
+    logger : Logger
+        Logger for operation tracking
+    optimize_order : bool, optional
+        Reorder the targets to minimise travel time, by default False. Only
+        use when the work done at each target is order independent.
+    on_arrival : Callable, optional
+        Called with each target once the gantry has stopped at it
+    travel_height : float, optional
+        Mill center Z for XY travel, by default the mill's safe_z_height.
+        Pass the max Z height to keep the clearance of move_to_safe_position.
+
+    Returns
+    -------
+    MotionPlan
+        The executed plan with predicted and actual time per segment
+
+    Notes
+    -----
+    Unlike a series of safe_move calls, Z is only lifted as far as the mill's
+    safe height and only when the next target needs it.
+    """
+    planner = MotionPlanner(mill, travel_height=travel_height, logger=logger)
+    plan = planner.plan(targets, optimize_order=optimize_order)
+    planner.execute(plan, on_arrival=on_arrival)
+    for segment in plan.report():
+        logger.debug("Motion segment: %s", segment)
+    return plan
 
 
-def capping_sequence(
+def _cap_handler(mill: Mill, ard_link: ArduinoLink) -> CapHandler:
+    """Cap handler sharing the process-wide cap state"""
+    # Legacy units have no line break sensor
+    has_sensor = config.getfloat("PANDA", "version") > 1.0
+    return CapHandler(mill, ard_link, sensor=has_sensor, cache=cap_states)
+
+
+def decapping_sequence(
     mill: Mill, target_coords: Coordinates, ard_link: ArduinoLink
 ) -> None:
-    """Execute vial capping sequence with retry and manual fallback."""
+    """Execute vial decapping sequence with retries.
 
-    def check_line_break() -> bool:
-        unit_version = config.getfloat("PANDA", "version")
-        if unit_version > 1.0:
-            return asyncio.run(ard_link.async_line_break())
-        else:
-            return True  # Assume success for legacy units
+    Each step waits only until it is confirmed: the mill reporting idle, the
+    electromagnet command being acknowledged and the line break sensor
+    detecting the cap. Skipped if the decapper already holds this vial's cap.
 
-    mill.safe_move(target_coords.x, target_coords.y, target_coords.z, tool="decapper")
-    time.sleep(0.5)  # Short pause to settle after move
+    Raises
+    ------
+    CapHandlingError
+        If the cap is not detected after all attempts
+    """
+    _cap_handler(mill, ard_link).decap(target_coords)
 
-    ard_link.ALL_CAP()
-    time.sleep(1.0)  # Wait for decapper to disengage
 
-    mill.move_to_position(
-        target_coords.x,
-        target_coords.y,
-        0,
-        tool="decapper",
-    )
-    time.sleep(3.0)  # Wait for motion to complete before checking sensor
-
-    MAX_ATTEMPTS = 3  # total tries before failing
-
-    for attempt in range(MAX_ATTEMPTS):
-        # Success path: cap not detected
-        if not check_line_break():
-            return
-
-        # Still detected
-        print(f"[WARNING] Cap detected. Attempt {attempt + 1} of {MAX_ATTEMPTS}...")
-
-        if attempt == 0:
-            time.sleep(1.0)
-            mill.safe_move(
-                target_coords.x, target_coords.y, target_coords.z, tool="decapper"
-            )
-            mill.move_to_position(
-                target_coords.x, target_coords.y + 5, target_coords.z, tool="decapper"
-            )
-            time.sleep(1.0)
-            ard_link.ALL_CAP()
-            time.sleep(1.0)
-            mill.move_to_position(target_coords.x, target_coords.y, 0, tool="decapper")
-            time.sleep(1.0)
-        else:
-            mill.safe_move(
-                target_coords.x, target_coords.y, target_coords.z, tool="decapper"
-            )
-            mill.move_to_position(
-                target_coords.x, target_coords.y + 5, target_coords.z, tool="decapper"
-            )
-            time.sleep(1.0)
-            ard_link.ALL_CAP()
-            time.sleep(1.0)
-            mill.move_to_position(target_coords.x, target_coords.y, 0, tool="decapper")
-            time.sleep(1.0)
-
-        # Re-check after the action
-        if not check_line_break():
-            return
-
-    # If we get here, all attempts failed
-    mill.safe_move(target_coords.x, target_coords.y, target_coords.z, tool="decapper")
-    time.sleep(0.5)
-    ard_link.ALL_CAP()
-    time.sleep(1.0)
-    mill.move_to_position(target_coords.x, target_coords.y, 0, tool="decapper")
-    time.sleep(1.0)
+def capping_sequence(
+    mill: Mill, target_coords: Coordinates, ard_link: ArduinoLink
+) -> None:
+    """Execute vial capping sequence with retries.
 
-    if check_line_break():
-        print("[WARNING] Cap still detected after capping.")
-        raise ValueError("Cap still detected after manual intervention.")
+    Each step waits only until it is confirmed: the mill reporting idle, the
+    electromagnet command being acknowledged and the line break sensor no
+    longer detecting the cap.
+
+    Raises
+    ------
+    CapHandlingError
+        If the cap is still detected after all attempts
+    """
+    _cap_handler(mill, ard_link).cap(target_coords)
 
 
 '''
@@ -1,7 +1,7 @@
 import logging
 import math
 import time
-from typing import Optional, Union
+from typing import Optional, Sequence, Tuple, Union
 from panda_lib.exceptions import NoAvailableSolution
 from panda_lib.hardware.grbl_cnc_mill import Instruments
 from panda_shared.config.config_tools import (
@@ -21,7 +21,12 @@ from ..labware import StockVial, Vial, WasteVial, Well
 from ..labware.services import TipService
 from ..toolkit import Hardware, Labware, Toolkit
 from ..utilities import Coordinates, correction_factor
-from .movement import capping_sequence, decapping_sequence
+from .movement import (
+    capping_sequence,
+    decapping_sequence,
+    move_through_targets,
+    vessel_target,
+)
 from .vessel_handling import _handle_source_vessels, solution_selector, waste_selector
 
 TESTING = read_testing_config()
@@ -353,19 +358,18 @@ def _pipette_action(
             )
 
         toolkit.pipette.prime()
-        # Use standard interface for aspirate
-        toolkit.mill.safe_move(
-            src_vessel.x,
-            src_vessel.y,
+        _move_pipette(
+            toolkit,
+            src_vessel,
             src_vessel.withdrawal_height,
-            tool=Instruments.PIPETTE,
+            cap_held=isinstance(src_vessel, StockVial),
         )
         toolkit.pipette.aspirate(repetition_vol, solution=src_vessel)
         time.sleep(3)  # Allow time for aspirate to complete
-        toolkit.mill.move_to_safe_position()
         # toolkit.pipette.drip_stop()
 
         if isinstance(src_vessel, StockVial):
+            toolkit.mill.move_to_safe_position()
             capping_sequence(
                 toolkit.mill,
                 Coordinates(src_vessel.x, src_vessel.y, src_vessel.top),
@@ -383,11 +387,11 @@ def _pipette_action(
         dispense_z = (
             ca_dispense_height if ca_dispense_height is not None else dst_vessel.top
         )
-        toolkit.mill.safe_move(
-            dst_vessel.x,
-            dst_vessel.y,
+        _move_pipette(
+            toolkit,
+            dst_vessel,
             dispense_z,
-            tool=Instruments.PIPETTE,
+            cap_held=isinstance(dst_vessel, WasteVial),
         )
         toolkit.pipette.dispense(
             volume_to_dispense=repetition_vol,
@@ -403,6 +407,26 @@ def _pipette_action(
             )
 
 
+def _move_pipette(
+    toolkit: Union[Toolkit, Hardware],
+    vessel: Union[Vial, Well],
+    z: float,
+    cap_held: bool = False,
+) -> None:
+    """Move the pipette to z above a vessel along one planned path.
+
+    Z is only lifted to the mill's safe height before XY travel. While the
+    decapper holds a cap the path travels at the max Z height instead, the
+    clearance move_to_safe_position gives.
+    """
+    move_through_targets(
+        [vessel_target(vessel, Instruments.PIPETTE, z=z)],
+        toolkit.mill,
+        logger,
+        travel_height=toolkit.mill.max_z_height if cap_held else None,
+    )
+
+
 def _forward_pipette_v3(
     volume: float,
     src_vessel: Union[str, Well, StockVial],
@@ -434,6 +458,9 @@ def _forward_pipette_v3(
             )
             raise e
 
+        if _take_predispensed(toolkit, volume, src_vessel, dst_vessel):
+            return 0
+
         selected_source_vessels, source_vessel_volumes = _handle_source_vessels(
             volume=volume,
             src_vessel=src_vessel,
@@ -468,6 +495,136 @@ def _forward_pipette_v3(
     return 0
 
 
+def _take_predispensed(
+    toolkit: Union[Toolkit, Hardware],
+    volume: float,
+    src_vessel: Union[str, Well, StockVial],
+    dst_vessel: Union[Well, WasteVial, StockVial],
+) -> bool:
+    """Check off a transfer that batched_transfer already made into the well"""
+    predispensed = getattr(toolkit, "predispensed", None)
+    if predispensed is None or not isinstance(src_vessel, str):
+        return False
+    if not isinstance(dst_vessel, Well):
+        return False
+    if not predispensed.take(
+        dst_vessel.plate_id, dst_vessel.well_id, src_vessel, volume
+    ):
+        return False
+    logger.info(
+        "%f uL of %s was already dispensed into %s by a lookahead batch",
+        volume,
+        src_vessel,
+        dst_vessel.well_id,
+    )
+    return True
+
+
+def batched_transfer(
+    solution_name: str,
+    dispenses: Sequence[Tuple[Well, float]],
+    toolkit: Toolkit,
+) -> int:
+    """Dispense one stock solution into several wells with a single decap.
+
+    Parameters
+    ----------
+    solution_name : str
+        Name of the stock solution
+    dispenses : Sequence[Tuple[Well, float]]
+        The wells to fill and the volume for each in microliters
+    toolkit : Toolkit
+        Toolkit object for hardware control
+
+    Returns
+    -------
+    int
+        0 on success
+
+    Notes
+    -----
+    _pipette_action decaps and recaps a stock vial for every pipette load. Here
+    the vial is decapped once, each load is aspirated and dispensed with the
+    cap held by the decapper, and the vial is recapped at the end. The loads
+    are visited along one motion planner path rather than a safe_move per
+    stop. Each dispense is recorded in toolkit.predispensed so the matching transfer call
+    in the experiment's protocol is skipped.
+    """
+    dispenses = [(well, volume) for well, volume in dispenses if volume > 0]
+    if not dispenses:
+        return 0
+    total_volume = sum(volume for _, volume in dispenses)
+    src_vessel = solution_selector(solution_name, total_volume)
+    capacity = toolkit.pipette.pipette_tracker.capacity_ul
+    logger.info(
+        "Dispensing %f uL of %s into %d wells with one decap",
+        total_volume,
+        src_vessel.name,
+        len(dispenses),
+    )
+
+    decapping_sequence(
+        toolkit.mill,
+        Coordinates(src_vessel.x, src_vessel.y, src_vessel.top),
+        toolkit.arduino,
+    )
+    # One planned path for the whole group: vial, well, vial, well, ...
+    # Travel stays at the max Z height since the decapper holds the cap.
+    targets = []
+    loads = []  # (well, volume per load, volume owed to the well, last load)
+    for dst_vessel, volume in dispenses:
+        repetitions = math.ceil(volume / capacity)
+        repetition_vol = correction_factor(
+            volume / repetitions, src_vessel.viscosity_cp
+        )
+        for rep in range(repetitions):
+            targets.append(
+                vessel_target(
+                    src_vessel, Instruments.PIPETTE, z=src_vessel.withdrawal_height
+                )
+            )
+            targets.append(vessel_target(dst_vessel, Instruments.PIPETTE))
+            loads.append((dst_vessel, repetition_vol, volume, rep == repetitions - 1))
+
+    arrivals = iter(range(len(targets)))
+
+    def on_arrival(_target) -> None:
+        step = next(arrivals)
+        dst_vessel, repetition_vol, volume, last = loads[step // 2]
+        if step % 2 == 0:
+            toolkit.pipette.aspirate(repetition_vol, solution=src_vessel)
+            time.sleep(3)  # Allow time for aspirate to complete
+            return
+        toolkit.pipette.dispense(
+            volume_to_dispense=repetition_vol,
+            being_infused=src_vessel,
+            infused_into=dst_vessel,
+        )
+        if last and getattr(toolkit, "predispensed", None) is not None:
+            toolkit.predispensed.record(
+                dst_vessel.plate_id, dst_vessel.well_id, solution_name, volume
+            )
+        if step + 1 < len(targets):
+            toolkit.pipette.prime()
+
+    try:
+        toolkit.pipette.prime()
+        move_through_targets(
+            targets,
+            toolkit.mill,
+            logger,
+            on_arrival=on_arrival,
+            travel_height=toolkit.mill.max_z_height,
+        )
+    finally:
+        capping_sequence(
+            toolkit.mill,
+            Coordinates(src_vessel.x, src_vessel.y, src_vessel.top),
+            toolkit.arduino,
+        )
+    return 0
+
+
 # No timer wrapper for this function since its a wrapper itself
 def transfer(
     volume: float,
@@ -14,7 +14,7 @@ from ..exceptions import (
     NoAvailableSolution,
 )
 from ..labware import StockVial, Vial, WasteVial, Well, read_vials
-from ..utilities import solve_vials_ilp
+from ..mixing import solve_vial_mix
 
 TESTING = read_testing_config()
 
@@ -95,7 +95,7 @@ def _handle_source_vessels(
                         "Source concentration not provided and not available in the database"
                     )
 
-        source_vessel_volumes, deviation, volumes_by_position = solve_vials_ilp(
+        source_vessel_volumes, deviation, volumes_by_position = solve_vial_mix(
             vial_concentration_map={
                 vial.position: vial.concentration for vial in selected_source_vessels
             },
@@ -326,7 +326,7 @@ class VesselSelector:
                             "Source concentration not provided and not available in the database"
                         )
 
-            source_vessel_volumes, deviation, volumes_by_position = solve_vials_ilp(
+            source_vessel_volumes, deviation, volumes_by_position = solve_vial_mix(
                 vial_concentration_map={
                     vial.position: vial.concentration
                     for vial in selected_source_vessels
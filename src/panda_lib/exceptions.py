@@ -44,6 +44,17 @@ class OCPError(Exception):
         super().__init__(self.message)
 
 
+class OCPAborted(OCPError):
+    """Raised when a streaming OCP rule stopped the run early"""
+
+    def __init__(self, stage, reason, voltage):
+        super().__init__(stage)
+        self.reason = reason
+        self.voltage = voltage
+        self.message = f"OCP aborted before {stage}: {reason} ({voltage} V)"
+        self.args = (self.message,)
+
+
 class OCPFailure(Exception):
     """Raised when OCP fails"""
 
@@ -187,3 +198,11 @@ class ContactAngleFailure(Exception):
         self.experiment_id = experiment_id
         self.well_id = well_id
         super().__init__(f"{message} (Experiment {experiment_id}, Well {well_id})")
+
+
+class CapHandlingError(ValueError):
+    """Raised when the decapper cannot confirm a cap was picked up or put back"""
+
+    def __init__(self, message="Cap handling failed"):
+        self.message = message
+        super().__init__(self.message)
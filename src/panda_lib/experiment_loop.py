@@ -21,7 +21,13 @@ from typing import Optional, Sequence, Tuple
 
 from sqlalchemy import update
 
-from panda_shared.config.config_tools import read_config, read_testing_config
+from panda_shared.config.config_tools import (
+    get_config_boolean,
+    get_config_float,
+    get_config_int,
+    read_config,
+    read_testing_config,
+)
 
 from .sql_tools.queries import system
 
@@ -33,7 +39,7 @@ from panda_shared.log_tools import (  # noqa: E402
 )
 
 from . import scheduler  # noqa: E402
-from .actions import purge_pipette  # noqa: E402
+from .actions import batched_transfer, purge_pipette  # noqa: E402
 from .exceptions import (  # noqa: E402
     CAFailure,
     CVFailure,
@@ -43,6 +49,7 @@ from .exceptions import (  # noqa: E402
     InstrumentConnectionError,
     InsufficientVolumeError,
     MismatchWellplateTypeError,
+    NoAvailableSolution,
     OCPError,
     ProtocolNotFoundError,
     ShutDownCommand,
@@ -56,11 +63,17 @@ from .experiments import (  # noqa: E402
     select_complete_experiment_information,
     select_experiment_status,
 )
+from .labware.state_store import (  # noqa: E402
+    close_labware_store,
+    flush_labware_state,
+)
 from .labware.vials import StockVial, Vial, WasteVial, read_vials  # noqa: E402
 from .labware.wellplates import Well, Wellplate  # noqa: E402
+from .lookahead import plan_lookahead  # noqa: E402
 from .slack_tools.slackbot_module import SlackBot, share_to_slack  # noqa: E402
 from .sql_tools import (  # noqa: E402
     Experiments,
+    QueueWatcher,
     get_next_experiment_from_queue,
     get_number_of_clear_wells,
     get_number_of_wells,
@@ -70,6 +83,7 @@ from .sql_tools import (  # noqa: E402
 from .toolkit import (  # noqa: E402
     Hardware,
     Labware,
+    Toolkit,
     connect_to_instruments,
     disconnect_from_instruments,
 )
@@ -143,6 +157,8 @@ def experiment_loop_worker(
             apply_log_filter(logger=logger)
             system.set_system_status(SystemState.BUSY)
             stock_vials, _, toolkit.wellplate = _establish_system_state()
+            # Lookahead dispenses into a plate that was swapped out never happen
+            toolkit.predispensed.keep_plate(toolkit.wellplate.id)
 
             while current_experiment is None:
                 ## Ask the scheduler for the next experiment
@@ -159,12 +175,10 @@ def experiment_loop_worker(
 
                     break  # break out of the while new experiment is None loop
 
-                logger.info(
-                    "No new experiments to run...waiting a minute for new experiments"
-                )
+                logger.info("No new experiments to run...waiting for new experiments")
                 controller_slack.send_message(
                     "alert",
-                    "No new experiments to run...waiting a minute for new experiments",
+                    "No new experiments to run...waiting for new experiments",
                 )
                 status_queue.put(
                     (
@@ -241,6 +255,10 @@ def experiment_loop_worker(
                 )
                 # continue  # continue to the next experiment
                 break  # break out of the main while True loop
+            lookahead = get_config_int("OPTIONS", "lookahead", default=0)
+            if lookahead > 0:
+                _run_lookahead(toolkit, lookahead, status_queue, process_id)
+
             # Announce the experiment
             pre_experiment_status_msg = (
                 f"Running experiment {current_experiment.experiment_id}"
@@ -300,16 +318,14 @@ def experiment_loop_worker(
                         f"Protocol {protocol_entry.name} does not have a 'run' or 'main' function"
                     )
 
-            try:
-                protocol_function(
-                    experiment=current_experiment,
-                    toolkit=toolkit,
-                )
-            except Exception as error:
-                logger.error(error)
-                current_experiment.set_status_and_save(ExperimentStatus.ERROR)
-                raise error
+            # A step that failed in an earlier experiment must not abort this one
+            toolkit.drain_executor()
+            _run_protocol(protocol_function, current_experiment, toolkit)
 
+            # Experiment boundary, every labware change must be in the database
+            # and every image on disk
+            flush_labware_state()
+            toolkit.image_writer.drain()
             current_experiment.set_status_and_save(ExperimentStatus.SAVING)
             current_experiment.results.save_results()
             current_experiment.set_status_and_save(ExperimentStatus.COMPLETE)
@@ -428,9 +444,16 @@ def experiment_loop_worker(
 
     finally:
         if current_experiment is not None:
+            if toolkit is not None:
+                toolkit.image_writer.drain()
             current_experiment.results.save_results()
             share_to_slack(current_experiment)
 
+        try:
+            close_labware_store()
+        except Exception as error:  # pylint: disable=broad-except
+            logger.error("Labware state could not be saved: %s", error)
+
         toolkit.mill.rest_electrode()
         if toolkit is not None:
             disconnect_from_instruments(toolkit)
@@ -539,6 +562,8 @@ def sila_experiment_loop_worker(
             exp_logger.info("Beginning experiment %d", exp_obj.experiment_id)
             protocol_function = _fetch_protocol_function(exp_obj.protocol_name)
 
+            # A step that failed in an earlier experiment must not abort this one
+            toolkit.drain_executor()
             try:
                 protocol_function(
                     experiment=exp_obj,
@@ -566,6 +591,7 @@ def sila_experiment_loop_worker(
             finally:
                 if exp_obj is not None:
                     status = select_experiment_status(exp_obj.experiment_id)
+                    toolkit.image_writer.drain()
                     exp_obj.results.save_results()
                     if status == ExperimentStatus.COMPLETE:
                         with SessionLocal() as connection:
@@ -581,6 +607,7 @@ def sila_experiment_loop_worker(
             set_worker_state(SystemState.ERROR)
             if exp_obj is not None:
                 exp_obj.set_status_and_save(ExperimentStatus.ERROR)
+                _forget_predispensed(toolkit, exp_obj)
             exp_logger.exception(error)
             raise error
 
@@ -608,6 +635,85 @@ def sila_experiment_loop_worker(
             set_worker_state(SystemState.IDLE)
 
 
+def _run_lookahead(
+    toolkit: Toolkit,
+    lookahead: int,
+    status_queue: multiprocessing.Queue,
+    process_id: Optional[int] = None,
+):
+    """
+    Plan the shared solution dispenses of the next queued experiments.
+
+    The decap count and time savings are posted to the status queue. When
+    [OPTIONS] lookahead_predispense is set, each shared solution is also
+    dispensed into all of its wells with one decap, and the matching transfers
+    in the protocols are skipped.
+    """
+    experiments = [
+        experiment
+        for experiment, _ in scheduler.read_next_experiments_from_queue(lookahead)
+    ]
+    plan = plan_lookahead(
+        experiments,
+        toolkit.pipette.pipette_tracker.capacity_ul,
+        exclude=[
+            (well_id, solution)
+            for plate_id, well_id, solution in toolkit.predispensed
+            if plate_id == toolkit.wellplate.id
+        ],
+    )
+    if not plan.groups:
+        return
+    logger.info(plan.summary())
+    status_queue.put((process_id, plan.summary()))
+
+    if not get_config_boolean("OPTIONS", "lookahead_predispense", default=False):
+        return
+    for group in plan.groups.values():
+        try:
+            batched_transfer(
+                group.solution,
+                [
+                    (toolkit.wellplate.wells[dispense.well_id], dispense.volume)
+                    for dispense in group.dispenses
+                ],
+                toolkit,
+            )
+        except NoAvailableSolution as error:
+            # No single vial holds the group's total. Nothing was dispensed, so
+            # each protocol pipettes its own share as usual.
+            logger.warning(
+                "Not predispensing %s for experiments %s: %s",
+                group.solution,
+                [dispense.experiment_id for dispense in group.dispenses],
+                error,
+            )
+
+
+def _run_protocol(protocol_function, experiment: ExperimentBase, toolkit: Toolkit):
+    """Run the experiment's protocol, marking the experiment failed if it raises"""
+    try:
+        protocol_function(
+            experiment=experiment,
+            toolkit=toolkit,
+        )
+    except Exception as error:
+        logger.error(error)
+        experiment.set_status_and_save(ExperimentStatus.ERROR)
+        _forget_predispensed(toolkit, experiment)
+        raise error
+
+
+def _forget_predispensed(toolkit: Toolkit, experiment: ExperimentBase):
+    """
+    Drop the lookahead dispenses into a failed experiment's well.
+
+    Its protocol will not reach those transfers. The wells of the other queued
+    experiments do hold their solution and keep their entries.
+    """
+    toolkit.predispensed.forget_well(experiment.plate_id, experiment.well_id)
+
+
 def _attach_well_to_experiment(exp_obj: ExperimentBase, trgt_well: Well):
     trgt_well.well_data.experiment_id = exp_obj.experiment_id
     trgt_well.well_data.project_id = exp_obj.project_id
@@ -935,6 +1041,10 @@ def _monitor_system_status(
 
     """
     first_pause = True
+    watcher = QueueWatcher(
+        poll_interval=get_config_float("OPTIONS", "queue_poll_interval", default=2.0)
+    )
+    fallback = get_config_float("OPTIONS", "idle_poll_fallback", default=60.0)
     while True:
         slack.check_slack_messages("alert")
         # Check the system status
@@ -958,16 +1068,11 @@ def _monitor_system_status(
                 slack.send_message("alert", "PANDA_SDL is paused")
                 status_queue.put((process_id, "idle"))
                 first_pause = False
-            for remaining in range(60, 0, -1):
-                sys.stdout.write("\r")
-                sys.stdout.write(
-                    f"Waiting for new experiments: {remaining} seconds remaining"
-                )
-                sys.stdout.flush()
-                time.sleep(1)
-            sys.stdout.write("\r")
-            sys.stdout.write("Waiting for new experiments: 0 seconds remaining")
+            # Wakes as soon as experiments are queued or the system status
+            # changes, the timeout is only a fallback for missed changes
+            sys.stdout.write("\rWaiting for new experiments")
             sys.stdout.flush()
+            watcher.wait(timeout=fallback)
             sys.stdout.write("\n")
             continue
 
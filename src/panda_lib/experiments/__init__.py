@@ -9,6 +9,8 @@ from .experiment_types import (
 )
 from .results import ExperimentResult, ExperimentResultsRecord
 from .sql_functions import (
+    experiment_parameter_rows,
+    experiment_rows,
     insert_experiment,
     insert_experiment_parameters,
     insert_experiments,
@@ -64,6 +66,8 @@ __all__ = [
     "ExperimentResultsRecord",
     "ExperimentBase",
     "ExperimentParameterRecord",
+    "experiment_parameter_rows",
+    "experiment_rows",
     "insert_experiment",
     "insert_experiment_parameters",
     "insert_experiments",
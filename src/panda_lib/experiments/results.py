@@ -2,11 +2,13 @@
 
 from dataclasses import field
 from pathlib import Path
-from typing import List, Tuple, Union
+from typing import Dict, List, Tuple, Union
 
+import pandas as pd
 from pydantic import ConfigDict, RootModel
 from pydantic.dataclasses import dataclass
 
+from panda_lib.hardware.potentiostat_data import load_echem_data
 from panda_lib.sql_tools import (
     ExperimentResults,
 )
@@ -63,6 +65,16 @@ class ExperimentResultsRecord:
         return [self.experiment_id, self.result_type, self.result_value, self.context]
 
 
+# Data layout of the files held in each ExperimentResult file field
+DATA_FILE_KINDS: Dict[str, str] = {
+    "ocp_file": "OCP",
+    "ocp_ca_file": "OCP",
+    "ocp_cv_file": "OCP",
+    "ca_data_file": "CA",
+    "cv_data_file": "CV",
+}
+
+
 @dataclass(config=ConfigDict(validate_assignment=True))
 class ExperimentResult:
     """Define the data that is generated by an experiment"""
@@ -158,6 +170,31 @@ class ExperimentResult:
             # Save the contents of the file (it will be text) into the data list as one index of the list
             self.cv_data.append((f.read(), context))
 
+    def load_data(
+        self, file_field: str, context: str = None, index: int = -1
+    ) -> pd.DataFrame:
+        """
+        Load one of the recorded data files as a float64 DataFrame.
+
+        Args:
+            file_field: One of the file fields, e.g. "ocp_file" or "cv_data_file"
+            context: Only consider files recorded with this context
+            index: Which of the matching files, the last one by default
+
+        Returns:
+            The file's data, read from its columnar sidecar when there is one
+        """
+        if file_field not in DATA_FILE_KINDS:
+            raise ValueError(f"{file_field} is not a data file field")
+        files = [
+            file
+            for file, file_context in getattr(self, file_field)
+            if context is None or file_context == context
+        ]
+        if not files:
+            raise ValueError(f"No {file_field} recorded for context {context}")
+        return load_echem_data(files[index], DATA_FILE_KINDS[file_field])
+
     def append_image_file(self, file: Path, context: str = None):
         """Append the image file"""
         self.images.append((file, context))
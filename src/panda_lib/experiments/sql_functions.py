@@ -2,7 +2,7 @@ import json
 from datetime import datetime
 from typing import List, Union, get_type_hints
 
-from sqlalchemy import select
+from sqlalchemy import insert, select
 
 from panda_lib.sql_tools import (
     ExperimentParameters,
@@ -177,6 +177,40 @@ def insert_experiment(experiment: ExperimentBase) -> None:
     insert_experiments([experiment])
 
 
+def experiment_rows(
+    experiments: List[ExperimentBase], created: datetime = None
+) -> List[dict]:
+    """
+    The experiments table rows for a list of experiments.
+
+    Args:
+        experiments (List[ExperimentBase]): The experiments.
+        created (datetime): The created time for every row, now if not given.
+
+    Returns:
+        List[dict]: One row per experiment, keyed by column name.
+    """
+    if created is None:
+        created = datetime.now().replace(microsecond=0)
+    return [
+        {
+            "experiment_id": experiment.experiment_id,
+            "project_id": experiment.project_id,
+            "project_campaign_id": experiment.project_campaign_id,
+            "well_type": experiment.wellplate_type_id,
+            "protocol_id": str(experiment.protocol_name),
+            "priority": experiment.priority,
+            "filename": experiment.filename,
+            "needs_analysis": experiment.needs_analysis,
+            "analysis_id": experiment.analysis_id,
+            "panda_version": experiment.panda_version,
+            "panda_unit_id": experiment.panda_unit_id,
+            "created": created,
+        }
+        for experiment in experiments
+    ]
+
+
 def insert_experiments(experiments: List[ExperimentBase]) -> None:
     """
     Insert a list of experiments into the experiments table.
@@ -184,43 +218,10 @@ def insert_experiments(experiments: List[ExperimentBase]) -> None:
     Args:
         experiments (List[ExperimentBase]): The experiments to insert.
     """
-    parameters = []
-    for experiment in experiments:
-        parameters.append(
-            (
-                experiment.experiment_id,
-                experiment.project_id,
-                experiment.project_campaign_id,
-                experiment.wellplate_type_id,
-                str(experiment.protocol_name),
-                experiment.priority,
-                experiment.filename,
-                experiment.needs_analysis,
-                experiment.analysis_id,
-                experiment.panda_version,
-                experiment.panda_unit_id,
-                datetime.now().isoformat(timespec="seconds"),
-            )
-        )
-
+    if not experiments:
+        return
     with SessionLocal() as session:
-        for parameter in parameters:
-            session.add(
-                Experiments(
-                    experiment_id=parameter[0],
-                    project_id=parameter[1],
-                    project_campaign_id=parameter[2],
-                    well_type=parameter[3],
-                    protocol_id=parameter[4],
-                    priority=parameter[5],
-                    filename=parameter[6],
-                    needs_analysis=parameter[7],
-                    analysis_id=parameter[8],
-                    panda_version=parameter[9],
-                    panda_unit_id=parameter[10],
-                    created=datetime.strptime(parameter[11], "%Y-%m-%dT%H:%M:%S"),
-                )
-            )
+        session.execute(insert(Experiments), experiment_rows(experiments))
         session.commit()
 
 
@@ -234,42 +235,54 @@ def insert_experiment_parameters(experiment: ExperimentBase) -> None:
     insert_experiments_parameters([experiment])
 
 
-def insert_experiments_parameters(experiments: List[ExperimentBase]) -> None:
+def experiment_parameter_rows(
+    experiments: List[ExperimentBase], created: datetime = None
+) -> List[dict]:
     """
-    Insert the experiment parameters into the experiment_parameters table.
+    The experiment_parameters table rows for a list of experiments.
 
     Args:
-        experiments (List[ExperimentBase]): The experiments to insert.
+        experiments (List[ExperimentBase]): The experiments.
+        created (datetime): The created time for every row, now if not given.
+
+    Returns:
+        List[dict]: One row per parameter, keyed by column name.
     """
-    parameters_to_insert = []  # this will be a list of tuples of the parameters to insert
+    if created is None:
+        created = datetime.now().replace(microsecond=0)
+    rows = []
     for experiment in experiments:
         experiment_parameters: list[ExperimentParameterRecord] = (
             experiment.generate_parameter_list()
         )
         for parameter in experiment_parameters:
-            parameters_to_insert.append(
-                (
-                    experiment.experiment_id,
-                    parameter.parameter_name,
-                    (
+            rows.append(
+                {
+                    "experiment_id": experiment.experiment_id,
+                    "parameter_name": parameter.parameter_name,
+                    "parameter_value": (
                         json.dumps(parameter.parameter_value, default=str)
                         if isinstance(parameter.parameter_value, dict)
                         else parameter.parameter_value
                     ),
-                    datetime.now().isoformat(timespec="seconds"),
-                )
+                    "created": created,
+                }
             )
+    return rows
+
+
+def insert_experiments_parameters(experiments: List[ExperimentBase]) -> None:
+    """
+    Insert the experiment parameters into the experiment_parameters table.
 
+    Args:
+        experiments (List[ExperimentBase]): The experiments to insert.
+    """
+    rows = experiment_parameter_rows(experiments)
+    if not rows:
+        return
     with SessionLocal() as session:
-        for parameter in parameters_to_insert:
-            session.add(
-                ExperimentParameters(
-                    experiment_id=parameter[0],
-                    parameter_name=parameter[1],
-                    parameter_value=parameter[2],
-                    created=datetime.strptime(parameter[3], "%Y-%m-%dT%H:%M:%S"),
-                )
-            )
+        session.execute(insert(ExperimentParameters), rows)
         session.commit()
 
 
@@ -1,11 +1,15 @@
 import glob
 import threading
 import asyncio
+import concurrent.futures
 import enum
+import itertools
 import logging
 import os
 import queue
+import re
 import time
+from collections import OrderedDict
 from typing import Any, Dict, Optional
 
 import serial
@@ -76,6 +80,32 @@ class PawduinoReturnCodes(enum.Enum):
     RESP_PIPETTE_ASPIRATE_REL = "OK:Pipette aspirated relative"
 
 
+# Pipelined responses are prefixed with the sequence ID of their command, e.g. "#12:OK:..."
+sequence_tag_pattern = re.compile(r"^#(\d+):(.*)$")
+
+# Seconds a pipelined command may wait for its response, matching the blocking send
+DEFAULT_COMMAND_TIMEOUT = 120.0
+
+# The subsystem each command drives; commands on different lanes can overlap
+COMMAND_LANES = {
+    PawduinoFunctions.CMD_HELLO: "system",
+    PawduinoFunctions.CMD_EMAG_ON: "magnet",
+    PawduinoFunctions.CMD_EMAG_OFF: "magnet",
+    PawduinoFunctions.CMD_LINE_BREAK: "sensor",
+    PawduinoFunctions.CMD_LINE_TEST: "sensor",
+    **{
+        function: "lights"
+        for function in PawduinoFunctions
+        if function.name.startswith(("CMD_WHITE", "CMD_CONTACT"))
+    },
+    **{
+        function: "pipette"
+        for function in PawduinoFunctions
+        if function.name.startswith(("CMD_PIPETTE", "CMD_MOVE"))
+    },
+}
+
+
 class ArduinoException(Exception):
     """Base class for Arduino communication errors."""
 
@@ -152,6 +182,9 @@ class ArduinoLink:
     - start_monitoring (starts a background task to monitor the Arduino messages)
     - stop_monitoring (stops the background task to monitor the Arduino messages)
     - get_next_message (gets the next message from the event queue) *available asynchronously
+    - start_pipeline (sends commands without waiting for the previous response)
+    - stop_pipeline (returns to one command at a time)
+    - submit (sends a command and returns a future for its response)
 
     Pipette Specific Methods:
     - home (homes the pipette)
@@ -191,9 +224,18 @@ class ArduinoLink:
         self._event_queue: asyncio.Queue = asyncio.Queue()
         self.pipette_active = True  # Assuming pipette is active by default
         self._tx_lock = threading.Lock()
+        self._init_pipeline()
         self.logger = logging.getLogger("panda")
         self.connect()
 
+    def _init_pipeline(self):
+        self.sequence_tags = False
+        self._pipeline_running = False
+        self._pipeline_reader: Optional[threading.Thread] = None
+        self._pending: "OrderedDict[int, Dict[str, Any]]" = OrderedDict()
+        self._pending_lock = threading.Lock()
+        self._sequence = itertools.count(1)
+
     def __enter__(self):
         return self
 
@@ -407,6 +449,7 @@ class ArduinoLink:
 
     def close(self):
         """Close the connection to the Arduino."""
+        self.stop_pipeline()
         if self._monitor_task and not self._monitor_task.done():
             self._monitor_task.cancel()
         if self.ser and self.ser.is_open:
@@ -563,6 +606,11 @@ class ArduinoLink:
                 f"send expects a PawduinoFunctions member, got {cmd_enum_member!r}"
             )
 
+        if self.pipeline_running:
+            return self._wait_for_pipelined(
+                self.submit(cmd_enum_member, *args), DEFAULT_COMMAND_TIMEOUT
+            )
+
         with self._send_lock:
             return self._send_internal(cmd_enum_member, *args)
 
@@ -668,6 +716,17 @@ class ArduinoLink:
         properly formatted response (starting with OK: or ERR:) is received,
         or until the total timeout of 60 seconds is reached.
         """
+        if self.pipeline_running:
+            future = self.submit(cmd_enum_member, *args)
+            try:
+                return await asyncio.wait_for(
+                    asyncio.wrap_future(future), DEFAULT_COMMAND_TIMEOUT
+                )
+            except asyncio.TimeoutError:
+                raise ArduinoTimeoutError(
+                    f"Timeout waiting for pipelined response to {cmd_enum_member.name}"
+                ) from None
+
         if (
             not self.connected
             or not self.configured
@@ -790,6 +849,168 @@ class ArduinoLink:
             f"Async: Timeout after {elapsed:.1f} seconds waiting for properly formatted response for: {command_to_send.strip()}"
         )
 
+    @property
+    def pipeline_running(self) -> bool:
+        """True while commands are pipelined through the background reader"""
+        return self._pipeline_running
+
+    def start_pipeline(self, sequence_tags: bool = False):
+        """
+        Pipeline commands instead of holding the port for each write/read round-trip.
+
+        A single reader thread owns the port and hands each OK:/ERR: line to the
+        future of the command it answers, so callers on different threads (or
+        tasks) can have several commands in flight, e.g. a pipette prime while
+        the lights change.
+
+        Args:
+            sequence_tags: Prefix each command with "#<seq>:" and match responses
+                by the "#<seq>:" the firmware echoes back, which allows the
+                firmware to answer out of order. Without tags, responses are
+                matched to commands in the order they were sent. Off by default
+                as the shipped firmware does not echo the tags yet.
+        """
+        if self.pipeline_running:
+            return
+        if not self.connected or not self.ser or not self.ser.is_open:
+            raise ArduinoConnectionError("Not connected to Arduino.")
+        self.sequence_tags = sequence_tags
+        self._pipeline_running = True
+        self._pipeline_reader = threading.Thread(
+            target=self._pipeline_read_loop, name="arduino-pipeline", daemon=True
+        )
+        self._pipeline_reader.start()
+        self.logger.info(
+            "Arduino command pipeline started (sequence tags: %s)", sequence_tags
+        )
+
+    def stop_pipeline(self, timeout: float = 2.0):
+        """Stop the reader thread and fail any command still waiting for a response"""
+        if not self._pipeline_running:
+            return
+        self._pipeline_running = False
+        cancel_read = getattr(self.ser, "cancel_read", None)
+        if cancel_read is not None:
+            try:
+                cancel_read()
+            except Exception:
+                pass
+        reader = self._pipeline_reader
+        if reader is not None and reader is not threading.current_thread():
+            reader.join(timeout)
+        self._pipeline_reader = None
+        self._fail_pending(ArduinoConnectionError("Arduino command pipeline stopped"))
+        self.logger.info("Arduino command pipeline stopped")
+
+    def submit(
+        self, cmd_enum_member: PawduinoFunctions, *args
+    ) -> "concurrent.futures.Future[Dict[str, Any]]":
+        """
+        Send a command through the pipeline without waiting for its response.
+
+        Returns:
+            Future: Resolves to the same response dictionary as send(), with the
+            command's "sequence" added.
+        """
+        if not isinstance(cmd_enum_member, PawduinoFunctions):
+            raise ArduinoCommandError(
+                f"submit expects a PawduinoFunctions member, got {cmd_enum_member!r}"
+            )
+        if not self.pipeline_running:
+            raise ArduinoConnectionError("The Arduino command pipeline is not running")
+
+        command = ",".join([cmd_enum_member.value, *map(str, args)])
+        future: "concurrent.futures.Future[Dict[str, Any]]" = (
+            concurrent.futures.Future()
+        )
+        if cmd_enum_member in {
+            PawduinoFunctions.CMD_EMAG_ON,
+            PawduinoFunctions.CMD_EMAG_OFF,
+        }:
+            time.sleep(0.05)  # 50 ms settle, as in the blocking send
+
+        with self._tx_lock:
+            sequence = next(self._sequence)
+            line = f"#{sequence}:{command}" if self.sequence_tags else command
+            with self._pending_lock:
+                self._pending[sequence] = {"command": command, "future": future}
+            self.logger.debug("Pipelined to Arduino: %s", line)
+            try:
+                self.ser.write((line + "\n").encode())
+                self.ser.flush()
+            except (serial.SerialException, OSError, IOError) as e:
+                with self._pending_lock:
+                    self._pending.pop(sequence, None)
+                raise ArduinoConnectionError(
+                    f"Serial error during send for {cmd_enum_member.name}: {e}"
+                ) from e
+        return future
+
+    def _wait_for_pipelined(
+        self, future: "concurrent.futures.Future[Dict[str, Any]]", timeout: float
+    ) -> Dict[str, Any]:
+        try:
+            return future.result(timeout)
+        except concurrent.futures.TimeoutError:
+            # The entry stays pending so a late response is still consumed in order
+            raise ArduinoTimeoutError(
+                f"Timeout after {timeout:.1f}s waiting for a pipelined response"
+            ) from None
+
+    def _pipeline_read_loop(self):
+        while self._pipeline_running:
+            try:
+                raw = self.ser.readline()
+            except (serial.SerialException, OSError, IOError) as e:
+                if self._pipeline_running:
+                    self.logger.error("Arduino pipeline read failed: %s", e)
+                    self._pipeline_running = False
+                    self._fail_pending(
+                        ArduinoConnectionError(f"Serial error in pipeline: {e}")
+                    )
+                return
+            if not raw:
+                continue
+            self._dispatch_pipelined(raw.decode(errors="replace").strip())
+
+    def _dispatch_pipelined(self, response_str: str):
+        """Resolve the future of the command a response line belongs to"""
+        self.logger.debug("Pipelined response: %s", response_str)
+        match = sequence_tag_pattern.match(response_str)
+        with self._pending_lock:
+            if match:
+                sequence = int(match.group(1))
+                response_str = match.group(2)
+                entry = self._pending.pop(sequence, None)
+            elif response_str.startswith(("OK:", "ERR:")) and self._pending:
+                sequence, entry = self._pending.popitem(last=False)
+            else:
+                entry = None
+
+        if not response_str.startswith(("OK:", "ERR:")):
+            self.logger.debug("Ignoring non-protocol line: %s", response_str)
+            return
+        if entry is None:
+            self.logger.warning("Response with no waiting command: %s", response_str)
+            return
+
+        result = self._process_response(response_str, entry["command"])
+        result["sequence"] = sequence
+        try:
+            entry["future"].set_result(result)
+        except concurrent.futures.InvalidStateError:
+            self.logger.debug("Dropping response for cancelled command %s", sequence)
+
+    def _fail_pending(self, error: Exception):
+        with self._pending_lock:
+            entries = list(self._pending.values())
+            self._pending.clear()
+        for entry in entries:
+            try:
+                entry["future"].set_exception(error)
+            except concurrent.futures.InvalidStateError:
+                pass
+
     async def start_monitoring(self):
         """Start monitoring Arduino messages in the background"""
         if self._running:
@@ -1375,9 +1596,15 @@ class MockArduinoLink(ArduinoLink):
 
     The class provides the following methods:
     - send (sends a message to the Arduino and waits for a response)
+    - start_pipeline / stop_pipeline / submit (same semantics as ArduinoLink)
 
     The class provides the following attributes:
     - arduinoQueue (a queue to store messages from the Arduino)
+    - command_delays (simulated seconds each command takes, for benchmarking)
+
+    Without a pipeline, commands run one at a time like the blocking ArduinoLink.
+    With a pipeline, each lane in COMMAND_LANES runs its commands in order while
+    different lanes overlap, as firmware answering tagged commands would.
     """
 
     arduinoQueue = queue.Queue()
@@ -1388,6 +1615,7 @@ class MockArduinoLink(ArduinoLink):
         baud_rate: int = 115200,
         read_timeout: float = 2.0,
         max_retries: int = 3,
+        command_delays: Optional[Dict[PawduinoFunctions, float]] = None,
     ):
         self.ser: Serial = None
         self.port_address: Optional[str] = port_address
@@ -1400,6 +1628,13 @@ class MockArduinoLink(ArduinoLink):
         self._running = False
         self._event_queue: asyncio.Queue = asyncio.Queue()
         self.pipette_active = True  # Assuming pipette is active by default
+        self.command_delays: Dict[PawduinoFunctions, float] = dict(
+            command_delays or {}
+        )
+        self._send_lock = threading.Lock()
+        self._tx_lock = threading.Lock()
+        self._init_pipeline()
+        self._lanes: Dict[str, concurrent.futures.ThreadPoolExecutor] = {}
         self.logger = logging.getLogger("panda")
         self.connect()
 
@@ -1409,12 +1644,66 @@ class MockArduinoLink(ArduinoLink):
         self.logger.info("MockArduinoLink connect() called - already mock connected.")
 
     def close(self):
+        self.stop_pipeline()
         self.connected = False
         self.configured = False
         self.logger.info("MockArduinoLink close() called.")
 
+    def start_pipeline(self, sequence_tags: bool = False):
+        """Start pipelining commands, one worker per command lane"""
+        if self.pipeline_running:
+            return
+        self.sequence_tags = sequence_tags
+        self._pipeline_running = True
+
+    def stop_pipeline(self, timeout: float = 2.0):
+        """Wait for in-flight commands and return to one command at a time"""
+        if not self._pipeline_running:
+            return
+        self._pipeline_running = False
+        for lane in self._lanes.values():
+            lane.shutdown(wait=True)
+        self._lanes.clear()
+
+    def submit(
+        self, cmd_enum_member: PawduinoFunctions, *args
+    ) -> "concurrent.futures.Future[Dict[str, Any]]":
+        """Queue a command on its lane and return a future for its response"""
+        if not self.pipeline_running:
+            raise ArduinoConnectionError("The Arduino command pipeline is not running")
+        with self._tx_lock:
+            sequence = next(self._sequence)
+            lane_name = COMMAND_LANES.get(cmd_enum_member, "system")
+            lane = self._lanes.get(lane_name)
+            if lane is None:
+                lane = concurrent.futures.ThreadPoolExecutor(
+                    max_workers=1, thread_name_prefix=f"mock-arduino-{lane_name}"
+                )
+                self._lanes[lane_name] = lane
+
+        def run() -> Dict[str, Any]:
+            response = self._run_command(cmd_enum_member, *args)
+            response["sequence"] = sequence
+            return response
+
+        return lane.submit(run)
+
     def send(self, cmd_enum_member: PawduinoFunctions, *args) -> Dict[str, Any]:
         """Mock send method. Returns a predefined response based on the command."""
+        if self.pipeline_running:
+            return self._wait_for_pipelined(
+                self.submit(cmd_enum_member, *args), DEFAULT_COMMAND_TIMEOUT
+            )
+        with self._send_lock:
+            return self._run_command(cmd_enum_member, *args)
+
+    def _run_command(
+        self, cmd_enum_member: PawduinoFunctions, *args
+    ) -> Dict[str, Any]:
+        """Simulate the command's duration and return its predefined response"""
+        delay = self.command_delays.get(cmd_enum_member, 0.0)
+        if delay:
+            time.sleep(delay)
         cmd_value = cmd_enum_member.value
         self.logger.debug("Mock Sending: %s with args %s", cmd_enum_member.name, args)
 
@@ -1487,6 +1776,8 @@ class MockArduinoLink(ArduinoLink):
         self, cmd_enum_member: PawduinoFunctions, *args
     ) -> Dict[str, Any]:
         """Mock async send method"""
+        if self.pipeline_running:
+            return await asyncio.wrap_future(self.submit(cmd_enum_member, *args))
         return self.send(cmd_enum_member, *args)
 
     async def async_line_break(self) -> Optional[bool]:
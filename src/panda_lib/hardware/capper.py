@@ -0,0 +1,224 @@
+"""
+Closed-loop cap handling for the decapper.
+
+Decapping and capping used to wait fixed times between each step. CapHandler
+instead moves on as soon as each step is confirmed:
+
+- mill moves return once GRBL reports Idle, so no settle time is added;
+- the electromagnet is switched with the Arduino's acknowledged command and
+  not followed by a fixed pause;
+- the line break sensor is polled until it reads the expected state, bounded
+  by `sensor_timeout`, before an attempt counts as failed.
+
+CapStateCache tracks which vials are uncapped and whose cap the decapper is
+holding, so a repeated decap of the same vial is skipped and a decap of another
+vial with a cap still on the magnet is refused.
+"""
+
+import logging
+import time
+from typing import List, Optional, Tuple
+
+from ..exceptions import CapHandlingError
+from .arduino_interface import PawduinoFunctions
+
+logger = logging.getLogger("panda")
+
+CAP_TOOL = "decapper"
+# Seconds for the electromagnet field to collapse before the decapper lifts away
+EMAG_RELEASE_SECONDS = 0.2
+# Capping retries approach the vial offset in Y to reseat a cap that caught the rim
+CAP_RETRY_Y_OFFSET = 5.0
+
+
+class CapStateCache:
+    """
+    Which vials are uncapped and whose cap the decapper holds.
+
+    Vials are keyed by their x, y position rounded to 0.1 mm.
+    """
+
+    def __init__(self):
+        self._open = set()
+        self.held: Optional[Tuple[float, float]] = None
+
+    @staticmethod
+    def key(coords) -> Tuple[float, float]:
+        return (round(float(coords.x), 1), round(float(coords.y), 1))
+
+    def is_open(self, coords) -> bool:
+        return self.key(coords) in self._open
+
+    def holds_cap_of(self, coords) -> bool:
+        return self.held == self.key(coords)
+
+    def mark_open(self, coords) -> None:
+        """The vial's cap is now on the decapper"""
+        self._open.add(self.key(coords))
+        self.held = self.key(coords)
+
+    def mark_closed(self, coords) -> None:
+        """The vial's cap is back on the vial"""
+        key = self.key(coords)
+        self._open.discard(key)
+        if self.held == key:
+            self.held = None
+
+    def open_vials(self) -> List[Tuple[float, float]]:
+        return sorted(self._open)
+
+    def clear(self) -> None:
+        self._open.clear()
+        self.held = None
+
+
+class CapHandler:
+    """
+    Decaps and caps vials, advancing on mill idle, magnet ack and the sensor.
+
+    Args:
+        mill: The mill, its moves return once the mill is idle
+        ard_link: The ArduinoLink driving the electromagnet and line break sensor
+        sensor: Whether the unit has a line break sensor. Without one every
+            attempt is assumed to succeed.
+        attempts: Tries before CapHandlingError is raised
+        sensor_timeout: Seconds to wait for the sensor to read the expected state
+        poll_interval: Seconds between sensor reads
+        cache: Cap state shared across handlers, a new one by default
+    """
+
+    def __init__(
+        self,
+        mill,
+        ard_link,
+        sensor: bool = True,
+        attempts: int = 3,
+        sensor_timeout: float = 1.5,
+        poll_interval: float = 0.02,
+        cache: Optional[CapStateCache] = None,
+        log: logging.Logger = logger,
+    ):
+        self.mill = mill
+        self.ard_link = ard_link
+        self.sensor = sensor
+        self.attempts = max(attempts, 1)
+        self.sensor_timeout = sensor_timeout
+        self.poll_interval = poll_interval
+        self.cache = cache if cache is not None else CapStateCache()
+        self.log = log
+
+    def cap_present(self) -> Optional[bool]:
+        """Read the sensor, True if a cap is on the decapper, None if unknown"""
+        if not self.sensor:
+            return None
+        return self.ard_link.line_break()
+
+    def wait_for_cap(self, present: bool, timeout: Optional[float] = None) -> bool:
+        """Poll the sensor until it reads `present`, False on timeout"""
+        if not self.sensor:
+            return True  # Assume success for legacy units
+        timeout = self.sensor_timeout if timeout is None else timeout
+        deadline = time.monotonic() + timeout
+        while True:
+            if self.ard_link.line_break() is present:
+                return True
+            if time.monotonic() >= deadline:
+                return False
+            time.sleep(self.poll_interval)
+
+    def _magnet(self, on: bool) -> bool:
+        """Switch the electromagnet, True once the Arduino acknowledges it"""
+        command = (
+            PawduinoFunctions.CMD_EMAG_ON if on else PawduinoFunctions.CMD_EMAG_OFF
+        )
+        response = self.ard_link.send(command)
+        if not response.get("success", False):
+            self.log.warning(
+                "Electromagnet %s not acknowledged: %s",
+                "on" if on else "off",
+                response.get("error_message"),
+            )
+            return False
+        return True
+
+    def decap(self, coords) -> int:
+        """
+        Lift the cap off the vial at coords.
+
+        Returns:
+            int: Attempts used, 0 if the decapper already held this vial's cap
+
+        Raises:
+            CapHandlingError: If the cap is not detected after all attempts, or
+                the decapper still holds the cap of another vial
+        """
+        if self.cache.held is not None:
+            if self.cap_present() is False:
+                self.log.warning("Decapper cap state was stale, no cap is held")
+                self.cache.held = None
+            elif self.cache.holds_cap_of(coords):
+                self.log.debug("Vial at %s is already open", self.cache.key(coords))
+                return 0
+            elif self.sensor:
+                raise CapHandlingError(
+                    f"Decapper still holds the cap of the vial at {self.cache.held}"
+                )
+
+        start = time.monotonic()
+        for attempt in range(1, self.attempts + 1):
+            self.mill.safe_move(coords.x, coords.y, coords.z, tool=CAP_TOOL)
+            if self._magnet(True):
+                self.mill.move_to_position(coords.x, coords.y, 0, tool=CAP_TOOL)
+                if self.wait_for_cap(True):
+                    self.cache.mark_open(coords)
+                    self.log.debug(
+                        "Decapped %s in %.2f s (attempt %d)",
+                        self.cache.key(coords),
+                        time.monotonic() - start,
+                        attempt,
+                    )
+                    return attempt
+            self.log.warning(
+                "Cap not detected, attempt %d of %d", attempt, self.attempts
+            )
+        raise CapHandlingError("Cap still not detected.")
+
+    def cap(self, coords) -> int:
+        """
+        Put the held cap back on the vial at coords.
+
+        Returns:
+            int: Attempts used
+
+        Raises:
+            CapHandlingError: If the cap is still detected after all attempts
+        """
+        if self.cache.held is not None and not self.cache.holds_cap_of(coords):
+            self.log.warning(
+                "Capping %s with the cap of the vial at %s",
+                self.cache.key(coords),
+                self.cache.held,
+            )
+
+        start = time.monotonic()
+        for attempt in range(1, self.attempts + 1):
+            self.mill.safe_move(coords.x, coords.y, coords.z, tool=CAP_TOOL)
+            if attempt > 1:
+                self.mill.move_to_position(
+                    coords.x, coords.y + CAP_RETRY_Y_OFFSET, coords.z, tool=CAP_TOOL
+                )
+            if self._magnet(False):
+                time.sleep(EMAG_RELEASE_SECONDS)
+                self.mill.move_to_position(coords.x, coords.y, 0, tool=CAP_TOOL)
+                if self.wait_for_cap(False):
+                    self.cache.mark_closed(coords)
+                    self.cache.held = None
+                    self.log.debug(
+                        "Capped %s in %.2f s (attempt %d)",
+                        self.cache.key(coords),
+                        time.monotonic() - start,
+                        attempt,
+                    )
+                    return attempt
+            self.log.warning("Cap detected, attempt %d of %d", attempt, self.attempts)
+        raise CapHandlingError("Cap still detected after capping.")
@@ -8,6 +8,9 @@ from typing import Tuple
 import pandas as pd
 import inspect
 
+from ..ocp_monitor import SampleCallback
+from ..potentiostat_data import load_echem_data, write_columnar
+
 global COMPLETE_FILE_NAME
 logger = logging.getLogger("panda")
 
@@ -224,8 +227,18 @@ def validate_file_name(file_name: str) -> str:
 # =====================
 
 
-def OCP(params: potentiostat_ocp_parameters):
-    """Run OCP experiment on EmStat"""
+# hardpotato runs a technique to completion, so streaming rules see a short
+# probe run before the full one
+OCP_PROBE_SECONDS = 1.0
+
+
+def OCP(params: potentiostat_ocp_parameters, on_sample: SampleCallback = None):
+    """Run OCP experiment on EmStat
+
+    With on_sample, a probe of OCP_PROBE_SECONDS is run first and its samples
+    streamed to on_sample. If it returns True the probe data is kept as the
+    run's data and the full OCP is skipped.
+    """
     model = "emstat4_lr"
     folder = read_data_dir()
     global COMPLETE_FILE_NAME
@@ -235,6 +248,20 @@ def OCP(params: potentiostat_ocp_parameters):
         raise RuntimeError("Could not connect to Pstat")
     COMPLETE_FILE_NAME = validate_file_name(COMPLETE_FILE_NAME)
     file_stem = pathlib.Path(COMPLETE_FILE_NAME).stem
+    if on_sample is not None and params.ttot > OCP_PROBE_SECONDS:
+        probe = hp.potentiostat.OCP(
+            OCP_PROBE_SECONDS, params.dt, file_stem, params.header
+        )
+        probe.run()
+        samples = load_echem_data(
+            pathlib.Path(folder) / f"{file_stem}.txt",
+            "OCP",
+            columns=["Time", "Vf"],
+            write_sidecar=False,
+        )
+        for sample_time, voltage in samples.itertuples(index=False):
+            if on_sample(sample_time, voltage):
+                return probe.data
     ocp = hp.potentiostat.OCP(params.ttot, params.dt, file_stem, params.header)
     ocp.run()
     # save_in_gamry_format(ocp.data, COMPLETE_FILE_NAME, params.header)
@@ -386,28 +413,35 @@ def save_in_gamry_format(data, file_name: str, header: str):
     if not isinstance(data, list) or len(data) == 0:
         raise ValueError("Data must be a non-empty list of dictionaries")
 
+    keys = ["t", "E", "U", "I", "Vsig", "Ach", "Overload", "StopTest", "Cycle", "Ach2"]
+    # Gamry names for the same columns
+    columns = [
+        "Time",
+        "Vf",
+        "Vu",
+        "Im",
+        "Vsig",
+        "Ach",
+        "Overload",
+        "StopTest",
+        "Cycle",
+        "Ach2",
+    ]
+
     with open(file_name, "w") as f:
         # Write header row (optional)
         # f.write(f"{header}\n")
 
         for row in data:
-            line = ",".join(
-                str(row.get(key, "N/A"))
-                for key in [
-                    "t",
-                    "E",
-                    "U",
-                    "I",
-                    "Vsig",
-                    "Ach",
-                    "Overload",
-                    "StopTest",
-                    "Cycle",
-                    "Ach2",
-                ]
-            )
+            line = ",".join(str(row.get(key, "N/A")) for key in keys)
             f.write(line + "\n")
 
+    # Columnar copy of the same rows, missing values become NaN
+    write_columnar(
+        file_name,
+        pd.DataFrame([[row.get(key) for key in keys] for row in data], columns=columns),
+    )
+
 
 # =====================
 # Helper functions
@@ -464,24 +498,9 @@ def activecheck():
 def check_vf_range(filename) -> Tuple[bool, float]:
     """Check if the Vf value is in the valid range for an echem experiment."""
     try:
-        # Read with a tolerant parser:
-        # - treat '#' as comments
-        # - allow commas OR whitespace as separators
-        # - force exactly two columns (Time, Vf)
-        ocp_data = pd.read_csv(
-            filename,
-            comment="#",
-            header=None,
-            names=["Time", "Vf"],
-            usecols=[0, 1],
-            sep=r"\s*,\s*|\s+",
-            engine="python",
-            skip_blank_lines=True,
-        )
-
-        # Ensure numeric; drop any rows that failed to parse
-        ocp_data["Time"] = pd.to_numeric(ocp_data["Time"], errors="coerce")
-        ocp_data["Vf"] = pd.to_numeric(ocp_data["Vf"], errors="coerce")
+        # The loader treats '#' as comments, allows commas OR whitespace as
+        # separators and drops rows whose values do not parse
+        ocp_data = load_echem_data(filename, "OCP", columns=["Time", "Vf"])
         ocp_data = ocp_data.dropna(subset=["Time", "Vf"])
 
         if ocp_data.empty:
@@ -65,9 +65,14 @@ def validate_file_name(file_name: str) -> str:
 # =====================
 
 
-def OCP(params: potentiostat_ocp_parameters):
+def OCP(params: potentiostat_ocp_parameters, on_sample=None):
     logging.info(f"[MOCK] Running OCP with params: {params}")
     data = DummyData(params.ttot, params.dt)
+    if on_sample is not None:
+        for i in range(len(data.t)):
+            if on_sample(data.t[i], data.E[i]):
+                data.truncate(i + 1)
+                break
     save_in_gamry_format(data, validate_file_name(params.fileName), params.header)
 
 
@@ -111,6 +116,11 @@ class DummyData:
         self.Ach2 = np.zeros_like(self.t)
         self.Temp = np.full_like(self.t, 25.0)
 
+    def truncate(self, n):
+        """Keep the first n samples, as an aborted run would"""
+        for name, values in vars(self).items():
+            setattr(self, name, values[:n])
+
 
 # =====================
 # Data saving utility (mock)
@@ -56,9 +56,9 @@ class GamryAdapter:
         self.complete_file_name = setfilename(*args, **kwargs)
         return self.complete_file_name
 
-    def OCP(self, ocp_params) -> None:
-        """Run open circuit potential measurement."""
-        OCP(ocp_params.OCPvi, ocp_params.OCPti, ocp_params.OCPrate)
+    def OCP(self, ocp_params, on_sample=None) -> None:
+        """Run open circuit potential measurement, streaming samples to on_sample."""
+        OCP(ocp_params, on_sample)
 
     def activecheck(self) -> None:
         """Check if experiment is active."""
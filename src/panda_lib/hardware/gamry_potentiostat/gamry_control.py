@@ -14,6 +14,8 @@ import pandas as pd
 from pydantic import ConfigDict
 from pydantic.dataclasses import dataclass
 
+from ..ocp_monitor import SampleCallback
+from ..potentiostat_data import load_echem_data, write_columnar
 from .errors import ErrorCodeLookup, GamryCOMError, check_platform_compatibility
 
 if sys.platform == "win32":
@@ -128,12 +130,25 @@ class potentiostat_ocp_parameters:
 
 
 class GamryDtaqEvents(object):
-    """Class to handle events from the data acquisition."""
+    """Class to handle events from the data acquisition.
 
-    def __init__(self, dtaq_value, complete_file_name):
+    If on_sample is given it is called with (Time, Vf) of each point as it is
+    cooked; when it returns True the run is stopped and the points so far saved.
+    """
+
+    def __init__(
+        self,
+        dtaq_value,
+        complete_file_name,
+        kind: str = None,
+        on_sample: SampleCallback = None,
+    ):
         self.dtaq = dtaq_value
         self.acquired_points = []
         self.complete_file_name = complete_file_name
+        self.kind = kind
+        self.on_sample = on_sample
+        self.aborted = False
 
     def call_stopacq(self):
         """stop the acquisition"""
@@ -141,7 +156,7 @@ class GamryDtaqEvents(object):
 
     def call_savedata(self, complete_file_name):
         """save the data to a file"""
-        savedata(complete_file_name)
+        savedata(complete_file_name, self.kind)
 
     def cook(self):
         """Cook the data acquired from the data acquisition."""
@@ -150,10 +165,29 @@ class GamryDtaqEvents(object):
             count, points = self.dtaq.Cook(10)
             # The columns exposed by GamryDtaq.Cook vary by dtaq and are
             # documented in the Toolkit Reference Manual.
-            self.acquired_points.extend(zip(*points))
+            new_points = list(zip(*points))
+            self.acquired_points.extend(new_points)
+            if self.on_sample is not None and not self.aborted:
+                # Time and Vf lead every dtaq's columns
+                for point in new_points:
+                    if self.on_sample(point[0], point[1]):
+                        self.abort()
+                        return
+
+    def abort(self):
+        """Stop the run early and save the points acquired so far"""
+        self.aborted = True
+        try:
+            self.dtaq.Run(False)
+        except Exception as e:
+            logger.error("Failed to stop the dtaq: %s", gamry_error_decoder(e))
+        self.call_stopacq()
+        self.call_savedata(self.complete_file_name)
 
     def _IGamryDtaqEvents_OnDataAvailable(self):
         """Called when data is available from the data acquisition."""
+        if self.aborted:
+            return
         self.cook()
         # loading = ["|", "/", "-", "\\"]
         # logger.debug("\rmade it to data available %s{random.choice(loading)}", end="")
@@ -161,7 +195,11 @@ class GamryDtaqEvents(object):
     def _IGamryDtaqEvents_OnDataDone(self):
         """Called when the data acquisition is complete."""
         logger.debug("made it to data done")
+        if self.aborted:
+            return  # already stopped and saved
         self.cook()  # a final cook
+        if self.aborted:
+            return
         time.sleep(2.0)
         self.call_stopacq()
         self.call_savedata(self.complete_file_name)
@@ -253,8 +291,8 @@ def pstatdisconnect():
     time.sleep(2)
 
 
-def savedata(complete_file_name):
-    """save the data to a file"""
+def savedata(complete_file_name, kind: str = None):
+    """save the data to a text file and its columnar sidecar"""
     # logger.debug(dtaqsink.acquired_points)
     logger.debug("number of data points acquired: %d", len(DTAQ_SINK.acquired_points))
     # savedata
@@ -262,6 +300,11 @@ def savedata(complete_file_name):
     output = pd.DataFrame(DTAQ_SINK.acquired_points)
     # complete_file_name = os.path(complete_file_name)
     np.savetxt(Path(complete_file_name).with_suffix(".txt"), output, fmt="%s")
+    # written after the text so the sidecar is never older than it
+    try:
+        write_columnar(complete_file_name, output, kind)
+    except OSError as error:
+        logger.warning("Could not write columnar data: %s", error)
     logger.debug("data saved")
 
 
@@ -317,7 +360,7 @@ def cyclic(params: cv_parameters):
     # signal and dtaq object creation
     SIGNAL = client.CreateObject("GamryCOM.GamrySignalRupdn")
     DTAQ = client.CreateObject("GamryCOM.GamryDtaqRcv")
-    DTAQ_SINK = GamryDtaqEvents(DTAQ, COMPLETE_FILE_NAME)
+    DTAQ_SINK = GamryDtaqEvents(DTAQ, COMPLETE_FILE_NAME, "CV")
     CONNECTION = client.GetEvents(DTAQ, DTAQ_SINK)
 
     SIGNAL.Init(
@@ -373,7 +416,7 @@ def chrono(params: chrono_parameters):
     SIGNAL = client.CreateObject("GamryCOM.GamrySignalDstep")
     DTAQ = client.CreateObject("GamryCOM.GamryDtaqChrono")
 
-    DTAQ_SINK = GamryDtaqEvents(DTAQ, COMPLETE_FILE_NAME)
+    DTAQ_SINK = GamryDtaqEvents(DTAQ, COMPLETE_FILE_NAME, "CA")
     CONNECTION = client.GetEvents(DTAQ, DTAQ_SINK)
 
     SIGNAL.Init(
@@ -397,13 +440,14 @@ def chrono(params: chrono_parameters):
     logger.debug("chrono: made it to run end")
 
 
-def OCP(params: potentiostat_ocp_parameters):
+def OCP(params: potentiostat_ocp_parameters, on_sample: SampleCallback = None):
     """
     open circuit potential
 
     :param OCPvi: initial voltage
     :param OCPti: time interval
     :param OCPrate: rate of change
+    :param on_sample: called with (Time, Vf) per sample, returning True aborts the run
 
     """
     global DTAQ
@@ -423,7 +467,7 @@ def OCP(params: potentiostat_ocp_parameters):
     SIGNAL = client.CreateObject("GamryCOM.GamrySignalConst")
     DTAQ = client.CreateObject("GamryCOM.GamryDtaqOcv")
 
-    DTAQ_SINK = GamryDtaqEvents(DTAQ, COMPLETE_FILE_NAME)
+    DTAQ_SINK = GamryDtaqEvents(DTAQ, COMPLETE_FILE_NAME, "OCP", on_sample)
     CONNECTION = client.GetEvents(DTAQ, DTAQ_SINK)
 
     SIGNAL.Init(PSTAT, params.OCPvi, params.OCPti, params.OCPrate, GAMRY_COM.PstatMode)
@@ -448,13 +492,8 @@ def activecheck():
 def check_vf_range(filename) -> Tuple[bool, float]:
     """Check if the Vf value is in the valid range for an echem experiment."""
     try:
-        ocp_data = pd.read_csv(
-            filename,
-            sep=" ",
-            header=None,
-            names=["Time", "Vf", "Vu", "Vsig", "Ach", "Overload", "StopTest", "Temp"],
-        )
-        vf_last_row_scientific = ocp_data.iloc[-2, ocp_data.columns.get_loc("Vf")]
+        ocp_data = load_echem_data(filename, "OCP", columns=["Vf"])
+        vf_last_row_scientific = ocp_data["Vf"].iloc[-2]
         logger.debug("Vf last row (sci): %.2E", Decimal(vf_last_row_scientific))
         vf_last_row_decimal = float(vf_last_row_scientific)
         logger.debug("Vf last row (float): %f", vf_last_row_decimal)
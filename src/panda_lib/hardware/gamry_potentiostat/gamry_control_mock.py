@@ -28,7 +28,7 @@ class GamryPotentiostat:
     def pstatdisconnect(self):
         self.OPEN_CONNECTION = False
 
-    def OCP(self, ocp_params):
+    def OCP(self, ocp_params, on_sample=None):
         self.OPEN_CONNECTION = True
         pass
 
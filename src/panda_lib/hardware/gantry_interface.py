@@ -8,6 +8,8 @@ from sqlalchemy import select
 from panda_lib.labware.vials import read_vial
 from panda_lib.sql_tools import VialStatus
 from panda_shared.config.config_tools import (
+    get_config_boolean,
+    get_config_float,
     read_config_value,
     read_logging_dir,
     read_testing_config,
@@ -50,6 +52,13 @@ class PandaMill(Mill):
         super().__init__()
         self.load_tools()
         self.logger = mill_control_logger
+        self.use_status_engine = get_config_boolean("MILL", "use_status_engine", True)
+        self.status_report_interval = get_config_float(
+            "MILL", "status_report_interval", self.status_report_interval
+        )
+        self.use_position_model = get_config_boolean(
+            "MILL", "use_position_model", True
+        )
 
     def load_tools(self):
         """Loads all of the tools from the local config file."""
@@ -161,6 +170,7 @@ class PandaMill(Mill):
             mill_control_logger.warning("Serial connection to mill is already None.")
             return
 
+        self.stop_status_engine()
         try:
             self.ser_mill.close()
             time.sleep(2)
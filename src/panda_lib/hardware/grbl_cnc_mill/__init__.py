@@ -14,6 +14,7 @@ from .exceptions import (
 )
 from .logger import set_up_mill_logger
 from .mock import MockMill
+from .motion_planner import MotionPlan, MotionPlanner, PlannerTarget
 from .status_codes import AlarmStatus, ErrorCodes, Status
 from .tools import Coordinates, Instruments, ToolManager, ToolOffset, Tools
 
@@ -22,6 +23,9 @@ VERSION = "1.0.0"  # Version of grbl_cnc_mill
 __all__ = [
     "Mill",
     "MockMill",
+    "MotionPlan",
+    "MotionPlanner",
+    "PlannerTarget",
     "AlarmStatus",
     "Coordinates",
     "ErrorCodes",
@@ -19,9 +19,10 @@ of the mill.
 import json
 import os
 import re
+import threading
 import time
 from pathlib import Path
-from typing import List, Optional, Tuple, Union
+from typing import Callable, Iterator, List, Optional, Tuple, Union
 
 # third-party libraries
 import serial
@@ -38,6 +39,8 @@ from .exceptions import (
 
 # local libraries
 from .logger import set_up_command_logger, set_up_mill_logger
+from .status_engine import DEFAULT_STATUS_INTERVAL, GrblStatusEngine, MachineState
+from .streaming import GRBL_RX_BUFFER_SIZE, GrblStreamer, StreamedLine
 from .tools import Coordinates, ToolManager
 
 # Formatted strings for the mill commands
@@ -52,6 +55,20 @@ RAPID_MILL_MOVE = (
 wpos_pattern = re.compile(r"WPos:([\d.-]+),([\d.-]+),([\d.-]+)")
 mpos_pattern = re.compile(r"MPos:([\d.-]+),([\d.-]+),([\d.-]+)")
 
+# Real-time commands are acted on immediately by GRBL and never acknowledged
+REALTIME_COMMANDS = ("?", "!", "~", "\x18")
+
+# Commands that can move the mill without the position model knowing the target:
+# motion/offset G-codes, bare axis words (modal motion), homing, jogging, unlock
+position_changing_pattern = re.compile(
+    r"G0*[0-3](?!\d)|G28|G30|G92|G10|\$H|\$J|\$X|[XYZ][-+.\d]|[!~\x18]",
+    re.IGNORECASE,
+)
+# Reported and modelled positions closer than this (mm) are considered equal
+POSITION_TOLERANCE = 0.005
+# Seconds sweep_z holds the mill still at each plane
+DEFAULT_PLANE_DWELL = 0.25
+
 axis_conf_table = [
     {"setting_value": 0, "reverse_x": 0, "reverse_y": 0, "reverse_z": 0},
     {"setting_value": 1, "reverse_x": 1, "reverse_y": 0, "reverse_z": 0},
@@ -89,6 +106,9 @@ class Mill:
         read_mill_config(): Read the mill configuration from the mill and set it as an attribute.
         write_mill_config_file(config_file): Write the mill configuration to the configuration file.
         execute_command(command): Execute a command on the mill.
+        stream_gcode(lines, timeout): Stream G-code lines using GRBL character counting.
+        start_status_engine(interval): Start streaming status reports in the background.
+        stop_status_engine(): Stop the background status engine.
         stop(): Stop the mill.
         reset(): Reset the mill.
         soft_reset(): Soft reset the mill.
@@ -103,7 +123,8 @@ class Mill:
         grbl_settings(): Get the GRBL settings of the mill.
         set_grbl_setting(setting, value): Set a GRBL setting of the mill.
         move_center_to_position(x_coord, y_coord, z_coord, coordinates): Move the mill to the specified coordinates.
-        current_coordinates(tool): Get the current coordinates of the mill.
+        current_coordinates(tool, tool_only, verify): Get the current coordinates of the mill.
+        invalidate_position(): Forget the modelled position so the next read queries the mill.
         move_to_safe_position(): Move the mill to its current x,y location and z = 0.
         move_to_position(x, y, z, coordinates, tool): Move the mill to the specified coordinates.
         update_offset(tool, offset_x, offset_y, offset_z): Update the offset in the config file.
@@ -125,6 +146,15 @@ class Mill:
         self.max_z_height = 0.0
         self.command_logger = set_up_command_logger(self.logger_location)
         self.interactive_mode = False
+        self.use_status_engine = True
+        self.status_report_interval = DEFAULT_STATUS_INTERVAL
+        self.status_engine: Optional[GrblStatusEngine] = None
+        self.rx_buffer_size = GRBL_RX_BUFFER_SIZE
+        self.feed_rate: Optional[float] = None
+        self.use_position_model = True
+        self._position: Optional[Coordinates] = None
+        self._position_updated_at = 0.0
+        self._motion_confirmed = True
 
     def read_working_volume(self):
         """Checks the mill config for soft limits to be enabled, and then if so check the x, y, and z max travel limits"""
@@ -329,8 +359,41 @@ class Mill:
 
         self.check_for_alarm_state()
         self.clear_buffers()
+        if self.use_status_engine:
+            self.start_status_engine()
         return self.ser_mill
 
+    @property
+    def status_engine_running(self) -> bool:
+        """True when status reports are being streamed in the background"""
+        return self.status_engine is not None and self.status_engine.running
+
+    def start_status_engine(self, interval: Optional[float] = None):
+        """
+        Start streaming GRBL status reports in the background.
+
+        Once running, the engine owns all reads from the serial port and every
+        command waits on its reports instead of on fixed sleeps.
+
+        Args:
+            interval (float): Seconds between status polls, defaults to status_report_interval.
+        """
+        if self.status_engine_running:
+            return
+        if interval is not None:
+            self.status_report_interval = interval
+        self.status_engine = GrblStatusEngine(
+            self.ser_mill, self.status_report_interval, self.logger
+        )
+        self.status_engine.start()
+
+    def stop_status_engine(self):
+        """Stop the background status engine and return to polled reads"""
+        if self.status_engine is None:
+            return
+        self.status_engine.stop()
+        self.status_engine = None
+
     def check_for_alarm_state(self):
         """Check if the mill is in an alarm state"""
         status = self.read()
@@ -404,6 +467,7 @@ class Mill:
         #     self.logger.debug("Mill was homed, resting electrode")
         #     self.rest_electrode()
 
+        self.stop_status_engine()
         self.ser_mill.close()
         time.sleep(2)
         self.logger.info("Mill connected: %s", self.ser_mill.is_open)
@@ -481,8 +545,14 @@ class Mill:
             self.logger.error("Error writing mill config to file: %s", str(exep))
             raise MillConfigError("Error writing mill config to file") from exep
 
-    def execute_command(self, command: str):
+    def execute_command(self, command: str, timeout: float = 5.0):
         """Encodes and sends commands to the mill and returns the response"""
+        if position_changing_pattern.search(str(command)):
+            # Movement methods record their target once the command has completed
+            self.invalidate_position()
+            self._motion_confirmed = False
+        if self.status_engine_running:
+            return self._execute_with_status_engine(command, timeout)
         try:
             self.logger.debug("Command sent: %s", command)
             self.command_logger.debug("%s", command)
@@ -502,21 +572,7 @@ class Mill:
                 full_mill_response = full_mill_response[:-1]
                 self.logger.debug("Returned %s", full_mill_response)
 
-                # parse the settings into a dictionary
-                settings_dict = {}
-                for setting in full_mill_response:
-                    if setting in [
-                        "",
-                        "Grbl 1.1h ['$' for help]",
-                        "[MSG:'$H'|'$X' to unlock]",
-                        "[MSG:Check Limits]",
-                    ]:
-                        continue
-                    setting: str
-                    key, value = setting.split("=")
-                    settings_dict[key] = value
-
-                return settings_dict
+                return self._parse_grbl_settings(full_mill_response)
 
             mill_response = self.read().lower()
             if not command.startswith("$"):
@@ -547,6 +603,101 @@ class Mill:
 
         return mill_response
 
+    def _execute_with_status_engine(self, command: str, timeout: float = 5.0):
+        """
+        Send a command while the status engine owns the serial port.
+
+        Multi-line commands are streamed with character counting, and motion
+        commands return as soon as an Idle report follows the last ok.
+        """
+        engine = self.status_engine
+        command = str(command)
+        try:
+            self.logger.debug("Command sent: %s", command)
+            self.command_logger.debug("%s", command)
+            if command in REALTIME_COMMANDS:
+                engine.write(command.encode(encoding="ascii"))
+                return ""
+
+            results = self.stream_gcode(command.split("\n"), timeout)
+            responses = [
+                line
+                for result in results
+                for line in result.messages + [result.response]
+                if line
+            ]
+            acknowledged_at = time.monotonic()
+
+            if command == "$$":
+                self.logger.debug("Returned %s", responses[:-1])
+                return self._parse_grbl_settings(responses[:-1])
+
+            mill_response = "\n".join(responses).lower()
+            if re.search(r"(error|alarm)", mill_response):
+                if re.search(r"error:22", mill_response):
+                    # This is a GRBL error that occurs when the feed rate isn't set before moving with G01 command
+                    self.logger.error("Error in status: %s", mill_response)
+                    self.set_feed_rate(2000)
+                    return self.execute_command(command, timeout)
+                self.logger.error("current_status: Error in status: %s", mill_response)
+                raise StatusReturnError(f"Error in status: {mill_response}")
+
+            if not command.startswith("$"):
+                state = engine.wait_for_idle(since=acknowledged_at, timeout=timeout)
+                mill_response = state.raw.lower()
+                self._motion_confirmed = True
+            self.logger.debug("Returned %s", mill_response)
+
+        except Exception as exep:
+            self.logger.error("Error executing command %s: %s", command, str(exep))
+            raise CommandExecutionError(
+                f"Error executing command {command}: {str(exep)}"
+            ) from exep
+
+        return mill_response
+
+    def stream_gcode(
+        self,
+        lines: List[str],
+        timeout: float = 5.0,
+        cancel: Optional[threading.Event] = None,
+    ) -> List[StreamedLine]:
+        """
+        Stream G-code lines to the mill using GRBL's character-counting protocol.
+
+        Lines are sent as long as the unacknowledged bytes fit in the mill's RX
+        buffer, so the planner stays full and consecutive segments blend into
+        continuous motion. Returns once every sent line has been acknowledged;
+        it does not wait for the motion to finish.
+
+        Args:
+            lines (List[str]): G-code lines without newlines.
+            timeout (float): Seconds to wait for an acknowledgement while the mill is not moving.
+            cancel (threading.Event): Set to stop sending lines that are not yet in GRBL's buffer.
+
+        Returns:
+            List[StreamedLine]: The ok/error response of each line, in order.
+        """
+        if not self.status_engine_running:
+            raise MillConnectionError("Streaming requires the status engine")
+        streamer = GrblStreamer(self.status_engine, self.rx_buffer_size)
+        results = streamer.stream(lines, timeout, cancel)
+        for result in results:
+            if result.error:
+                self.logger.error("%s rejected: %s", result.line, result.response)
+        return results
+
+    def _parse_grbl_settings(self, response_lines: List[str]) -> dict:
+        """Parse the lines returned by $$ into a dictionary of settings"""
+        settings_dict = {}
+        for setting in response_lines:
+            setting: str
+            if "=" not in setting or not setting.startswith("$"):
+                continue
+            key, value = setting.split("=", 1)
+            settings_dict[key] = value
+        return settings_dict
+
     def stop(self):
         """Stop the mill"""
         self.execute_command("!")
@@ -561,6 +712,14 @@ class Mill:
 
     def home(self, timeout=90):
         """Home the mill with a timeout"""
+        if self.status_engine_running:
+            # GRBL only acknowledges $H once the homing cycle has finished
+            self.execute_command("$H", timeout=timeout)
+            self.status_engine.wait_for_idle(timeout=timeout)
+            self.logger.info("Homing completed")
+            self.homed = True
+            return
+
         self.execute_command("$H")
         time.sleep(15)
         start_time = time.time()
@@ -600,11 +759,14 @@ class Mill:
                 self.logger.warning("Command execution timed out")
                 return status
             status = self.current_status()
+        self._motion_confirmed = True
         # print("Time to wait for completion: ", time.time() - start_time)
         return status
 
     def current_status(self) -> str:
         """Get the current status of the mill"""
+        if self.status_engine_running:
+            return self.status_engine.wait_for_report().raw
         # start_time = time.time()
         attempt_limit = 5
         status = self.read()
@@ -646,6 +808,9 @@ class Mill:
             # If not a status request, ensure there is a carriage return at the end
             command += "\n"
 
+        if self.status_engine_running:
+            self.status_engine.write(command.encode(encoding="ascii"))
+            return
         self.ser_mill.write(command.encode(encoding="ascii"))
 
     def read(self):
@@ -665,9 +830,13 @@ class Mill:
     def set_feed_rate(self, rate):
         """Set the feed rate"""
         self.execute_command(f"F{rate}")
+        self.feed_rate = rate
 
     def clear_buffers(self):
         """Clear input and output buffers"""
+        if self.status_engine_running:
+            self.status_engine.clear_responses()
+            return
         self.ser_mill.flush()  # Clear input buffer
         self.ser_mill.read_all()  # Clear output buffer
 
@@ -693,16 +862,88 @@ class Mill:
         return self.execute_command(command)
 
     def current_coordinates(
-        self, tool: Optional[str] = None, tool_only: bool = True
+        self, tool: Optional[str] = None, tool_only: bool = True, verify: bool = False
     ) -> Union[Coordinates, Tuple[Coordinates, Coordinates]]:
         """
         Get the current coordinates of the mill.
+
+        The position is taken from the driver's position model when it is known,
+        which avoids a status round-trip. The model is set from the targets of
+        completed moves and reconciled with any newer Idle report the status
+        engine has already received.
+
         Args:
             tool (Tool): The tool for which to get the offset coordinates.
+            tool_only (bool): Only return the tool head coordinates.
+            verify (bool): Query the mill for its position instead of using the model,
+                for calibration or any time the physical position must be confirmed.
         Returns:
             mill_center (Coordinates): [x,y,z]
             tool_head (Coordinates): [x,y,z]
         """
+        mill_center = None if verify else self._modelled_position()
+        if mill_center is None:
+            if self.status_engine_running:
+                state = self.status_engine.wait_for_report()
+                status, reported_at = state.raw, state.timestamp
+            else:
+                status, reported_at = self._poll_status_report(), time.monotonic()
+            mill_center = self._center_from_status(status)
+            self._reconcile_position(mill_center, reported_at)
+        return self._tool_coordinates(mill_center, tool, tool_only)
+
+    def invalidate_position(self):
+        """Forget the modelled position so the next read queries the mill"""
+        self._position = None
+        self._position_updated_at = time.monotonic()
+
+    def _record_position(self, mill_center: Coordinates):
+        """Set the modelled position to the target of a completed move"""
+        if not self.use_position_model:
+            return
+        if not self._motion_confirmed:
+            # The move timed out before Idle, the mill may not be at the target
+            self.invalidate_position()
+            return
+        self._position = Coordinates(
+            round(mill_center.x, 3), round(mill_center.y, 3), round(mill_center.z, 3)
+        )
+        self._position_updated_at = time.monotonic()
+
+    def _modelled_position(self) -> Optional[Coordinates]:
+        """The modelled mill center, reconciled with the latest streamed report"""
+        if not self.use_position_model or self._position is None:
+            return None
+        if self.status_engine_running:
+            state = self.status_engine.latest()
+            if (
+                state is not None
+                and state.is_idle
+                and state.timestamp > self._position_updated_at
+            ):
+                self._reconcile_position(
+                    self._center_from_status(state.raw), state.timestamp
+                )
+        return Coordinates(*self._position)
+
+    def _reconcile_position(self, reported: Coordinates, reported_at: float):
+        """Adopt a position reported by the mill, warning if the model disagreed"""
+        if not self.use_position_model:
+            return
+        if self._position is not None and any(
+            abs(modelled - actual) > POSITION_TOLERANCE
+            for modelled, actual in zip(self._position, reported)
+        ):
+            self.logger.warning(
+                "Position model %s disagrees with the mill at %s, using the mill",
+                self._position,
+                reported,
+            )
+        self._position = reported
+        self._position_updated_at = reported_at
+
+    def _poll_status_report(self) -> str:
+        """Request a status report with ? and read it back"""
         self.ser_mill.write(b"?")
         time.sleep(0.2)
         status = self.read()
@@ -715,6 +956,10 @@ class Mill:
                 self.logger.debug("OK in status: %s", status)
             status = self.read()
             attempts += 1
+        return status
+
+    def _center_from_status(self, status: str) -> Coordinates:
+        """Extract the mill center coordinates from a status report"""
         # Get the current mode of the mill
         # 0=WCS position, 1=Machine position, 2= plan/buffer and WCS position, 3=plan/buffer and Machine position.
         status_mode = int(self.config["$10"])
@@ -758,17 +1003,30 @@ class Mill:
                 )
                 raise LocationNotFound
 
-        mill_center = Coordinates(x_coord, y_coord, z_coord)
-        # So far we have obtain the mill's coordinates
-        # Now we need to adjust them based on the instrument to communicate where the current instrument is
+        return Coordinates(x_coord, y_coord, z_coord)
+
+    def _center_from_state(self, state: MachineState) -> Optional[Coordinates]:
+        """The mill center from a parsed status report, without logging it"""
+        if int(self.config["$10"]) in [0, 2]:
+            position, pull_off = state.wpos, 0.0
+        else:
+            position, pull_off = state.mpos, float(self.config["$27"])
+        if position is None:
+            return None
+        return Coordinates(*(round(axis, 3) + pull_off for axis in position))
+
+    def _tool_coordinates(
+        self, mill_center: Coordinates, tool: Optional[str] = None, tool_only: bool = True
+    ) -> Union[Coordinates, Tuple[Coordinates, Coordinates]]:
+        """Adjust the mill center coordinates to where the tool head is"""
         if tool:
             try:
                 offsets = self.tool_manager.get_offset(tool)
                 # NOTE that these have minus instead of plus as usual since we are saying where the tool head is
                 tool_head = Coordinates(
-                    x_coord - offsets.x,
-                    y_coord - offsets.y,
-                    z_coord - offsets.z,
+                    mill_center.x - offsets.x,
+                    mill_center.y - offsets.y,
+                    mill_center.z - offsets.z,
                 )
 
             except Exception as exception:
@@ -785,7 +1043,11 @@ class Mill:
 
     def move_to_safe_position(self) -> str:
         """Move the mill to its current x,y location and the max z height"""
-        return self.execute_command(f"G01 Z{self.max_z_height}")
+        position = self._position
+        response = self.execute_command(f"G01 Z{self.max_z_height}")
+        if position is not None:
+            self._record_position(Coordinates(position.x, position.y, self.max_z_height))
+        return response
 
     def move_to_position(
         self,
@@ -837,6 +1099,7 @@ class Mill:
         # self.execute_command(command)
         command_str = "\n".join(commands)
         self.execute_command(command_str)
+        self._record_position(target_coordinates)
         return None  # self.current_coordinates(tool)
 
     def move_to_positions(
@@ -903,6 +1166,155 @@ class Mill:
         if commands:
             command_str = "\n".join(commands)
             self.execute_command(command_str)
+            self._record_position(current_coordinates)
+
+    def sweep_z(
+        self,
+        x_coord: float,
+        y_coord: float,
+        z_coords: List[float],
+        tool: str = "center",
+        dwell: Union[float, Callable[[], float]] = DEFAULT_PLANE_DWELL,
+        timeout: float = 5.0,
+        cancel: Optional[threading.Event] = None,
+    ) -> Iterator[Optional[Coordinates]]:
+        """
+        Step the tool through z_coords above one x, y position.
+
+        The first plane is reached with safe_move. The rest of the sweep is
+        streamed as one G-code path with a G4 dwell after every move, so the
+        mill goes from plane to plane without waiting on the host. The
+        generator yields the measured tool position while the mill dwells at
+        each plane; whatever the caller does there should fit in the dwell.
+        A plane the mill has already moved past by the time the host asks for
+        it yields None instead, and the sweep carries on with the next one.
+
+        Setting cancel, or closing the generator, stops sending the path. Moves
+        already in GRBL's buffer still run and the generator returns once the
+        mill is idle. Without the status engine each plane is a blocking move.
+
+        Args:
+            x_coord (float): X coordinate of the tool.
+            y_coord (float): Y coordinate of the tool.
+            z_coords (List[float]): Tool Z coordinates, in sweep order.
+            tool (str): The tool to position.
+            dwell (float): Seconds to hold still at each plane, or a callable
+                returning them. The callable is read once the caller is done
+                with the first plane, so the dwell can be sized from the time
+                that took.
+            timeout (float): Seconds to wait for a plane while the mill is not moving.
+            cancel (threading.Event): Set to end the sweep early.
+
+        Yields:
+            Coordinates: The tool position reported at each plane, None for a
+                plane that was missed.
+        """
+        if not isinstance(tool, str):
+            tool = tool.value
+        if not z_coords:
+            return
+        cancel = cancel or threading.Event()
+        offsets = self.tool_manager.get_offset(tool)
+        self.safe_move(x_coord, y_coord, z_coords[0], tool=tool)
+        yield self.current_coordinates(tool)
+
+        previous = self._calculate_target_coordinates(
+            Coordinates(x_coord, y_coord, z_coords[0]), None, offsets
+        )
+        targets = []
+        for z_coord in z_coords[1:]:
+            target = self._calculate_target_coordinates(
+                Coordinates(x_coord, y_coord, z_coord), None, offsets
+            )
+            self._validate_target_coordinates(target)
+            targets.append(target)
+
+        if not self.status_engine_running:
+            for target in targets:
+                if cancel.is_set():
+                    return
+                self.execute_command(f"G01 Z{target.z}")
+                self._record_position(target)
+                yield self.current_coordinates(tool)
+            return
+
+        if callable(dwell):
+            dwell = dwell()
+        lines = []
+        for target in targets:
+            lines.extend([f"G01 Z{target.z}", f"G4 P{dwell:.3f}"])
+        failure: List[Exception] = []
+
+        def stream():
+            try:
+                self.stream_gcode(lines, timeout, cancel)
+            except Exception as exep:  # pylint: disable=broad-except
+                failure.append(exep)
+                cancel.set()
+
+        self.invalidate_position()
+        streamer = threading.Thread(target=stream, name="grbl-z-sweep", daemon=True)
+        since = time.monotonic()
+        streamer.start()
+        try:
+            for target in targets:
+                if cancel.is_set():
+                    break
+                step = target.z - previous.z
+                previous = target
+                state = self.status_engine.wait_for_state(
+                    lambda state, z=target.z, step=step: (
+                        cancel.is_set()
+                        or self._at_plane(state, z)
+                        or self._past_plane(state, z, step)
+                    ),
+                    since=since,
+                    timeout=timeout,
+                )
+                if cancel.is_set():
+                    break
+                if not self._at_plane(state, target.z):
+                    # The report that showed the mill past this plane may be
+                    # its dwell at the next one, so since is left as it was
+                    self.logger.warning(
+                        "Missed the plane at Z=%s, the host took longer than the %.3f s dwell",
+                        target.z,
+                        dwell,
+                    )
+                    yield None
+                    continue
+                since = state.timestamp
+                yield self._tool_coordinates(self._center_from_state(state), tool)
+                latest = self.status_engine.latest()
+                if latest is not None and not latest.is_idle:
+                    self.logger.warning(
+                        "Mill left Z=%s before the host was done, dwell %.3f s is too short",
+                        target.z,
+                        dwell,
+                    )
+        finally:
+            cancel.set()
+            streamer.join()
+            self.status_engine.wait_for_idle(timeout=timeout)
+            self.invalidate_position()
+        if failure:
+            raise CommandExecutionError(f"Z sweep failed: {failure[0]}") from failure[0]
+
+    def _at_plane(self, state: MachineState, z: float) -> bool:
+        """Whether the report shows the mill holding still at machine Z z"""
+        center = self._center_from_state(state)
+        return (
+            state.is_idle
+            and center is not None
+            and abs(center.z - z) <= POSITION_TOLERANCE
+        )
+
+    def _past_plane(self, state: MachineState, z: float, step: float) -> bool:
+        """Whether the report shows the mill beyond machine Z z, moving by step"""
+        center = self._center_from_state(state)
+        if center is None or step == 0:
+            return False
+        return (center.z - z) * (1 if step > 0 else -1) > POSITION_TOLERANCE
 
     def update_offset(self, tool, offset_x, offset_y, offset_z):
         """
@@ -989,9 +1401,13 @@ class Mill:
             )
         )
 
+        final_coordinates = target_coordinates
         if second_z_cord is not None:
             # Adjust the second_z_coord according to the tool offsets
             second_z_cord += offsets.z
+            final_coordinates = Coordinates(
+                target_coordinates.x, target_coordinates.y, second_z_cord
+            )
 
             # Add the movement to the second z coordinate and feed rate
             commands.append(f"G01 Z{second_z_cord} F{second_z_cord_feed}")
@@ -1000,6 +1416,7 @@ class Mill:
         # Form the individual movement commands into a block seperated by \n
         command_str = "\n".join(commands)
         self.execute_command(command_str)
+        self._record_position(final_coordinates)
 
         return self.current_coordinates()
 
@@ -4,6 +4,8 @@
 import json
 import logging
 import re
+import threading
+from collections import deque
 from pathlib import Path
 
 # third-party libraries
@@ -11,6 +13,7 @@ import serial
 
 from .driver import Mill as RealMill
 from .exceptions import MillConfigError
+from .streaming import GRBL_RX_BUFFER_SIZE
 from .tools import Coordinates
 
 
@@ -119,13 +122,29 @@ class MockMill(RealMill):
     def home(self):
         """Simulate homing the mill"""
         self.logger.info("Homing the mill")
+        self.invalidate_position()
         self.ser_mill.write(b"$H\n")
 
 
 class MockSerialToMill:
-    """A class that simulates a serial connection to the mill for testing purposes."""
+    """A class that simulates a serial connection to the mill for testing purposes.
 
-    def __init__(self, port, baudrate, parity, stopbits, bytesize, timeout):
+    Like GRBL, written lines sit in a fixed size RX buffer until the host reads
+    their "ok", one line per readline() call. Writing more than the buffer can
+    hold is counted in rx_overflows, where a real controller would drop the
+    characters.
+    """
+
+    def __init__(
+        self,
+        port,
+        baudrate,
+        parity,
+        stopbits,
+        bytesize,
+        timeout,
+        rx_buffer_size: int = GRBL_RX_BUFFER_SIZE,
+    ):
         self.port = port
         self.baudrate = baudrate
         self.timeout = timeout
@@ -138,15 +157,72 @@ class MockSerialToMill:
         self.current_y = 0.0
         self.current_z = 0.0
         self.logger = logging.getLogger(__name__)
+        self.rx_buffer_size = rx_buffer_size
+        self.rx_overflows = 0
+        self.max_rx_bytes = 0
+        self._rx_lines = deque()
+        self._rx_bytes = 0
+        self._rx_partial = ""
+        self._output = deque()
+        self._output_ready = threading.Condition()
 
     def close(self):
         """Simulate closing the serial connection"""
         self.is_open = False
+        self.cancel_read()
+
+    def cancel_read(self):
+        """Release a blocked readline()"""
+        with self._output_ready:
+            self._output_ready.notify_all()
+
+    def _status_report(self) -> str:
+        rx_free = self.rx_buffer_size - 1 - self._rx_bytes
+        return f"<Idle|MPos:{self.current_x - 3},{self.current_y - 3},{self.current_z - 3}|Bf:15,{rx_free}|FS:0,0>"
+
+    def _buffer_input(self, command: str):
+        """Account for written characters in the emulated RX buffer"""
+        with self._output_ready:
+            if command == "?":
+                self._output.append(self._status_report() + "\r\n")
+                self._output_ready.notify_all()
+                return
+            if self._rx_bytes + len(command) > self.rx_buffer_size - 1:
+                self.rx_overflows += 1
+                self.logger.debug(
+                    "RX buffer overflow: %s bytes pending, %s written",
+                    self._rx_bytes,
+                    len(command),
+                )
+            self._rx_bytes += len(command)
+            self.max_rx_bytes = max(self.max_rx_bytes, self._rx_bytes)
+            self._rx_partial += command
+            *lines, self._rx_partial = self._rx_partial.split("\n")
+            self._rx_lines.extend(lines)
+            self._output_ready.notify_all()
+
+    def _acknowledge_line(self) -> bool:
+        """Parse the oldest buffered line, freeing its bytes and queuing its ok"""
+        if not self._rx_lines:
+            return False
+        self._rx_bytes -= len(self._rx_lines.popleft()) + 1
+        self._output.append("ok\r\n")
+        return True
+
+    def _drain(self) -> str:
+        """Acknowledge everything and return all pending output"""
+        with self._output_ready:
+            while self._acknowledge_line():
+                pass
+            pending = "".join(self._output)
+            self._output.clear()
+            return pending
 
     def write(self, command: bytes):
         """Simulate writing to the serial connection"""
         # decode the command to a string
         command = command.decode("utf-8")
+        self._buffer_input(command)
         if command == "$H\n" or command == "$H":
             self.current_x = 0.0
             self.current_y = 0.0
@@ -196,16 +272,23 @@ class MockSerialToMill:
 
     def read(self, size):
         """Simulate reading from the serial connection"""
-        msg = f"<Idle|MPos:{self.current_x - 3},{self.current_y - 3},{self.current_z - 3}|Bf:15,127|FS:0,0>".encode()
+        self._drain()
+        msg = self._status_report().encode()
         return msg[:size]
 
     def read_all(self):
         """Simulate reading from the serial connection"""
-        return f"<Idle|MPos:{self.current_x - 3},{self.current_y - 3},{self.current_z - 3}|Bf:15,127|FS:0,0>\n".encode()
+        self._drain()
+        return f"{self._status_report()}\n".encode()
 
     def readline(self):
-        """Simulate reading from the serial connection"""
-        return f"<Idle|MPos:{self.current_x - 3},{self.current_y - 3},{self.current_z - 3}|Bf:15,127|FS:0,0>\n".encode()
+        """Return the next queued response, acknowledging one buffered line if none is queued"""
+        with self._output_ready:
+            if not self._output and not self._acknowledge_line():
+                self._output_ready.wait(self.timeout)
+                if not self._output and not self._acknowledge_line():
+                    return b""
+            return self._output.popleft().encode()
 
     def readlines(self):
         """Simulate reading from the serial connection"""
@@ -0,0 +1,390 @@
+"""Batch motion planning for the gantry.
+
+Each safe_move call only knows about its own target, so a sequence of moves
+lifts to the max Z height before every XY travel and stops between each
+command. The MotionPlanner takes a whole batch of tool-tagged targets and turns
+them into one path:
+
+- Z only lifts when the mill is below safe_z_height, and only as high as
+  safe_z_height, the same height above which safe_move already allows diagonal
+  XY travel.
+- Above safe_z_height, XY and Z are combined into a single diagonal move.
+- Consecutive Z moves are merged and moves that go nowhere are dropped.
+- The order of the targets can optionally be changed to minimise travel time.
+
+Travel time is predicted from the GRBL max rate ($110-$112) and acceleration
+($120-$122) settings with a trapezoidal velocity profile per move, and
+compared with the measured time of each leg when the plan is executed.
+"""
+
+import itertools
+import logging
+import math
+import time
+from dataclasses import dataclass, field
+from typing import Callable, Dict, List, Optional, Sequence
+
+from .tools import Coordinates
+
+# GRBL defaults, used when a setting is missing from the mill config
+DEFAULT_MAX_RATE = 5000.0  # mm/min
+DEFAULT_ACCELERATION = 300.0  # mm/s^2
+
+
+@dataclass(frozen=True)
+class AxisLimits:
+    """Per axis speed and acceleration limits of the mill.
+
+    Attributes:
+        max_rate (tuple): Max rate of x, y and z in mm/min ($110-$112).
+        acceleration (tuple): Acceleration of x, y and z in mm/s^2 ($120-$122).
+    """
+
+    max_rate: tuple = (DEFAULT_MAX_RATE,) * 3
+    acceleration: tuple = (DEFAULT_ACCELERATION,) * 3
+
+    @classmethod
+    def from_grbl_settings(cls, settings: Dict[str, str]) -> "AxisLimits":
+        """Build the limits from a grbl_settings() dictionary"""
+
+        def setting(key: str, default: float) -> float:
+            try:
+                return float(settings[key])
+            except (KeyError, TypeError, ValueError):
+                return default
+
+        return cls(
+            max_rate=tuple(
+                setting(f"${number}", DEFAULT_MAX_RATE) for number in (110, 111, 112)
+            ),
+            acceleration=tuple(
+                setting(f"${number}", DEFAULT_ACCELERATION)
+                for number in (120, 121, 122)
+            ),
+        )
+
+    def move_time(
+        self, start: Coordinates, end: Coordinates, feed_rate: float
+    ) -> float:
+        """
+        Predict the time for a straight G01 move that starts and ends at rest.
+
+        GRBL scales the feed rate and acceleration of a multi-axis move so that no
+        axis exceeds its own limit; the move then follows a trapezoidal profile,
+        or a triangular one if it is too short to reach full speed.
+
+        Args:
+            start (Coordinates): Start of the move.
+            end (Coordinates): End of the move.
+            feed_rate (float): Requested feed rate in mm/min.
+
+        Returns:
+            float: Predicted duration in seconds.
+        """
+        deltas = [e - s for s, e in zip(start, end)]
+        distance = math.sqrt(sum(delta**2 for delta in deltas))
+        if distance == 0:
+            return 0.0
+        speed = feed_rate / 60
+        acceleration = math.inf
+        for delta, max_rate, axis_acceleration in zip(
+            deltas, self.max_rate, self.acceleration
+        ):
+            fraction = abs(delta) / distance
+            if fraction > 0:
+                speed = min(speed, max_rate / 60 / fraction)
+                acceleration = min(acceleration, axis_acceleration / fraction)
+
+        if distance >= speed**2 / acceleration:
+            return distance / speed + speed / acceleration
+        return 2 * math.sqrt(distance / acceleration)
+
+
+@dataclass
+class PlannerTarget:
+    """A position a tool has to visit.
+
+    Attributes:
+        coordinates (Coordinates): Where the tool should go, in deck coordinates.
+        tool (str): The tool that should arrive there.
+        label (str): A name for reports, e.g. "A1" or "tip rack".
+        payload (object): Anything the caller wants back on arrival (a vial, a well).
+    """
+
+    coordinates: Coordinates
+    tool: str = "center"
+    label: str = ""
+    payload: object = None
+
+
+@dataclass
+class PathSegment:
+    """The moves that take the mill from the previous target to the next one.
+
+    Attributes:
+        target (PlannerTarget): The target reached at the end of the segment.
+        waypoints (List[Coordinates]): Mill center positions, starting at the previous target.
+        commands (List[str]): The G-code lines for the segment.
+        predicted_time (float): Predicted travel time in seconds.
+        actual_time (float | None): Measured travel time once executed.
+    """
+
+    target: PlannerTarget
+    waypoints: List[Coordinates]
+    commands: List[str]
+    predicted_time: float
+    actual_time: Optional[float] = None
+
+
+@dataclass
+class MotionPlan:
+    """An ordered list of segments covering every target."""
+
+    segments: List[PathSegment] = field(default_factory=list)
+
+    @property
+    def predicted_time(self) -> float:
+        """Total predicted travel time in seconds"""
+        return sum(segment.predicted_time for segment in self.segments)
+
+    @property
+    def actual_time(self) -> Optional[float]:
+        """Total measured travel time, or None until every segment has run"""
+        if any(segment.actual_time is None for segment in self.segments):
+            return None
+        return sum(segment.actual_time for segment in self.segments)
+
+    @property
+    def commands(self) -> List[str]:
+        """Every G-code line of the plan, in order"""
+        return [line for segment in self.segments for line in segment.commands]
+
+    def report(self) -> List[Dict[str, object]]:
+        """Predicted and actual time for each segment"""
+        return [
+            {
+                "target": segment.target.label,
+                "tool": segment.target.tool,
+                "moves": len(segment.commands),
+                "predicted_s": round(segment.predicted_time, 3),
+                "actual_s": (
+                    None
+                    if segment.actual_time is None
+                    else round(segment.actual_time, 3)
+                ),
+            }
+            for segment in self.segments
+        ]
+
+
+class MotionPlanner:
+    """Plans and executes a batch of tool moves as a single path.
+
+    Attributes:
+        mill (Mill): The mill that will run the plan, used for tool offsets, limits and heights.
+        limits (AxisLimits): Speed and acceleration limits from the mill's GRBL settings.
+        feed_rate (float): Feed rate for all planned moves in mm/min.
+        travel_height (float): The mill center Z used for XY travel below safe_z_height.
+    """
+
+    # Exhaustively check orderings up to this many targets, use 2-opt above it
+    EXHAUSTIVE_LIMIT = 7
+
+    def __init__(
+        self,
+        mill,
+        feed_rate: Optional[float] = None,
+        travel_height: Optional[float] = None,
+        logger: Optional[logging.Logger] = None,
+    ):
+        self.mill = mill
+        self.limits = AxisLimits.from_grbl_settings(mill.config)
+        self.feed_rate = feed_rate or getattr(mill, "feed_rate", None) or max(
+            self.limits.max_rate
+        )
+        self.travel_height = (
+            mill.safe_z_height if travel_height is None else travel_height
+        )
+        self.logger = logger or mill.logger
+
+    def plan(
+        self,
+        targets: Sequence[PlannerTarget],
+        start: Optional[Coordinates] = None,
+        optimize_order: bool = False,
+    ) -> MotionPlan:
+        """
+        Plan a path through the targets.
+
+        Args:
+            targets (Sequence[PlannerTarget]): The targets to visit.
+            start (Coordinates): Mill center position to start from, defaults to the current position.
+            optimize_order (bool): Visit the targets in the order with the least predicted
+                travel time instead of the given order. Only use this when the order of
+                the work done at each target does not matter, e.g. imaging a plate.
+
+        Returns:
+            MotionPlan: The planned segments.
+        """
+        if start is None:
+            start = self.mill.current_coordinates()
+        positions = [self._mill_position(target) for target in targets]
+
+        order = list(range(len(targets)))
+        if optimize_order and len(order) > 1:
+            order = self._optimize_order(start, positions)
+
+        plan = MotionPlan()
+        current = start
+        for index in order:
+            waypoints = self._waypoints(current, positions[index])
+            plan.segments.append(
+                PathSegment(
+                    target=targets[index],
+                    waypoints=waypoints,
+                    commands=[
+                        f"G01 X{point.x} Y{point.y} Z{point.z}"
+                        for point in waypoints[1:]
+                    ],
+                    predicted_time=self._waypoint_time(waypoints),
+                )
+            )
+            current = positions[index]
+
+        self.logger.debug(
+            "Planned %d targets, predicted travel %.2f s",
+            len(plan.segments),
+            plan.predicted_time,
+        )
+        return plan
+
+    def execute(
+        self,
+        plan: MotionPlan,
+        on_arrival: Optional[Callable[[PlannerTarget], None]] = None,
+    ) -> MotionPlan:
+        """
+        Run a plan one segment at a time, timing each segment.
+
+        Args:
+            plan (MotionPlan): The plan to run.
+            on_arrival (Callable): Called with each target once the mill has stopped there.
+
+        Returns:
+            MotionPlan: The same plan with actual_time filled in.
+        """
+        self.mill.set_feed_rate(self.feed_rate)
+        for segment in plan.segments:
+            started = time.perf_counter()
+            if segment.commands:
+                self.mill.execute_command("\n".join(segment.commands))
+                self.mill._record_position(segment.waypoints[-1])
+            segment.actual_time = time.perf_counter() - started
+            self.logger.debug(
+                "Reached %s with %s: predicted %.3f s, actual %.3f s",
+                segment.target.label,
+                segment.target.tool,
+                segment.predicted_time,
+                segment.actual_time,
+            )
+            if on_arrival is not None:
+                on_arrival(segment.target)
+
+        self.logger.info(
+            "Motion plan finished: predicted %.2f s, actual %.2f s",
+            plan.predicted_time,
+            plan.actual_time,
+        )
+        return plan
+
+    def _mill_position(self, target: PlannerTarget) -> Coordinates:
+        """The validated mill center position that puts the target's tool on its coordinates"""
+        tool = target.tool if isinstance(target.tool, str) else target.tool.value
+        offsets = self.mill.tool_manager.get_offset(tool)
+        position = self.mill._calculate_target_coordinates(
+            target.coordinates, None, offsets
+        )
+        self.mill._validate_target_coordinates(position)
+        return position
+
+    def _waypoints(
+        self, current: Coordinates, target: Coordinates
+    ) -> List[Coordinates]:
+        """
+        The positions the mill center passes through from current to target.
+
+        Below travel_height the mill only moves vertically, above it XY and Z are
+        combined into one diagonal move.
+        """
+        waypoints = [current]
+        travel = min(
+            max(self.travel_height, self.mill.safe_z_height), self.mill.max_z_height
+        )
+        same_xy = (current.x, current.y) == (target.x, target.y)
+
+        if not same_xy:
+            if current.z < travel:
+                waypoints.append(Coordinates(current.x, current.y, travel))
+            above = Coordinates(target.x, target.y, max(target.z, travel))
+            waypoints.append(above)
+        waypoints.append(target)
+
+        # Drop moves that go nowhere and merge consecutive vertical moves
+        merged = [waypoints[0]]
+        for point in waypoints[1:]:
+            if point == merged[-1]:
+                continue
+            if (
+                len(merged) > 1
+                and (point.x, point.y) == (merged[-1].x, merged[-1].y)
+                and (merged[-2].x, merged[-2].y) == (merged[-1].x, merged[-1].y)
+            ):
+                merged[-1] = point
+                continue
+            merged.append(point)
+        return merged
+
+    def _waypoint_time(self, waypoints: List[Coordinates]) -> float:
+        return sum(
+            self.limits.move_time(start, end, self.feed_rate)
+            for start, end in zip(waypoints, waypoints[1:])
+        )
+
+    def _optimize_order(self, start: Coordinates, positions) -> List[int]:
+        """Order the targets to minimise the predicted travel time"""
+        # Leg times between every pair of points, row/column 0 is the start
+        points = [start] + list(positions)
+        leg = [
+            [self._waypoint_time(self._waypoints(a, b)) for b in points] for a in points
+        ]
+
+        def route_time(order) -> float:
+            stops = [0] + [index + 1 for index in order]
+            return sum(leg[a][b] for a, b in zip(stops, stops[1:]))
+
+        indices = range(len(positions))
+        if len(positions) <= self.EXHAUSTIVE_LIMIT:
+            return list(min(itertools.permutations(indices), key=route_time))
+
+        # Nearest neighbour followed by 2-opt improvement
+        remaining = set(indices)
+        order = []
+        current = 0
+        while remaining:
+            nearest = min(remaining, key=lambda i: leg[current][i + 1])
+            order.append(nearest)
+            remaining.remove(nearest)
+            current = nearest + 1
+
+        best = route_time(order)
+        improved = True
+        while improved:
+            improved = False
+            for i in range(len(order) - 1):
+                for j in range(i + 1, len(order)):
+                    candidate = order[:i] + order[i : j + 1][::-1] + order[j + 1 :]
+                    candidate_time = route_time(candidate)
+                    if candidate_time < best - 1e-9:
+                        order, best = candidate, candidate_time
+                        improved = True
+        return order
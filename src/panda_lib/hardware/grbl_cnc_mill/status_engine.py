@@ -0,0 +1,397 @@
+"""Background status engine for GRBL controllers.
+
+GRBL answers the real-time ``?`` command with a status report of the form
+``<Idle|MPos:0.000,0.000,0.000|Bf:15,128|FS:0,0>``. The engine polls for these
+reports at a fixed rate from one thread while a second thread owns all reads
+from the serial port. Status reports are parsed into a shared, timestamped
+``MachineState``; every other line (``ok``, ``error:N``, ``ALARM:N``, ``$``
+responses, messages) is put on a response queue for whoever sent the command.
+
+Callers block on a condition variable instead of sleeping, so a move is known
+to be complete the moment an ``Idle`` report arrives.
+"""
+
+import logging
+import queue
+import re
+import threading
+import time
+from dataclasses import dataclass, field
+from typing import Callable, Optional, Tuple
+
+from .exceptions import StatusReturnError
+
+status_report_pattern = re.compile(r"<([^|>]+)((?:\|[^|>]*)*)>")
+
+DEFAULT_STATUS_INTERVAL = 0.1  # seconds between "?" polls (10 Hz)
+
+
+@dataclass(frozen=True)
+class MachineState:
+    """A single parsed GRBL status report.
+
+    Attributes:
+        state (str): The machine state, e.g. "Idle", "Run", "Hold:0", "Alarm".
+        mpos (Tuple[float, float, float] | None): Machine position, if reported.
+        wpos (Tuple[float, float, float] | None): Work position, if reported.
+        wco (Tuple[float, float, float] | None): Work coordinate offset, if reported.
+        planner_blocks_free (int | None): Free planner blocks from the Bf field.
+        rx_bytes_free (int | None): Free serial RX bytes from the Bf field.
+        feed (float | None): Current feed rate from the FS/F field.
+        timestamp (float): time.monotonic() at which the report was received.
+        raw (str): The report as received.
+    """
+
+    state: str
+    mpos: Optional[Tuple[float, float, float]] = None
+    wpos: Optional[Tuple[float, float, float]] = None
+    wco: Optional[Tuple[float, float, float]] = None
+    planner_blocks_free: Optional[int] = None
+    rx_bytes_free: Optional[int] = None
+    feed: Optional[float] = None
+    timestamp: float = field(default_factory=time.monotonic)
+    raw: str = ""
+
+    @property
+    def is_idle(self) -> bool:
+        """True when the machine reports Idle"""
+        return self.state == "Idle"
+
+    @property
+    def is_alarm(self) -> bool:
+        """True when the machine reports an Alarm state"""
+        return self.state.startswith("Alarm")
+
+
+def _parse_axes(value: str) -> Tuple[float, float, float]:
+    x, y, z = (float(item) for item in value.split(",")[:3])
+    return (x, y, z)
+
+
+def parse_status_report(line: str, timestamp: Optional[float] = None) -> MachineState:
+    """Parse a GRBL 1.1 status report into a MachineState.
+
+    Args:
+        line (str): A status report line, e.g. "<Idle|MPos:0,0,0|FS:0,0>".
+        timestamp (float): Receive time, defaults to time.monotonic().
+
+    Returns:
+        MachineState: The parsed state.
+
+    Raises:
+        ValueError: If the line is not a status report.
+    """
+    match = status_report_pattern.search(line)
+    if not match:
+        raise ValueError(f"Not a status report: {line}")
+
+    fields = {}
+    for item in match.group(2).split("|")[1:]:
+        key, _, value = item.partition(":")
+        fields[key] = value
+
+    planner_blocks_free = rx_bytes_free = None
+    if "Bf" in fields:
+        blocks, _, rx_bytes = fields["Bf"].partition(",")
+        planner_blocks_free = int(blocks)
+        rx_bytes_free = int(rx_bytes) if rx_bytes else None
+
+    feed = None
+    if "FS" in fields:
+        feed = float(fields["FS"].split(",")[0])
+    elif "F" in fields:
+        feed = float(fields["F"])
+
+    return MachineState(
+        state=match.group(1),
+        mpos=_parse_axes(fields["MPos"]) if "MPos" in fields else None,
+        wpos=_parse_axes(fields["WPos"]) if "WPos" in fields else None,
+        wco=_parse_axes(fields["WCO"]) if "WCO" in fields else None,
+        planner_blocks_free=planner_blocks_free,
+        rx_bytes_free=rx_bytes_free,
+        feed=feed,
+        timestamp=time.monotonic() if timestamp is None else timestamp,
+        raw=match.group(0),
+    )
+
+
+class GrblStatusEngine:
+    """Streams GRBL status reports into a shared machine state.
+
+    The engine owns every read from the serial port once started. Writes to the
+    port should go through ``write`` so that the poller's ``?`` bytes never land
+    in the middle of a command line.
+
+    Attributes:
+        ser (serial.Serial): The open serial connection to the controller.
+        interval (float): Seconds between status polls.
+        logger (Logger): The logger to report parse problems to.
+    """
+
+    def __init__(
+        self,
+        ser,
+        interval: float = DEFAULT_STATUS_INTERVAL,
+        logger: Optional[logging.Logger] = None,
+    ):
+        self.ser = ser
+        self.interval = interval
+        self.logger = logger or logging.getLogger("grbl_cnc_mill")
+        self._state: Optional[MachineState] = None
+        self._previous_state: Optional[MachineState] = None
+        self._condition = threading.Condition()
+        self._write_lock = threading.Lock()
+        self._responses: "queue.Queue[Tuple[float, str]]" = queue.Queue()
+        self._stop = threading.Event()
+        self._report_requested = threading.Event()
+        self._reader: Optional[threading.Thread] = None
+        self._poller: Optional[threading.Thread] = None
+        self._planner_capacity = 0
+
+    @property
+    def running(self) -> bool:
+        """True while the reader thread is alive"""
+        return self._reader is not None and self._reader.is_alive()
+
+    def start(self):
+        """Start the reader and poller threads"""
+        if self.running:
+            return
+        self._stop.clear()
+        self._reader = threading.Thread(
+            target=self._read_loop, name="grbl-status-reader", daemon=True
+        )
+        self._poller = threading.Thread(
+            target=self._poll_loop, name="grbl-status-poller", daemon=True
+        )
+        self._reader.start()
+        self._poller.start()
+        self.logger.debug("Status engine started at %.3f s interval", self.interval)
+
+    def stop(self, timeout: float = 2.0):
+        """Stop both threads and release any waiters"""
+        self._stop.set()
+        self._report_requested.set()
+        cancel_read = getattr(self.ser, "cancel_read", None)
+        if cancel_read is not None:
+            try:
+                cancel_read()
+            except Exception:  # pylint: disable=broad-except
+                pass
+        for thread in (self._poller, self._reader):
+            if thread is not None and thread is not threading.current_thread():
+                thread.join(timeout)
+        with self._condition:
+            self._condition.notify_all()
+        self._reader = self._poller = None
+        self.logger.debug("Status engine stopped")
+
+    def write(self, data: bytes):
+        """Write raw bytes to the controller"""
+        with self._write_lock:
+            self.ser.write(data)
+
+    def request_report(self):
+        """Ask the poller to send a "?" now rather than on its next tick"""
+        self._report_requested.set()
+
+    def latest(self) -> Optional[MachineState]:
+        """The most recent status report, or None if none has arrived yet"""
+        with self._condition:
+            return self._state
+
+    def wait_for_report(
+        self, since: Optional[float] = None, timeout: float = 5.0
+    ) -> MachineState:
+        """Block until a status report newer than ``since`` arrives.
+
+        Args:
+            since (float): A time.monotonic() value, defaults to now.
+            timeout (float): Seconds to wait.
+
+        Returns:
+            MachineState: The first report received after ``since``.
+        """
+        since = time.monotonic() if since is None else since
+        self.request_report()
+        with self._condition:
+            fresh = self._condition.wait_for(
+                lambda: (
+                    self._stop.is_set()
+                    or (self._state is not None and self._state.timestamp > since)
+                ),
+                timeout,
+            )
+            if not fresh or self._state is None or self._state.timestamp <= since:
+                raise StatusReturnError("Timed out waiting for a status report")
+            return self._state
+
+    def wait_for_idle(
+        self, since: Optional[float] = None, timeout: float = 5.0
+    ) -> MachineState:
+        """Block until the controller reports Idle after ``since``.
+
+        The timeout is an inactivity timeout: it restarts whenever a report shows
+        the machine running, so long moves do not need a long timeout.
+
+        Args:
+            since (float): Only reports received after this time.monotonic() value count.
+            timeout (float): Seconds without a Run report before giving up.
+
+        Returns:
+            MachineState: The Idle report.
+
+        Raises:
+            StatusReturnError: On an Alarm state or on timeout.
+        """
+        since = time.monotonic() if since is None else since
+        deadline = time.monotonic() + timeout
+        self.request_report()
+        with self._condition:
+            while True:
+                state = self._state
+                if state is not None and state.timestamp > since:
+                    if state.is_idle and self._planner_drained(state, since):
+                        return state
+                    if state.is_alarm:
+                        self.logger.error("Alarm in status: %s", state.raw)
+                        raise StatusReturnError(f"Alarm in status: {state.raw}")
+                    if state.state in ("Run", "Home", "Jog"):
+                        deadline = max(deadline, state.timestamp + timeout)
+                remaining = deadline - time.monotonic()
+                if remaining <= 0 or self._stop.is_set():
+                    self.logger.warning("Timed out waiting for Idle")
+                    raise StatusReturnError("Timed out waiting for the mill to idle")
+                self._condition.wait(remaining)
+
+    def wait_for_state(
+        self,
+        predicate: Callable[[MachineState], bool],
+        since: Optional[float] = None,
+        timeout: float = 5.0,
+    ) -> MachineState:
+        """Block until a report received after ``since`` satisfies ``predicate``.
+
+        Like wait_for_idle, the timeout restarts whenever a report shows the
+        machine running.
+
+        Args:
+            predicate (Callable[[MachineState], bool]): Test applied to each new report.
+            since (float): Only reports received after this time.monotonic() value count.
+            timeout (float): Seconds without a Run report before giving up.
+
+        Returns:
+            MachineState: The first matching report.
+
+        Raises:
+            StatusReturnError: On an Alarm state or on timeout.
+        """
+        since = time.monotonic() if since is None else since
+        deadline = time.monotonic() + timeout
+        checked: Optional[MachineState] = None
+        self.request_report()
+        with self._condition:
+            while True:
+                state = self._state
+                if (
+                    state is not None
+                    and state.timestamp > since
+                    and state is not checked
+                ):
+                    checked = state
+                    if predicate(state):
+                        return state
+                    if state.is_alarm:
+                        self.logger.error("Alarm in status: %s", state.raw)
+                        raise StatusReturnError(f"Alarm in status: {state.raw}")
+                    if state.state in ("Run", "Home", "Jog"):
+                        deadline = max(deadline, state.timestamp + timeout)
+                remaining = deadline - time.monotonic()
+                if remaining <= 0 or self._stop.is_set():
+                    self.logger.warning(
+                        "Timed out waiting for a matching status report"
+                    )
+                    raise StatusReturnError("Timed out waiting for the mill state")
+                self._condition.wait(remaining)
+
+    def clear_responses(self):
+        """Discard any unread non-status lines"""
+        while True:
+            try:
+                self._responses.get_nowait()
+            except queue.Empty:
+                return
+
+    def next_response(self, timeout: Optional[float] = None) -> str:
+        """Return the next non-status line from the controller.
+
+        Raises:
+            queue.Empty: If nothing arrives within ``timeout`` seconds.
+        """
+        return self._responses.get(timeout=timeout)[1]
+
+    def _planner_drained(self, state: MachineState, since: float) -> bool:
+        """An Idle report only means done once the planner has no queued blocks.
+
+        GRBL acknowledges a motion line before auto cycle start, so a report can
+        read Idle with blocks still waiting. The capacity is the largest Bf value
+        seen. When Bf is not reported ($10 without the buffer bit), the previous
+        report received after ``since`` must also read Idle.
+        """
+        if state.planner_blocks_free is None:
+            previous = self._previous_state
+            return (
+                previous is not None and previous.is_idle and previous.timestamp > since
+            )
+        return state.planner_blocks_free >= self._planner_capacity
+
+    def _poll_loop(self):
+        while not self._stop.is_set():
+            try:
+                self.write(b"?")
+            except Exception as exep:  # pylint: disable=broad-except
+                if not self._stop.is_set():
+                    self.logger.error("Status poll failed: %s", str(exep))
+                return
+            self._report_requested.wait(self.interval)
+            self._report_requested.clear()
+
+    def _read_loop(self):
+        while not self._stop.is_set():
+            try:
+                raw = self.ser.readline()
+            except Exception as exep:  # pylint: disable=broad-except
+                if not self._stop.is_set():
+                    self.logger.error("Status reader failed: %s", str(exep))
+                break
+            if not raw:
+                continue
+            self._handle_line(raw.decode(encoding="ascii", errors="replace").strip())
+        with self._condition:
+            self._condition.notify_all()
+
+    def _handle_line(self, line: str):
+        if not line:
+            return
+        received = time.monotonic()
+        if line.startswith("<"):
+            try:
+                state = parse_status_report(line, received)
+            except ValueError:
+                self.logger.warning("Unparseable status report: %s", line)
+                return
+            with self._condition:
+                self._previous_state = self._state
+                self._state = state
+                if state.planner_blocks_free is not None:
+                    self._planner_capacity = max(
+                        self._planner_capacity, state.planner_blocks_free
+                    )
+                self._condition.notify_all()
+            return
+
+        if line.startswith("ALARM"):
+            with self._condition:
+                self._state = MachineState(state="Alarm", timestamp=received, raw=line)
+                self._condition.notify_all()
+        self._responses.put((received, line))
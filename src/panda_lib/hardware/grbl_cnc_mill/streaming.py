@@ -0,0 +1,155 @@
+"""Character-counting G-code streaming for GRBL.
+
+GRBL holds incoming characters in a 128 byte serial RX buffer and answers every
+line with ``ok`` or ``error:N`` once it has been parsed into the planner. A
+sender that tracks how many bytes are still unacknowledged can keep that buffer
+(and therefore the planner) full without ever overflowing it, which is what
+lets multi-segment paths run as continuous motion instead of stopping between
+lines. See the "Streaming Protocol: Character-Counting" section of the GRBL
+wiki.
+"""
+
+import queue
+import threading
+import time
+from collections import deque
+from dataclasses import dataclass, field
+from typing import List, Optional
+
+from .exceptions import StatusReturnError
+from .status_engine import GrblStatusEngine
+
+GRBL_RX_BUFFER_SIZE = 128
+
+
+@dataclass
+class StreamedLine:
+    """The outcome of one streamed G-code line.
+
+    Attributes:
+        line (str): The line as sent, without the trailing newline.
+        response (str): "ok", "error:N", or "" if the line was never sent.
+        messages (List[str]): Any other lines GRBL sent before the acknowledgement.
+        sent_at (float | None): time.monotonic() when the line was written.
+        acknowledged_at (float | None): time.monotonic() when the response arrived.
+    """
+
+    line: str
+    response: str = ""
+    messages: List[str] = field(default_factory=list)
+    sent_at: Optional[float] = None
+    acknowledged_at: Optional[float] = None
+
+    @property
+    def ok(self) -> bool:
+        """True when GRBL accepted the line"""
+        return self.response == "ok"
+
+    @property
+    def error(self) -> bool:
+        """True when GRBL rejected the line"""
+        return self.response.startswith("error")
+
+
+class GrblStreamer:
+    """Streams G-code lines through a running status engine.
+
+    Attributes:
+        engine (GrblStatusEngine): The engine that owns the serial port.
+        rx_buffer_size (int): Size of the controller's serial RX buffer in bytes.
+    """
+
+    def __init__(
+        self, engine: GrblStatusEngine, rx_buffer_size: int = GRBL_RX_BUFFER_SIZE
+    ):
+        self.engine = engine
+        self.rx_buffer_size = rx_buffer_size
+
+    def stream(
+        self,
+        lines: List[str],
+        timeout: float = 5.0,
+        cancel: Optional[threading.Event] = None,
+    ) -> List[StreamedLine]:
+        """
+        Send lines while keeping the unacknowledged byte count below the RX buffer size.
+
+        Sending stops at the first error or once ``cancel`` is set; lines already
+        in GRBL's buffer are still acknowledged and recorded, and lines after
+        them are returned unsent.
+
+        Args:
+            lines (List[str]): G-code lines without newlines.
+            timeout (float): Seconds to wait for an acknowledgement while the mill is not moving.
+            cancel (threading.Event): Set to stop sending further lines.
+
+        Returns:
+            List[StreamedLine]: One result per line, in order.
+
+        Raises:
+            ValueError: If a line cannot fit in the RX buffer.
+            StatusReturnError: On an alarm or when acknowledgements stop arriving.
+        """
+        results = [StreamedLine(line.strip()) for line in lines if line.strip()]
+        for result in results:
+            if len(result.line) + 1 >= self.rx_buffer_size:
+                raise ValueError(f"Line exceeds the GRBL RX buffer: {result.line}")
+
+        in_flight = deque()
+        buffered_bytes = 0
+        next_line = 0
+        stopped = False
+        messages = []
+        deadline = time.monotonic() + timeout
+        self.engine.clear_responses()
+
+        while (next_line < len(results) and not stopped) or in_flight:
+            if cancel is not None and cancel.is_set():
+                stopped = True
+                if not in_flight:
+                    break
+            while next_line < len(results) and not stopped:
+                result = results[next_line]
+                size = len(result.line) + 1
+                if buffered_bytes + size >= self.rx_buffer_size:
+                    break
+                self.engine.write(result.line.encode(encoding="ascii") + b"\n")
+                result.sent_at = time.monotonic()
+                in_flight.append((result, size))
+                buffered_bytes += size
+                next_line += 1
+
+            try:
+                response = self.engine.next_response(timeout=self.engine.interval)
+            except queue.Empty:
+                state = self.engine.latest()
+                if state is not None and state.state in ("Run", "Home", "Jog"):
+                    deadline = time.monotonic() + timeout
+                if time.monotonic() > deadline:
+                    raise StatusReturnError(
+                        f"Timed out waiting for acknowledgement of {in_flight[0][0].line}"
+                    ) from None
+                continue
+
+            deadline = time.monotonic() + timeout
+            lowered = response.lower()
+            if lowered == "ok" or lowered.startswith("error"):
+                if not in_flight:
+                    # A late reply to a $ command or one from before a reset
+                    self.engine.logger.warning(
+                        "Ignoring %s with no line in flight", response
+                    )
+                    continue
+                result, size = in_flight.popleft()
+                buffered_bytes -= size
+                result.response = lowered
+                result.messages = messages
+                result.acknowledged_at = time.monotonic()
+                messages = []
+                stopped = stopped or result.error
+            elif lowered.startswith("alarm"):
+                raise StatusReturnError(f"Alarm while streaming: {response}")
+            else:
+                messages.append(response)
+
+        return results
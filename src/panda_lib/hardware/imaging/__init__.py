@@ -15,6 +15,9 @@ from .flir_camera_tools import (
 )
 from .panda_image_tools import add_data_zone, invert_image
 from .camera_factory import CameraFactory, CameraType
+from .camera_session import CameraSession
+from .image_writer import ImageWriter, ImageWriteResult
+from .z_stack import ZStack, ZStackAcquisition, ZStackFrame, z_planes
 
 __all__ = [
     "add_data_zone",
@@ -23,7 +26,14 @@ __all__ = [
     "image_filepath_generator",
     "invert_image",
     "CameraFactory",
+    "CameraSession",
     "CameraType",
+    "ImageWriter",
+    "ImageWriteResult",
+    "ZStack",
+    "ZStackAcquisition",
+    "ZStackFrame",
+    "z_planes",
 ]
 
 default_logger = logging.getLogger("panda")
@@ -36,6 +46,7 @@ def capture_new_image(
     logger: Optional[Logger] = default_logger,
     camera_type: Union[str, CameraType] = CameraType.FLIR,
     camera_id: int = 0,
+    session: Optional[CameraSession] = None,
 ) -> Tuple[Path, bool]:
     """Capture a new image from a camera
 
@@ -46,6 +57,9 @@ def capture_new_image(
         logger: Logger to use
         camera_type: Type of camera to use (OPENCV, FLIR, or MOCK)
         camera_id: ID of the camera to use
+        session: An open camera session to capture with. The session's camera
+            is used as is and left connected, camera_type and camera_id are
+            ignored.
 
     Returns:
         Tuple[Path, bool]: Path to the saved image and whether the operation was successful
@@ -56,6 +70,18 @@ def capture_new_image(
     # Check the file name and enumerate if it already exists
     file_name = file_enumeration(file_name)
 
+    if session is not None:
+        try:
+            file_path, result = session.capture_and_save(file_name)
+        except Exception as e:
+            logger.error(f"Error capturing image: {e}")
+            return file_name, False
+        if result:
+            logger.info(f"Image captured and saved to {file_path}")
+        else:
+            logger.error("Failed to capture or save image")
+        return file_path, result
+
     # Create the camera
     camera = CameraFactory.create_camera(camera_type=camera_type, camera_id=camera_id)
     if camera is None:
@@ -0,0 +1,125 @@
+"""
+A long-lived camera session.
+
+capture_new_image creates, connects and closes a camera for every frame, which
+for a FLIR camera is a full PySpin system and camera init and teardown per
+image. A CameraSession connects once, keeps the camera armed for acquisition
+when the camera supports it, and hands frames to callers until it is closed.
+
+The Toolkit owns one session for its camera::
+
+    frame = toolkit.camera_session.capture()
+    path, ok = toolkit.camera_session.capture_and_save(path)
+"""
+
+import logging
+import threading
+from pathlib import Path
+from typing import Any, List, Optional, Tuple, Union
+
+from PIL import Image
+
+from .flir_camera_tools import file_enumeration
+from .interface import CameraInterface
+
+
+class CameraSession:
+    """Keeps one camera connected and armed across many captures.
+
+    Attributes:
+        camera (CameraInterface): The camera driven by the session.
+        frames_captured (int): Frames captured since the session was created.
+    """
+
+    def __init__(
+        self, camera: CameraInterface, logger: Optional[logging.Logger] = None
+    ):
+        self.camera = camera
+        self.logger = logger or logging.getLogger("panda")
+        self.frames_captured = 0
+        self._lock = threading.RLock()
+
+    def __enter__(self) -> "CameraSession":
+        self.open()
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback) -> None:
+        self.close()
+
+    @property
+    def is_open(self) -> bool:
+        return self.camera.is_connected()
+
+    def open(self) -> bool:
+        """Connect and arm the camera if it is not already, returns success"""
+        with self._lock:
+            if self.camera.is_connected():
+                return True
+            if not self.camera.connect():
+                self.logger.error("Failed to connect to camera")
+                return False
+            arm = getattr(self.camera, "arm", None)
+            if arm is not None and not arm():
+                self.logger.warning(
+                    "Could not arm camera acquisition, capturing frame by frame"
+                )
+            return True
+
+    def close(self) -> None:
+        """Disarm and disconnect the camera"""
+        with self._lock:
+            if self.camera.is_connected():
+                self.camera.close()
+
+    def capture(self) -> Optional[Any]:
+        """
+        Capture one frame.
+
+        The camera is opened on first use. If a capture fails the camera is
+        reconnected once and the capture retried.
+
+        Returns:
+            The frame as returned by the camera, or None on failure.
+        """
+        with self._lock:
+            for attempt in range(2):
+                if not self.open():
+                    return None
+                frame = self.camera.capture_image()
+                if frame is not None:
+                    self.frames_captured += 1
+                    return frame
+                if attempt == 0:
+                    self.logger.warning("Capture failed, reconnecting camera")
+                    self.camera.close()
+            self.logger.error("Failed to capture image")
+            return None
+
+    def burst(self, count: int) -> List[Any]:
+        """Capture count frames back to back, stopping at the first failure"""
+        frames = []
+        with self._lock:
+            for _ in range(count):
+                frame = self.capture()
+                if frame is None:
+                    break
+                frames.append(frame)
+        return frames
+
+    def save(self, frame: Any, path: Union[str, Path]) -> Tuple[Path, bool]:
+        """Save a captured frame, enumerating the file name if it already exists"""
+        path = file_enumeration(Path(path))
+        return path, self.camera.save_image(frame, path)
+
+    def capture_and_save(self, path: Union[str, Path]) -> Tuple[Path, bool]:
+        """Capture a frame and save it, like CameraInterface.capture_and_save"""
+        frame = self.capture()
+        if frame is None:
+            return Path(path), False
+        return self.save(frame, path)
+
+    def to_image(self, frame: Any) -> Image.Image:
+        """A PIL image of a captured frame, in RGB"""
+        if getattr(self.camera, "color_order", "RGB") == "BGR" and frame.ndim == 3:
+            frame = frame[..., ::-1]
+        return Image.fromarray(frame)
@@ -54,6 +54,7 @@ class FlirCamera(CameraInterface):
         self.camera_list = None
         self.camera = None
         self.connected = False
+        self.armed = False
 
     def connect(self) -> bool:
         """Connect to the FLIR camera
@@ -95,6 +96,7 @@ class FlirCamera(CameraInterface):
         if not PYSPIN_AVAILABLE or not self.connected:
             return
 
+        self.disarm()
         try:
             if self.camera is not None:
                 try:
@@ -148,22 +150,100 @@ class FlirCamera(CameraInterface):
         """
         return self.connected and self.camera is not None
 
+    @staticmethod
+    def _set_enum(nodemap, node_name: str, entry_name: str) -> bool:
+        """Set an enumeration node by entry name, returns False if not possible"""
+        node = PySpin.CEnumerationPtr(nodemap.GetNode(node_name))
+        if not (PySpin.IsAvailable(node) and PySpin.IsWritable(node)):
+            return False
+        entry = node.GetEntryByName(entry_name)
+        if not (entry and PySpin.IsAvailable(entry)):
+            return False
+        node.SetIntValue(entry.GetValue())
+        return True
+
+    def _set_rgb8(self, nodemap) -> None:
+        if self._set_enum(nodemap, "PixelFormat", "RGB8"):
+            self.logger.info(
+                "Set camera to RGB8 format - using built-in color processing"
+            )
+
+    def arm(self) -> bool:
+        """Keep acquisition running and take frames on a software trigger.
+
+        An armed camera skips BeginAcquisition/EndAcquisition for every frame.
+        Each capture fires the trigger, so the frame is exposed after the call
+        and never comes from the buffer of an earlier scene.
+
+        Returns:
+            bool: True if the camera is armed
+        """
+        if not PYSPIN_AVAILABLE or not self.is_connected():
+            return False
+        if self.armed:
+            return True
+        try:
+            nodemap = self.camera.GetNodeMap()
+            self._set_rgb8(nodemap)
+            self._set_enum(nodemap, "AcquisitionMode", "Continuous")
+            # The trigger source can only be changed while the trigger is off
+            self._set_enum(nodemap, "TriggerMode", "Off")
+            if not self._set_enum(nodemap, "TriggerSource", "Software"):
+                return False
+            self._set_enum(nodemap, "TriggerMode", "On")
+            self._set_enum(
+                self.camera.GetTLStreamNodeMap(), "StreamBufferHandlingMode", "NewestOnly"
+            )
+            self.camera.BeginAcquisition()
+            self.armed = True
+            self.logger.info("FLIR camera armed for software triggered capture")
+            return True
+        except PySpin.SpinnakerException as ex:
+            self.logger.warning(f"Could not arm FLIR camera: {ex}")
+            return False
+
+    def disarm(self) -> None:
+        """Stop the running acquisition and turn the trigger off"""
+        if not self.armed:
+            return
+        self.armed = False
+        try:
+            self.camera.EndAcquisition()
+            self._set_enum(self.camera.GetNodeMap(), "TriggerMode", "Off")
+        except PySpin.SpinnakerException as ex:
+            self.logger.warning(f"Error disarming FLIR camera: {ex}")
+
+    def _capture_armed(self) -> Optional[np.ndarray]:
+        trigger = PySpin.CCommandPtr(self.camera.GetNodeMap().GetNode("TriggerSoftware"))
+        trigger.Execute()
+        image_result = self.camera.GetNextImage(1000)
+        try:
+            if image_result.IsIncomplete():
+                self.logger.error(
+                    f"Image incomplete with status {image_result.GetImageStatus()}"
+                )
+                return None
+            return image_result.GetNDArray().copy()
+        finally:
+            image_result.Release()
+
     def capture_image(self) -> Optional[np.ndarray]:
         """Capture a single image from the FLIR camera using RGB8 color processing"""
         if not PYSPIN_AVAILABLE or not self.is_connected():
             self.logger.error("Cannot capture image: Camera not connected")
             return None
 
+        if self.armed:
+            try:
+                return self._capture_armed()
+            except PySpin.SpinnakerException as ex:
+                self.logger.error(f"Error capturing armed image from FLIR camera: {ex}")
+                self.disarm()
+                return None
+
         try:
             nodemap = self.camera.GetNodeMap()
-            pixel_format = PySpin.CEnumerationPtr(nodemap.GetNode("PixelFormat"))
-            if PySpin.IsAvailable(pixel_format) and PySpin.IsWritable(pixel_format):
-                rgb8_entry = pixel_format.GetEntryByName("RGB8")
-                if rgb8_entry and PySpin.IsAvailable(rgb8_entry):
-                    pixel_format.SetIntValue(rgb8_entry.GetValue())
-                    self.logger.info(
-                        "Set camera to RGB8 format - using built-in color processing"
-                    )
+            self._set_rgb8(nodemap)
 
             self.camera.BeginAcquisition()
             image_result = self.camera.GetNextImage(1000)
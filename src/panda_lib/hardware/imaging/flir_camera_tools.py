@@ -5,6 +5,7 @@ This script is used to capture images from the FLIR camera.
 
 import logging
 from pathlib import Path
+from typing import Collection
 
 from panda_shared.log_tools import setup_default_logger
 
@@ -16,10 +17,10 @@ logger = setup_default_logger(
 )
 
 
-def file_enumeration(file_path: Path) -> Path:
-    """Enumerate a file path if it already exists"""
+def file_enumeration(file_path: Path, taken: Collection[Path] = ()) -> Path:
+    """Enumerate a file path if it already exists or is one of the taken paths"""
     i = 1
-    while file_path.exists():
+    while file_path.exists() or file_path in taken:
         file_path = file_path.with_name(
             file_path.stem + "_" + str(i) + file_path.suffix
         )
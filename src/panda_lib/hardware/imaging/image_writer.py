@@ -0,0 +1,201 @@
+"""
+Background encoding and annotation of captured frames.
+
+Saving a frame as TIFF and rendering its data-zone copy take longer than the
+exposure itself. The ImageWriter takes frames that are already in memory and
+does that work on a small thread pool, so the gantry can move on as soon as the
+capture returns::
+
+    frame = toolkit.camera_session.capture()
+    toolkit.arduino.lights_off()
+    toolkit.image_writer.submit(
+        frame, path, toolkit.camera_session, experiment=experiment,
+        context=label, add_datazone=True,
+    )
+    ...
+    toolkit.image_writer.drain()  # before the experiment results are saved
+
+Saved paths are recorded in ``experiment.results`` by the writer once the file
+is on disk, so a frame that fails to save is never listed.
+"""
+
+import logging
+import threading
+from concurrent.futures import Future, ThreadPoolExecutor, wait
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Any, Callable, List, Optional, Set, Union
+
+from .camera_session import CameraSession
+from .flir_camera_tools import file_enumeration
+from .panda_image_tools import add_data_zone
+
+
+@dataclass
+class ImageWriteResult:
+    """The outcome of one submitted frame.
+
+    Attributes:
+        path (Path): Where the frame was saved.
+        ok (bool): Whether the frame was saved.
+        datazone_path (Path): The annotated copy, if one was requested and saved.
+        error (Exception): What went wrong, if anything.
+    """
+
+    path: Path
+    ok: bool
+    datazone_path: Optional[Path] = None
+    error: Optional[BaseException] = None
+
+
+class ImageWriter:
+    """Saves and annotates captured frames on background threads.
+
+    Args:
+        max_workers (int): Frames encoded at the same time.
+        annotate (Callable): Renders the data zone, called like add_data_zone.
+    """
+
+    def __init__(
+        self,
+        max_workers: int = 2,
+        logger: Optional[logging.Logger] = None,
+        annotate: Callable = add_data_zone,
+    ):
+        self.logger = logger or logging.getLogger("panda")
+        self.annotate = annotate
+        self._pool = ThreadPoolExecutor(
+            max_workers=max_workers, thread_name_prefix="image-writer"
+        )
+        self._pending: List[Future] = []
+        # Names handed out to frames that are not on disk yet
+        self._reserved: Set[Path] = set()
+        self._lock = threading.Lock()
+
+    def __enter__(self) -> "ImageWriter":
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback) -> None:
+        self.shutdown()
+
+    def submit(
+        self,
+        frame: Any,
+        path: Union[str, Path],
+        session: CameraSession,
+        experiment: Optional[object] = None,
+        context: Optional[str] = None,
+        add_datazone: bool = False,
+    ) -> Future:
+        """
+        Queue a frame to be saved.
+
+        The file name is enumerated now and held until the frame is written,
+        so frames submitted back to back never claim the same name.
+
+        Args:
+            frame: The frame as returned by session.capture().
+            path: Where to save the frame.
+            session: The session that captured the frame, used to encode it.
+            experiment: The experiment whose results record the saved paths.
+            context: The image context recorded with the paths.
+            add_datazone: Also save a copy with the data zone banner.
+
+        Returns:
+            Future: Resolves to an ImageWriteResult.
+        """
+        with self._lock:
+            path = file_enumeration(Path(path), taken=self._reserved)
+            self._reserved.add(path)
+            future = self._pool.submit(
+                self._write, frame, path, session, experiment, context, add_datazone
+            )
+            self._pending = [f for f in self._pending if not f.done()]
+            self._pending.append(future)
+        return future
+
+    def drain(self, timeout: Optional[float] = None) -> List[ImageWriteResult]:
+        """
+        Wait for every submitted frame to be written.
+
+        Returns:
+            List[ImageWriteResult]: The results of the frames that were pending.
+
+        Raises:
+            TimeoutError: If the frames were not written in time.
+        """
+        with self._lock:
+            pending, self._pending = self._pending, []
+        done, not_done = wait(pending, timeout=timeout)
+        if not_done:
+            with self._lock:
+                self._pending = list(not_done) + self._pending
+            raise TimeoutError(
+                f"{len(not_done)} images still being written after {timeout} s"
+            )
+        return [future.result() for future in pending]
+
+    def shutdown(self) -> None:
+        """Write the pending frames and stop the pool"""
+        self.drain()
+        self._pool.shutdown(wait=True)
+
+    def _write(
+        self,
+        frame: Any,
+        path: Path,
+        session: CameraSession,
+        experiment: Optional[object],
+        context: Optional[str],
+        add_datazone: bool,
+    ) -> ImageWriteResult:
+        try:
+            return self._save(frame, path, session, experiment, context, add_datazone)
+        finally:
+            with self._lock:
+                self._reserved.discard(path)
+
+    def _save(
+        self,
+        frame: Any,
+        path: Path,
+        session: CameraSession,
+        experiment: Optional[object],
+        context: Optional[str],
+        add_datazone: bool,
+    ) -> ImageWriteResult:
+        try:
+            ok = session.camera.save_image(frame, path)
+        except Exception as error:  # pylint: disable=broad-except
+            self.logger.error("Failed to save image %s: %s", path, error)
+            return ImageWriteResult(path, False, error=error)
+        if not ok:
+            self.logger.error("Failed to save image %s", path)
+            return ImageWriteResult(path, False)
+        self.logger.debug("Image saved to %s", path)
+
+        result = ImageWriteResult(path, True)
+        if add_datazone:
+            datazone_path = path.with_name(path.stem + "_dz" + path.suffix)
+            try:
+                image = self.annotate(
+                    experiment=experiment,
+                    image=session.to_image(frame),
+                    context=context,
+                )
+                image.save(datazone_path)
+                result.datazone_path = datazone_path
+            except Exception as error:  # pylint: disable=broad-except
+                # The raw frame is saved, only the annotated copy is missing
+                self.logger.error(
+                    "Failed to add data zone to %s: %s", path, error
+                )
+                result.error = error
+
+        if experiment is not None:
+            if result.datazone_path is not None:
+                experiment.results.append_image_file(
+                    result.datazone_path, context=f"{context}_dz"
+                )
+            experiment.results.append_image_file(path, context=context)
+        return result
@@ -13,6 +13,9 @@ class CameraInterface(ABC):
     Both OpenCVCamera and FlirCamera should implement this interface.
     """
 
+    # Channel order of the frames capture_image returns
+    color_order = "RGB"
+
     @abstractmethod
     def connect(self) -> bool:
         """
@@ -15,6 +15,8 @@ from .interface import CameraInterface
 class OpenCVCamera(CameraInterface):
     """Class for controlling webcams using OpenCV"""
 
+    color_order = "BGR"
+
     def __init__(self, camera_id: int = 0, resolution: Tuple[int, int] = (1280, 720)):
         """Initialize the OpenCV camera.
 
@@ -150,6 +152,8 @@ class OpenCVCamera(CameraInterface):
 class MockOpenCVCamera(CameraInterface):
     """Mock OpenCV camera for testing"""
 
+    color_order = "BGR"
+
     def __init__(self, camera_id: int = 0, resolution: Tuple[int, int] = (1280, 720)):
         """Initialize the mock camera"""
         self.camera_id = camera_id
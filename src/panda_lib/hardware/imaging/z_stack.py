@@ -0,0 +1,226 @@
+"""
+Z-stack acquisition for contact angle curvature imaging.
+
+Imaging a droplet through focus used to be one full cycle per plane: a safe
+move with its status polls, lights on, a camera capture and lights off. A
+ZStackAcquisition instead has the mill sweep every plane as one streamed path
+(see Mill.sweep_z), keeps the lights on for the whole sweep and captures each
+plane through one camera session. Frames are returned in memory, tagged with
+the Z the mill reported when they were taken::
+
+    stack = ZStackAcquisition(toolkit.mill, toolkit.camera_session).acquire(
+        x,
+        y,
+        z_planes(z_start, 0.2, 11),
+        tool=Instruments.LENS,
+        lights_on=toolkit.arduino.ca_lights_on_50,
+        lights_off=toolkit.arduino.lights_off,
+    )
+    for plane in stack:
+        toolkit.image_writer.submit(plane.frame, path_for(plane.target_z), ...)
+"""
+
+import logging
+import threading
+import time
+from dataclasses import dataclass, field
+from typing import Any, Callable, Iterator, List, Optional
+
+from .camera_session import CameraSession
+
+# Seconds the mill holds still at each plane, long enough for one exposure
+DEFAULT_PLANE_DWELL = 0.25
+# Headroom over the slowest plane the host has handled when sizing the dwell
+DWELL_MARGIN = 1.5
+
+
+def z_planes(z_start: float, step: float, count: int) -> List[float]:
+    """count Z coordinates from z_start, step apart, rounded to 0.01 mm"""
+    return [round(z_start + index * step, 2) for index in range(count)]
+
+
+@dataclass
+class ZStackFrame:
+    """One plane of a Z-stack.
+
+    Attributes:
+        index (int): Position of the plane in the sweep.
+        target_z (float): The planned tool Z.
+        measured_z (float): The tool Z the mill reported while the frame was taken.
+        frame (Any): The frame as returned by the camera.
+        captured_at (float): time.monotonic() when the capture returned.
+    """
+
+    index: int
+    target_z: float
+    measured_z: float
+    frame: Any
+    captured_at: float
+
+
+@dataclass
+class ZStack:
+    """The frames of one sweep, in sweep order.
+
+    Attributes:
+        x (float): Tool X of the stack.
+        y (float): Tool Y of the stack.
+        planned (List[float]): Every planned tool Z, including planes not reached.
+        frames (List[ZStackFrame]): The captured planes.
+        missed (List[int]): Indices of planes the mill moved past before they
+            were captured.
+        stopped_early (bool): Whether the sweep ended before the last plane.
+        started_at (float): time.monotonic() when the sweep started.
+        finished_at (float): time.monotonic() when the mill was idle again.
+    """
+
+    x: float
+    y: float
+    planned: List[float]
+    frames: List[ZStackFrame] = field(default_factory=list)
+    missed: List[int] = field(default_factory=list)
+    stopped_early: bool = False
+    started_at: float = 0.0
+    finished_at: float = 0.0
+
+    def __len__(self) -> int:
+        return len(self.frames)
+
+    def __iter__(self) -> Iterator[ZStackFrame]:
+        return iter(self.frames)
+
+    @property
+    def measured_z(self) -> List[float]:
+        return [plane.measured_z for plane in self.frames]
+
+    @property
+    def elapsed(self) -> float:
+        """Seconds from the start of the sweep until the mill was idle again"""
+        return self.finished_at - self.started_at
+
+
+class ZStackAcquisition:
+    """Captures a Z-stack with one streamed sweep and one camera session.
+
+    The dwell is sized once the first plane has been captured: at least
+    dwell, and enough for the slowest plane the host has handled so far,
+    capture and on_frame included. A stack that still misses planes is taken
+    with a longer dwell next time.
+
+    Args:
+        mill: The mill, anything with a Mill.sweep_z.
+        session (CameraSession): An open or openable camera session.
+        dwell (float): Least number of seconds the mill holds still at each plane.
+    """
+
+    def __init__(
+        self,
+        mill,
+        session: CameraSession,
+        dwell: float = DEFAULT_PLANE_DWELL,
+        logger: Optional[logging.Logger] = None,
+    ):
+        self.mill = mill
+        self.session = session
+        self.dwell = dwell
+        self.logger = logger or logging.getLogger("panda")
+        # Seconds the host spent on its slowest plane
+        self.slowest_plane = 0.0
+
+    @property
+    def plane_dwell(self) -> float:
+        """The dwell for the next sweep"""
+        return max(self.dwell, self.slowest_plane * DWELL_MARGIN)
+
+    def acquire(
+        self,
+        x: float,
+        y: float,
+        planes: List[float],
+        tool: str = "center",
+        lights_on: Optional[Callable[[], bool]] = None,
+        lights_off: Optional[Callable[[], Any]] = None,
+        on_frame: Optional[Callable[[ZStackFrame], bool]] = None,
+    ) -> ZStack:
+        """
+        Sweep the tool through planes and capture one frame at each.
+
+        Args:
+            x (float): Tool X.
+            y (float): Tool Y.
+            planes (List[float]): Tool Z of each plane, in sweep order.
+            tool (str): The tool the planes refer to, normally the lens.
+            lights_on (Callable): Turns the lights on once the first plane is
+                reached, returns success.
+            lights_off (Callable): Turns the lights off after the sweep.
+            on_frame (Callable): Called with each captured plane; returning
+                True ends the sweep after that plane.
+
+        Returns:
+            ZStack: The captured planes. Planes whose capture failed or that
+                were missed are left out.
+        """
+        stack = ZStack(x=x, y=y, planned=list(planes), started_at=time.monotonic())
+        cancel = threading.Event()
+        sweep = self.mill.sweep_z(
+            x,
+            y,
+            list(planes),
+            tool=tool,
+            dwell=lambda: self.plane_dwell,
+            cancel=cancel,
+        )
+        lit = False
+        try:
+            if not self.session.open():
+                raise RuntimeError("Camera session could not be opened")
+            for index, position in enumerate(sweep):
+                if position is None:
+                    stack.missed.append(index)
+                    continue
+                if not lit and lights_on is not None:
+                    if not lights_on():
+                        self.logger.warning("Failed to turn on the z-stack lights")
+                    lit = True
+                reached = time.monotonic()
+                frame = self.session.capture()
+                if frame is None:
+                    self.logger.error(
+                        "Failed to capture plane %s at Z=%.3f", index, position.z
+                    )
+                    self._time_plane(reached)
+                    continue
+                plane = ZStackFrame(
+                    index=index,
+                    target_z=planes[index],
+                    measured_z=position.z,
+                    frame=frame,
+                    captured_at=time.monotonic(),
+                )
+                stack.frames.append(plane)
+                stop = on_frame is not None and on_frame(plane)
+                self._time_plane(reached)
+                if stop:
+                    stack.stopped_early = index < len(planes) - 1
+                    cancel.set()
+        finally:
+            sweep.close()
+            if lit and lights_off is not None:
+                lights_off()
+            stack.finished_at = time.monotonic()
+        if stack.missed:
+            self.logger.warning(
+                "Missed planes %s, the next sweep dwells %.3f s per plane",
+                stack.missed,
+                self.plane_dwell,
+            )
+        self.logger.debug(
+            "Captured %s of %s planes in %.2f s",
+            len(stack),
+            len(planes),
+            stack.elapsed,
+        )
+        return stack
+
+    def _time_plane(self, reached: float):
+        self.slowest_plane = max(self.slowest_plane, time.monotonic() - reached)
@@ -0,0 +1,231 @@
+"""
+Concurrent bring-up of the instruments.
+
+Connecting the mill (with homing), the camera, the Arduino and the pipette one
+after another makes every restart pay the sum of their startup times. Most of
+them do not depend on each other, so start_instruments runs each
+DeviceStartup on its own thread as soon as the devices it depends on are
+ready:
+
+- a device that fails is retried on its own up to `attempts` times;
+- a failure only holds back the devices that depend on it;
+- the StartupReport records readiness, attempts and timing for each device.
+
+Example::
+
+    steps = [
+        DeviceStartup("mill", connect_mill),
+        DeviceStartup("arduino", connect_arduino),
+        DeviceStartup("pipette", connect_pipette, depends_on=("arduino",)),
+    ]
+    devices, report = start_instruments(steps)
+    devices["pipette"]  # connect_pipette(arduino=devices["arduino"])
+"""
+
+import logging
+import time
+from concurrent.futures import FIRST_COMPLETED, Future, ThreadPoolExecutor, wait
+from dataclasses import dataclass, field
+from typing import Any, Callable, Dict, List, Optional, Sequence, Tuple
+
+logger = logging.getLogger("panda")
+
+
+@dataclass
+class DeviceStartup:
+    """
+    How to bring up one device.
+
+    Attributes:
+        name: Device name, used in the report and as the keyword for dependents
+        connect: Returns the ready device, or raises / returns None on failure.
+            It is called with the devices it depends on as keyword arguments.
+        depends_on: Names of devices that must be ready first
+        attempts: Total tries before the device is reported as not ready
+        retry_delay: Seconds to wait between tries
+        required: Whether the startup fails when this device is not ready
+    """
+
+    name: str
+    connect: Callable[..., Any]
+    depends_on: Tuple[str, ...] = ()
+    attempts: int = 1
+    retry_delay: float = 1.0
+    required: bool = True
+
+
+@dataclass
+class DeviceReport:
+    """Readiness and timing of one device"""
+
+    name: str
+    required: bool = True
+    ready: bool = False
+    attempts: int = 0
+    started: Optional[float] = None  # seconds after startup began
+    seconds: float = 0.0
+    error: Optional[str] = None
+
+
+@dataclass
+class StartupReport:
+    """Readiness and timing of a startup"""
+
+    devices: Dict[str, DeviceReport] = field(default_factory=dict)
+    wall_seconds: float = 0.0
+
+    @property
+    def all_ready(self) -> bool:
+        """Whether every required device is ready"""
+        return all(device.ready for device in self.devices.values() if device.required)
+
+    @property
+    def serial_seconds(self) -> float:
+        """Time the same startup would take one device after another"""
+        return sum(device.seconds for device in self.devices.values())
+
+    def not_ready(self) -> List[str]:
+        """Names of the required devices that are not ready"""
+        return [
+            name
+            for name, device in self.devices.items()
+            if device.required and not device.ready
+        ]
+
+    def summary(self) -> str:
+        lines = [f"{'device':<12}{'ready':<7}{'tries':>5}{'start s':>9}{'took s':>8}"]
+        for device in self.devices.values():
+            started = "-" if device.started is None else f"{device.started:.1f}"
+            ready = "yes" if device.ready else ("NO" if device.required else "no")
+            line = (
+                f"{device.name:<12}{ready:<7}"
+                f"{device.attempts:>5}{started:>9}{device.seconds:>8.1f}"
+            )
+            if device.error:
+                line += f"  {device.error}"
+            lines.append(line)
+        lines.append(
+            f"Instruments up in {self.wall_seconds:.1f} s "
+            f"({self.serial_seconds:.1f} s one after another)"
+        )
+        return "\n".join(lines)
+
+
+def _run_step(
+    step: DeviceStartup,
+    report: DeviceReport,
+    dependencies: Dict[str, Any],
+    t0: float,
+) -> Any:
+    """Try the step up to step.attempts times, filling in report"""
+    report.started = time.monotonic() - t0
+    start = time.monotonic()
+    try:
+        for attempt in range(1, max(step.attempts, 1) + 1):
+            report.attempts = attempt
+            try:
+                device = step.connect(**dependencies)
+                if device is None:
+                    raise RuntimeError("connect returned nothing")
+                report.ready = True
+                report.error = None
+                return device
+            except Exception as error:
+                report.error = f"{type(error).__name__}: {error}"
+                logger.warning(
+                    "%s not ready (attempt %d/%d): %s",
+                    step.name,
+                    attempt,
+                    step.attempts,
+                    error,
+                )
+                if attempt < step.attempts:
+                    time.sleep(step.retry_delay)
+        return None
+    finally:
+        report.seconds = time.monotonic() - start
+
+
+def start_instruments(
+    steps: Sequence[DeviceStartup],
+    max_workers: Optional[int] = None,
+    log: logging.Logger = logger,
+) -> Tuple[Dict[str, Any], StartupReport]:
+    """
+    Bring up the devices concurrently, each once its dependencies are ready.
+
+    Args:
+        steps: One DeviceStartup per device
+        max_workers: Threads to use, one per device by default
+        log: Logger for the per-device readiness lines and the summary
+
+    Returns:
+        (devices, report): devices maps each name to its device, None if not ready
+    """
+    by_name = {step.name: step for step in steps}
+    if len(by_name) != len(steps):
+        raise ValueError("Device names must be unique")
+    for step in steps:
+        unknown = set(step.depends_on) - set(by_name)
+        if unknown:
+            raise ValueError(f"{step.name} depends on unknown devices {unknown}")
+
+    report = StartupReport(
+        {step.name: DeviceReport(step.name, step.required) for step in steps}
+    )
+    devices: Dict[str, Any] = {}
+    pending = list(steps)
+    running: Dict[Future, DeviceStartup] = {}
+    t0 = time.monotonic()
+
+    with ThreadPoolExecutor(
+        max_workers=max_workers or max(len(steps), 1),
+        thread_name_prefix="startup",
+    ) as pool:
+        while pending or running:
+            progressed = True
+            while progressed:
+                progressed = False
+                for step in list(pending):
+                    failed = [
+                        d
+                        for d in step.depends_on
+                        if d in devices and devices[d] is None
+                    ]
+                    if failed:
+                        pending.remove(step)
+                        devices[step.name] = None
+                        skipped = report.devices[step.name]
+                        skipped.error = f"skipped, {', '.join(failed)} not ready"
+                        log.error("%s not started: %s not ready", step.name, failed)
+                        progressed = True
+                    elif all(d in devices for d in step.depends_on):
+                        pending.remove(step)
+                        dependencies = {d: devices[d] for d in step.depends_on}
+                        future = pool.submit(
+                            _run_step, step, report.devices[step.name], dependencies, t0
+                        )
+                        running[future] = step
+            if not running:
+                if pending:
+                    names = [step.name for step in pending]
+                    raise ValueError(f"Circular device dependencies among {names}")
+                break
+            done, _ = wait(running, return_when=FIRST_COMPLETED)
+            for future in done:
+                step = running.pop(future)
+                devices[step.name] = future.result()
+                device_report = report.devices[step.name]
+                if device_report.ready:
+                    log.info("%s ready in %.1f s", step.name, device_report.seconds)
+                else:
+                    log.error(
+                        "%s not ready after %d attempt(s): %s",
+                        step.name,
+                        device_report.attempts,
+                        device_report.error,
+                    )
+
+    report.wall_seconds = time.monotonic() - t0
+    log.info("Instrument startup:\n%s", report.summary())
+    return devices, report
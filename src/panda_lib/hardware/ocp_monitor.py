@@ -0,0 +1,122 @@
+"""
+Streaming pass/fail rules for open circuit potential runs.
+
+The potentiostat drivers call an `on_sample(time, voltage)` callback for each
+OCP sample as it is acquired. When the callback returns True the driver stops
+the run and saves what it has. OCPMonitor is that callback: it feeds each
+sample to a set of OCPRules and aborts on the first rule that trips, so a
+shorted or out-of-solution electrode is caught in the first second rather
+than after the full OCP duration.
+"""
+
+import logging
+import math
+from dataclasses import dataclass
+from typing import Callable, Optional, Sequence
+
+logger = logging.getLogger("panda")
+
+# (time [s], voltage [V]) -> True to abort the run
+SampleCallback = Callable[[float, float], bool]
+
+
+@dataclass(frozen=True)
+class OCPRule:
+    """
+    Abort when |voltage| stays below `below` or above `above` for `hold` seconds.
+
+    Attributes:
+        name: Reason reported when the rule trips
+        below: Trip while |voltage| is below this (V)
+        above: Trip while |voltage| is above this (V)
+        hold: Seconds of instrument time the condition must hold
+        min_samples: Consecutive samples the condition must hold
+        within: Only evaluate samples up to this time (s), None for the whole run
+    """
+
+    name: str
+    below: Optional[float] = None
+    above: Optional[float] = None
+    hold: float = 0.5
+    min_samples: int = 3
+    within: Optional[float] = None
+
+    def violated_by(self, voltage: float) -> bool:
+        magnitude = abs(voltage)
+        if self.below is not None and magnitude < self.below:
+            return True
+        return self.above is not None and magnitude > self.above
+
+
+# Both faults show from the first sample. Later in a run a solution can
+# legitimately settle near 0 V or drift above 1 V, which the end of run
+# range check judges instead.
+# The counter electrode touching the working electrode reads about 0 V
+SHORTED = OCPRule("shorted", below=0.01, within=1.5)
+# An electrode out of solution floats above 1 V
+OUT_OF_SOLUTION = OCPRule("out of solution", above=1.0, within=1.5)
+
+DEFAULT_OCP_RULES = (SHORTED, OUT_OF_SOLUTION)
+
+
+class OCPMonitor:
+    """
+    Evaluates OCPRules on streamed samples, usable as a driver's on_sample callback.
+
+    Attributes:
+        aborted: Whether a rule tripped
+        reason: Name of the rule that tripped
+        abort_time: Instrument time of the sample that tripped it
+        last_time: Instrument time of the last sample seen
+        last_voltage: Last voltage seen
+        n_samples: Samples seen
+    """
+
+    def __init__(self, rules: Sequence[OCPRule] = DEFAULT_OCP_RULES):
+        self.rules = tuple(rules)
+        self.reset()
+
+    def reset(self) -> None:
+        self.aborted = False
+        self.reason: Optional[str] = None
+        self.abort_time: Optional[float] = None
+        self.last_time: Optional[float] = None
+        self.last_voltage: Optional[float] = None
+        self.n_samples = 0
+        # per rule: start time and sample count of the current violating run
+        self._streak_start = [None] * len(self.rules)
+        self._streak_count = [0] * len(self.rules)
+
+    def __call__(self, time: float, voltage: float) -> bool:
+        """Take one sample, returns True once the run should be aborted"""
+        if self.aborted:
+            return True
+        time, voltage = float(time), float(voltage)
+        if not (math.isfinite(time) and math.isfinite(voltage)):
+            return False
+        self.n_samples += 1
+        self.last_time = time
+        self.last_voltage = voltage
+
+        for i, rule in enumerate(self.rules):
+            if rule.within is not None and time > rule.within:
+                continue
+            if not rule.violated_by(voltage):
+                self._streak_start[i] = None
+                self._streak_count[i] = 0
+                continue
+            if self._streak_start[i] is None:
+                self._streak_start[i] = time
+            self._streak_count[i] += 1
+            if (
+                self._streak_count[i] >= rule.min_samples
+                and time - self._streak_start[i] >= rule.hold
+            ):
+                self.aborted = True
+                self.reason = rule.name
+                self.abort_time = time
+                logger.warning(
+                    "OCP aborted at %.2f s: %s (%.4f V)", time, rule.name, voltage
+                )
+                return True
+        return False
@@ -0,0 +1,224 @@
+"""
+Columnar storage and loading for potentiostat data files.
+
+OCP, CA and CV runs are saved as space- or comma-separated text. Those files
+stay the record of the run, but re-parsing them on every analysis is slow. Next
+to each `<run>.txt` a `<run>.npy` sidecar holds the same rows as a structured
+float64 array, one named field per column. NumPy can memory-map it, so loading
+a run is a plain read with no text parsing.
+
+`load_echem_data` is the one reader for these files:
+1. If a sidecar at least as new as the text file exists, it is memory-mapped
+2. Otherwise the text is parsed once with the C parser, and the sidecar is
+   written so the next load takes step 1
+"""
+
+import io
+import logging
+import os
+from pathlib import Path
+from typing import Dict, List, Optional, Sequence, Union
+
+import numpy as np
+import pandas as pd
+
+logger = logging.getLogger("panda")
+
+SIDECAR_SUFFIX = ".npy"
+
+# Column layouts of the Gamry text files, which the EmStat writer mirrors
+ECHEM_COLUMNS: Dict[str, List[str]] = {
+    "OCP": ["Time", "Vf", "Vu", "Vsig", "Ach", "Overload", "StopTest", "Temp"],
+    "CA": ["Time", "Vf", "Vu", "Im", "Q", "Vsig", "Ach", "IERange", "Over", "StopTest"],
+    "CV": [
+        "Time",
+        "Vf",
+        "Vu",
+        "Im",
+        "Vsig",
+        "Ach",
+        "IERange",
+        "Overload",
+        "StopTest",
+        "Cycle",
+        "Ach2",
+    ],
+}
+
+PathLike = Union[str, Path]
+
+
+def sidecar_path(filename: PathLike) -> Path:
+    """The columnar sidecar of a text data file"""
+    return Path(filename).with_suffix(SIDECAR_SUFFIX)
+
+
+def _column_names(width: int, kind: Optional[str]) -> List[str]:
+    """Names for `width` columns, taken from the kind's layout and padded with colN"""
+    names = list(ECHEM_COLUMNS.get(kind, [])) if kind else []
+    names = names[:width]
+    names += [f"col{i}" for i in range(len(names), width)]
+    return names
+
+
+def to_columnar(data: pd.DataFrame) -> np.ndarray:
+    """Convert a frame to a structured float64 array; non-numeric values become NaN"""
+    numeric = data.apply(pd.to_numeric, errors="coerce")
+    dtype = np.dtype([(str(name), np.float64) for name in numeric.columns])
+    array = np.empty(len(numeric), dtype=dtype)
+    for name in numeric.columns:
+        array[str(name)] = numeric[name].to_numpy(dtype=np.float64, na_value=np.nan)
+    return array
+
+
+def write_columnar(
+    filename: PathLike, data: pd.DataFrame, kind: Optional[str] = None
+) -> Path:
+    """
+    Write the sidecar for a text data file.
+
+    The file is written under a temporary name and moved into place, so a
+    reader never sees a partial sidecar.
+
+    Args:
+        filename: The text data file (its suffix is replaced)
+        data: The rows that were written to the text file
+        kind: "OCP", "CA" or "CV" to name positional columns by that layout,
+            otherwise they are named colN
+
+    Returns:
+        Path of the sidecar
+    """
+    data = data.copy(deep=False)
+    if all(isinstance(c, (int, np.integer)) for c in data.columns):
+        data.columns = _column_names(data.shape[1], kind)
+    return _save_array(filename, to_columnar(data))
+
+
+def _save_array(filename: PathLike, array: np.ndarray) -> Path:
+    path = sidecar_path(filename)
+    tmp_path = path.with_name(path.name + ".tmp")
+    with open(tmp_path, "wb") as f:
+        np.save(f, array, allow_pickle=False)
+    os.replace(tmp_path, path)
+    return path
+
+
+def _parse_text(filename: PathLike, kind: Optional[str]) -> pd.DataFrame:
+    """Parse a space- or comma-separated data file with '#' comments"""
+    raw = Path(filename).read_bytes().replace(b",", b" ")
+    lines = raw.splitlines()
+    # rows share one width, so the first and last lines are enough to size the frame
+    sample = [line.split(b"#", 1)[0].split() for line in lines[:50] + lines[-50:]]
+    width = max((len(tokens) for tokens in sample), default=0)
+    if width == 0:
+        return pd.DataFrame(columns=_column_names(0, kind), dtype=np.float64)
+    names = _column_names(width, kind)
+    data = pd.read_csv(
+        io.BytesIO(raw),
+        sep=r"\s+",
+        header=None,
+        names=names,
+        comment="#",
+        skip_blank_lines=True,
+    )
+    # only columns holding header or status text need coercing
+    for name in data.select_dtypes(include="object").columns:
+        data[name] = pd.to_numeric(data[name], errors="coerce")
+    data = data.astype(np.float64)
+    # header or status lines have no numeric first column
+    return data.dropna(subset=[names[0]]).reset_index(drop=True)
+
+
+def _with_kind(array: np.ndarray, kind: Optional[str]) -> np.ndarray:
+    """View the array with positional colN fields named by the kind's layout"""
+    names = list(array.dtype.names)
+    if not kind or not any(name.startswith("col") for name in names):
+        return array
+    layout = _column_names(len(names), kind)
+    renamed = [
+        layout[i] if name == f"col{i}" and layout[i] not in names else name
+        for i, name in enumerate(names)
+    ]
+    fields = array.dtype.fields
+    dtype = np.dtype(
+        {
+            "names": renamed,
+            "formats": [fields[name][0] for name in names],
+            "offsets": [fields[name][1] for name in names],
+            "itemsize": array.dtype.itemsize,
+        }
+    )
+    return array.view(dtype)
+
+
+def _sidecar_is_current(filename: Path, sidecar: Path) -> bool:
+    if not sidecar.exists():
+        return False
+    if not filename.exists():
+        return True
+    return sidecar.stat().st_mtime >= filename.stat().st_mtime
+
+
+def load_echem_array(
+    filename: PathLike, kind: Optional[str] = None, write_sidecar: bool = True
+) -> np.ndarray:
+    """
+    Load a data file as a structured float64 array, one field per column.
+
+    Args:
+        filename: The text data file (or its sidecar)
+        kind: "OCP", "CA" or "CV" to name the text file's columns
+        write_sidecar: Write the sidecar when the text had to be parsed
+
+    Returns:
+        The rows, memory-mapped read-only when read from the sidecar
+    """
+    filename = Path(filename)
+    if filename.suffix == SIDECAR_SUFFIX:
+        filename = filename.with_suffix(".txt")
+    sidecar = sidecar_path(filename)
+    if _sidecar_is_current(filename, sidecar):
+        try:
+            array = np.load(sidecar, mmap_mode="r", allow_pickle=False)
+            return _with_kind(array, kind)
+        except (OSError, ValueError) as error:
+            logger.warning("Ignoring unreadable sidecar %s: %s", sidecar, error)
+
+    array = to_columnar(_parse_text(filename, kind))
+    if write_sidecar:
+        try:
+            _save_array(filename, array)
+        except OSError as error:
+            logger.debug("Could not write sidecar for %s: %s", filename, error)
+    return array
+
+
+def load_echem_data(
+    filename: PathLike,
+    kind: Optional[str] = None,
+    columns: Optional[Sequence[str]] = None,
+    write_sidecar: bool = True,
+) -> pd.DataFrame:
+    """
+    Load a potentiostat data file as a float64 DataFrame.
+
+    Args:
+        filename: The text data file
+        kind: "OCP", "CA" or "CV" to name the text file's columns
+        columns: Only load these columns
+        write_sidecar: Write the sidecar when the text had to be parsed
+
+    Returns:
+        One float64 column per data column with a RangeIndex
+
+    Raises:
+        FileNotFoundError: Neither the text file nor its sidecar exist
+        KeyError: A requested column is not in the file
+    """
+    array = load_echem_array(filename, kind, write_sidecar)
+    names = list(columns) if columns is not None else list(array.dtype.names)
+    missing = [name for name in names if name not in array.dtype.names]
+    if missing:
+        raise KeyError(f"Columns {missing} not in {filename}")
+    return pd.DataFrame({name: np.array(array[name]) for name in names})
@@ -15,6 +15,7 @@ from .schemas import (
     WellWriteModel,
 )
 from .services import VialService, WellplateService, WellService
+from .state_store import LabwareStateStore, flush_labware_state, get_labware_store
 from .vials import StockVial, Vial, WasteVial, read_vials
 from .wellplates import Well, Wellplate
 from .tipracks import Tip, Rack
@@ -28,6 +29,9 @@ __all__ = [
     "VialService",
     "WellService",
     "WellplateService",
+    "LabwareStateStore",
+    "flush_labware_state",
+    "get_labware_store",
     "DeckObjectModel",
     "VesselModel",
     "VialWriteModel",
@@ -21,3 +21,15 @@ class OverDraftException(Exception):
         self.volume = volume
         self.added_volume = added_volume
         self.capacity = capacity
+
+
+class LabwareWriteError(Exception):
+    """Raised by a flush when a queued labware write could not be saved"""
+
+    def __init__(self, key, error) -> None:
+        super().__init__(self)
+        self.key = key
+        self.error = error
+
+    def __str__(self) -> str:
+        return f"LabwareWriteError: saving {self.key} failed: {self.error}"
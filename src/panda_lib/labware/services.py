@@ -1,5 +1,5 @@
 import logging
-from typing import List, Optional, Tuple
+from typing import Dict, List, Optional, Tuple
 from datetime import datetime, timezone
 from sqlalchemy import select, update, delete, func, text, Integer, cast
 from sqlalchemy.sql import func
@@ -851,6 +851,72 @@ class WellService:
                 active_db_session.rollback()
                 raise ValueError(f"Error updating well: {e}")
 
+    def create_wells(self, wells_data: List[WellWriteModel]) -> List[WellReadModel]:
+        """Create several wells of one plate in one transaction"""
+        if not wells_data:
+            return []
+        with self.session_maker() as active_db_session:
+            active_db_session: Session
+            try:
+                wells = [WellDBModel(**well.model_dump()) for well in wells_data]
+                active_db_session.add_all(wells)
+                active_db_session.commit()
+            except SQLAlchemyError as e:
+                active_db_session.rollback()
+                raise ValueError(f"Error creating wells: {e}")
+        return self.get_wells(
+            wells_data[0].plate_id, [well.well_id for well in wells_data]
+        )
+
+    def get_wells(
+        self, plate_id: int, well_ids: Optional[List[str]] = None
+    ) -> List[WellReadModel]:
+        """Read the wells of a plate, or only the given wells, in one query"""
+        with self.session_maker() as active_db_session:
+            stmt = select(WellDBModel).filter_by(plate_id=plate_id)
+            if well_ids is not None:
+                stmt = stmt.where(WellDBModel.well_id.in_(well_ids))
+            wells = active_db_session.execute(stmt).scalars().all()
+            return [WellReadModel.model_validate(well) for well in wells]
+
+    def update_wells(
+        self, plate_id: int, updates: Dict[str, dict]
+    ) -> List[WellReadModel]:
+        """
+        Write the changes of several wells in one transaction.
+
+        Args:
+            plate_id (int): The plate the wells belong to.
+            updates (Dict[str, dict]): The new well data keyed by well id.
+
+        Returns:
+            List[WellReadModel]: The updated wells, read back in one query.
+        """
+        if not updates:
+            return []
+        with self.session_maker() as active_db_session:
+            try:
+                stmt = select(WellDBModel).where(
+                    WellDBModel.plate_id == plate_id,
+                    WellDBModel.well_id.in_(list(updates)),
+                )
+                wells = {
+                    well.well_id: well
+                    for well in active_db_session.execute(stmt).scalars().all()
+                }
+                missing = set(updates) - set(wells)
+                if missing:
+                    raise ValueError(f"Wells {sorted(missing)} not found.")
+                for well_id, well_updates in updates.items():
+                    updated_model = WellWriteModel(**well_updates).model_dump()
+                    for key, value in updated_model.items():
+                        setattr(wells[well_id], key, value)
+                active_db_session.commit()
+            except SQLAlchemyError as e:
+                active_db_session.rollback()
+                raise ValueError(f"Error updating wells: {e}")
+        return self.get_wells(plate_id, list(updates))
+
     def delete_well(self, well_id: str) -> None:
         with self.session_maker() as active_db_session:
             try:
@@ -0,0 +1,310 @@
+"""
+In-process labware state with write-behind persistence.
+
+Vial and Well save themselves after every volume change, and Well.save() reads
+the row back, so each pipetting repetition waits on several database
+round-trips. When the store is enabled ([OPTIONS] labware_write_behind) it
+becomes the authoritative copy of the labware state for this process:
+
+- reads of a vial or well are served from memory once it has been loaded,
+  including vial lookups by name;
+- saves update memory immediately and are written to the database by a
+  background thread, in the order they were made. Saves are full snapshots, so
+  a vessel that changes again before its write starts is only written once
+  with its latest state;
+- every save is appended to a journal file before it is queued and marked done
+  once written. On start up, saves that never reached the database are
+  replayed from the journal;
+- flush() waits until every queued save is written, and is called at
+  experiment boundaries.
+
+The generated height columns (top, bottom, volume_height) are recomputed in
+memory with the same formulas the database uses.
+"""
+
+import json
+import logging
+import os
+import threading
+import time
+from collections import OrderedDict
+from pathlib import Path
+from typing import Callable, Dict, Optional, Tuple
+
+from pydantic import BaseModel
+
+from panda_shared.config.config_tools import get_config_boolean, read_config_value
+from panda_shared.db_setup import SessionLocal
+
+from .errors import LabwareWriteError
+from .services import VialService, WellService
+
+logger = logging.getLogger("panda")
+
+# The factor the generated columns in sql_tools.models use for pi
+AREA_FACTOR = 3.1459
+WRITE_RETRIES = 3
+
+StateKey = Tuple
+
+_store: Optional["LabwareStateStore"] = None
+_store_lock = threading.Lock()
+
+
+def vial_key(position: str) -> StateKey:
+    return ("vial", position)
+
+
+def well_key(plate_id: int, well_id: str) -> StateKey:
+    return ("well", plate_id, well_id)
+
+
+def refresh_generated_heights(model: BaseModel) -> None:
+    """Recompute top, bottom and volume_height like the database does"""
+    z = (model.coordinates or {}).get("z") or 0.0
+    area = AREA_FACTOR * model.radius * model.radius
+    model.top = round(z + model.base_thickness + model.height, 2)
+    model.bottom = round(z + model.base_thickness + model.dead_volume / area, 2)
+    model.volume_height = round(z + model.base_thickness + model.volume / area, 2)
+
+
+class LabwareStateStore:
+    """
+    Authoritative in-memory labware state with ordered write-behind saves.
+
+    Args:
+        writers: One function per key kind ("vial", "well") that writes a
+            snapshot to the database, called as writer(key, data).
+        journal_path: Where to journal queued saves, or None for no journal.
+    """
+
+    def __init__(
+        self,
+        writers: Dict[str, Callable[[StateKey, dict], None]],
+        journal_path: Optional[Path] = None,
+    ):
+        self.writers = writers
+        self.journal_path = Path(journal_path) if journal_path else None
+        self._cache: Dict[StateKey, BaseModel] = {}
+        self._pending: "OrderedDict[StateKey, Tuple[int, dict]]" = OrderedDict()
+        self._in_flight: Optional[StateKey] = None
+        self._error: Optional[LabwareWriteError] = None
+        self._failed: Dict[StateKey, int] = {}
+        self._sequence = 0
+        self._condition = threading.Condition()
+        self._journal_lock = threading.Lock()
+        self._running = True
+        self._thread = threading.Thread(
+            target=self._write_loop, name="labware-write-behind", daemon=True
+        )
+        self._thread.start()
+
+    # region Cache
+    def get(self, key: StateKey) -> Optional[BaseModel]:
+        """A copy of the cached state, or None if the vessel was never loaded"""
+        with self._condition:
+            model = self._cache.get(key)
+            return model.model_copy(deep=True) if model is not None else None
+
+    def find(self, kind: str, **fields) -> Optional[BaseModel]:
+        """A copy of the first cached vessel of a kind whose fields all match, or None"""
+        with self._condition:
+            for key, model in self._cache.items():
+                if key[0] == kind and all(
+                    getattr(model, name, None) == value
+                    for name, value in fields.items()
+                ):
+                    return model.model_copy(deep=True)
+        return None
+
+    def cache(self, key: StateKey, model: BaseModel) -> None:
+        """Remember state read from the database"""
+        with self._condition:
+            if key not in self._pending and key != self._in_flight:
+                self._cache[key] = model.model_copy(deep=True)
+
+    def invalidate(self, key: Optional[StateKey] = None) -> None:
+        """Forget one cached vessel, or all of them, so the next read hits the database"""
+        with self._condition:
+            if key is None:
+                self._cache.clear()
+            else:
+                self._cache.pop(key, None)
+
+    # endregion
+
+    def save(self, key: StateKey, model: BaseModel) -> None:
+        """
+        Update the in-memory state and queue the write.
+
+        The model's generated heights are refreshed in place so the caller sees
+        the same values it would after reloading from the database.
+        """
+        refresh_generated_heights(model)
+        data = model.model_dump(mode="json")
+        with self._condition:
+            self._sequence += 1
+            sequence = self._sequence
+            self._cache[key] = model.model_copy(deep=True)
+            self._journal({"seq": sequence, "key": list(key), "data": data})
+            # A vessel already queued keeps its place, but only its latest state is written
+            self._pending[key] = (sequence, data)
+            self._condition.notify_all()
+
+    def flush(self, timeout: Optional[float] = None) -> None:
+        """
+        Wait until every queued save has been written.
+
+        Raises:
+            LabwareWriteError: If a save failed since the last flush.
+            TimeoutError: If the saves did not finish in time.
+        """
+        with self._condition:
+            if not self._condition.wait_for(
+                lambda: not self._pending and self._in_flight is None, timeout
+            ):
+                raise TimeoutError(
+                    f"{len(self._pending)} labware saves still queued after {timeout} s"
+                )
+            error, self._error = self._error, None
+            # Failed saves stay in the journal until the vessel is saved again
+            if not self._failed:
+                self._truncate_journal()
+        if error is not None:
+            raise error
+
+    def close(self) -> None:
+        """Flush the queued saves and stop the writer thread"""
+        try:
+            self.flush()
+        finally:
+            with self._condition:
+                self._running = False
+                self._condition.notify_all()
+            self._thread.join(timeout=5)
+
+    def replay(self) -> int:
+        """
+        Write the saves the journal holds that never reached the database.
+
+        Returns:
+            int: The number of vessels restored.
+        """
+        if self.journal_path is None or not self.journal_path.exists():
+            return 0
+        latest: Dict[StateKey, dict] = {}
+        done = set()
+        with open(self.journal_path, encoding="utf-8") as journal:
+            for line in journal:
+                try:
+                    record = json.loads(line)
+                except json.JSONDecodeError:
+                    continue  # A line cut short by a crash
+                if "done" in record:
+                    done.add(record["done"])
+                else:
+                    latest[tuple(record["key"])] = record
+
+        restored = 0
+        for key, record in sorted(latest.items(), key=lambda item: item[1]["seq"]):
+            if record["seq"] in done:
+                continue
+            logger.warning("Restoring unsaved labware state for %s", key)
+            self.writers[key[0]](key, record["data"])
+            restored += 1
+        with self._condition:
+            self._truncate_journal()
+        return restored
+
+    def _write_loop(self):
+        while True:
+            with self._condition:
+                self._condition.wait_for(lambda: self._pending or not self._running)
+                if not self._pending:
+                    return
+                key, (sequence, data) = self._pending.popitem(last=False)
+                self._in_flight = key
+
+            error = None
+            for attempt in range(WRITE_RETRIES):
+                try:
+                    self.writers[key[0]](key, data)
+                    error = None
+                    break
+                except Exception as exc:  # pylint: disable=broad-except
+                    error = exc
+                    logger.warning(
+                        "Saving %s failed (attempt %d): %s", key, attempt + 1, exc
+                    )
+                    time.sleep(0.1 * (attempt + 1))
+
+            with self._condition:
+                if error is None:
+                    self._journal({"done": sequence})
+                    self._failed.pop(key, None)
+                else:
+                    # Left undone in the journal so it is replayed on restart
+                    logger.error("Saving %s failed: %s", key, error)
+                    self._failed[key] = sequence
+                    if self._error is None:
+                        self._error = LabwareWriteError(key, error)
+                self._in_flight = None
+                self._condition.notify_all()
+
+    def _journal(self, record: dict) -> None:
+        if self.journal_path is None:
+            return
+        with self._journal_lock:
+            with open(self.journal_path, "a", encoding="utf-8") as journal:
+                journal.write(json.dumps(record) + "\n")
+                journal.flush()
+                os.fsync(journal.fileno())
+
+    def _truncate_journal(self) -> None:
+        if self.journal_path is None:
+            return
+        with self._journal_lock:
+            self.journal_path.parent.mkdir(parents=True, exist_ok=True)
+            open(self.journal_path, "w", encoding="utf-8").close()
+
+
+def _database_writers(session_maker=SessionLocal):
+    vials = VialService(session_maker)
+    wells = WellService(session_maker)
+    return {
+        "vial": lambda key, data: vials.update_vial(key[1], data),
+        "well": lambda key, data: wells.update_well(key[2], key[1], data),
+    }
+
+
+def get_labware_store() -> Optional[LabwareStateStore]:
+    """The process wide store, or None when write-behind is disabled"""
+    global _store
+    if _store is not None:
+        return _store
+    if not get_config_boolean("OPTIONS", "labware_write_behind", default=False):
+        return None
+    with _store_lock:
+        if _store is None:
+            journal = read_config_value(
+                "OPTIONS", "labware_journal", "labware_journal.jsonl"
+            )
+            store = LabwareStateStore(_database_writers(), Path(journal))
+            store.replay()
+            _store = store
+    return _store
+
+
+def flush_labware_state(timeout: Optional[float] = None) -> None:
+    """Wait for queued labware saves, a no-op when write-behind is disabled"""
+    if _store is not None:
+        _store.flush(timeout)
+
+
+def close_labware_store() -> None:
+    """Flush and stop the process wide store"""
+    global _store
+    with _store_lock:
+        store, _store = _store, None
+    if store is not None:
+        store.close()
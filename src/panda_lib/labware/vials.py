@@ -15,6 +15,7 @@ from panda_shared.log_tools import setup_default_logger
 from .errors import OverDraftException, OverFillException  # Custom exceptions
 from .schemas import VialReadModel, VialWriteModel  # Pydantic models
 from .services import VialService
+from .state_store import get_labware_store, vial_key
 
 vial_logger = setup_default_logger("vial_logger")
 
@@ -176,14 +177,36 @@ class Vial:
         self.load_vial()
 
     def load_vial(self):
-        """Loads an existing vial from the database."""
+        """Loads an existing vial, from the labware state store when it holds it."""
+        store = get_labware_store()
+        if store is not None:
+            if self._vial_name:
+                cached = store.find("vial", name=self._vial_name, active=1)
+            elif self.position:
+                cached = store.get(vial_key(self.position))
+            else:
+                cached = None
+            if cached is not None:
+                self.vial_data = cached
+                return
+            if self._vial_name:
+                # A queued save may have renamed a vial the database still
+                # holds under this name
+                store.flush()
         if self._vial_name:
             self.vial_data = self.service.get_vial(name=self._vial_name)
         else:
             self.vial_data = self.service.get_vial(position=self.position)
+        if store is not None:
+            store.cache(vial_key(self.vial_data.position), self.vial_data)
 
     def save(self):
         """Updates the database with the current state of the vial."""
+        store = get_labware_store()
+        if store is not None:
+            position = self.position or self.vial_data.position
+            store.save(vial_key(position), self.vial_data)
+            return
         self.service.update_vial(self.position, self.vial_data.model_dump())
 
     def add_contents(self, from_vessel: Dict[str, float], volume: float):
@@ -6,8 +6,10 @@ wellplate and the wells in it.
 
 import json
 import logging
+from collections import OrderedDict
+from contextlib import contextmanager
 from pathlib import Path
-from typing import Optional, Tuple, Union
+from typing import Dict, Iterator, Optional, Tuple, Union
 
 from pydantic import BaseModel
 from sqlalchemy import select
@@ -17,6 +19,7 @@ from sqlalchemy.orm import sessionmaker
 from panda_lib.exceptions import OverFillException
 from panda_lib.hardware.gantry_interface import Coordinates
 from panda_lib.labware.services import WellplateService, WellService, get_unit_id
+from panda_lib.labware.state_store import get_labware_store, well_key
 from panda_lib.sql_tools import (
     ExperimentParameters,
     ExperimentResults,
@@ -86,7 +89,10 @@ class Well:
     kwargs: WellKwargs
         Keyword arguments for making the well
     well_data: Optional[WellReadModel]
-        The well data
+        The well data. When given the well is built from it without a query,
+        e.g. from a bulk read of the whole plate
+    unit_of_work: Optional[WellUnitOfWork]
+        While set, save() hands the well to the unit of work instead of writing
 
     Methods:
     --------
@@ -115,6 +121,7 @@ class Well:
         plate_id: int,
         session_maker: sessionmaker = SessionLocal,
         create_new: bool = False,
+        well_data: Optional[WellReadModel] = None,
         **kwargs: WellKwargs,
     ):
         self.well_id = well_id
@@ -122,9 +129,12 @@ class Well:
         self.session_maker = session_maker
         self.service = WellService(session_maker=session_maker)
         self.well_data: WellReadModel
+        self.unit_of_work: Optional[WellUnitOfWork] = None
 
         if create_new:
             self.create_new_well(**kwargs)
+        elif well_data is not None:
+            self.well_data = well_data
         else:
             self.load_well()
 
@@ -232,13 +242,28 @@ class Well:
         self.load_well()
 
     def load_well(self):
-        """Load the well data from the database"""
+        """Load the well data, from the labware state store when it holds it"""
+        store = get_labware_store()
+        if store is not None:
+            cached = store.get(well_key(self.plate_id, self.well_id))
+            if cached is not None:
+                self.well_data = cached
+                return
         self.well_data: WellReadModel = self.service.get_well(
             self.well_id, self.plate_id
         )
+        if store is not None:
+            store.cache(well_key(self.plate_id, self.well_id), self.well_data)
 
     def save(self):
-        """Save the well data to the database"""
+        """Save the well data to the database, or mark it dirty in the active unit of work"""
+        if self.unit_of_work is not None:
+            self.unit_of_work.register(self)
+            return
+        store = get_labware_store()
+        if store is not None:
+            store.save(well_key(self.plate_id, self.well_id), self.well_data)
+            return
         self.service.update_well(
             self.well_id, self.plate_id, self.well_data.model_dump()
         )
@@ -344,6 +369,55 @@ class Well:
         return f"<Well(well_id={self.well_id}, volume={self.well_data.volume}, contents={self.well_data.contents})>"
 
 
+class WellUnitOfWork:
+    """
+    Collects changed wells and writes them in one transaction.
+
+    Wells register themselves from save() while the unit of work is active.
+    commit() writes every dirty well and reads them back in a single query
+    instead of one update and one re-read per well.
+    """
+
+    def __init__(self, service: WellService, plate_id: int):
+        self.service = service
+        self.plate_id = plate_id
+        self.dirty: Dict[str, Well] = OrderedDict()
+
+    def register(self, well: Well):
+        """Mark a well as changed"""
+        self.dirty[well.well_id] = well
+
+    def commit(self):
+        """Write all dirty wells in one transaction and refresh their data"""
+        if not self.dirty:
+            return
+        store = get_labware_store()
+        if store is not None:
+            # Older write-behind saves must not land on top of this commit
+            store.flush()
+        rows = self.service.update_wells(
+            self.plate_id,
+            {
+                well_id: well.well_data.model_dump()
+                for well_id, well in self.dirty.items()
+            },
+        )
+        for row in rows:
+            self.dirty[row.well_id].well_data = row
+            if store is not None:
+                store.cache(well_key(self.plate_id, row.well_id), row)
+        logger.debug("Saved %d wells in one transaction", len(self.dirty))
+        self.dirty.clear()
+
+    def rollback(self):
+        """Discard the pending changes and restore the stored well data"""
+        if not self.dirty:
+            return
+        for row in self.service.get_wells(self.plate_id, list(self.dirty)):
+            self.dirty[row.well_id].well_data = row
+        self.dirty.clear()
+
+
 class Wellplate:
     def __init__(
         self,
@@ -459,44 +533,106 @@ class Wellplate:
         self.load_wells()
 
     def load_wells(self):
+        """Build every well of the plate from a single query"""
         wells_data = self.service.get_wells(self.plate_data.id)
+        store = get_labware_store()
+        if store is not None:
+            # Wells with saves still queued are newer in memory than in the database
+            for index, well_data in enumerate(wells_data):
+                key = well_key(self.plate_data.id, well_data.well_id)
+                store.cache(key, well_data)
+                wells_data[index] = store.get(key)
         self.wells = {
             well_data.well_id: Well(
                 plate_id=self.plate_data.id,  # TODO: could add assuming the current plate ID
                 well_id=well_data.well_id,
                 session_maker=self.database_session,
+                well_data=well_data,
             )
             for well_data in wells_data
         }
 
+    @contextmanager
+    def unit_of_work(self) -> Iterator[WellUnitOfWork]:
+        """
+        Batch well writes into one transaction.
+
+        Inside the block Well.save() only marks wells as dirty; they are all
+        written when the block exits. If the block raises, the changes are
+        discarded and the wells are reloaded from the database. Nested blocks
+        join the outer unit of work.
+
+        Example::
+
+            with wellplate.unit_of_work():
+                for well in wellplate.wells.values():
+                    well.update_status("new")
+        """
+        active = next(
+            (well.unit_of_work for well in self.wells.values() if well.unit_of_work),
+            None,
+        )
+        if active is not None:
+            yield active
+            return
+
+        unit_of_work = WellUnitOfWork(
+            WellService(session_maker=self.database_session), self.plate_data.id
+        )
+        for well in self.wells.values():
+            well.unit_of_work = unit_of_work
+        try:
+            yield unit_of_work
+        except BaseException:
+            for well in self.wells.values():
+                well.unit_of_work = None
+            unit_of_work.rollback()
+            raise
+        for well in self.wells.values():
+            well.unit_of_work = None
+        unit_of_work.commit()
+
     def save(self):
         self.service.update_plate(self.plate_data.id, self.plate_data.model_dump())
 
     def _create_wells_from_type(self):
-        """Create wells based on the type of wellplate."""
-        wells: dict[str:Well] = {}
+        """Create wells based on the type of wellplate, in one transaction."""
         rows: list = list(self.plate_data.rows)
         cols: range = range(1, int(self.plate_data.cols) + 1)
 
-        for row in rows:
-            for col in cols:
-                coordinates = self.calculate_well_coordinates(row, col)
-                wells[str(row) + str(col)] = Well(
-                    create_new=True,
-                    session_maker=self.database_session,
-                    plate_id=self.plate_data.id,
-                    well_id=f"{row}{col}",
-                    experiment_id=0,
-                    project_id=0,
-                    status="new",
-                    contents={},
-                    volume=0.0,
-                    coordinates=coordinates,
-                    contamination=0,
-                    dead_volume=0.0,
-                    name=f"{self.plate_data.id}_{row}{col}",
-                )
-        return wells
+        new_wells = [
+            WellWriteModel(
+                plate_id=self.plate_data.id,
+                well_id=f"{row}{col}",
+                experiment_id=0,
+                project_id=0,
+                status="new",
+                contents={},
+                volume=0.0,
+                coordinates=self.calculate_well_coordinates(row, col),
+                contamination=0,
+                dead_volume=0.0,
+                name=f"{self.plate_data.id}_{row}{col}",
+                base_thickness=self.plate_type.base_thickness,
+                height=self.plate_type.gasket_height_mm,
+                radius=self.plate_type.radius_mm,
+                capacity=self.plate_type.capacity_ul,
+            )
+            for row in rows
+            for col in cols
+        ]
+        wells_data = WellService(session_maker=self.database_session).create_wells(
+            new_wells
+        )
+        return {
+            well_data.well_id: Well(
+                plate_id=self.plate_data.id,
+                well_id=well_data.well_id,
+                session_maker=self.database_session,
+                well_data=well_data,
+            )
+            for well_data in wells_data
+        }
 
     def update_coordinates(self, new_coordinates: dict):
         self.plate_data.coordinates = new_coordinates
@@ -505,10 +641,11 @@ class Wellplate:
         # self.recalculate_well_positions()
 
     def recalculate_well_positions(self):
-        for well_id, well in self.wells.items():
-            row, col = well_id[0], int(well_id[1:])
-            well.well_data.base_thickness = self.plate_data.base_thickness
-            well.update_coordinates(self.calculate_well_coordinates(row, col))
+        with self.unit_of_work():
+            for well_id, well in self.wells.items():
+                row, col = well_id[0], int(well_id[1:])
+                well.well_data.base_thickness = self.plate_data.base_thickness
+                well.update_coordinates(self.calculate_well_coordinates(row, col))
 
     def calculate_well_coordinates(self, row: str, col: int) -> dict:
         """
@@ -0,0 +1,245 @@
+"""
+Lookahead batching of shared solution dispenses.
+
+The experiment loop runs one experiment at a time, so when consecutive
+experiments draw from the same stock vial the vial is decapped and recapped for
+every pipette load of every experiment. Looking ahead at the next queued
+experiments on the current wellplate lets those dispenses be grouped by
+solution: one decap, an aspirate/dispense cycle per well, one recap.
+
+Only solutions listed with an explicit ``volume`` in ``experiment.solutions``
+are batched. Solutions given only as a concentration are mixed by the protocol
+itself and are left alone.
+
+What a batch dispensed is kept in a PredispenseLedger until the experiment's
+protocol reaches the matching transfer and skips it.
+"""
+
+import logging
+import math
+from collections import OrderedDict
+from dataclasses import dataclass, field
+from typing import Dict, Iterator, List, Optional, Sequence, Tuple
+
+from sqlalchemy import delete, select
+
+from panda_lib.sql_tools.models import PredispensedVolumes
+from panda_shared.db_setup import SessionLocal
+
+logger = logging.getLogger("panda")
+
+# (plate_id, well_id, solution)
+PredispenseKey = Tuple[int, str, str]
+
+# Estimated time for one decap and recap of a stock vial, in seconds: the
+# decapper moves and sensor confirmations in decapping_sequence and
+# capping_sequence
+DECAP_CYCLE_SECONDS = 8.0
+
+
+@dataclass
+class SolutionDispense:
+    """One experiment's dispense of a solution into its well.
+
+    Attributes:
+        experiment_id (int): The experiment the dispense belongs to.
+        well_id (str): The well that receives the solution.
+        volume (float): The volume to dispense in uL.
+    """
+
+    experiment_id: int
+    well_id: str
+    volume: float
+
+
+@dataclass
+class SourceGroup:
+    """The dispenses of one solution, served by a single decap of its vial."""
+
+    solution: str
+    dispenses: List[SolutionDispense] = field(default_factory=list)
+
+    @property
+    def total_volume(self) -> float:
+        """Total volume drawn from the vial in uL"""
+        return sum(dispense.volume for dispense in self.dispenses)
+
+
+@dataclass
+class LookaheadPlan:
+    """Dispenses of the next queued experiments grouped by solution.
+
+    Attributes:
+        experiment_ids (List[int]): The experiments covered, in queue order.
+        groups (Dict[str, SourceGroup]): One group per solution, in first-use order.
+        capacity_ul (float): Pipette capacity, one decap per load when unbatched.
+        decap_seconds (float): Estimated time of one decap and recap.
+    """
+
+    experiment_ids: List[int]
+    groups: Dict[str, SourceGroup]
+    capacity_ul: float
+    decap_seconds: float = DECAP_CYCLE_SECONDS
+
+    @property
+    def unbatched_decaps(self) -> int:
+        """Decaps when every experiment pipettes its own solutions"""
+        return sum(
+            math.ceil(dispense.volume / self.capacity_ul)
+            for group in self.groups.values()
+            for dispense in group.dispenses
+        )
+
+    @property
+    def batched_decaps(self) -> int:
+        """Decaps when each solution is dispensed to all its wells at once"""
+        return len(self.groups)
+
+    @property
+    def decaps_saved(self) -> int:
+        return self.unbatched_decaps - self.batched_decaps
+
+    @property
+    def time_saved(self) -> float:
+        """Estimated time saved in seconds"""
+        return self.decaps_saved * self.decap_seconds
+
+    def summary(self) -> str:
+        """A one line description for the status queue and logs"""
+        return (
+            f"Lookahead over experiments {self.experiment_ids}: "
+            f"{len(self.groups)} shared solutions, "
+            f"{self.batched_decaps} decaps instead of {self.unbatched_decaps}, "
+            f"~{self.time_saved:.0f} s saved"
+        )
+
+
+def plan_lookahead(
+    experiments: Sequence,
+    capacity_ul: float,
+    decap_seconds: float = DECAP_CYCLE_SECONDS,
+    exclude: Optional[Sequence[Tuple[str, str]]] = None,
+    min_dispenses: int = 2,
+) -> LookaheadPlan:
+    """
+    Group the solution dispenses of the given experiments by solution.
+
+    A solution with fewer than min_dispenses dispenses saves nothing by
+    batching, so it is left out of the plan and left to the protocol.
+
+    Args:
+        experiments (Sequence[ExperimentBase]): The next experiments, in queue order.
+        capacity_ul (float): The pipette capacity in uL.
+        decap_seconds (float): Estimated time of one decap and recap.
+        exclude (Sequence[Tuple[str, str]]): (well_id, solution) pairs that were
+            already dispensed by an earlier batch.
+        min_dispenses (int): The fewest dispenses worth batching.
+
+    Returns:
+        LookaheadPlan: The grouped dispenses and the predicted savings.
+    """
+    excluded = set(exclude or ())
+    groups: Dict[str, SourceGroup] = OrderedDict()
+    for experiment in experiments:
+        for name, details in (experiment.solutions or {}).items():
+            volume = details.get("volume") if isinstance(details, dict) else None
+            if not volume or volume <= 0:
+                continue
+            solution = name.lower()
+            if (experiment.well_id, solution) in excluded:
+                continue
+            groups.setdefault(solution, SourceGroup(solution)).dispenses.append(
+                SolutionDispense(experiment.experiment_id, experiment.well_id, volume)
+            )
+
+    plan = LookaheadPlan(
+        experiment_ids=[experiment.experiment_id for experiment in experiments],
+        groups=OrderedDict(
+            (solution, group)
+            for solution, group in groups.items()
+            if len(group.dispenses) >= min_dispenses
+        ),
+        capacity_ul=capacity_ul,
+        decap_seconds=decap_seconds,
+    )
+    logger.debug(plan.summary())
+    return plan
+
+
+class PredispenseLedger:
+    """
+    Volumes a lookahead batch already dispensed, by (plate_id, well_id, solution).
+
+    Every change is written to panda_predispensed and the ledger is read back
+    from there on first use, so a restarted experiment loop still skips the
+    transfers into wells that were dosed before it stopped.
+    """
+
+    def __init__(self, session_maker=SessionLocal):
+        self._session_maker = session_maker
+        self._volumes: Optional[Dict[PredispenseKey, float]] = None
+
+    @property
+    def volumes(self) -> Dict[PredispenseKey, float]:
+        if self._volumes is None:
+            with self._session_maker() as session:
+                self._volumes = {
+                    (row.plate_id, row.well_id, row.solution): row.volume
+                    for row in session.scalars(select(PredispensedVolumes))
+                }
+        return self._volumes
+
+    def __iter__(self) -> Iterator[PredispenseKey]:
+        return iter(list(self.volumes))
+
+    def __len__(self) -> int:
+        return len(self.volumes)
+
+    def __contains__(self, key: PredispenseKey) -> bool:
+        return key in self.volumes
+
+    def record(self, plate_id: int, well_id: str, solution: str, volume: float):
+        """Note that volume uL of solution is now in the well"""
+        key = (plate_id, well_id, solution.lower())
+        with self._session_maker() as session:
+            session.merge(
+                PredispensedVolumes(
+                    plate_id=plate_id, well_id=well_id, solution=key[2], volume=volume
+                )
+            )
+            session.commit()
+        self.volumes[key] = volume
+
+    def take(self, plate_id: int, well_id: str, solution: str, volume: float) -> bool:
+        """Check off a transfer of volume uL, True if the batch already made it"""
+        key = (plate_id, well_id, solution.lower())
+        recorded = self.volumes.get(key)
+        if recorded is None or not math.isclose(recorded, volume):
+            return False
+        self._delete(
+            PredispensedVolumes.plate_id == plate_id,
+            PredispensedVolumes.well_id == well_id,
+            PredispensedVolumes.solution == key[2],
+        )
+        del self.volumes[key]
+        return True
+
+    def forget_well(self, plate_id: int, well_id: str):
+        """Drop the entries of a well whose experiment will not run its transfers"""
+        self._delete(
+            PredispensedVolumes.plate_id == plate_id,
+            PredispensedVolumes.well_id == well_id,
+        )
+        for key in [k for k in self.volumes if k[:2] == (plate_id, well_id)]:
+            del self.volumes[key]
+
+    def keep_plate(self, plate_id: Optional[int]):
+        """Drop the entries of every plate but plate_id, those plates were swapped out"""
+        self._delete(PredispensedVolumes.plate_id != plate_id)
+        for key in [k for k in self.volumes if k[0] != plate_id]:
+            del self.volumes[key]
+
+    def _delete(self, *where):
+        with self._session_maker() as session:
+            session.execute(delete(PredispensedVolumes).where(*where))
+            session.commit()
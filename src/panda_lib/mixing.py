@@ -0,0 +1,187 @@
+"""
+Cached solver for mixing stock vials to a target concentration.
+
+solve_vials_ilp builds a pulp model and runs the external CBC solver for every
+transfer, which costs a few hundred milliseconds per dispense even when one
+vial already holds the target concentration. MixingSolver answers the common
+cases directly and only falls back to the ILP when they do not apply:
+
+- a vial at the target concentration is used on its own;
+- otherwise the target is bracketed by two vials and mixed in closed form,
+  choosing the pair whose smaller draw is largest;
+- anything else (more than two vials needed) goes to solve_vials_ilp.
+
+Results are memoized on the vials' positions and concentrations, the total
+volume and the target, so repeated transfers of the same solution are free.
+"""
+
+import logging
+import math
+from collections import OrderedDict
+from typing import Dict, Hashable, Mapping, Optional, Tuple
+
+from .utilities import solve_vials_ilp
+
+logger = logging.getLogger("panda")
+
+# Per-vial draw limits, matching the bounds in solve_vials_ilp (uL)
+MIN_DRAW_UL = 10.0
+MAX_DRAW_UL = 300.0
+
+# (volume by concentration, deviation, volume by position), all None if unsolvable
+MixResult = Tuple[
+    Optional[Dict[float, float]], Optional[float], Optional[Dict[Hashable, float]]
+]
+
+
+def _same(a: float, b: float) -> bool:
+    return math.isclose(a, b, rel_tol=1e-9, abs_tol=1e-12)
+
+
+def _first_vial_per_concentration(
+    concentrations: Mapping[Hashable, float],
+) -> Dict[float, Hashable]:
+    """{concentration: position}, solve_vials_ilp shares one volume per concentration"""
+    by_conc: Dict[float, Hashable] = {}
+    for position, concentration in concentrations.items():
+        by_conc.setdefault(concentration, position)
+    return by_conc
+
+
+class MixingSolver:
+    """
+    Vial mixing with closed-form fast paths and an LRU cache over the ILP.
+
+    Attributes:
+        hits: Solves answered from the cache
+        fast: Solves answered by the single-vial or two-vial path
+        ilp: Solves that needed solve_vials_ilp
+    """
+
+    def __init__(self, maxsize: int = 256):
+        self.maxsize = maxsize
+        self._cache: "OrderedDict[tuple, MixResult]" = OrderedDict()
+        self.hits = 0
+        self.fast = 0
+        self.ilp = 0
+
+    def clear(self) -> None:
+        self._cache.clear()
+        self.hits = self.fast = self.ilp = 0
+
+    def solve(
+        self,
+        vial_concentration_map: Mapping[Hashable, float],
+        v_total: float,
+        c_target: float,
+    ) -> MixResult:
+        """
+        Volumes to draw from each vial to make v_total at c_target.
+
+        Parameters
+        ----------
+        vial_concentration_map : dict - Concentration of each vial, keyed by position.
+        v_total : float - Total volume to achieve in uL.
+        c_target : float - Target concentration, in the units of the map.
+
+        Returns
+        -------
+        The same (vial_vol_by_conc, deviation, vial_vol_by_location) tuple as
+        solve_vials_ilp. Vials not drawn from get a volume of 0, and of several
+        vials at the same concentration only the first is drawn from.
+        """
+        concentrations = {p: float(c) for p, c in vial_concentration_map.items()}
+        v_total = float(v_total)
+        c_target = float(c_target)
+        key = (tuple(concentrations.items()), v_total, c_target)
+        if key in self._cache:
+            self._cache.move_to_end(key)
+            self.hits += 1
+            return self._copy(self._cache[key])
+
+        result = self._fast_path(concentrations, v_total, c_target)
+        if result is not None:
+            self.fast += 1
+        else:
+            result = self._ilp(concentrations, v_total, c_target)
+            self.ilp += 1
+
+        self._cache[key] = result
+        if len(self._cache) > self.maxsize:
+            self._cache.popitem(last=False)
+        return self._copy(result)
+
+    @staticmethod
+    def _copy(result: MixResult) -> MixResult:
+        by_conc, deviation, by_position = result
+        return (
+            None if by_conc is None else dict(by_conc),
+            deviation,
+            None if by_position is None else dict(by_position),
+        )
+
+    @staticmethod
+    def _fast_path(
+        concentrations: Dict[Hashable, float], v_total: float, c_target: float
+    ) -> Optional[MixResult]:
+        """Single-vial or two-vial answer, None if the ILP is needed"""
+        by_position = {p: 0.0 for p in concentrations}
+
+        matches = [p for p, c in concentrations.items() if _same(c, c_target)]
+        if matches:
+            position = matches[0]
+            by_position[position] = v_total
+            return {concentrations[position]: v_total}, 0.0, by_position
+
+        if len(concentrations) == 1:
+            deviation = abs(next(iter(concentrations.values())) - c_target)
+            return None, deviation, None
+
+        by_conc = _first_vial_per_concentration(concentrations)
+        low = [c for c in by_conc if c < c_target]
+        high = [c for c in by_conc if c > c_target]
+
+        best = None
+        for c_low in low:
+            for c_high in high:
+                v_high = v_total * (c_target - c_low) / (c_high - c_low)
+                v_low = v_total - v_high
+                draws = ((c_low, v_low), (c_high, v_high))
+                if not all(MIN_DRAW_UL <= v <= MAX_DRAW_UL for _, v in draws):
+                    continue
+                if best is None or min(v_low, v_high) > min(v for _, v in best):
+                    best = draws
+        if best is None:
+            return None
+
+        vol_by_conc = {}
+        for c, v in best:
+            vol_by_conc[c] = round(v, 2)
+            by_position[by_conc[c]] = round(v, 2)
+        return vol_by_conc, 0.0, by_position
+
+    @staticmethod
+    def _ilp(
+        concentrations: Dict[Hashable, float], v_total: float, c_target: float
+    ) -> MixResult:
+        """solve_vials_ilp on one vial per distinct concentration"""
+        by_conc = _first_vial_per_concentration(concentrations)
+        vol_by_conc, deviation, solved = solve_vials_ilp(
+            {p: c for c, p in by_conc.items()}, v_total, c_target
+        )
+        if solved is None:
+            return None, None, None
+        by_position = {p: solved.get(p, 0.0) for p in concentrations}
+        return vol_by_conc, deviation, by_position
+
+
+mixing_solver = MixingSolver()
+
+
+def solve_vial_mix(
+    vial_concentration_map: Mapping[Hashable, float],
+    v_total: float,
+    c_target: float,
+) -> MixResult:
+    """MixingSolver.solve on the process-wide solver"""
+    return mixing_solver.solve(vial_concentration_map, v_total, c_target)
@@ -9,13 +9,15 @@ The scheduler module will be responsible for:
 
 import json
 import sqlite3
+import time
+from dataclasses import dataclass, field
+from datetime import datetime
 from pathlib import Path
-from typing import Tuple, Union
+from typing import Dict, List, Set, Tuple, Union
 
 import sqlalchemy.exc
-from sqlalchemy import select, update
+from sqlalchemy import insert, select, update
 
-from panda_lib.experiments.sql_functions import update_experiment_status
 from panda_shared.db_setup import SessionLocal
 from panda_shared.log_tools import setup_default_logger
 
@@ -24,8 +26,8 @@ from .experiments import (
     ExperimentBase,
     ExperimentGenerator,
     ExperimentStatus,
-    insert_experiments,
-    insert_experiments_parameters,
+    experiment_parameter_rows,
+    experiment_rows,
     select_experiment_information,
     select_experiment_parameters,
     select_next_experiment_id,
@@ -35,9 +37,12 @@ from .sql_tools import (
     ExperimentParameters,
     Experiments,
     Projects,
+    WellModel,
     check_if_plate_type_exists,
     get_next_experiment_from_queue,
+    get_next_experiments_from_queue,
     get_well_by_id,
+    notify_queue_changed,
     select_current_wellplate_info,
     select_next_available_well,
     select_well_status,
@@ -145,6 +150,39 @@ def read_next_experiment_from_queue(
     return experiment, filename
 
 
+def read_next_experiments_from_queue(
+    lookahead: int,
+) -> List[Tuple[ExperimentBase, Path]]:
+    """
+    Reads the next experiments from the queue, in the order they will be run.
+
+    Unlike read_next_experiment_from_queue this does not pick randomly, the
+    experiments are returned in queue order so the first one is the one the
+    loop runs next.
+
+    Args:
+        lookahead (int): The maximum number of experiments to read.
+
+    Returns:
+        List[Tuple[ExperimentBase, Path]]: The experiments and their filenames.
+    """
+    try:
+        queue_info = get_next_experiments_from_queue(lookahead)
+    except sqlite3.Error as e:
+        logger.error("Error occurred while reading experiments from queue: %s", e)
+        raise e
+
+    experiments = []
+    for experiment_id, filename, _, well_id in queue_info:
+        experiment = select_experiment_information(experiment_id)
+        experiment.map_parameter_list_to_experiment(
+            select_experiment_parameters(experiment_id)
+        )
+        experiment.well_id = well_id
+        experiments.append((experiment, filename))
+    return experiments
+
+
 def update_experiment_queue_priority(experiment_id: int, priority: int):
     """Update the priority of experiments in the queue"""
     try:
@@ -305,32 +343,131 @@ def assign_well_if_unavailable(experiment: ExperimentBase) -> bool:
     return True
 
 
-def schedule_experiments(
-    experiments: list[
-        Union[ExperimentBase, ExperimentGenerator, EchemExperimentGenerator]
-    ],
-    override: bool = False,
-) -> int:
+@dataclass
+class ScheduleReport:
+    """
+    What a bulk schedule wrote, or would write on a dry run.
+
+    Attributes:
+        requested: Experiments passed in
+        scheduled: (experiment_id, plate_id, well_id) of each queued experiment
+        skipped: (experiment_id, reason) of each experiment left out
+        parameters: Experiment parameter rows written
+        projects: Project ids that were added to the projects table
+        dry_run: True if nothing was written
+        seconds: Wall time to validate, assign and write the batch
     """
-    Schedules a list of experiments by assigning each to a wellplate well. Each experiment is assigned to an available well,
-    validated for plate type, and checked for project ID. If the well is unavailable, the function will request user input
-    unless the override flag is set.
 
-    Args:
-        experiments (list[Union[ExperimentBase, ExperimentGenerator, EchemExperimentGenerator]]):
-            A list of experiments to be added to the queue. Can be base experiment types or generator types.
-        override (bool, optional): If True, overrides the well selection process. Defaults to False.
-    Returns:
-        int: The number of experiments successfully added to the queue.
-    Raises:
-        sqlite3.Error: If an error occurs while inserting experiments or their parameters into the database.
+    requested: int = 0
+    scheduled: List[Tuple[int, int, str]] = field(default_factory=list)
+    skipped: List[Tuple[int, str]] = field(default_factory=list)
+    parameters: int = 0
+    projects: List[int] = field(default_factory=list)
+    dry_run: bool = False
+    seconds: float = 0.0
+
+    @property
+    def experiments_per_second(self) -> float:
+        return len(self.scheduled) / self.seconds if self.seconds > 0 else 0.0
+
+    def skip(self, experiment_id, reason: str) -> None:
+        message = f"Experiment {experiment_id} {reason}, not adding to queue"
+        logger.info(message)
+        print(message)
+        self.skipped.append((experiment_id, reason))
+
+    def summary(self) -> str:
+        return (
+            f"{'Would schedule' if self.dry_run else 'Scheduled'} "
+            f"{len(self.scheduled)} of {self.requested} experiments "
+            f"({self.parameters} parameters) in {self.seconds:.2f} s, "
+            f"{self.experiments_per_second:.1f} experiments/s"
+        )
+
+
+def _well_order(well_id: str) -> tuple:
+    """Row letter then column number, the order select_next_available_well uses"""
+    try:
+        return (well_id[:1], int(well_id[1:]))
+    except ValueError:
+        return (well_id[:1], 0)
+
+
+class WellAllocator:
+    """
+    Hands out 'new' wells for a batch of experiments.
+
+    Each plate's well statuses are read once. Wells handed out are remembered,
+    so two experiments in the same batch never get the same well.
     """
-    if len(experiments) == 0:
-        logger.info("No experiments to add to queue")
-        return 0
 
-    # Convert any generator types to their respective base types
-    converted_experiments = []
+    def __init__(self, session):
+        self.session = session
+        self._status: Dict[int, Dict[str, str]] = {}
+        self._free: Dict[int, List[str]] = {}
+        self._claimed = set()
+
+    def _load(self, plate_id: int) -> Dict[str, str]:
+        if plate_id not in self._status:
+            rows = self.session.execute(
+                select(WellModel.well_id, WellModel.status).where(
+                    WellModel.plate_id == plate_id
+                )
+            ).all()
+            self._status[plate_id] = dict(rows)
+            self._free[plate_id] = sorted(
+                (well for well, status in rows if status == "new"),
+                key=_well_order,
+                reverse=True,
+            )
+        return self._status[plate_id]
+
+    def claim(self, plate_id: int, well_id: str) -> None:
+        self._claimed.add((plate_id, well_id))
+
+    def assign(self, experiment: ExperimentBase) -> bool:
+        """
+        Keep the experiment's well if it is new and unclaimed, otherwise move
+        it to the next free well. Returns False if the plate has none left.
+        """
+        plate_id = experiment.plate_id
+        statuses = self._load(plate_id)
+        if (
+            statuses.get(experiment.well_id) == "new"
+            and (plate_id, experiment.well_id) not in self._claimed
+        ):
+            self.claim(plate_id, experiment.well_id)
+            return True
+
+        free = self._free[plate_id]
+        while free and (plate_id, free[-1]) in self._claimed:
+            free.pop()
+        if not free:
+            logger.info(
+                "No wells available for experiment originally for well %s.",
+                experiment.well_id,
+            )
+            print(
+                f"No wells available for experiment originally for well {experiment.well_id}."
+            )
+            return False
+
+        target_well = free.pop()
+        logger.info(
+            "Experiment originally for well %s is now for well %s.",
+            experiment.well_id,
+            target_well,
+        )
+        experiment.well_id = target_well
+        self.claim(plate_id, target_well)
+        return True
+
+
+def _to_experiment_bases(
+    experiments: list, report: ScheduleReport
+) -> List[ExperimentBase]:
+    """Convert generators to experiments and give id-less ones the next free ids"""
+    valid = []
     for experiment in experiments:
         if not isinstance(experiment, (ExperimentBase, ExperimentGenerator)):
             logger.error(
@@ -338,98 +475,220 @@ def schedule_experiments(
                 str(experiment),
             )
             print(f"Experiment {str(experiment)} is not a valid experiment type")
+            report.skipped.append((None, "is not a valid experiment type"))
             continue
+        valid.append(experiment)
+
+    # One id lookup for the batch, clear of any ids the batch already uses
+    next_id = None
+    if any(experiment.experiment_id is None for experiment in valid):
+        given = [e.experiment_id for e in valid if e.experiment_id is not None]
+        next_id = max([select_next_experiment_id(), *(i + 1 for i in given)])
+
+    converted = []
+    for experiment in valid:
         if experiment.experiment_id is None:
-            experiment.experiment_id = select_next_experiment_id()
+            experiment.experiment_id = next_id
+            next_id += 1
         if isinstance(experiment, EchemExperimentGenerator):
-            converted_experiments.append(experiment.to_echem_experiment_base())
+            converted.append(experiment.to_echem_experiment_base())
         elif isinstance(experiment, ExperimentGenerator):
-            converted_experiments.append(experiment.to_experiment_base())
+            converted.append(experiment.to_experiment_base())
         else:
-            converted_experiments.append(experiment)
+            converted.append(experiment)
+    return converted
 
-    experiments = converted_experiments
 
-    for experiment in experiments:
-        try:
-            override = experiment.override_well_selection
-        except AttributeError:
-            pass
-
-        if not override:
-            ## First check the existing status, if not new or queued, then do not add to queue
-            if experiment.status not in [
-                ExperimentStatus.NEW,
-                ExperimentStatus.QUEUED,
-            ]:
-                message = f"Experiment {experiment.experiment_id} is not new or queued, not adding to queue"
-                logger.info(message)
-                print(message)
-                experiments.remove(experiment)
-
-            if not validate_experiment_plate(experiment):
-                experiments.remove(experiment)
-                continue
-
-            if not assign_well_if_unavailable(experiment):
-                experiments.remove(experiment)
-                continue
-
-        # Check if the project_id is in the projects table, if not add it
-        if not check_project_id(experiment.project_id):
-            add_project_id(experiment.project_id)
-
-        # Data clean the solutions to all be lowercase
-        experiment.solutions = {
-            k.lower().strip(): v for k, v in experiment.solutions.items()
-        }
-
-        # Individually insert the experiment and update the status
-        # We do this so that the wellchecker is checking as the wells are allocated
-        # The parameters are quite lengthy, so we will save those for a bulk entry
+def bulk_schedule_experiments(
+    experiments: list[
+        Union[ExperimentBase, ExperimentGenerator, EchemExperimentGenerator]
+    ],
+    override: bool = False,
+    dry_run: bool = False,
+) -> ScheduleReport:
+    """
+    Validate a batch of experiments, assign their ids and wells, and insert the
+    experiments, their parameters and their well assignments in one transaction.
+
+    Plates, projects, existing experiment ids and well statuses are each read
+    once for the whole batch, and every table is written with a single
+    executemany, so the database is only locked for the final write.
+
+    Args:
+        experiments: The experiments to add to the queue. Can be base
+            experiment types or generator types.
+        override (bool, optional): If True, skips the status, plate and well
+            checks for every experiment, as override_well_selection does for one.
+        dry_run (bool, optional): Validate and assign ids and wells without
+            writing anything. The experiments keep the ids and wells they
+            would be given.
+    Returns:
+        ScheduleReport: What was scheduled and skipped, and the throughput.
+    Raises:
+        sqlite3.Error, sqlalchemy.exc.SQLAlchemyError: If the write fails. The
+            transaction is rolled back and nothing is added to the tables.
+    """
+    start = time.perf_counter()
+    report = ScheduleReport(requested=len(experiments), dry_run=dry_run)
+    if len(experiments) == 0:
+        logger.info("No experiments to add to queue")
+        return report
+
+    batch = _to_experiment_bases(experiments, report)
+    current_plate_id = None
+    plate_checks: Dict[Tuple[int, int], bool] = {}
+    accepted: List[ExperimentBase] = []
+
+    with SessionLocal() as session:
         try:
-            insert_experiments([experiment])
-            update_experiment_status(experiment, ExperimentStatus.QUEUED)
-        except (sqlite3.IntegrityError, sqlalchemy.exc.IntegrityError) as e:
-            if "UNIQUE" in str(e):
-                logger.info(
-                    "Experiment %s already exists in the experiments table, skipping",
-                    experiment.experiment_id,
+            existing = set(
+                session.scalars(
+                    select(Experiments.experiment_id).where(
+                        Experiments.experiment_id.in_(
+                            {experiment.experiment_id for experiment in batch}
+                        )
+                    )
+                )
+            )
+            seen: Set[int] = set()
+            wells = WellAllocator(session)
+
+            for experiment in batch:
+                skip_checks = override or getattr(
+                    experiment, "override_well_selection", False
                 )
-                print(
-                    f"Experiment {experiment.experiment_id} already exists in the experiments table, skipping"
+
+                if experiment.experiment_id in existing:
+                    report.skip(
+                        experiment.experiment_id,
+                        "already exists in the experiments table",
+                    )
+                    continue
+
+                if experiment.experiment_id in seen:
+                    report.skip(
+                        experiment.experiment_id, "duplicate experiment_id in batch"
+                    )
+                    continue
+
+                if experiment.plate_id is None:
+                    if current_plate_id is None:
+                        current_plate_id, _, _ = select_current_wellplate_info()
+                    experiment.plate_id = current_plate_id
+
+                if skip_checks:
+                    wells.claim(experiment.plate_id, experiment.well_id)
+                else:
+                    if experiment.status not in [
+                        ExperimentStatus.NEW,
+                        ExperimentStatus.QUEUED,
+                    ]:
+                        report.skip(experiment.experiment_id, "is not new or queued")
+                        continue
+
+                    plate_key = (experiment.plate_id, experiment.wellplate_type_id)
+                    if plate_key not in plate_checks:
+                        plate_checks[plate_key] = validate_experiment_plate(experiment)
+                    if not plate_checks[plate_key]:
+                        report.skip(experiment.experiment_id, "has no valid plate")
+                        continue
+
+                    if not wells.assign(experiment):
+                        report.skip(experiment.experiment_id, "has no free well")
+                        continue
+
+                # Data clean the solutions to all be lowercase
+                experiment.solutions = {
+                    k.lower().strip(): v for k, v in experiment.solutions.items()
+                }
+                seen.add(experiment.experiment_id)
+                accepted.append(experiment)
+
+            project_ids = {experiment.project_id for experiment in accepted}
+            known_projects = set(
+                session.scalars(select(Projects.id).where(Projects.id.in_(project_ids)))
+            )
+            report.projects = sorted(project_ids - known_projects)
+
+            created = datetime.now().replace(microsecond=0)
+            parameter_rows = experiment_parameter_rows(accepted, created)
+            report.parameters = len(parameter_rows)
+
+            if dry_run or not accepted:
+                session.rollback()
+            else:
+                for experiment in accepted:
+                    experiment.set_status(ExperimentStatus.QUEUED)
+                if report.projects:
+                    session.execute(
+                        insert(Projects), [{"id": p} for p in report.projects]
+                    )
+                session.execute(insert(Experiments), experiment_rows(accepted, created))
+                if parameter_rows:
+                    session.execute(insert(ExperimentParameters), parameter_rows)
+                session.execute(
+                    update(WellModel),
+                    [
+                        {
+                            "plate_id": experiment.plate_id,
+                            "well_id": experiment.well_id,
+                            "status": experiment.status.value,
+                            "status_date": experiment.status_date,
+                            "experiment_id": experiment.experiment_id,
+                            "project_id": experiment.project_id,
+                        }
+                        for experiment in accepted
+                    ],
                 )
-                experiments.remove(experiment)
-                continue
+                session.commit()
 
         except (sqlite3.Error, sqlalchemy.exc.SQLAlchemyError) as e:
+            session.rollback()
             logger.error(
-                "Error occurred while adding the experiment to experiments table: %s. The statements have been rolled back and nothing has been added to the tables.",
+                "Error occurred while scheduling %d experiments: %s. The statements have been rolled back and nothing has been added to the tables.",
+                len(accepted),
                 e,
             )
             print(
                 "The statements have been rolled back and nothing has been added to the tables."
             )
-            experiments.remove(experiment)
-            continue
+            raise e
 
-    # Add the experiment to experiments table
-    try:
-        # Bulk add the experiment parameters to the experiment_parameters table
-        insert_experiments_parameters(experiments)
+    report.scheduled = [
+        (experiment.experiment_id, experiment.plate_id, experiment.well_id)
+        for experiment in accepted
+    ]
+    report.seconds = time.perf_counter() - start
+    logger.info(report.summary())
+    if accepted and not dry_run:
+        notify_queue_changed()
+    return report
 
-    except sqlite3.Error as e:
-        logger.error(
-            "Error occurred while adding the experiment parameters to experiment_parameters table: %s. The statements have been rolled back and nothing has been added to the tables.",
-            e,
-        )
-        print(
-            "The statements have been rolled back and nothing has been added to the tables."
-        )
-        raise e
 
-    logger.info("Experiments loaded and added to queue")
-    return len(experiments)
+def schedule_experiments(
+    experiments: list[
+        Union[ExperimentBase, ExperimentGenerator, EchemExperimentGenerator]
+    ],
+    override: bool = False,
+    dry_run: bool = False,
+) -> int:
+    """
+    Schedules a list of experiments by assigning each to a wellplate well. Each experiment is assigned to an available well,
+    validated for plate type, and checked for project ID. The whole list is written in one transaction by
+    bulk_schedule_experiments.
+
+    Args:
+        experiments (list[Union[ExperimentBase, ExperimentGenerator, EchemExperimentGenerator]]):
+            A list of experiments to be added to the queue. Can be base experiment types or generator types.
+        override (bool, optional): If True, overrides the well selection process. Defaults to False.
+        dry_run (bool, optional): If True, validates and assigns wells without writing anything. Defaults to False.
+    Returns:
+        int: The number of experiments successfully added to the queue, or that would be on a dry run.
+    Raises:
+        sqlite3.Error: If an error occurs while inserting experiments or their parameters into the database.
+    """
+    report = bulk_schedule_experiments(experiments, override=override, dry_run=dry_run)
+    return len(report.scheduled)
 
 
 def check_project_id(project_id: int) -> bool:
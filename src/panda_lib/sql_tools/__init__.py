@@ -30,6 +30,7 @@ from .models import (
     PipetteLog,
     PlateTypes,
     PotentiostatReadout,
+    PredispensedVolumes,
     Projects,
     Protocols,
     Racks,
@@ -49,6 +50,7 @@ from .queries import (
     ProtocolEntry,  # TODO move to types
     # Queue management
     Queue,  # TODO move to types
+    QueueWatcher,
     add_wellplate,
     check_if_current_wellplate_is_new,
     check_if_plate_type_exists,
@@ -64,6 +66,9 @@ from .queries import (
     get_generator_name,
     get_generators,
     get_next_experiment_from_queue,
+    get_next_experiments_from_queue,
+    notify_queue_changed,
+    queue_change_token,
     get_number_of_clear_wells,
     get_number_of_wells,
     get_well_by_experiment_id,
@@ -151,6 +156,7 @@ __all__ = [
     "Wellplates",
     "PlateTypes",
     "PotentiostatReadout",
+    "PredispensedVolumes",
     "SlackTickets",
     "PandaUnits",
     "Pipette",
@@ -261,6 +267,10 @@ __all__ = [
     "Queue",
     "select_queue",
     "get_next_experiment_from_queue",
+    "get_next_experiments_from_queue",
+    "QueueWatcher",
+    "notify_queue_changed",
+    "queue_change_token",
     "count_queue_length",
     # System queries
     "select_system_status",
@@ -30,7 +30,7 @@ from .protocols import Protocols
 
 # from .analyzers import
 from .vials import Vials, VialsBase, VialStatus
-from .wellplates import PlateTypes, WellModel, Wellplates
+from .wellplates import PlateTypes, PredispensedVolumes, WellModel, Wellplates
 from .racks import TipModel, Racks, RackTypes
 
 __all__ = [
@@ -43,6 +43,7 @@ __all__ = [
     "WellModel",
     "Wellplates",
     "PlateTypes",
+    "PredispensedVolumes",
     "ExperimentParameters",
     "ExperimentResults",
     "Experiments",
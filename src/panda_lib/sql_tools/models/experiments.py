@@ -1,7 +1,7 @@
 from datetime import datetime as dt
 from datetime import timezone
 
-from sqlalchemy import Column, ForeignKey
+from sqlalchemy import Column, ForeignKey, Index
 from sqlalchemy.orm import Mapped, mapped_column, relationship
 from sqlalchemy.sql.sqltypes import (
     BigInteger,
@@ -79,6 +79,10 @@ class ExperimentResults(Base):
         String, default=dt.now(timezone.utc), onupdate=dt.now(timezone.utc)
     )
 
+    __table_args__ = (
+        Index("ix_experiment_results_experiment", "experiment_id", "result_type"),
+    )
+
     def __repr__(self):
         return f"<ExperimentResults(id={self.id}, experiment_id={self.experiment_id}, result_type={self.result_type}, result_value={self.result_value}, created={self.created}, updated={self.updated}, context={self.context})>"
 
@@ -98,5 +102,9 @@ class ExperimentParameters(Base):
         String, default=dt.now(timezone.utc), onupdate=dt.now(timezone.utc)
     )
 
+    __table_args__ = (
+        Index("ix_experiment_parameters_experiment", "experiment_id", "parameter_name"),
+    )
+
     def __repr__(self):
         return f"<ExperimentParameters(id={self.id}, experiment_id={self.experiment_id}, parameter_name={self.parameter_name}, parameter_value={self.parameter_value}, created={self.created}, updated={self.updated})>"
@@ -2,7 +2,7 @@ from datetime import datetime as dt
 from datetime import timezone
 
 import sqlalchemy as sa
-from sqlalchemy import Computed, ForeignKey
+from sqlalchemy import Computed, ForeignKey, Index, event
 from sqlalchemy.orm import Mapped, mapped_column
 from sqlalchemy.sql.sqltypes import (
     JSON,
@@ -12,7 +12,7 @@ from sqlalchemy.sql.sqltypes import (
     String,
 )
 
-from .base import Base, DeckObjectBase, JSONEncodedDict, view
+from .base import Base, DeckObjectBase, JSONEncodedDict
 
 
 class VesselBase(DeckObjectBase):
@@ -114,6 +114,11 @@ class Vials(Base):
         Integer, ForeignKey("panda_units.id"), nullable=False
     )
 
+    __table_args__ = (
+        Index("ix_vials_position_updated", "position", "updated"),
+        Index("ix_vials_unit_active", "panda_unit_id", "active", "position"),
+    )
+
     def __repr__(self):
         return f"<Vials(id={self.id}, position={self.position}, contents={self.contents}, viscosity_cp={self.viscosity_cp}, concentration={self.concentration}, density={self.density}, category={self.category}, radius={self.radius}, height={self.height}, name={self.name}, volume={self.volume}, capacity={self.capacity}, contamination={self.contamination}, coordinates={self.coordinates}, updated={self.updated})>"
 
@@ -130,47 +135,38 @@ class Vials(Base):
         return self.coordinates.get("z", 0)
 
 
-_subquery = sa.select(
-    sa.func.row_number()
-    .over(partition_by=Vials.position, order_by=Vials.updated.desc())
-    .label("rn"),
-    Vials,
-).alias("RankedVials")
-
-_vial_status_view = view(
-    "panda_vial_status",
-    Base.metadata,
-    sa.select(
-        _subquery.c.id.label("id"),
-        _subquery.c.position.label("position"),
-        _subquery.c.category.label("category"),
-        _subquery.c.viscosity_cp.label("viscosity_cp"),
-        _subquery.c.concentration.label("concentration"),
-        _subquery.c.density.label("density"),
-        _subquery.c.active.label("active"),
-        _subquery.c.updated.label("updated"),
-        _subquery.c.coordinates.label("coordinates"),
-        _subquery.c.base_thickness.label("base_thickness"),
-        _subquery.c.height.label("height"),
-        _subquery.c.top.label("top"),
-        _subquery.c.bottom.label("bottom"),
-        _subquery.c.name.label("name"),
-        _subquery.c.radius.label("radius"),
-        _subquery.c.volume.label("volume"),
-        _subquery.c.capacity.label("capacity"),
-        _subquery.c.contamination.label("contamination"),
-        _subquery.c.dead_volume.label("dead_volume"),
-        _subquery.c.volume_height.label("volume_height"),
-        _subquery.c.contents.label("contents"),
-        _subquery.c.panda_unit_id.label("panda_unit_id"),
-    ).where(_subquery.c.rn == 1),
-)
-
-
 class VialStatus(Base):
-    """VialStatus view model"""
+    """Current vial at each position: the newest panda_vials row per position.
+
+    A table rather than a view ranking the whole vial history on every read. It
+    is kept up to date whenever the ORM writes panda_vials, see
+    refresh_vial_status for the writes it does not see.
+    """
 
-    __table__ = _vial_status_view
+    __tablename__ = "panda_vial_status"
+    # Lengths as in migration d55e0781076d, MySQL needs them on VARCHAR keys
+    position: Mapped[str] = mapped_column(String(64), primary_key=True)
+    id: Mapped[int] = mapped_column(Integer)
+    category: Mapped[int] = mapped_column(Integer)
+    viscosity_cp: Mapped[float] = mapped_column(Float)
+    concentration: Mapped[float] = mapped_column(Float)
+    density: Mapped[float] = mapped_column(Float)
+    active: Mapped[int] = mapped_column(Integer)
+    updated: Mapped[str] = mapped_column(String(64))
+    coordinates: Mapped[dict] = mapped_column(JSONEncodedDict)
+    base_thickness: Mapped[float] = mapped_column(Float)
+    height: Mapped[float] = mapped_column(Float)
+    top: Mapped[float] = mapped_column(Float)
+    bottom: Mapped[float] = mapped_column(Float)
+    name: Mapped[str] = mapped_column(String(255))
+    radius: Mapped[float] = mapped_column(Float)
+    volume: Mapped[float] = mapped_column(Float)
+    capacity: Mapped[float] = mapped_column(Float)
+    contamination: Mapped[int] = mapped_column(Integer)
+    dead_volume: Mapped[float] = mapped_column(Float)
+    volume_height: Mapped[float] = mapped_column(Float)
+    contents: Mapped[dict] = mapped_column(JSONEncodedDict)
+    panda_unit_id: Mapped[int] = mapped_column(Integer)
 
     def __repr__(self):
         return f"<VialStatus(id={self.id}, position={self.position}, contents={self.contents}, viscosity_cp={self.viscosity_cp}, concentration={self.concentration}, density={self.density}, category={self.category}, radius={self.radius}, height={self.height}, name={self.name}, volume={self.volume}, capacity={self.capacity}, contamination={self.contamination}, coordinates={self.coordinates}, updated={self.updated})>"
@@ -186,3 +182,41 @@ class VialStatus(Base):
     @property
     def z(self):
         return self.coordinates.get("z", 0)
+
+
+def refresh_vial_status(connection: sa.engine.Connection, positions) -> None:
+    """
+    Copy the newest panda_vials row at each position into panda_vial_status.
+
+    The mapper events below call this after every ORM flush of a Vials object.
+    Writes that bypass the unit of work fire no mapper events and leave
+    panda_vial_status stale: Core statements on Vials.__table__, ORM bulk
+    session.execute(update(Vials)) / insert / delete, and raw SQL. Code that
+    writes panda_vials that way must call this with the positions it touched,
+    on the same connection.
+    """
+    source = Vials.__table__
+    status = VialStatus.__table__
+    columns = [column.name for column in status.columns]
+    for position in set(positions):
+        connection.execute(status.delete().where(status.c.position == position))
+        newest = (
+            sa.select(*(source.c[name] for name in columns))
+            .where(source.c.position == position)
+            .order_by(source.c.updated.desc(), source.c.id.desc())
+            .limit(1)
+        )
+        connection.execute(status.insert().from_select(columns, newest))
+
+
+@event.listens_for(Vials, "after_insert")
+@event.listens_for(Vials, "after_delete")
+def _vial_written(mapper, connection, target: Vials) -> None:
+    refresh_vial_status(connection, [target.position])
+
+
+@event.listens_for(Vials, "after_update")
+def _vial_updated(mapper, connection, target: Vials) -> None:
+    # A vial moved to another position also changes its old position
+    moved_from = sa.inspect(target).attrs.position.history.deleted or ()
+    refresh_vial_status(connection, [target.position, *moved_from])
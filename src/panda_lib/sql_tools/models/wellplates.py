@@ -7,7 +7,7 @@ This module contains the SQLAlchemy ORM models for wellplates and wells.
 from datetime import datetime as dt
 from datetime import timezone
 
-from sqlalchemy import Float, ForeignKey, Integer, String
+from sqlalchemy import Float, ForeignKey, Index, Integer, String
 from sqlalchemy.orm import Mapped, mapped_column
 from sqlalchemy.sql.sqltypes import JSON, Boolean
 
@@ -31,10 +31,32 @@ class WellModel(VesselBase, Base):
         String, default=dt.now(timezone.utc), nullable=False
     )
 
+    __table_args__ = (
+        Index("ix_well_hx_experiment", "experiment_id"),
+        Index("ix_well_hx_status", "status", "plate_id"),
+    )
+
     def __repr__(self):
         return f"<WellHx(plate_id={self.plate_id}, well_id={self.well_id}, experiment_id={self.experiment_id}, project_id={self.project_id}, status={self.status}, status_date={self.status_date}, contents={self.contents}, volume={self.volume}, coordinates={self.coordinates}, base_thickness={self.base_thickness}, height={self.height}, radius={self.radius}, capacity={self.capacity}, top={self.top}, bottom={self.bottom}, updated={self.updated})>"
 
 
+class PredispensedVolumes(Base):
+    """Solution a lookahead batch dispensed into a well ahead of its experiment.
+
+    The row is removed when the experiment's protocol reaches the matching
+    transfer, so a restarted loop does not dispense it a second time.
+    """
+
+    __tablename__ = "panda_predispensed"
+    plate_id: Mapped[int] = mapped_column(Integer, primary_key=True)
+    well_id: Mapped[str] = mapped_column(String(8), primary_key=True)
+    solution: Mapped[str] = mapped_column(String(255), primary_key=True)
+    volume: Mapped[float] = mapped_column(Float)
+
+    def __repr__(self):
+        return f"<PredispensedVolumes(plate_id={self.plate_id}, well_id={self.well_id}, solution={self.solution}, volume={self.volume})>"
+
+
 class PlateTypes(Base):
     """PlateTypes table model"""
 
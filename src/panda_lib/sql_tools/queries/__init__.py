@@ -30,8 +30,12 @@ from .protocols import (
 )
 from .queue import (
     Queue,
+    QueueWatcher,
     count_queue_length,
     get_next_experiment_from_queue,
+    get_next_experiments_from_queue,
+    notify_queue_changed,
+    queue_change_token,
     select_queue,
 )
 from .system import select_system_status, set_system_status
@@ -180,5 +184,9 @@ __all__ = [
     "Queue",  # TODO move to types
     "select_queue",
     "get_next_experiment_from_queue",
+    "get_next_experiments_from_queue",
+    "QueueWatcher",
+    "notify_queue_changed",
+    "queue_change_token",
     "count_queue_length",
 ]
@@ -15,9 +15,11 @@ Otherwise the experiment is not in the queue.
 
 # from panda_lib.sql_tools.sql_utilities import execute_sql_command, execute_sql_command_no_return
 import random
-from typing import Optional
+import threading
+import time
+from typing import Callable, Hashable, Optional
 
-from sqlalchemy import and_, select
+from sqlalchemy import and_, func, select
 
 from panda_shared.config.config_tools import get_unit_id
 from panda_shared.db_setup import SessionLocal
@@ -172,6 +174,108 @@ def get_next_experiment_from_queue(
     )
 
 
+def get_next_experiments_from_queue(
+    count: int,
+    project_id: Optional[int] = None,
+) -> list[tuple[int, str, int, str]]:
+    """
+    Reads the next experiments from the queue table in the order they will be run,
+    highest priority (lowest value) first, then lowest experiment id.
+
+    Used to look ahead at upcoming experiments on the current wellplate, for
+    example to batch the solutions they share.
+
+    Args:
+        count (int): The maximum number of experiments to read.
+        project_id (int): Only read experiments of this project.
+
+    Returns:
+        list: (experiment ID, filename, project ID, well ID) for each experiment.
+    """
+    if count <= 0:
+        return []
+    return [
+        (row.experiment_id, row.filename, row.project_id, row.well_id)
+        for row in select_queue(project_id=project_id)[:count]
+    ]
+
+
+# region Queue notifications
+# Set by schedule_experiments so a loop in the same process wakes immediately
+_queue_changed = threading.Event()
+
+
+def notify_queue_changed() -> None:
+    """Wake anything in this process waiting in QueueWatcher.wait"""
+    _queue_changed.set()
+
+
+def queue_change_token() -> tuple:
+    """
+    A cheap fingerprint of the queue and the system status.
+
+    It changes whenever an experiment is queued or leaves the queue, or a new
+    system status (pause, resume, stop) is set, so another process can detect
+    new work with one small aggregate query instead of reading the queue.
+    """
+    from ..models import SystemStatus, WellModel
+
+    with SessionLocal() as session:
+        stmt = select(
+            func.count(WellModel.experiment_id),
+            func.max(WellModel.experiment_id),
+            func.max(WellModel.status_date),
+            select(func.max(SystemStatus.id)).scalar_subquery(),
+        ).where(WellModel.status.in_(["queued", "waiting"]))
+        return tuple(session.execute(stmt).one())
+
+
+class QueueWatcher:
+    """
+    Waits for new work without sleeping through it.
+
+    wait() returns as soon as schedule_experiments runs in this process, or
+    when queue_change_token changes, which is checked every poll_interval
+    seconds to pick up experiments queued by other processes.
+
+    Args:
+        poll_interval (float): Seconds between token checks.
+        token_reader (Callable): Returns the change token.
+    """
+
+    def __init__(
+        self,
+        poll_interval: float = 2.0,
+        token_reader: Callable[[], Hashable] = queue_change_token,
+    ):
+        self.poll_interval = poll_interval
+        self.token_reader = token_reader
+        self._token = token_reader()
+
+    def wait(self, timeout: float) -> bool:
+        """
+        Block until the queue changes or the timeout passes.
+
+        Returns:
+            bool: True if a change was seen, False on timeout.
+        """
+        deadline = time.monotonic() + timeout
+        while True:
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return False
+            if _queue_changed.wait(min(self.poll_interval, remaining)):
+                _queue_changed.clear()
+                self._token = self.token_reader()
+                return True
+            token = self.token_reader()
+            if token != self._token:
+                self._token = token
+                return True
+
+
+# endregion
+
 # def clear_queue() -> None:
 #     """Go through and change the status of any queued experiment to pending"""
 #     # execute_sql_command_no_return(
@@ -2,20 +2,31 @@
 
 import logging
 import os
+import threading
 from dataclasses import dataclass
 from logging import Logger
 from typing import Union
 
+from panda_lib.action_executor import ActionExecutor
 from panda_lib.hardware import ArduinoLink, PandaMill
 from panda_lib.hardware.imaging.camera_factory import CameraFactory, CameraType
+from panda_lib.hardware.imaging.camera_session import CameraSession
+from panda_lib.hardware.imaging.image_writer import ImageWriter
 from panda_lib.hardware.imaging.interface import CameraInterface
+from panda_lib.hardware.instrument_startup import (
+    DeviceStartup,
+    StartupReport,
+    start_instruments,
+)
 from panda_lib.hardware.panda_pipettes import (
     Pipette,
 )
 from panda_lib.labware.vials import StockVial, WasteVial, read_vials
 from panda_lib.labware.wellplates import Wellplate
+from panda_lib.lookahead import PredispenseLedger
 from panda_lib.slack_tools.slackbot_module import SlackBot
 from panda_shared.config.config_tools import (
+    get_config_boolean,
     read_camera_type,
     read_config_value,
     read_webcam_settings,
@@ -45,6 +56,7 @@ class Toolkit:
                 - slack_monitor: The Slack monitor object (SlackBot)
                 - global_logger: The global logger object (Logger)
                 - experiment_logger: The experiment logger object (Logger)
+                - predispensed: The lookahead dispense ledger (PredispenseLedger)
 
         """
         self.camera = kwargs.get("camera", None)
@@ -58,6 +70,15 @@ class Toolkit:
         self.slack_monitor = kwargs.get("slack_monitor", None)
         self.global_logger = kwargs.get("global_logger", None)
         self.experiment_logger = kwargs.get("experiment_logger", None)
+        self._executor: Union[ActionExecutor, None] = None
+        self._camera_session: Union[CameraSession, None] = None
+        self._image_writer: Union[ImageWriter, None] = None
+        # uL already dispensed into wells by a lookahead batch
+        self.predispensed: PredispenseLedger = kwargs.get("predispensed", None)
+        if self.predispensed is None:
+            self.predispensed = PredispenseLedger()
+        # per-device readiness and timing of the last connect_to_instruments
+        self.startup_report: Union[StartupReport, None] = None
 
     mill: Union[PandaMill, None] = None
     # scale: Union[Scale, None] = None
@@ -69,6 +90,29 @@ class Toolkit:
     camera: Union[None, CameraInterface] = None
     slack_monitor: SlackBot = None
 
+    @property
+    def executor(self) -> ActionExecutor:
+        """The shared executor protocols use to overlap steps on different hardware"""
+        if self._executor is None:
+            self._executor = ActionExecutor()
+        return self._executor
+
+    @property
+    def camera_session(self) -> Union[CameraSession, None]:
+        """A session that keeps the camera connected between captures"""
+        if self.camera is None:
+            return None
+        if self._camera_session is None or self._camera_session.camera is not self.camera:
+            self._camera_session = CameraSession(self.camera, self.global_logger)
+        return self._camera_session
+
+    @property
+    def image_writer(self) -> ImageWriter:
+        """Saves and annotates captured frames in the background"""
+        if self._image_writer is None:
+            self._image_writer = ImageWriter(logger=self.global_logger)
+        return self._image_writer
+
     def initialize_camera(self, use_mock=False):
         """Initialize the appropriate camera using the factory"""
         camera_type = read_camera_type().lower()
@@ -97,8 +141,23 @@ class Toolkit:
                 resolution=resolution,
             )
 
+    def drain_executor(self):
+        """Clear a failure an earlier experiment left on the executor, if one was started"""
+        if self._executor is not None:
+            self._executor.drain()
+
+    def shutdown_workers(self):
+        """Finish the queued executor steps and image writes and stop their threads"""
+        if self._executor is not None:
+            self._executor.shutdown(wait=True)
+            self._executor = None
+        if self._image_writer is not None:
+            self._image_writer.shutdown()
+            self._image_writer = None
+
     def disconnect(self):
         """Disconnect from the instruments"""
+        self.shutdown_workers()
         if self.mill:
             self.mill.disconnect()
         # if self.flir_camera: self.flir_camera.DeInit()
@@ -235,36 +294,28 @@ def connect_to_instruments(
 
         return instruments, True
 
-    incomplete = False
     logger.info("Connecting to instruments:")
-    try:
-        logger.debug("Connecting to mill")
-        instruments.mill = PandaMill()
-        instruments.mill.connect_to_mill()
-        instruments.mill.homing_sequence()
-    except Exception as error:
-        logger.error("No mill connected, %s", error)
-        instruments.mill = None
-        # raise error
-        incomplete = True
+    # The mill and the Arduino both probe serial ports when they connect. Only
+    # one probes at a time so neither opens the port the other is claiming;
+    # homing runs outside the lock, alongside the Arduino.
+    port_discovery = threading.Lock()
 
-    # Initialize the camera
-    logger.debug("Connecting to camera")
-    # if instruments.camera is None:
-    #    instruments.initialize_camera(use_mock=False)
-
-    # Connect to the camera
-    if instruments.camera is not None:
-        if instruments.camera.connect():
-            logger.error("Connected to FLIR camera successfully")
-        else:
-            logger.debug("Failed to connect to FLIR camera")
-    else:
-        logger.error("Failed to initialize FLIR camera")
-        incomplete = True
-
-    # Connect to Arduino
-    try:
+    def connect_mill():
+        logger.debug("Connecting to mill")
+        mill = PandaMill()
+        with port_discovery:
+            mill.connect_to_mill()
+        mill.homing_sequence()
+        return mill
+
+    def connect_camera():
+        # Connect to the camera, kept open and armed for the whole run
+        logger.debug("Connecting to camera")
+        if not instruments.camera_session.open():
+            raise RuntimeError("Failed to connect to FLIR camera")
+        return instruments.camera
+
+    def connect_arduino():
         cfg_port = (read_config_value("ARDUINO", "port") or "").strip()
         # try the configured value first; if it's not "auto", also try auto as a fallback
         candidates = [cfg_port] if cfg_port else []
@@ -273,75 +324,54 @@ def connect_to_instruments(
         if not candidates:
             candidates = ["auto"]
 
-        arduino = None
         for cand in candidates:
             try:
                 logger.debug("Connecting to Arduino (port=%r)...", cand)
-                arduino = ArduinoLink(port_address=cand)
+                with port_discovery:
+                    arduino = ArduinoLink(port_address=cand)
                 if arduino.configured:
-                    instruments.arduino = arduino
                     logger.debug("Connected to Arduino on %s", arduino.port_address)
-                    break
+                    if get_config_boolean("ARDUINO", "pipelined", False):
+                        arduino.start_pipeline(
+                            get_config_boolean("ARDUINO", "sequence_tags", False)
+                        )
+                    return arduino
             except Exception as e:
                 logger.warning("Connect failed using %r: %s", cand, e, exc_info=True)
-                arduino = None
-
-        if not arduino or not arduino.configured:
-            logger.error(
-                "No Arduino connected (tried: %s)", ", ".join(map(repr, candidates))
-            )
-            incomplete = True
-            instruments.arduino = None
+        raise RuntimeError(
+            f"No Arduino connected (tried: {', '.join(map(repr, candidates))})"
+        )
 
-    except Exception as error:
-        logger.error("Error connecting to Arduino: %s", error, exc_info=True)
-        incomplete = True
-        instruments.arduino = None
+    # TODO: look into why the pump logic wasn't working, for now....specify pipette directly instead of syringe pump because it wasn't connecting to the pipette
+    def connect_pipette(arduino):
+        # the OT2 stepper is driven through the Arduino
+        pipette = OT2P300(arduino=arduino)
+        if not pipette.get_status():
+            raise RuntimeError("Failed to connect to OT2 Pipette")
+        logger.debug("Connected to OT2 Pipette")
+        return pipette
+
+    steps = [
+        DeviceStartup("mill", connect_mill),
+        DeviceStartup("arduino", connect_arduino),
+        DeviceStartup("pipette", connect_pipette, depends_on=("arduino",), attempts=2),
+    ]
+    if instruments.camera is not None:
+        # a camera that will not open is reported but does not stop the run
+        steps.append(
+            DeviceStartup("camera", connect_camera, attempts=2, required=False)
+        )
+    else:
+        logger.error("Failed to initialize FLIR camera")
 
-    # Connect to the pump or pipette depending on configuration
-    # Check if the config specifies a syringe pump. If not skip the check
-    """
-    syringe_pump = read_config_value("PIPETTE", "PIPETTE_TYPE")
-    pump_port = read_config_value("PUMP", "PORT")
+    # Independent devices come up in parallel, each retried on its own
+    devices, report = start_instruments(steps, log=logger)
+    instruments.mill = devices["mill"]
+    instruments.arduino = devices["arduino"]
+    instruments.pipette = devices["pipette"]
+    instruments.startup_report = report
 
-    if not pump_port:
-        logger.warning(
-            "No pump port specified in the configuration file. Will check for Pipette"
-        )
-        instruments.pipette = None
-        incomplete = True
-    elif syringe_pump in ["OT2", "ot2"]:
-        logger.debug("Connecting to OT2 Pipette")
-        try:
-            if instruments.arduino is None:
-                raise Exception("No Arduino connected")
-            stepper = instruments.arduino
-            instruments.pipette = Pipette.from_config(stepper=stepper)
-            status = instruments.pipette.get_status()
-            if status:
-                logger.debug("Connected to OT2 Pipette")
-            else:
-                raise Exception("Failed to connect to OT2 Pipette")
-        except Exception as error:
-            logger.error("No OT2 Pipette connected, %s", error)
-            instruments.pipette = None
-            incomplete = True
-    """
-    # TODO: look into why the pump logic wasn't working, for now....specify pipette directly instead of syringe pump because it wasn't connecting to the pipette
-    try:
-        if instruments.arduino is None:
-            raise Exception("No Arduino connected")
-        instruments.pipette = OT2P300(arduino=instruments.arduino)
-        status = instruments.pipette.get_status()
-        if status:
-            logger.debug("Connected to OT2 Pipette")
-        else:
-            raise Exception("Failed to connect to OT2 Pipette")
-    except Exception as error:
-        logger.error("No OT2 Pipette connected, %s", error)
-        instruments.pipette = None
-        incomplete = True
-    if incomplete:
+    if not report.all_ready or instruments.camera is None:
         print("Not all instruments connected")
         return instruments, False
 
@@ -660,6 +690,7 @@ def test_instrument_connections(
 
 def disconnect_from_instruments(instruments: Toolkit):
     """Disconnect from the instruments"""
+    instruments.shutdown_workers()
     if instruments.mill:
         instruments.mill.disconnect()
     # if instruments.flir_camera: instruments.flir_camera.DeInit()
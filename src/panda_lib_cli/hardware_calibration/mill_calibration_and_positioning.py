@@ -485,7 +485,7 @@ def calibrate_bottom_of_wellplate(mill: Mill, wellplate: Wellplate, *args, **kwa
         # Step 4: Ask if user wants to test current bottom or specify a new test value
         use_current = (
             input(
-                f"\nDo you want to test the current bottom ({well.bottom})? The pipette tip is currently located at {mill.current_coordinates(tool='pipette').z} (y/n): "
+                f"\nDo you want to test the current bottom ({well.bottom})? The pipette tip is currently located at {mill.current_coordinates(tool='pipette', verify=True).z} (y/n): "
             )
             .lower()
             .strip()
@@ -598,8 +598,8 @@ def calibrate_echem_height(mill: Mill, wellplate: Wellplate, *args, **kwargs):
         f"  - Echem height offset from well bottom: {wellplate.plate_data.echem_height} mm"
     )
     print(f"  - Echem Z-target: {wellplate.echem_height}")
-    print(f"  - RE Z-position:  {mill.current_coordinates('electrode').z}")
-    print(f"  - Mill Z-position:{mill.current_coordinates().z}")
+    print(f"  - RE Z-position:  {mill.current_coordinates('electrode', verify=True).z}")
+    print(f"  - Mill Z-position:{mill.current_coordinates(verify=True).z}")
 
     # Step 4: Optionally test current setting
     check_current = (
@@ -1094,7 +1094,7 @@ def manual_commands(mill: Mill, *args, **kwargs):
                 continue
 
             elif command.lower() == "position":
-                pos = mill.current_coordinates()
+                pos = mill.current_coordinates(verify=True)
                 print(
                     f"Mill position (center): X={pos.x:.3f}, Y={pos.y:.3f}, Z={pos.z:.3f}"
                 )
@@ -1114,7 +1114,9 @@ def manual_commands(mill: Mill, *args, **kwargs):
                 # Process actual GRBL commands
                 # Check if it's a movement command to handle specially
                 # Handle both "G00 X10 Y20" and "G00X10Y20" formats
-                command, coordinates = _parse_gcode(command, mill.current_coordinates())
+                command, coordinates = _parse_gcode(
+                    command, mill.current_coordinates(verify=True)
+                )
 
                 # If we have at least one coordinate, ask about tool selection
                 if coordinates:
@@ -300,19 +300,6 @@ def temp_test_db():
                 WHERE b.current = 1
                 ORDER BY SUBSTRING(a.well_id, 1, 1), CAST(SUBSTRING(a.well_id, 2) AS UNSIGNED);
                 """,
-                "DROP VIEW IF EXISTS panda_vial_status;",
-                """
-                CREATE VIEW panda_vial_status AS
-                WITH RankedVials AS (
-                    SELECT v.*, ROW_NUMBER() OVER (PARTITION BY v.position ORDER BY v.updated DESC, v.id DESC) AS rn
-                    FROM panda_vials v
-                    WHERE v.active = 1
-                )
-                SELECT rv.*
-                FROM RankedVials rv
-                WHERE rv.rn = 1
-                ORDER BY rv.position ASC;
-                """,
                 "DROP VIEW IF EXISTS panda_pipette_status;",
                 """
                 CREATE VIEW panda_pipette_status AS
@@ -515,7 +502,6 @@ def temp_test_db():
                 views = [
                     "panda_queue",
                     "panda_well_status",
-                    "panda_vial_status",
                     "panda_pipette_status",
                 ]
                 for view in views:
@@ -566,6 +552,24 @@ def temp_test_db():
             print("Warning: Failed to delete temp.db after multiple attempts")
 
 
+@pytest.fixture
+def ledger_sessions():
+    """Sessions on an in-memory database holding panda_predispensed"""
+    from sqlalchemy import create_engine
+    from sqlalchemy.orm import sessionmaker
+    from sqlalchemy.pool import StaticPool
+
+    from panda_lib.sql_tools import PredispensedVolumes
+
+    engine = create_engine(
+        "sqlite:///:memory:",
+        connect_args={"check_same_thread": False},
+        poolclass=StaticPool,
+    )
+    PredispensedVolumes.__table__.create(engine)
+    return sessionmaker(bind=engine)
+
+
 @pytest.fixture
 def mock_config():
     """Mock configuration settings."""
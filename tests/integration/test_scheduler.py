@@ -1,9 +1,10 @@
 import pytest
-from sqlalchemy import select, text
+from sqlalchemy import func, select, text
 
 from panda_lib.experiments import ExperimentBase
 from panda_lib.scheduler import (
     add_project_id,
+    bulk_schedule_experiments,
     check_project_id,
     check_well_status,
     choose_next_new_well,
@@ -349,3 +350,94 @@ def test_determine_next_experiment_id(setup_db):
     next_experiment_id = determine_next_experiment_id()
     assert isinstance(next_experiment_id, int)
     assert next_experiment_id > 0
+
+
+def _batch(first_id: int, count: int, well_id: str = "B2") -> list:
+    return [
+        ExperimentBase(
+            experiment_id=first_id + i,
+            project_id=1,
+            project_campaign_id=1,
+            plate_id=1,
+            wellplate_type_id=1,
+            protocol_name=1,
+            analysis_id=1,
+            priority=0,
+            well_id=well_id,
+            filename="test_file",
+            needs_analysis=False,
+            solutions={"EDOT ": {"volume": 100, "concentration": 0.01}},
+        )
+        for i in range(count)
+    ]
+
+
+def test_bulk_schedule_gives_each_experiment_its_own_well(setup_db):
+    """
+    Tests that experiments asking for the same well in one batch get distinct
+    wells, and that the experiments, parameters and wells are all written.
+    """
+    experiments = _batch(500, 5)
+    report = bulk_schedule_experiments(experiments)
+
+    assert [e[0] for e in report.scheduled] == [500, 501, 502, 503, 504]
+    wells = [well_id for _, _, well_id in report.scheduled]
+    assert len(set(wells)) == 5
+    assert report.parameters > 0
+    assert report.experiments_per_second > 0
+
+    with setup_db() as session:
+        assert (
+            session.scalar(
+                select(func.count()).where(Experiments.experiment_id.between(500, 504))
+            )
+            == 5
+        )
+        assert (
+            session.scalar(
+                select(func.count()).where(
+                    ExperimentParameters.experiment_id.between(500, 504)
+                )
+            )
+            == report.parameters
+        )
+        solutions = session.scalar(
+            select(ExperimentParameters.parameter_value).filter_by(
+                experiment_id=500, parameter_name="solutions"
+            )
+        )
+    assert '"edot"' in solutions
+    for experiment_id, plate_id, well_id in report.scheduled:
+        assert check_well_status(well_id, plate_id) == "queued"
+
+
+def test_bulk_schedule_dry_run_writes_nothing(setup_db):
+    """
+    Tests that a dry run plans the batch without touching the database.
+    """
+    experiments = _batch(600, 3, well_id="H1")
+    report = bulk_schedule_experiments(experiments, dry_run=True)
+
+    assert report.dry_run
+    assert len(report.scheduled) == 3
+    assert report.summary().startswith("Would schedule 3 of 3")
+    with setup_db() as session:
+        assert (
+            session.scalar(
+                select(func.count()).where(Experiments.experiment_id.between(600, 602))
+            )
+            == 0
+        )
+    for _, plate_id, well_id in report.scheduled:
+        assert check_well_status(well_id, plate_id) == "new"
+
+
+def test_bulk_schedule_skips_repeated_ids(setup_db):
+    """
+    Tests that an id repeated within a batch is only scheduled once.
+    """
+    experiments = _batch(700, 1) + _batch(700, 1)
+    report = bulk_schedule_experiments(experiments)
+
+    assert len(report.scheduled) == 1
+    assert report.skipped == [(700, "duplicate experiment_id in batch")]
@@ -0,0 +1,106 @@
+import threading
+import time
+from unittest.mock import MagicMock
+
+import pytest
+
+from panda_lib.action_executor import ActionExecutor, ExecutorAborted, Resource
+from panda_lib.toolkit import Toolkit
+
+
+def test_steps_on_different_resources_overlap():
+    with ActionExecutor() as executor:
+        start = time.perf_counter()
+        futures = [
+            executor.submit([Resource.MILL], time.sleep, 0.2),
+            executor.submit([Resource.CAMERA], time.sleep, 0.2),
+            executor.submit(["potentiostat"], time.sleep, 0.2),
+        ]
+        executor.wait(*futures)
+        assert time.perf_counter() - start < 0.4
+
+
+def test_shared_resource_is_exclusive_and_ordered():
+    active = []
+    order = []
+    lock = threading.Lock()
+
+    def step(name):
+        with lock:
+            active.append(name)
+            assert len(active) == 1, f"{active} ran together"
+        time.sleep(0.05)
+        with lock:
+            active.remove(name)
+            order.append(name)
+
+    with ActionExecutor() as executor:
+        futures = [
+            executor.submit([Resource.MILL], step, "travel"),
+            executor.submit([Resource.MILL, Resource.PUMP], step, "rinse"),
+            executor.submit([Resource.PUMP], step, "prime"),
+        ]
+        executor.wait(*futures)
+    assert order == ["travel", "rinse", "prime"]
+
+
+def test_after_waits_for_other_lanes():
+    events = []
+    with ActionExecutor() as executor:
+        capture = executor.submit(
+            [Resource.CAMERA], lambda: (time.sleep(0.1), events.append("capture"))
+        )
+        executor.submit(
+            [Resource.MILL], lambda: events.append("move"), after=[capture]
+        ).result(1)
+    assert events == ["capture", "move"]
+
+
+def test_failure_aborts_pending_steps():
+    def fail():
+        time.sleep(0.05)
+        raise RuntimeError("mill alarm")
+
+    executor = ActionExecutor()
+    failed = executor.submit([Resource.MILL], fail)
+    skipped = executor.submit([Resource.MILL], time.sleep, 0)
+
+    with pytest.raises(RuntimeError):
+        failed.result(1)
+    with pytest.raises(ExecutorAborted):
+        skipped.result(1)
+    assert isinstance(executor.failure, RuntimeError)
+    executor.shutdown()
+
+
+def test_drain_lets_the_next_experiment_run_after_a_failure():
+    def fail():
+        raise RuntimeError("mill alarm")
+
+    with ActionExecutor() as executor:
+        with pytest.raises(RuntimeError):
+            executor.submit([Resource.MILL], fail).result(1)
+        with pytest.raises(ExecutorAborted):
+            executor.submit([Resource.CAMERA], time.sleep, 0).result(1)
+
+        # Next experiment
+        assert isinstance(executor.drain(timeout=1), RuntimeError)
+        assert executor.failure is None
+        assert executor.run([Resource.MILL], lambda: "moved") == "moved"
+
+
+def test_toolkit_only_drains_an_executor_it_started():
+    toolkit = Toolkit(camera=MagicMock())
+    toolkit.drain_executor()
+    assert toolkit._executor is None
+
+    def fail():
+        raise RuntimeError("mill alarm")
+
+    with pytest.raises(RuntimeError):
+        toolkit.executor.submit([Resource.MILL], fail).result(1)
+    toolkit.drain_executor()
+    assert toolkit.executor.failure is None
+
+    toolkit.shutdown_workers()
+    assert toolkit._executor is None
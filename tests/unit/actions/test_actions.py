@@ -5,8 +5,11 @@ from unittest.mock import AsyncMock, MagicMock, patch
 
 import pytest
 
+from panda_lib.actions import pipetting
 from panda_lib.actions.pipetting import (
     _pipette_action,
+    _take_predispensed,
+    batched_transfer,
     volume_correction,
 )
 from panda_lib.actions.vessel_handling import (
@@ -21,7 +24,8 @@ from panda_lib.hardware.panda_pipettes import (
     PipetteDBHandler,
     # PipetteModel,
 )
-from panda_lib.labware import StockVial, Well
+from panda_lib.labware import StockVial, WasteVial, Well
+from panda_lib.lookahead import PredispenseLedger
 
 # from panda_lib.labware.schemas import VialWriteModel, WellWriteModel
 # from panda_lib.sql_tools import Base, Vials, WellModel
@@ -69,14 +73,14 @@ def test_handle_source_vessels(temp_test_db, src_vessel):
     with (
         patch("panda_lib.actions.vessel_handling.read_vials") as mock_read_vials,
         patch(
-            "panda_lib.actions.vessel_handling.solve_vials_ilp"
-        ) as mock_solve_vials_ilp,
+            "panda_lib.actions.vessel_handling.solve_vial_mix"
+        ) as mock_solve_vial_mix,
     ):
         mock_read_vials.return_value = (
             [src_vessel],  # stock vials
             [],  # waste vials
         )
-        mock_solve_vials_ilp.return_value = (
+        mock_solve_vial_mix.return_value = (
             {1.0, 100.0},
             0.0,
             {"s2": 100.0},
@@ -125,6 +129,26 @@ def test_volume_correction():
     assert corrected_volume == 100.0
 
 
+def test_predispensed_is_keyed_by_plate():
+    ledger = MagicMock(spec=PredispenseLedger)
+    ledger.take.return_value = False
+    toolkit = Toolkit(camera=MagicMock(), predispensed=ledger)
+    other_plate = MagicMock(spec=Well, plate_id=124, well_id="B5")
+
+    # The same well on the next plate was never dispensed into
+    assert not _take_predispensed(toolkit, 100.0, "EDOT", other_plate)
+    ledger.take.assert_called_once_with(124, "B5", "EDOT", 100.0)
+
+    ledger.take.return_value = True
+    same_plate = MagicMock(spec=Well, plate_id=123, well_id="B5")
+    assert _take_predispensed(toolkit, 100.0, "EDOT", same_plate)
+
+    # Only wells are predispensed into
+    ledger.take.reset_mock()
+    assert not _take_predispensed(toolkit, 100.0, "EDOT", MagicMock(spec=StockVial))
+    ledger.take.assert_not_called()
+
+
 def test_solution_selector(temp_test_db):
     solution_name = "test_solution"
     volume = 100.0
@@ -143,3 +167,86 @@ def test_waste_selector(temp_test_db):
 
 if __name__ == "__main__":
     pytest.main()
+
+
+def _arrive_at_each(targets, mill, logger, on_arrival=None, travel_height=None):
+    for target in targets:
+        if on_arrival is not None:
+            on_arrival(target)
+
+
+def test_batched_transfer_visits_loads_along_one_plan():
+    toolkit = MagicMock()
+    toolkit.pipette.pipette_tracker.capacity_ul = 200
+    toolkit.mill.max_z_height = 0
+    vial = StockVial("s2")
+    wells = [Well("A1", plate_id=1), Well("A2", plate_id=1)]
+    calls = []
+    toolkit.pipette.aspirate.side_effect = lambda vol, solution: calls.append(
+        ("aspirate", vol)
+    )
+    toolkit.pipette.dispense.side_effect = lambda **kw: calls.append(
+        ("dispense", kw["infused_into"].well_id, kw["volume_to_dispense"])
+    )
+    toolkit.predispensed.record.side_effect = lambda *args: calls.append(
+        ("record", args[1], args[3])
+    )
+
+    with (
+        patch.object(pipetting, "solution_selector", return_value=vial),
+        patch.object(pipetting, "correction_factor", side_effect=lambda v, _: v),
+        patch.object(pipetting, "decapping_sequence"),
+        patch.object(pipetting, "capping_sequence") as capping,
+        patch.object(pipetting.time, "sleep"),
+        patch.object(
+            pipetting, "move_through_targets", side_effect=_arrive_at_each
+        ) as move,
+    ):
+        batched_transfer("water", [(wells[0], 300), (wells[1], 100)], toolkit)
+
+    # A single plan, travelling at max Z since the decapper holds the cap
+    move.assert_called_once()
+    targets = move.call_args.args[0]
+    assert [t.payload for t in targets] == [
+        vial,
+        wells[0],
+        vial,
+        wells[0],
+        vial,
+        wells[1],
+    ]
+    assert move.call_args.kwargs["travel_height"] == 0
+    assert calls == [
+        ("aspirate", 150),
+        ("dispense", "A1", 150),
+        ("aspirate", 150),
+        ("dispense", "A1", 150),
+        ("record", "A1", 300),
+        ("aspirate", 100),
+        ("dispense", "A2", 100),
+        ("record", "A2", 100),
+    ]
+    capping.assert_called_once()
+
+
+@pytest.mark.usefixtures("temp_test_db")
+def test_pipette_action_travels_at_safe_z_unless_a_cap_is_held():
+    toolkit = MagicMock()
+    toolkit.pipette.pipette_tracker.capacity_ul = 200
+    toolkit.pipette.pipette_tracker.volume = 0
+    toolkit.mill.max_z_height = 0
+    src = Well("A1", plate_id=1)
+    dst = WasteVial("w0")
+
+    with (
+        patch.object(pipetting, "capping_sequence"),
+        patch.object(pipetting, "decapping_sequence"),
+        patch.object(pipetting.time, "sleep"),
+        patch.object(pipetting, "move_through_targets") as move,
+    ):
+        _pipette_action(toolkit, src, dst, 100)
+
+    # Aspirate from an open well at safe Z, dispense into the decapped waste at max Z
+    assert [c.args[0][0].payload for c in move.call_args_list] == [src, dst]
+    assert [c.kwargs["travel_height"] for c in move.call_args_list] == [None, 0]
+    toolkit.mill.move_to_safe_position.assert_not_called()
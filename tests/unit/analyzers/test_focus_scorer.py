@@ -0,0 +1,56 @@
+import time
+from unittest.mock import patch
+
+import numpy as np
+import pytest
+
+from panda_experiment_analyzers.contact_angle import contact_angle_led_detect
+from panda_experiment_analyzers.contact_angle.contact_angle_led_detect import (
+    StreamingFocusScorer,
+)
+
+
+@pytest.fixture
+def scores():
+    """Scores score_focus_image hands out in order, slowly like a real frame"""
+    queue = []
+
+    def score(image, *args, **kwargs):
+        time.sleep(0.05)
+        return {"score": queue.pop(0), "details": {"red_sep": 80, "blue_sep": 40}}
+
+    with (
+        patch.object(contact_angle_led_detect, "score_focus_image", score),
+        patch.object(contact_angle_led_detect, "FramePrep"),
+    ):
+        yield queue
+
+
+def submit(scorer, count):
+    for _ in range(count):
+        scorer.submit(np.zeros((4, 4, 3), np.uint8))
+
+
+def test_peak_reached_waits_for_submitted_frames(scores):
+    scores.extend([1.0, 5.0, 3.0, 2.0])
+    scorer = StreamingFocusScorer(patience=2, min_drop=0.5, min_frames=3)
+
+    submit(scorer, 3)
+    assert not scorer.peak_reached()
+    submit(scorer, 1)
+    assert scorer.peak_reached()
+    assert scorer.finish()["score"] == 5.0
+
+
+def test_reset_forgets_the_previous_stack(scores):
+    scores.extend([1.0, 5.0, 3.0, 2.0, 2.0])
+    scorer = StreamingFocusScorer(patience=2, min_drop=0.5, min_frames=3)
+    submit(scorer, 4)
+    assert scorer.peak_reached()
+
+    scorer.reset()
+    submit(scorer, 1)
+    assert not scorer.peak_reached()
+    best = scorer.finish()
+    assert best["score"] == 2.0
+    assert best["index"] == 0
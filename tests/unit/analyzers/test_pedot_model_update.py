@@ -0,0 +1,148 @@
+from unittest.mock import patch
+
+import pytest
+
+torch = pytest.importorskip("torch")
+gpytorch = pytest.importorskip("gpytorch")
+
+from panda_experiment_analyzers.pedot import ml_model  # noqa: E402
+from panda_experiment_analyzers.pedot.ml_model.pedot_ml_analyzer_v9 import (  # noqa: E402
+    ModelUpdatePolicy,
+    PEDOTGaussianProcess,
+    PEDOTOptimizer,
+    data_fingerprint,
+)
+
+N_CHECKPOINT = 8
+
+
+@pytest.fixture
+def rows():
+    torch.manual_seed(0)
+    train_x = torch.rand(10, 3)
+    train_y = torch.sin(train_x.sum(dim=1))
+    return train_x, train_y
+
+
+def checkpoint(train_x, train_y, **metadata):
+    """A saved state trained on train_x/train_y, like save_model writes"""
+    likelihood = gpytorch.likelihoods.GaussianLikelihood()
+    model = PEDOTGaussianProcess(train_x, train_y, likelihood)
+    optimizer = torch.optim.Adam(model.parameters(), lr=0.1)
+    return {
+        "model_state_dict": model.state_dict(),
+        "optimizer_state_dict": optimizer.state_dict(),
+        "likelihood_state_dict": likelihood.state_dict(),
+        "learning_rate": 0.1,
+        "n_train_rows": len(train_y),
+        "data_fingerprint": data_fingerprint(train_x, train_y),
+        "updates_since_full": 0,
+        **metadata,
+    }
+
+
+@pytest.fixture
+def optimizer(tmp_path, rows):
+    train_x, train_y = rows
+    optimizer = PEDOTOptimizer(
+        str(tmp_path / "pedot_gp_model"),
+        str(tmp_path / "contourplots"),
+        update_policy=ModelUpdatePolicy(warm_start_iterations=2, full_iterations=2),
+    )
+    optimizer.saved_state = checkpoint(train_x[:N_CHECKPOINT], train_y[:N_CHECKPOINT])
+    optimizer._read_checkpoint = lambda: (3, optimizer.saved_state)
+
+    optimizer.full_retrains = []
+
+    def full_retrain(saved_state, train_x, train_y, n_iterations):
+        optimizer.full_retrains.append(len(train_y))
+        return "model", "likelihood", "optimizer", 0.5
+
+    optimizer._full_retrain = full_retrain
+    return optimizer
+
+
+def test_warm_start_folds_in_new_rows(optimizer, rows):
+    train_x, train_y = rows
+    with patch.object(optimizer, "new_row_drift", return_value=(0.5, 0.2)):
+        update = optimizer.update_model(train_x, train_y)
+
+    assert optimizer.full_retrains == []
+    assert update.mode == "warm"
+    assert update.rmse == 0.2
+    assert update.n_new_rows == 2
+    assert update.model.train_inputs[0].shape[0] == 10
+    assert update.metadata["updates_since_full"] == 1
+    assert update.metadata["n_train_rows"] == 10
+
+
+def test_drifting_rows_trigger_a_full_retrain(optimizer, rows):
+    train_x, train_y = rows
+    with patch.object(optimizer, "new_row_drift", return_value=(5.0, 1.0)):
+        update = optimizer.update_model(train_x, train_y)
+
+    assert optimizer.full_retrains == [10]
+    assert update.mode == "full"
+    assert "drifted" in update.reason
+    assert update.rmse == 0.5
+    assert update.metadata["updates_since_full"] == 0
+
+
+def test_scheduled_full_retrain(optimizer, rows):
+    train_x, train_y = rows
+    optimizer.saved_state["updates_since_full"] = 9
+    update = optimizer.update_model(train_x, train_y)
+
+    assert optimizer.full_retrains == [10]
+    assert "scheduled" in update.reason
+
+
+def test_changed_rows_trigger_a_full_retrain(optimizer, rows):
+    train_x, train_y = rows
+    changed_y = train_y.clone()
+    changed_y[0] += 1.0
+    update = optimizer.update_model(train_x, changed_y)
+
+    assert optimizer.full_retrains == [10]
+    assert update.reason == "earlier training rows changed"
+
+
+def test_new_row_drift_measures_prediction_errors(optimizer, rows):
+    train_x, train_y = rows
+    model, likelihood = optimizer._model_from_state(
+        optimizer.saved_state, train_x[:N_CHECKPOINT], train_y[:N_CHECKPOINT]
+    )
+    seen, _ = optimizer.new_row_drift(model, likelihood, train_x[:1], train_y[:1])
+    outlier, _ = optimizer.new_row_drift(
+        model, likelihood, train_x[:1], train_y[:1] + 100.0
+    )
+
+    assert seen < ModelUpdatePolicy().drift_threshold < outlier
+
+
+def test_v8_is_the_default_model():
+    with (
+        patch.object(ml_model, "get_config_boolean", return_value=False),
+        patch.object(ml_model, "pedot_model_v8", return_value="v8") as v8,
+        patch(
+            "panda_experiment_analyzers.pedot.ml_model.pedot_ml_analyzer_v9.main"
+        ) as v9,
+    ):
+        assert ml_model.pedot_model("model", "plots", experiment_id=7) == "v8"
+
+    v8.assert_called_once_with("model", "plots", experiment_id=7)
+    v9.assert_not_called()
+
+
+def test_incremental_model_is_opt_in():
+    with (
+        patch.object(ml_model, "get_config_boolean", return_value=True),
+        patch.object(ml_model, "pedot_model_v8") as v8,
+        patch(
+            "panda_experiment_analyzers.pedot.ml_model.pedot_ml_analyzer_v9.main",
+            return_value="v9",
+        ),
+    ):
+        assert ml_model.pedot_model("model", "plots", experiment_id=7) == "v9"
+
+    v8.assert_not_called()
@@ -1,12 +1,21 @@
+from unittest.mock import MagicMock, patch
+
 import pytest
 
+from panda_lib.actions import transfer
+from panda_lib.exceptions import ExperimentError, NoAvailableSolution
 from panda_lib.experiment_loop import (
     _check_stock_vials,
     _establish_system_state,
+    _run_lookahead,
+    _run_protocol,
     read_vials,
 )
+from panda_lib.experiments import ExperimentStatus
+from panda_lib.lookahead import PredispenseLedger
 from panda_lib.labware.vials import StockVial
 from panda_lib.labware.wellplates import Well, Wellplate
+from panda_lib.toolkit import Toolkit
 
 
 @pytest.fixture
@@ -83,3 +92,66 @@ def test_insufficient_volume_error(temp_test_db):
     exp_soln = {"solution1": {"volume": 2000, "repeated": 1}}
     passes, table = _check_stock_vials(exp_soln, stock_vial_list)
     assert passes is False
+
+
+def test_failed_experiment_keeps_other_predispensed_wells(ledger_sessions):
+    ledger = PredispenseLedger(ledger_sessions)
+    # A lookahead batch filled the wells of experiments N and N+1
+    ledger.record(123, "B5", "edot", 100.0)
+    ledger.record(123, "B6", "edot", 100.0)
+    toolkit = Toolkit(camera=MagicMock(), predispensed=ledger)
+
+    def failing_protocol(experiment, toolkit):
+        raise ExperimentError("protocol failed")
+
+    experiment_n = MagicMock(plate_id=123, well_id="B5")
+    with pytest.raises(ExperimentError):
+        _run_protocol(failing_protocol, experiment_n, toolkit)
+    experiment_n.set_status_and_save.assert_called_once_with(ExperimentStatus.ERROR)
+
+    def protocol(experiment, toolkit):
+        well = MagicMock(spec=Well, plate_id=123, well_id="B6")
+        transfer(100.0, "edot", well, toolkit)
+
+    with patch("panda_lib.actions.pipetting._pipette_action") as pipette_action:
+        _run_protocol(protocol, MagicMock(plate_id=123, well_id="B6"), toolkit)
+
+    # N+1's well already holds its edot, so the transfer is not repeated
+    pipette_action.assert_not_called()
+    assert list(ledger) == []
+
+
+def test_lookahead_skips_groups_no_vial_can_serve(ledger_sessions):
+    toolkit = Toolkit(
+        camera=MagicMock(),
+        pipette=MagicMock(),
+        wellplate=MagicMock(id=123),
+        predispensed=PredispenseLedger(ledger_sessions),
+    )
+    toolkit.pipette.pipette_tracker.capacity_ul = 200
+    queued = [
+        (MagicMock(experiment_id=i, well_id=w, solutions=s), None)
+        for i, w, s in [
+            (1, "B5", {"edot": {"volume": 100}, "rinse": {"volume": 50}}),
+            (2, "B6", {"edot": {"volume": 100}, "rinse": {"volume": 50}}),
+        ]
+    ]
+
+    def batched_transfer(solution, dispenses, toolkit):
+        if solution == "edot":
+            raise NoAvailableSolution("edot")
+
+    with (
+        patch("panda_lib.experiment_loop.get_config_boolean", return_value=True),
+        patch(
+            "panda_lib.experiment_loop.scheduler.read_next_experiments_from_queue",
+            return_value=queued,
+        ),
+        patch(
+            "panda_lib.experiment_loop.batched_transfer", side_effect=batched_transfer
+        ) as batch,
+    ):
+        _run_lookahead(toolkit, 2, MagicMock())
+
+    # The edot group is left to the protocols, the rinse group still runs
+    assert [call.args[0] for call in batch.call_args_list] == ["edot", "rinse"]
@@ -0,0 +1,107 @@
+from types import SimpleNamespace
+
+import pytest
+
+from panda_lib.lookahead import PredispenseLedger, plan_lookahead
+
+
+def experiment(experiment_id, well_id, **solutions):
+    return SimpleNamespace(
+        experiment_id=experiment_id, well_id=well_id, solutions=solutions
+    )
+
+
+@pytest.fixture
+def experiments():
+    return [
+        experiment(1, "A1", edot={"concentration": 0.01, "volume": 120}),
+        experiment(
+            2,
+            "A2",
+            EDOT={"concentration": 0.01, "volume": 320},
+            rinse={"concentration": 0, "volume": 100},
+        ),
+        experiment(3, "A3", edot={"concentration": 0.01, "volume": 120}),
+        # Concentration only, mixed by the protocol
+        experiment(4, "A4", pama={"concentration": 0.1}),
+    ]
+
+
+def test_dispenses_are_grouped_by_solution(experiments):
+    plan = plan_lookahead(experiments, capacity_ul=200)
+
+    # A single rinse gains nothing from batching and is left to the protocol
+    assert list(plan.groups) == ["edot"]
+    assert [d.well_id for d in plan.groups["edot"].dispenses] == ["A1", "A2", "A3"]
+    assert plan.groups["edot"].total_volume == 560
+    assert plan.experiment_ids == [1, 2, 3, 4]
+
+
+def test_decap_savings(experiments):
+    plan = plan_lookahead(experiments, capacity_ul=200, decap_seconds=10)
+
+    # 320 uL needs two pipette loads, so four decaps for edot
+    assert plan.unbatched_decaps == 4
+    assert plan.batched_decaps == 1
+    assert plan.decaps_saved == 3
+    assert plan.time_saved == 30
+    assert "1 shared solutions, 1 decaps instead of 4" in plan.summary()
+
+
+def test_single_dispenses_kept_when_asked(experiments):
+    plan = plan_lookahead(experiments, capacity_ul=200, min_dispenses=1)
+
+    assert list(plan.groups) == ["edot", "rinse"]
+    assert plan.batched_decaps == 2
+
+
+def test_already_dispensed_wells_are_excluded(experiments):
+    plan = plan_lookahead(
+        experiments, capacity_ul=200, exclude=[("A1", "edot"), ("A2", "rinse")]
+    )
+
+    assert list(plan.groups) == ["edot"]
+    assert [d.well_id for d in plan.groups["edot"].dispenses] == ["A2", "A3"]
+
+
+def test_empty_window():
+    plan = plan_lookahead([], capacity_ul=200)
+    assert plan.groups == {}
+    assert plan.decaps_saved == 0
+
+
+def test_ledger_take_checks_off_matching_volume(ledger_sessions):
+    ledger = PredispenseLedger(ledger_sessions)
+    ledger.record(123, "B5", "EDOT", 100.0)
+
+    assert (123, "B5", "edot") in ledger
+    assert not ledger.take(123, "B5", "edot", 50.0)
+    assert ledger.take(123, "B5", "Edot", 100.0)
+    assert not ledger.take(123, "B5", "edot", 100.0)
+    assert len(ledger) == 0
+
+
+def test_ledger_survives_a_restart(ledger_sessions):
+    ledger = PredispenseLedger(ledger_sessions)
+    ledger.record(123, "B5", "edot", 100.0)
+    ledger.record(123, "B6", "edot", 80.0)
+    ledger.take(123, "B6", "edot", 80.0)
+
+    restarted = PredispenseLedger(ledger_sessions)
+    assert list(restarted) == [(123, "B5", "edot")]
+    assert restarted.take(123, "B5", "edot", 100.0)
+
+
+def test_ledger_forget_well_and_keep_plate(ledger_sessions):
+    ledger = PredispenseLedger(ledger_sessions)
+    ledger.record(123, "B5", "edot", 100.0)
+    ledger.record(123, "B5", "rinse", 50.0)
+    ledger.record(123, "B6", "edot", 100.0)
+    ledger.record(124, "B5", "edot", 100.0)
+
+    ledger.forget_well(123, "B5")
+    assert sorted(ledger) == [(123, "B6", "edot"), (124, "B5", "edot")]
+
+    ledger.keep_plate(124)
+    assert list(ledger) == [(124, "B5", "edot")]
+    assert list(PredispenseLedger(ledger_sessions)) == [(124, "B5", "edot")]
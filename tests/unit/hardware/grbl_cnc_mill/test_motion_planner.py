@@ -0,0 +1,114 @@
+from unittest.mock import MagicMock
+
+import pytest
+
+from panda_lib.hardware.grbl_cnc_mill.driver import Mill
+from panda_lib.hardware.grbl_cnc_mill.motion_planner import (
+    AxisLimits,
+    MotionPlanner,
+    PlannerTarget,
+)
+from panda_lib.hardware.grbl_cnc_mill.tools import Coordinates
+
+
+@pytest.fixture
+def mill():
+    mill = Mill()
+    mill.ser_mill = MagicMock()
+    mill.max_z_height = 0
+    mill.safe_z_height = -10
+    mill.working_volume = Coordinates(x=-415.0, y=-300.0, z=-200.0)
+    mill.config.update({"$110": "6000", "$111": "6000", "$112": "3000"})
+    mill.config.update({"$120": "300", "$121": "300", "$122": "100"})
+    mill.execute_command = MagicMock(return_value="<idle>")
+    return mill
+
+
+def test_axis_limits_from_grbl_settings():
+    limits = AxisLimits.from_grbl_settings({"$110": "1000", "$122": "50"})
+    assert limits.max_rate == (1000.0, 5000.0, 5000.0)
+    assert limits.acceleration == (300.0, 300.0, 50.0)
+
+
+def test_move_time_trapezoid_and_triangle():
+    limits = AxisLimits(max_rate=(6000.0,) * 3, acceleration=(100.0,) * 3)
+    start = Coordinates(0, 0, 0)
+    # 100 mm/s cruise needs 1 s and 100 mm to reach and leave, so 200 mm takes 3 s
+    assert limits.move_time(start, Coordinates(-200, 0, 0), 6000) == pytest.approx(3.0)
+    # 25 mm never reaches cruise: 2 * sqrt(25 / 100)
+    assert limits.move_time(start, Coordinates(-25, 0, 0), 6000) == pytest.approx(1.0)
+    assert limits.move_time(start, start, 6000) == 0.0
+
+
+def test_plan_lifts_only_to_safe_height(mill):
+    planner = MotionPlanner(mill, feed_rate=3000)
+    plan = planner.plan(
+        [PlannerTarget(Coordinates(-200, -100, -50), label="B")],
+        start=Coordinates(-100, -100, -50),
+    )
+    assert plan.segments[0].commands == [
+        "G01 X-100.0 Y-100.0 Z-10.0",
+        "G01 X-200.0 Y-100.0 Z-10.0",
+        "G01 X-200.0 Y-100.0 Z-50.0",
+    ]
+    assert plan.predicted_time > 0
+
+
+def test_plan_moves_diagonally_above_safe_height(mill):
+    planner = MotionPlanner(mill, feed_rate=3000)
+    plan = planner.plan(
+        [PlannerTarget(Coordinates(-200, -150, -5))],
+        start=Coordinates(-100, -100, 0),
+    )
+    assert plan.segments[0].commands == ["G01 X-200.0 Y-150.0 Z-5.0"]
+
+
+def test_plan_merges_vertical_moves(mill):
+    planner = MotionPlanner(mill, feed_rate=3000)
+    plan = planner.plan(
+        [
+            PlannerTarget(Coordinates(-100, -100, -60)),
+            PlannerTarget(Coordinates(-100, -100, -60)),
+        ],
+        start=Coordinates(-100, -100, -20),
+    )
+    assert plan.segments[0].commands == ["G01 X-100.0 Y-100.0 Z-60.0"]
+    assert plan.segments[1].commands == []
+
+
+def test_plan_optimize_order_reduces_travel(mill):
+    planner = MotionPlanner(mill, feed_rate=3000)
+    xs = [-300, -20, -250, -60, -200, -100, -150, -280, -40]
+    targets = [PlannerTarget(Coordinates(x, -100, -50), label=str(x)) for x in xs]
+    start = Coordinates(0, -100, 0)
+    given = planner.plan(targets, start=start)
+    optimized = planner.plan(targets, start=start, optimize_order=True)
+    assert optimized.predicted_time < given.predicted_time
+    assert sorted(s.target.label for s in optimized.segments) == sorted(map(str, xs))
+    assert [s.target.label for s in optimized.segments] == [
+        str(x) for x in sorted(xs, reverse=True)
+    ]
+
+
+def test_plan_rejects_targets_outside_working_volume(mill):
+    planner = MotionPlanner(mill)
+    with pytest.raises(ValueError, match="out of range"):
+        planner.plan(
+            [PlannerTarget(Coordinates(10, -100, -50))], start=Coordinates(0, 0, 0)
+        )
+
+
+def test_execute_records_actual_times(mill):
+    planner = MotionPlanner(mill, feed_rate=3000)
+    arrived = []
+    plan = planner.plan(
+        [PlannerTarget(Coordinates(-200, -100, -50), label="A1")],
+        start=Coordinates(-100, -100, 0),
+    )
+    planner.execute(plan, on_arrival=arrived.append)
+    assert [target.label for target in arrived] == ["A1"]
+    assert plan.actual_time is not None
+    report = plan.report()
+    assert report[0]["target"] == "A1"
+    assert report[0]["actual_s"] is not None
+    mill.execute_command.assert_any_call("\n".join(plan.segments[0].commands))
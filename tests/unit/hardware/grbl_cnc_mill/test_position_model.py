@@ -0,0 +1,109 @@
+import pytest
+import serial
+
+from panda_lib.hardware.grbl_cnc_mill.driver import Mill
+from panda_lib.hardware.grbl_cnc_mill.mock import MockSerialToMill
+from panda_lib.hardware.grbl_cnc_mill.tools import Coordinates
+
+
+class CountingSerial(MockSerialToMill):
+    """Counts the status requests written to the mill"""
+
+    def __init__(self, *args, **kwargs):
+        super().__init__(*args, **kwargs)
+        self.status_requests = 0
+
+    def write(self, command: bytes):
+        if command == b"?":
+            self.status_requests += 1
+        super().write(command)
+
+
+def make_mill(status_engine: bool = False) -> Mill:
+    mill = Mill()
+    mill.ser_mill = CountingSerial(
+        port="COM4",
+        baudrate=115200,
+        parity=serial.PARITY_NONE,
+        stopbits=serial.STOPBITS_ONE,
+        bytesize=serial.EIGHTBITS,
+        timeout=0.05,
+    )
+    mill.homed = True
+    mill.max_z_height = 0
+    mill.safe_z_height = -10
+    mill.working_volume = Coordinates(x=-415.0, y=-300.0, z=-200.0)
+    if status_engine:
+        mill.start_status_engine(interval=0.01)
+    return mill
+
+
+@pytest.fixture
+def mill():
+    return make_mill()
+
+
+def test_coordinates_come_from_model_after_move(mill):
+    mill.safe_move(-50.5, -60.25, -20)
+    requests = mill.ser_mill.status_requests
+
+    assert mill.current_coordinates() == Coordinates(-50.5, -60.25, -20)
+    mill.safe_move(-80, -60.25, -20)
+    assert mill.current_coordinates() == Coordinates(-80, -60.25, -20)
+    assert mill.ser_mill.status_requests == requests
+
+
+def test_verify_queries_mill_and_corrects_model(mill):
+    mill.safe_move(-50, -60, -20)
+    mill._position = Coordinates(-1, -1, -1)
+    requests = mill.ser_mill.status_requests
+
+    assert mill.current_coordinates(verify=True) == Coordinates(-50, -60, -20)
+    assert mill.ser_mill.status_requests == requests + 1
+    assert mill.current_coordinates() == Coordinates(-50, -60, -20)
+
+
+def test_raw_motion_command_invalidates_model(mill):
+    mill.safe_move(-50, -60, -20)
+    mill.execute_command("F2000")
+    assert mill.current_coordinates() == Coordinates(-50, -60, -20)
+
+    mill.execute_command("G01 X-70")
+    requests = mill.ser_mill.status_requests
+    assert mill.current_coordinates() == Coordinates(-70, -60, -20)
+    assert mill.ser_mill.status_requests > requests
+
+
+def test_move_without_idle_is_not_recorded(mill):
+    mill.safe_move(-50, -60, -20)
+    # The polled wait times out and hands back the last non-Idle status
+    mill._Mill__wait_for_completion = lambda status, timeout=5: "<run|mpos:0,0,0>"
+    mill.move_to_position(-70, -60, -20)
+
+    assert mill._position is None
+    del mill._Mill__wait_for_completion
+    requests = mill.ser_mill.status_requests
+    mill.current_coordinates()
+    assert mill.ser_mill.status_requests > requests
+
+
+def test_position_model_can_be_disabled(mill):
+    mill.use_position_model = False
+    mill.safe_move(-50, -60, -20)
+    requests = mill.ser_mill.status_requests
+    assert mill.current_coordinates() == Coordinates(-50, -60, -20)
+    assert mill.ser_mill.status_requests > requests
+
+
+def test_model_reconciles_with_streamed_reports():
+    mill = make_mill(status_engine=True)
+    try:
+        mill.safe_move(-50, -60, -20)
+        assert mill.current_coordinates() == Coordinates(-50, -60, -20)
+
+        # The mill ends up somewhere else than the model expects
+        mill.ser_mill.current_x = -51.0
+        mill.status_engine.wait_for_report(timeout=1)
+        assert mill.current_coordinates() == Coordinates(-51, -60, -20)
+    finally:
+        mill.stop_status_engine()
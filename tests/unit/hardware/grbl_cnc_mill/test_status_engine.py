@@ -0,0 +1,132 @@
+import queue
+import threading
+import time
+
+import pytest
+
+from panda_lib.hardware.grbl_cnc_mill.driver import Mill
+from panda_lib.hardware.grbl_cnc_mill.exceptions import StatusReturnError
+from panda_lib.hardware.grbl_cnc_mill.status_engine import (
+    GrblStatusEngine,
+    parse_status_report,
+)
+
+
+class FakeGrblSerial:
+    """Answers ? with a status report and reports Run for a few polls after each line"""
+
+    def __init__(self, run_reports: int = 3):
+        self.run_reports = run_reports
+        self.remaining_run = 0
+        self.alarm = False
+        self.written = []
+        self.lines = queue.Queue()
+        self.lock = threading.Lock()
+
+    def write(self, data: bytes):
+        with self.lock:
+            self.written.append(data)
+            if data == b"?":
+                state = "Run" if self.remaining_run > 0 else "Idle"
+                state = "Alarm" if self.alarm else state
+                blocks = 14 if self.remaining_run > 0 else 15
+                self.remaining_run = max(0, self.remaining_run - 1)
+                self.lines.put(
+                    f"<{state}|MPos:-1.000,-2.000,-3.000|Bf:{blocks},128|FS:0,0>\r\n".encode()
+                )
+                return
+            for line in data.decode().split("\n"):
+                if line.strip():
+                    self.remaining_run = self.run_reports
+                    self.lines.put(b"ok\r\n")
+
+    def readline(self):
+        try:
+            return self.lines.get(timeout=0.05)
+        except queue.Empty:
+            return b""
+
+    def cancel_read(self):
+        pass
+
+
+@pytest.fixture
+def engine():
+    fake = FakeGrblSerial()
+    status_engine = GrblStatusEngine(fake, interval=0.01)
+    status_engine.start()
+    yield status_engine
+    status_engine.stop()
+
+
+def test_parse_status_report():
+    state = parse_status_report("<Run|MPos:-1.5,2.0,-3.25|Bf:12,100|FS:1500,0>", 1.0)
+    assert state.state == "Run"
+    assert state.mpos == (-1.5, 2.0, -3.25)
+    assert state.wpos is None
+    assert state.planner_blocks_free == 12
+    assert state.rx_bytes_free == 100
+    assert state.feed == 1500.0
+    assert state.timestamp == 1.0
+    assert not state.is_idle
+
+
+def test_parse_status_report_rejects_other_lines():
+    with pytest.raises(ValueError):
+        parse_status_report("ok")
+
+
+def test_engine_streams_reports(engine):
+    state = engine.wait_for_report(timeout=1)
+    assert state.is_idle
+    assert state.mpos == (-1.0, -2.0, -3.0)
+    assert engine.latest() is state or engine.latest().timestamp >= state.timestamp
+
+
+def test_wait_for_idle_after_motion(engine):
+    engine.wait_for_report(timeout=1)
+    engine.write(b"G01 X-1 Y-2\n")
+    assert engine.next_response(timeout=1) == "ok"
+    sent = time.monotonic()
+    state = engine.wait_for_idle(since=sent, timeout=1)
+    assert state.is_idle
+    assert state.timestamp > sent
+
+
+def test_wait_for_idle_without_bf_needs_two_idle_reports():
+    status_engine = GrblStatusEngine(FakeGrblSerial(), interval=0.01)
+    sent = time.monotonic()
+    status_engine._handle_line("<Idle|MPos:0.000,0.000,0.000|FS:0,0>")
+    with pytest.raises(StatusReturnError):
+        status_engine.wait_for_idle(since=sent, timeout=0.1)
+
+    threading.Timer(
+        0.05, status_engine._handle_line, ("<Idle|MPos:0.000,0.000,0.000|FS:0,0>",)
+    ).start()
+    state = status_engine.wait_for_idle(since=sent, timeout=1)
+    assert state.is_idle
+
+
+def test_wait_for_idle_raises_on_alarm(engine):
+    engine.wait_for_report(timeout=1)
+    engine.ser.alarm = True
+    engine.ser.lines.put(b"ALARM:1\r\n")
+    assert engine.next_response(timeout=1) == "ALARM:1"
+    with pytest.raises(StatusReturnError, match="Alarm"):
+        engine.wait_for_idle(timeout=1)
+
+
+def test_mill_execute_command_returns_on_idle():
+    mill = Mill()
+    mill.ser_mill = FakeGrblSerial()
+    mill.start_status_engine(interval=0.01)
+    try:
+        start = time.monotonic()
+        response = mill.execute_command("G01 X-1 Y-2")
+        assert response.startswith("<idle")
+        assert time.monotonic() - start < 0.5
+        assert b"G01 X-1 Y-2\n" in mill.ser_mill.written
+        assert mill.current_status().startswith("<Idle")
+    finally:
+        mill.stop_status_engine()
+    assert not mill.status_engine_running
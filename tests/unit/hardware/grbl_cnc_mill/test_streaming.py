@@ -0,0 +1,99 @@
+import pytest
+import serial
+
+from panda_lib.hardware.grbl_cnc_mill.driver import Mill
+from panda_lib.hardware.grbl_cnc_mill.exceptions import (
+    CommandExecutionError,
+    MillConnectionError,
+)
+from panda_lib.hardware.grbl_cnc_mill.mock import MockSerialToMill
+
+
+class RejectingSerial(MockSerialToMill):
+    """Answers error:20 for any line containing G99"""
+
+    def _acknowledge_line(self):
+        rejected = bool(self._rx_lines) and "G99" in self._rx_lines[0]
+        if not super()._acknowledge_line():
+            return False
+        if rejected:
+            self._output[-1] = "error:20\r\n"
+        return True
+
+
+def make_serial(serial_class=MockSerialToMill):
+    return serial_class(
+        port="COM4",
+        baudrate=115200,
+        parity=serial.PARITY_NONE,
+        stopbits=serial.STOPBITS_ONE,
+        bytesize=serial.EIGHTBITS,
+        timeout=0.05,
+    )
+
+
+@pytest.fixture
+def streaming_mill():
+    mill = Mill()
+    mill.ser_mill = make_serial()
+    mill.start_status_engine(interval=0.01)
+    yield mill
+    mill.stop_status_engine()
+
+
+def rinse_path(repeats: int = 10):
+    lines = []
+    for _ in range(repeats):
+        lines.extend(["G01 Z0", "G01 X-120.5 Y-45.25", "G01 Z-70.125"])
+    return lines
+
+
+def test_stream_gcode_respects_rx_buffer(streaming_mill):
+    lines = rinse_path()
+    assert sum(len(line) + 1 for line in lines) > streaming_mill.rx_buffer_size
+
+    results = streaming_mill.stream_gcode(lines)
+
+    assert [result.line for result in results] == lines
+    assert all(result.ok for result in results)
+    assert streaming_mill.ser_mill.rx_overflows == 0
+    assert streaming_mill.ser_mill.max_rx_bytes < streaming_mill.rx_buffer_size
+
+
+def test_blob_write_overflows_mock_buffer():
+    ser = make_serial()
+    ser.write(("\n".join(rinse_path()) + "\n").encode())
+    assert ser.rx_overflows > 0
+
+
+def test_execute_command_streams_multiline_blocks(streaming_mill):
+    response = streaming_mill.execute_command("\n".join(rinse_path()))
+    assert response.startswith("<idle")
+    assert streaming_mill.ser_mill.rx_overflows == 0
+    assert streaming_mill.ser_mill.current_z == -70.125
+
+
+def test_stream_gcode_stops_sending_after_error():
+    mill = Mill()
+    mill.ser_mill = make_serial(RejectingSerial)
+    mill.ser_mill.rx_buffer_size = 24
+    mill.rx_buffer_size = 24
+    mill.start_status_engine(interval=0.01)
+    try:
+        results = mill.stream_gcode(["G01 Z-1", "G99", "G01 Z-2", "G01 Z-3", "G01 Z-4"])
+        assert results[0].ok
+        assert results[1].response == "error:20"
+        # Lines already buffered by GRBL are still acknowledged, later ones are never sent
+        assert results[-1].response == ""
+        assert results[-1].sent_at is None
+        with pytest.raises(CommandExecutionError):
+            mill.execute_command("G99")
+    finally:
+        mill.stop_status_engine()
+
+
+def test_stream_gcode_requires_status_engine():
+    mill = Mill()
+    mill.ser_mill = make_serial()
+    with pytest.raises(MillConnectionError):
+        mill.stream_gcode(["G01 Z0"])
@@ -0,0 +1,84 @@
+from pathlib import Path
+
+from panda_lib.hardware.imaging.camera_session import CameraSession
+from panda_lib.hardware.imaging.interface import CameraInterface
+
+
+class CountingCamera(CameraInterface):
+    """A camera that counts connections and can fail captures on demand"""
+
+    def __init__(self, fail_captures: int = 0):
+        self.connected = False
+        self.connects = 0
+        self.closes = 0
+        self.armed = 0
+        self.fail_captures = fail_captures
+        self.saved = []
+
+    def connect(self) -> bool:
+        self.connects += 1
+        self.connected = True
+        return True
+
+    def arm(self) -> bool:
+        self.armed += 1
+        return True
+
+    def close(self) -> None:
+        self.closes += 1
+        self.connected = False
+
+    def is_connected(self) -> bool:
+        return self.connected
+
+    def capture_image(self):
+        if self.fail_captures:
+            self.fail_captures -= 1
+            return None
+        return "frame"
+
+    def save_image(self, image, path) -> bool:
+        self.saved.append(Path(path))
+        return True
+
+    def capture_and_save(self, path):
+        return Path(path), self.save_image(self.capture_image(), path)
+
+
+def test_session_connects_once_for_many_captures(tmp_path):
+    camera = CountingCamera()
+    with CameraSession(camera) as session:
+        for i in range(11):
+            path, ok = session.capture_and_save(tmp_path / f"z{i}.tiff")
+            assert ok
+
+    assert camera.connects == 1
+    assert camera.armed == 1
+    assert camera.closes == 1
+    assert session.frames_captured == 11
+    assert len(camera.saved) == 11
+
+
+def test_failed_capture_reconnects_and_retries():
+    camera = CountingCamera(fail_captures=1)
+    session = CameraSession(camera)
+
+    assert session.capture() == "frame"
+    assert camera.connects == 2
+    assert camera.closes == 1
+
+
+def test_capture_gives_up_after_retry():
+    camera = CountingCamera(fail_captures=5)
+    session = CameraSession(camera)
+
+    assert session.capture() is None
+    assert session.frames_captured == 0
+
+
+def test_burst_returns_frames_back_to_back():
+    camera = CountingCamera()
+    session = CameraSession(camera)
+
+    assert session.burst(5) == ["frame"] * 5
+    assert camera.connects == 1
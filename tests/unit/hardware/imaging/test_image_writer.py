@@ -0,0 +1,141 @@
+import threading
+import time
+from pathlib import Path
+
+import numpy as np
+
+from panda_lib.hardware.imaging.camera_session import CameraSession
+from panda_lib.hardware.imaging.image_writer import ImageWriter
+from panda_lib.hardware.imaging.interface import CameraInterface
+
+
+class SlowSavingCamera(CameraInterface):
+    """A camera whose saves block until released"""
+
+    def __init__(self):
+        self.release = threading.Event()
+        self.saved = []
+
+    def connect(self) -> bool:
+        return True
+
+    def close(self) -> None:
+        pass
+
+    def is_connected(self) -> bool:
+        return True
+
+    def capture_image(self):
+        return np.zeros((4, 4, 3), dtype=np.uint8)
+
+    def save_image(self, image, path) -> bool:
+        self.release.wait(2)
+        self.saved.append(Path(path))
+        return True
+
+    def capture_and_save(self, path):
+        return Path(path), self.save_image(self.capture_image(), path)
+
+
+class AnnotatedImage:
+    def __init__(self, saved):
+        self.saved = saved
+
+    def save(self, path):
+        self.saved.append(Path(path))
+
+
+class Results:
+    def __init__(self):
+        self.images = []
+
+    def append_image_file(self, file, context=None):
+        self.images.append((file, context))
+
+
+class Experiment:
+    def __init__(self):
+        self.results = Results()
+
+
+def test_submit_returns_before_the_frame_is_saved(tmp_path):
+    camera = SlowSavingCamera()
+    session = CameraSession(camera)
+    experiment = Experiment()
+
+    with ImageWriter() as writer:
+        start = time.monotonic()
+        writer.submit(session.capture(), tmp_path / "a.tiff", session, experiment, "a")
+        assert time.monotonic() - start < 0.5
+        assert experiment.results.images == []
+
+        camera.release.set()
+        results = writer.drain(timeout=2)
+
+    assert [result.ok for result in results] == [True]
+    assert experiment.results.images == [(tmp_path / "a.tiff", "a")]
+
+
+def test_queued_frames_get_distinct_names(tmp_path):
+    camera = SlowSavingCamera()
+    session = CameraSession(camera)
+
+    with ImageWriter() as writer:
+        for _ in range(3):
+            writer.submit(session.capture(), tmp_path / "d.tiff", session)
+        camera.release.set()
+        results = writer.drain(timeout=2)
+
+    assert [result.path.name for result in results] == [
+        "d.tiff",
+        "d_1.tiff",
+        "d_1_2.tiff",
+    ]
+    assert writer._reserved == set()
+
+
+def test_datazone_is_rendered_from_the_frame_in_memory(tmp_path):
+    camera = SlowSavingCamera()
+    camera.release.set()
+    session = CameraSession(camera)
+    experiment = Experiment()
+    annotated = []
+    rendered = []
+
+    def annotate(experiment, image, context):
+        rendered.append(image.size)
+        return AnnotatedImage(annotated)
+
+    with ImageWriter(annotate=annotate) as writer:
+        writer.submit(
+            session.capture(),
+            tmp_path / "b.tiff",
+            session,
+            experiment,
+            "b",
+            add_datazone=True,
+        )
+        (result,) = writer.drain(timeout=2)
+
+    assert rendered == [(4, 4)]
+    assert result.datazone_path == tmp_path / "b_dz.tiff"
+    assert annotated == [tmp_path / "b_dz.tiff"]
+    assert experiment.results.images == [
+        (tmp_path / "b_dz.tiff", "b_dz"),
+        (tmp_path / "b.tiff", "b"),
+    ]
+
+
+def test_failed_save_is_not_recorded(tmp_path):
+    camera = SlowSavingCamera()
+    camera.release.set()
+    camera.save_image = lambda image, path: False
+    session = CameraSession(camera)
+    experiment = Experiment()
+
+    with ImageWriter() as writer:
+        writer.submit(session.capture(), tmp_path / "c.tiff", session, experiment, "c")
+        (result,) = writer.drain(timeout=2)
+
+    assert not result.ok
+    assert experiment.results.images == []
@@ -0,0 +1,178 @@
+import re
+import time
+
+import pytest
+import serial
+
+from panda_lib.hardware.grbl_cnc_mill.driver import Mill
+from panda_lib.hardware.grbl_cnc_mill.mock import MockSerialToMill
+from panda_lib.hardware.imaging.camera_session import CameraSession
+from panda_lib.hardware.imaging.z_stack import ZStackAcquisition, z_planes
+
+from .test_camera import CountingCamera
+
+axis_pattern = re.compile(r"([XYZ])([\d.-]+)")
+
+
+class DwellingSerial(MockSerialToMill):
+    """Moves when a line is parsed rather than when it is written, and holds G4 lines"""
+
+    def __init__(self, *args, **kwargs):
+        super().__init__(*args, **kwargs)
+        self.dwell_until = None
+        self.lines_seen = []
+
+    def write(self, command: bytes):
+        self._buffer_input(command.decode())
+
+    def _acknowledge_line(self) -> bool:
+        if not self._rx_lines:
+            return False
+        line = self._rx_lines[0]
+        if line.startswith("G4"):
+            if self.dwell_until is None:
+                self.dwell_until = time.monotonic() + float(line.split("P")[1])
+            if time.monotonic() < self.dwell_until:
+                return False
+            self.dwell_until = None
+        for axis, value in axis_pattern.findall(line):
+            setattr(self, f"current_{axis.lower()}", float(value))
+        self.lines_seen.append(line)
+        return super()._acknowledge_line()
+
+
+class FrameCamera(CountingCamera):
+    """Returns numbered frames"""
+
+    def __init__(self):
+        super().__init__()
+        self.frames = 0
+
+    def capture_image(self):
+        self.frames += 1
+        return self.frames
+
+
+@pytest.fixture
+def sweeping_mill():
+    mill = Mill()
+    mill.ser_mill = DwellingSerial(
+        port="COM4",
+        baudrate=115200,
+        parity=serial.PARITY_NONE,
+        stopbits=serial.STOPBITS_ONE,
+        bytesize=serial.EIGHTBITS,
+        timeout=0.01,
+    )
+    mill.start_status_engine(interval=0.01)
+    yield mill
+    mill.stop_status_engine()
+
+
+def test_z_planes():
+    assert z_planes(-20.0, 0.2, 3) == [-20.0, -19.8, -19.6]
+
+
+def test_acquire_streams_one_path_and_tags_measured_z(sweeping_mill):
+    camera = FrameCamera()
+    lights = []
+    planes = z_planes(-20.0, 0.2, 6)
+
+    stack = ZStackAcquisition(sweeping_mill, CameraSession(camera), dwell=0.05).acquire(
+        -100.0,
+        -100.0,
+        planes,
+        lights_on=lambda: lights.append("on") or True,
+        lights_off=lambda: lights.append("off"),
+    )
+
+    assert [plane.target_z for plane in stack] == planes
+    assert stack.measured_z == pytest.approx(planes)
+    assert [plane.frame for plane in stack] == [1, 2, 3, 4, 5, 6]
+    assert not stack.stopped_early
+    assert lights == ["on", "off"]
+    assert camera.connects == 1
+    dwells = [
+        line for line in sweeping_mill.ser_mill.lines_seen if line.startswith("G4")
+    ]
+    assert len(dwells) == len(planes) - 1
+
+
+def test_acquire_stops_when_asked(sweeping_mill):
+    planes = z_planes(-20.0, 0.2, 11)
+
+    stack = ZStackAcquisition(
+        sweeping_mill, CameraSession(FrameCamera()), dwell=0.05
+    ).acquire(-100.0, -100.0, planes, on_frame=lambda plane: plane.index == 2)
+
+    assert len(stack) == 3
+    assert stack.stopped_early
+    moves = [
+        line for line in sweeping_mill.ser_mill.lines_seen if line.startswith("G01 Z")
+    ]
+    assert len(moves) < len(planes)
+
+
+def test_acquire_without_status_engine_moves_plane_by_plane(sweeping_mill):
+    sweeping_mill.stop_status_engine()
+    sweeping_mill.ser_mill = MockSerialToMill(
+        port="COM4",
+        baudrate=115200,
+        parity=serial.PARITY_NONE,
+        stopbits=serial.STOPBITS_ONE,
+        bytesize=serial.EIGHTBITS,
+        timeout=0.01,
+    )
+    sweeping_mill.execute_command = lambda command, timeout=5.0: (
+        sweeping_mill.ser_mill.write(f"{command}\n".encode())
+    )
+    planes = z_planes(-20.0, 0.2, 3)
+
+    stack = ZStackAcquisition(sweeping_mill, CameraSession(FrameCamera())).acquire(
+        -100.0, -100.0, planes
+    )
+
+    assert [plane.measured_z for plane in stack] == pytest.approx(planes)
+
+
+def test_slow_consumer_misses_planes_instead_of_failing(sweeping_mill):
+    planes = z_planes(-20.0, 0.2, 6)
+    acquisition = ZStackAcquisition(
+        sweeping_mill, CameraSession(FrameCamera()), dwell=0.05
+    )
+
+    def slow_on_plane_1(plane):
+        if plane.index == 1:
+            # Longer than the dwell at every remaining plane together
+            time.sleep(0.5)
+        return False
+
+    stack = acquisition.acquire(-100.0, -100.0, planes, on_frame=slow_on_plane_1)
+
+    assert stack.missed
+    assert sorted([plane.index for plane in stack] + stack.missed) == list(range(6))
+    # The mill ends idle at the last plane, so it is still captured
+    assert stack.frames[-1].index == 5
+    assert stack.frames[-1].measured_z == pytest.approx(planes[-1])
+    assert acquisition.plane_dwell >= 0.5
+
+
+def test_dwell_is_sized_from_the_first_plane(sweeping_mill):
+    planes = z_planes(-20.0, 0.2, 3)
+
+    def slow_on_plane_0(plane):
+        if plane.index == 0:
+            time.sleep(0.1)
+        return False
+
+    stack = ZStackAcquisition(
+        sweeping_mill, CameraSession(FrameCamera()), dwell=0.05
+    ).acquire(-100.0, -100.0, planes, on_frame=slow_on_plane_0)
+
+    assert not stack.missed
+    dwells = [
+        float(line.split("P")[1])
+        for line in sweeping_mill.ser_mill.lines_seen
+        if line.startswith("G4")
+    ]
+    assert dwells and all(dwell >= 0.15 for dwell in dwells)
@@ -0,0 +1,154 @@
+import asyncio
+import queue
+import threading
+import time
+
+import pytest
+
+from panda_lib.hardware.arduino_interface import (
+    ArduinoLink,
+    ArduinoTimeoutError,
+    MockArduinoLink,
+    PawduinoFunctions,
+)
+
+
+class FakeFirmware:
+    """Answers tagged commands after a per-command delay, possibly out of order"""
+
+    def __init__(self, delays=None, tagged=True):
+        self.delays = delays or {}
+        self.tagged = tagged
+        self.is_open = True
+        self.written = []
+        self.lines = queue.Queue()
+
+    def write(self, data: bytes):
+        line = data.decode().strip()
+        self.written.append(line)
+        tag, _, command = line.rpartition(":") if self.tagged else ("", "", line)
+        code = command.split(",")[0]
+        response = "ERR:Unknown command" if code == "99" else f"OK:done {command}"
+        if code == PawduinoFunctions.CMD_LINE_BREAK.value:
+            response = 'OK:{"value1":0}'
+        prefix = f"{tag}:" if tag else ""
+        timer = threading.Timer(
+            self.delays.get(code, 0.0),
+            lambda: self.lines.put((prefix + response + "\r\n").encode()),
+        )
+        timer.start()
+
+    def flush(self):
+        pass
+
+    def readline(self):
+        try:
+            return self.lines.get(timeout=0.05)
+        except queue.Empty:
+            return b""
+
+    def cancel_read(self):
+        pass
+
+    def close(self):
+        self.is_open = False
+
+
+class FakeLink(ArduinoLink):
+    def __init__(self, firmware):
+        self.firmware = firmware
+        super().__init__()
+
+    def connect(self):
+        self.ser = self.firmware
+        self.connected = True
+        self.configured = True
+
+
+def test_pipelined_responses_are_matched_by_sequence():
+    pipette = PawduinoFunctions.CMD_PIPETTE_MOVE_TO
+    link = FakeLink(FakeFirmware(delays={pipette.value: 0.2}))
+    link.start_pipeline(sequence_tags=True)
+    try:
+        slow = link.submit(pipette, 0)
+        fast = link.submit(PawduinoFunctions.CMD_LINE_BREAK)
+
+        assert link.line_break() is False
+        assert fast.result(1)["parsed_data"] == {"value1": 0}
+        assert not slow.done()
+        assert slow.result(1)["raw_data"] == "done 11,0"
+        assert link.firmware.written[:2] == ["#1:11,0", "#2:7"]
+    finally:
+        link.stop_pipeline()
+
+
+def test_untagged_pipeline_matches_in_order():
+    link = FakeLink(FakeFirmware(tagged=False))
+    link.start_pipeline()
+    try:
+        futures = [link.submit(PawduinoFunctions.CMD_WHITE_ON) for _ in range(3)]
+        futures.append(link.submit(PawduinoFunctions.CMD_PIPETTE_HOME))
+        results = [future.result(1) for future in futures]
+        assert [result["sequence"] for result in results] == [1, 2, 3, 4]
+        assert results[-1]["raw_data"] == "done 10"
+        assert link.firmware.written[0] == "1"
+    finally:
+        link.stop_pipeline()
+
+
+def test_pipelined_error_and_timeout():
+    link = FakeLink(FakeFirmware(delays={"10": 5.0}))
+    link.start_pipeline(sequence_tags=True)
+    try:
+        with pytest.raises(ArduinoTimeoutError):
+            link._wait_for_pipelined(
+                link.submit(PawduinoFunctions.CMD_PIPETTE_HOME), 0.1
+            )
+        assert link.white_lights_on() is True
+    finally:
+        link.stop_pipeline()
+    assert not link.pipeline_running
+
+
+def test_async_send_uses_pipeline():
+    link = FakeLink(FakeFirmware())
+    link.start_pipeline(sequence_tags=True)
+
+    async def lights_and_sensor():
+        return await asyncio.gather(
+            link.async_white_lights_on(), link.async_line_break()
+        )
+
+    try:
+        assert asyncio.run(lights_and_sensor()) == [True, False]
+    finally:
+        link.stop_pipeline()
+
+
+def test_mock_pipeline_overlaps_lanes():
+    delays = {
+        PawduinoFunctions.CMD_PIPETTE_MOVE_TO: 0.2,
+        PawduinoFunctions.CMD_WHITE_ON: 0.2,
+        PawduinoFunctions.CMD_LINE_BREAK: 0.2,
+    }
+    arduino = MockArduinoLink(command_delays=delays)
+
+    start = time.perf_counter()
+    arduino.move_to(0)
+    arduino.white_lights_on()
+    arduino.line_break()
+    serial_time = time.perf_counter() - start
+
+    arduino.start_pipeline()
+    start = time.perf_counter()
+    futures = [
+        arduino.submit(PawduinoFunctions.CMD_PIPETTE_MOVE_TO, 0),
+        arduino.submit(PawduinoFunctions.CMD_WHITE_ON),
+        arduino.submit(PawduinoFunctions.CMD_LINE_BREAK),
+    ]
+    assert all(future.result(1)["success"] for future in futures)
+    pipelined_time = time.perf_counter() - start
+    arduino.close()
+
+    assert serial_time >= 0.6
+    assert pipelined_time < 0.45
@@ -0,0 +1,100 @@
+import pytest
+
+from panda_lib.exceptions import CapHandlingError
+from panda_lib.hardware.arduino_interface import PawduinoFunctions
+from panda_lib.hardware.capper import CapHandler, CapStateCache
+from panda_lib.utilities import Coordinates
+
+
+class FakeMill:
+    def __init__(self):
+        self.moves = []
+
+    def safe_move(self, x, y, z, tool="center"):
+        self.moves.append(("safe", x, y, z))
+
+    def move_to_position(self, x, y, z, tool="center"):
+        self.moves.append(("move", x, y, z))
+
+
+class FakeArduino:
+    """Electromagnet holds a cap once the sensor has seen it `lag` reads later"""
+
+    def __init__(self, picks_up=True, lag=2, stuck_releases=0):
+        self.picks_up = picks_up
+        self.lag = lag
+        self.stuck_releases = stuck_releases
+        self.magnet = False
+        self.reads_since_switch = 0
+        self.sent = []
+
+    def send(self, command):
+        self.sent.append(command)
+        if command == PawduinoFunctions.CMD_EMAG_OFF and self.stuck_releases:
+            self.stuck_releases -= 1
+            return {"success": True}
+        self.magnet = command == PawduinoFunctions.CMD_EMAG_ON
+        self.reads_since_switch = 0
+        return {"success": True}
+
+    def line_break(self):
+        self.reads_since_switch += 1
+        if self.reads_since_switch <= self.lag:
+            return not self.magnet
+        return self.magnet and self.picks_up
+
+
+VIAL = Coordinates(10.0, 20.0, -30.0)
+OTHER = Coordinates(50.0, 20.0, -30.0)
+
+
+def _handler(arduino, **kwargs):
+    return CapHandler(FakeMill(), arduino, poll_interval=0, **kwargs)
+
+
+def test_decap_and_cap_advance_on_sensor_and_track_state():
+    handler = _handler(FakeArduino())
+
+    assert handler.decap(VIAL) == 1
+    assert handler.cache.is_open(VIAL)
+    assert handler.cache.holds_cap_of(VIAL)
+    # already holding this vial's cap, nothing to do
+    assert handler.decap(VIAL) == 0
+    assert handler.ard_link.sent == [PawduinoFunctions.CMD_EMAG_ON]
+
+    assert handler.cap(VIAL) == 1
+    assert handler.cache.open_vials() == []
+    assert handler.cache.held is None
+
+
+def test_decap_failure_retries_then_raises():
+    handler = _handler(FakeArduino(picks_up=False), sensor_timeout=0.01)
+    with pytest.raises(CapHandlingError):
+        handler.decap(VIAL)
+    assert handler.ard_link.sent == [PawduinoFunctions.CMD_EMAG_ON] * 3
+    assert not handler.cache.is_open(VIAL)
+
+
+def test_decap_of_another_vial_is_refused_while_holding_a_cap():
+    cache = CapStateCache()
+    handler = _handler(FakeArduino(lag=0), cache=cache)
+    handler.decap(VIAL)
+    with pytest.raises(CapHandlingError):
+        handler.decap(OTHER)
+    assert not cache.is_open(OTHER)
+
+
+def test_cap_retry_approaches_offset_in_y():
+    # the cap stays on the decapper after the first release
+    handler = _handler(FakeArduino(lag=0, stuck_releases=1), sensor_timeout=0.01)
+    handler.decap(VIAL)
+
+    assert handler.cap(VIAL) == 2
+    assert ("move", VIAL.x, VIAL.y + 5.0, VIAL.z) in handler.mill.moves
+
+
+def test_legacy_unit_without_sensor_assumes_success():
+    arduino = FakeArduino(picks_up=False)
+    handler = _handler(arduino, sensor=False)
+    assert handler.decap(VIAL) == 1
+    assert handler.cap(VIAL) == 1
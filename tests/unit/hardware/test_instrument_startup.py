@@ -0,0 +1,134 @@
+import time
+
+import pytest
+
+from panda_lib.hardware.instrument_startup import DeviceStartup, start_instruments
+
+
+def _slow(value, seconds=0.2):
+    def connect(**_):
+        time.sleep(seconds)
+        return value
+
+    return connect
+
+
+def test_independent_devices_start_in_parallel():
+    steps = [DeviceStartup(name, _slow(name)) for name in ("mill", "camera", "arduino")]
+    devices, report = start_instruments(steps)
+
+    assert devices == {"mill": "mill", "camera": "camera", "arduino": "arduino"}
+    assert report.all_ready
+    assert report.wall_seconds < 0.5 < report.serial_seconds
+
+
+def test_dependent_gets_its_dependency_and_waits_for_it():
+    seen = {}
+
+    def connect_pipette(arduino):
+        seen["arduino"] = arduino
+        return "pipette"
+
+    steps = [
+        DeviceStartup("pipette", connect_pipette, depends_on=("arduino",)),
+        DeviceStartup("arduino", _slow("link", 0.1)),
+    ]
+    devices, report = start_instruments(steps)
+
+    assert seen["arduino"] == "link"
+    assert devices["pipette"] == "pipette"
+    pipette = report.devices["pipette"]
+    assert pipette.started >= report.devices["arduino"].seconds
+
+
+def test_failure_is_retried_and_only_blocks_dependents():
+    calls = {"arduino": 0}
+
+    def flaky_arduino():
+        calls["arduino"] += 1
+        raise ConnectionError("no port")
+
+    steps = [
+        DeviceStartup("mill", _slow("mill", 0.05)),
+        DeviceStartup("arduino", flaky_arduino, attempts=3, retry_delay=0.01),
+        DeviceStartup("pipette", lambda arduino: "pipette", depends_on=("arduino",)),
+    ]
+    devices, report = start_instruments(steps)
+
+    assert calls["arduino"] == 3
+    assert devices == {"mill": "mill", "arduino": None, "pipette": None}
+    assert report.devices["arduino"].attempts == 3
+    assert "no port" in report.devices["arduino"].error
+    assert "skipped" in report.devices["pipette"].error
+    assert report.not_ready() == ["arduino", "pipette"]
+    assert not report.all_ready
+
+
+def test_optional_device_does_not_fail_startup():
+    steps = [
+        DeviceStartup("mill", _slow("mill", 0)),
+        DeviceStartup("camera", lambda: None, required=False),
+    ]
+    devices, report = start_instruments(steps)
+
+    assert devices["camera"] is None
+    assert report.all_ready
+
+
+def test_circular_dependencies_are_rejected():
+    steps = [
+        DeviceStartup("a", lambda b: "a", depends_on=("b",)),
+        DeviceStartup("b", lambda a: "b", depends_on=("a",)),
+    ]
+    with pytest.raises(ValueError):
+        start_instruments(steps)
+
+
+def test_mill_and_arduino_do_not_probe_ports_at_once(monkeypatch):
+    from panda_lib import toolkit
+
+    probing = []
+    overlaps = []
+
+    def probe():
+        probing.append(1)
+        overlaps.append(len(probing))
+        time.sleep(0.1)
+        probing.pop()
+
+    class FakeMill:
+        def connect_to_mill(self):
+            probe()
+
+        def homing_sequence(self):
+            pass
+
+    class FakeArduino:
+        configured = True
+
+        def __init__(self, port_address):
+            self.port_address = port_address
+            probe()
+
+    class FakePipette:
+        def __init__(self, arduino):
+            pass
+
+        def get_status(self):
+            return True
+
+    monkeypatch.setattr(toolkit, "PandaMill", FakeMill)
+    monkeypatch.setattr(toolkit, "ArduinoLink", FakeArduino)
+    monkeypatch.setattr(toolkit, "OT2P300", FakePipette)
+    monkeypatch.setattr(toolkit, "read_config_value", lambda *args: "auto")
+    monkeypatch.setattr(toolkit, "get_config_boolean", lambda *args: False)
+    monkeypatch.setattr(
+        toolkit.CameraFactory, "create_camera", staticmethod(lambda **_: None)
+    )
+    monkeypatch.setattr(toolkit.Toolkit, "initialize_camera", lambda *args: None)
+
+    instruments, _ = toolkit.connect_to_instruments(use_mock_instruments=False)
+
+    assert isinstance(instruments.mill, FakeMill)
+    assert isinstance(instruments.arduino, FakeArduino)
+    assert overlaps == [1, 1]
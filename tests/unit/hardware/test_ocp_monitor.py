@@ -0,0 +1,112 @@
+from unittest.mock import MagicMock
+
+import pytest
+
+from panda_lib.actions import electrochemistry
+from panda_lib.exceptions import OCPAborted
+from panda_lib.hardware.gamry_potentiostat import gamry_control
+from panda_lib.hardware.ocp_monitor import (
+    OUT_OF_SOLUTION,
+    SHORTED,
+    OCPMonitor,
+    OCPRule,
+)
+
+
+def _feed(monitor, voltages, dt=0.1):
+    for i, voltage in enumerate(voltages):
+        if monitor(i * dt, voltage):
+            return i
+    return None
+
+
+def test_shorted_electrode_aborts_within_first_second():
+    monitor = OCPMonitor()
+    index = _feed(monitor, [0.002] * 50)
+    assert monitor.aborted
+    assert monitor.reason == SHORTED.name
+    assert monitor.abort_time <= 1.0
+    assert index == 5  # 0.5 s hold at 10 Hz
+
+
+def test_out_of_solution_aborts():
+    monitor = OCPMonitor()
+    _feed(monitor, [1.4] * 50)
+    assert monitor.reason == OUT_OF_SOLUTION.name
+    assert monitor.last_voltage == pytest.approx(1.4)
+
+
+def test_good_ocp_and_brief_excursions_do_not_abort():
+    monitor = OCPMonitor()
+    # a glitch through 0 V shorter than the hold time resets the streak
+    voltages = [0.2, 0.001, 0.001, 0.2] * 20
+    assert _feed(monitor, voltages) is None
+    assert not monitor.aborted
+    assert monitor.n_samples == len(voltages)
+
+
+def test_rule_only_applies_within_its_window():
+    monitor = OCPMonitor([OCPRule("late short", below=0.01, within=0.3)])
+    assert _feed(monitor, [0.2] * 5 + [0.0] * 20) is None
+
+
+def test_default_rules_only_watch_the_start_of_the_run():
+    monitor = OCPMonitor()
+    # settles near 0 V after two seconds
+    assert _feed(monitor, [0.2] * 20 + [0.002] * 50) is None
+    assert not monitor.aborted
+
+
+def test_aborted_ocp_is_recorded_before_raising(monkeypatch):
+    pstat = MagicMock()
+    pstat.setfilename.return_value = "run.txt"
+
+    def run(params, on_sample):
+        _feed(on_sample, [0.002] * 20)
+
+    pstat.OCP.side_effect = run
+    monkeypatch.setattr(electrochemistry, "echem", lambda: pstat)
+    exp = MagicMock()
+
+    with pytest.raises(OCPAborted) as aborted:
+        electrochemistry.open_circuit_potential("tag", exp=exp, testing=True)
+
+    assert aborted.value.reason == SHORTED.name
+    exp.results.set_ocp_file.assert_called_once_with("run.txt", False, 0.002, "tag")
+    pstat.check_vf_range.assert_not_called()
+
+
+def test_gamry_sink_stops_and_saves_on_abort(monkeypatch):
+    calls = []
+    monkeypatch.setattr(gamry_control, "stopacq", lambda: calls.append("stop"))
+    monkeypatch.setattr(
+        gamry_control, "savedata", lambda name, kind: calls.append(("save", name))
+    )
+
+    class FakeDtaq:
+        def __init__(self):
+            self.remaining = 30
+            self.t = 0.0
+            self.running = True
+
+        def Cook(self, n):
+            n = min(n, self.remaining)
+            self.remaining -= n
+            times = [self.t + 0.1 * i for i in range(n)]
+            self.t += 0.1 * n
+            # Time, Vf, then the other OCP columns
+            return n, [times, [0.0] * n] + [[0] * n] * 6
+
+        def Run(self, state):
+            self.running = state
+
+    dtaq = FakeDtaq()
+    sink = gamry_control.GamryDtaqEvents(dtaq, "run.txt", "OCP", OCPMonitor())
+    sink._IGamryDtaqEvents_OnDataAvailable()
+
+    assert sink.aborted
+    assert not dtaq.running
+    assert calls == ["stop", ("save", "run.txt")]
+    assert len(sink.acquired_points) == 10  # the cook that tripped the rule
+    sink._IGamryDtaqEvents_OnDataDone()
+    assert calls == ["stop", ("save", "run.txt")]
@@ -0,0 +1,71 @@
+import os
+
+import numpy as np
+import pandas as pd
+import pytest
+
+from panda_lib.hardware.potentiostat_data import (
+    load_echem_data,
+    sidecar_path,
+    write_columnar,
+)
+
+
+def _write_gamry_ocp(path, n=20):
+    rows = [(0.5 * i, 0.01 * i, 0, 0, 0, 0, 0, 25.0) for i in range(n)]
+    np.savetxt(path, pd.DataFrame(rows), fmt="%s")
+    return rows
+
+
+def test_text_is_parsed_once_then_read_from_sidecar(tmp_path):
+    path = tmp_path / "run_OCP_0.txt"
+    rows = _write_gamry_ocp(path)
+
+    first = load_echem_data(path, "OCP")
+    assert list(first.columns[:2]) == ["Time", "Vf"]
+    assert (first.dtypes == np.float64).all()
+    assert first["Vf"].iloc[-2] == pytest.approx(rows[-2][1])
+    assert sidecar_path(path).exists()
+
+    # the second load must not touch the text
+    path.write_text("not data\n")
+    os.utime(sidecar_path(path), (path.stat().st_mtime + 1,) * 2)
+    second = load_echem_data(path, "OCP", columns=["Vf"])
+    assert list(second.columns) == ["Vf"]
+    np.testing.assert_array_equal(second["Vf"], first["Vf"])
+
+
+def test_stale_sidecar_is_replaced(tmp_path):
+    path = tmp_path / "run_OCP_0.txt"
+    _write_gamry_ocp(path, n=5)
+    load_echem_data(path, "OCP")
+
+    _write_gamry_ocp(path, n=8)
+    os.utime(path, (sidecar_path(path).stat().st_mtime + 1,) * 2)
+    assert len(load_echem_data(path, "OCP")) == 8
+
+
+def test_comma_and_comment_lines_match_tolerant_parse(tmp_path):
+    path = tmp_path / "emstat_OCP_0.txt"
+    path.write_text("# header\nt/s, E/V\n0.0, 0.1\n0.5,0.2\n\n1.0 ,  0.3\n")
+
+    data = load_echem_data(path, "OCP", write_sidecar=False)
+    assert data["Time"].tolist() == [0.0, 0.5, 1.0]
+    assert data["Vf"].tolist() == [0.1, 0.2, 0.3]
+    assert not sidecar_path(path).exists()
+
+
+def test_positional_sidecar_is_named_by_kind(tmp_path):
+    path = tmp_path / "run_CA_0.txt"
+    frame = pd.DataFrame([[0.0, 0.1, 0.0, 1e-6], [1.0, 0.1, 0.0, 2e-6]])
+    write_columnar(path, frame)
+
+    data = load_echem_data(path, "CA", columns=["Time", "Im"])
+    assert data["Im"].tolist() == [1e-6, 2e-6]
+
+
+def test_missing_column_raises(tmp_path):
+    path = tmp_path / "run_OCP_0.txt"
+    _write_gamry_ocp(path, n=3)
+    with pytest.raises(KeyError):
+        load_echem_data(path, "OCP", columns=["Cycle"])
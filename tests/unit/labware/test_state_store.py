@@ -0,0 +1,111 @@
+import threading
+
+import pytest
+
+from panda_lib.labware.errors import LabwareWriteError
+from panda_lib.labware.schemas import WellReadModel
+from panda_lib.labware.state_store import LabwareStateStore, well_key
+
+
+class RecordingWriter:
+    """Stands in for the database, optionally blocking until released"""
+
+    def __init__(self, fail_times: int = 0):
+        self.writes = []
+        self.fail_times = fail_times
+        self.release = threading.Event()
+        self.release.set()
+
+    def __call__(self, key, data):
+        self.release.wait(1)
+        if self.fail_times:
+            self.fail_times -= 1
+            raise ConnectionError("database went away")
+        self.writes.append((key, data["volume"]))
+
+
+def make_well(well_id: str = "A1", volume: float = 0.0) -> WellReadModel:
+    return WellReadModel(
+        name=f"1_{well_id}",
+        well_id=well_id,
+        plate_id=1,
+        experiment_id=0,
+        project_id=0,
+        coordinates={"x": 0.0, "y": 0.0, "z": -80.0},
+        radius=3.0,
+        volume=volume,
+        dead_volume=0.0,
+    )
+
+
+@pytest.fixture
+def writer():
+    return RecordingWriter()
+
+
+def test_reads_come_from_memory_and_saves_are_ordered(writer, tmp_path):
+    store = LabwareStateStore({"well": writer}, tmp_path / "journal.jsonl")
+    writer.release.clear()
+
+    for well_id, volume in [("A1", 100.0), ("A2", 50.0), ("A3", 25.0)]:
+        store.save(well_key(1, well_id), make_well(well_id, volume))
+    assert store.get(well_key(1, "A2")).volume == 50.0
+
+    writer.release.set()
+    store.flush(timeout=2)
+    assert [key[2] for key, _ in writer.writes] == ["A1", "A2", "A3"]
+    store.close()
+
+
+def test_repeated_saves_write_the_latest_state(writer):
+    store = LabwareStateStore({"well": writer})
+    writer.release.clear()
+    store.save(well_key(1, "B1"), make_well("B1", 10.0))  # picked up, blocked
+    store.save(well_key(1, "B2"), make_well("B2", 10.0))
+    store.save(well_key(1, "B2"), make_well("B2", 20.0))
+    store.save(well_key(1, "B2"), make_well("B2", 30.0))
+
+    writer.release.set()
+    store.flush(timeout=2)
+    assert [volume for key, volume in writer.writes if key[2] == "B2"] == [30.0]
+    store.close()
+
+
+def test_find_matches_cached_fields(writer):
+    store = LabwareStateStore({"well": writer})
+    store.save(well_key(1, "A1"), make_well("A1", 10.0))
+    store.save(well_key(1, "A2"), make_well("A2", 20.0))
+
+    assert store.find("well", name="1_A2").volume == 20.0
+    assert store.find("well", name="1_A3") is None
+    assert store.find("vial", name="1_A2") is None
+    store.close()
+
+
+def test_saved_model_gets_generated_heights(writer):
+    store = LabwareStateStore({"well": writer})
+    well = make_well(volume=282.0)
+    store.save(well_key(1, "A1"), well)
+
+    assert well.top == -73.0  # z + base_thickness + height
+    assert well.volume_height == round(-80 + 1 + 282 / (3.1459 * 9), 2)
+    store.close()
+
+
+def test_failed_save_is_reported_and_replayed(tmp_path):
+    journal = tmp_path / "journal.jsonl"
+    failing = RecordingWriter(fail_times=3)
+    store = LabwareStateStore({"well": failing}, journal)
+    store.save(well_key(1, "C1"), make_well("C1", 75.0))
+
+    with pytest.raises(LabwareWriteError):
+        store.flush(timeout=5)
+    store.close()
+
+    # A new process replays the save the database never received
+    writer = RecordingWriter()
+    restored = LabwareStateStore({"well": writer}, journal)
+    assert restored.replay() == 1
+    assert writer.writes == [(("well", 1, "C1"), 75.0)]
+    assert journal.read_text() == ""
+    restored.close()
@@ -1,8 +1,14 @@
+import threading
+from unittest.mock import patch
+
 import pytest
 from sqlalchemy import create_engine, select
 from sqlalchemy.orm import Session, sessionmaker
+from sqlalchemy.pool import StaticPool
 
 from panda_lib.labware.errors import OverDraftException, OverFillException
+from panda_lib.labware.services import VialService
+from panda_lib.labware.state_store import LabwareStateStore
 from panda_lib.labware.vials import Vial
 from panda_lib.sql_tools import Base, Vials
 
@@ -70,6 +76,48 @@ def test_load_existing_vial(session_maker: Session):
     assert vial.vial_data.volume == 100.0
 
 
+def test_load_by_name_sees_queued_saves():
+    # The store writes from its own thread, so every connection shares one database
+    shared = create_engine(
+        DATABASE_URL,
+        connect_args={"check_same_thread": False},
+        poolclass=StaticPool,
+    )
+    Base.metadata.create_all(shared)
+    session_maker = sessionmaker(bind=shared)
+    Vial(
+        position="A9",
+        session_maker=session_maker,
+        create_new=True,
+        name="Old Name",
+        volume=100.0,
+        capacity=200.0,
+        category=1,
+    )
+    release = threading.Event()
+    service = VialService(session_maker)
+
+    def write(key, data):
+        release.wait(2)
+        service.update_vial(key[1], data)
+
+    store = LabwareStateStore({"vial": write})
+    with patch("panda_lib.labware.vials.get_labware_store", return_value=store):
+        vial = Vial(position="A9", session_maker=session_maker)
+        vial.vial_data.name = "New Name"
+        vial.save()
+
+        # The rename has not reached the database yet
+        renamed = Vial(vial_name="New Name", session_maker=session_maker)
+        assert renamed.vial_data.position == "A9"
+
+        # A name only the database still holds is looked up after the flush
+        release.set()
+        with pytest.raises(ValueError):
+            Vial(vial_name="Old Name", session_maker=session_maker)
+    store.close()
+
+
 def test_add_contents(session_maker: Session):
     vial = Vial(
         position="A3",
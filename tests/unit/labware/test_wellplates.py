@@ -2,7 +2,7 @@ import json
 from pathlib import Path
 
 import pytest
-from sqlalchemy import create_engine, select
+from sqlalchemy import create_engine, event, select
 from sqlalchemy.orm import Session, sessionmaker
 
 from panda_lib.exceptions import OverDraftException, OverFillException
@@ -443,6 +443,96 @@ def test_deactivate_plate(session: sessionmaker):
     assert plate.plate_data.current is False
 
 
+def count_statements(callable_):
+    """Run callable_ and return its result and the number of SQL statements it issued"""
+    statements = []
+
+    def before_cursor_execute(conn, cursor, statement, *args):
+        statements.append(statement)
+
+    event.listen(engine, "before_cursor_execute", before_cursor_execute)
+    try:
+        result = callable_()
+    finally:
+        event.remove(engine, "before_cursor_execute", before_cursor_execute)
+    return result, len(statements)
+
+
+def test_load_wells_uses_one_query(session: sessionmaker):
+    Wellplate(
+        session_maker=session,
+        plate_id=10,
+        create_new=True,
+        name="Test Plate",
+        type_id=1,
+        a1_x=0.0,
+        a1_y=0.0,
+        orientation=0,
+        rows="ABCDEFGH",
+        cols=12,
+    )
+
+    plate, statements = count_statements(
+        lambda: Wellplate(session_maker=session, plate_id=10)
+    )
+    assert len(plate.wells) == 96
+    assert plate.wells["H12"].well_data.plate_id == 10
+    # plate, plate type and one query for all wells
+    assert statements <= 3
+
+
+def test_unit_of_work_saves_wells_together(session: sessionmaker):
+    plate = Wellplate(
+        session_maker=session,
+        plate_id=11,
+        create_new=True,
+        name="Test Plate",
+        type_id=1,
+        a1_x=0.0,
+        a1_y=0.0,
+        orientation=0,
+        rows="ABCDEFGH",
+        cols=12,
+    )
+
+    def fill_row():
+        with plate.unit_of_work() as unit_of_work:
+            for col in range(1, 13):
+                plate.wells[f"A{col}"].add_contents({"water": 10.0}, 10.0)
+            assert len(unit_of_work.dirty) == 12
+
+    _, statements = count_statements(fill_row)
+    # One select, batched updates and one read back instead of 24 round-trips
+    assert statements < 12
+
+    reloaded = Wellplate(session_maker=session, plate_id=11)
+    assert all(reloaded.wells[f"A{col}"].volume == 10.0 for col in range(1, 13))
+    assert plate.wells["A1"].unit_of_work is None
+
+
+def test_unit_of_work_rolls_back_on_error(session: sessionmaker):
+    plate = Wellplate(
+        session_maker=session,
+        plate_id=12,
+        create_new=True,
+        name="Test Plate",
+        type_id=1,
+        a1_x=0.0,
+        a1_y=0.0,
+        orientation=0,
+        rows="ABCDEFGH",
+        cols=12,
+    )
+
+    with pytest.raises(RuntimeError):
+        with plate.unit_of_work():
+            plate.wells["B2"].update_status("running")
+            raise RuntimeError("experiment failed")
+
+    assert plate.wells["B2"].status == "new"
+    assert Wellplate(session_maker=session, plate_id=12).wells["B2"].status == "new"
+
+
 def test_load_configuration():
     """Test loading the mill configuration from a JSON file. The Wellplate module uses this
     to determine the valid x and y coordinates for the wells."""
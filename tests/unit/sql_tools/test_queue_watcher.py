@@ -0,0 +1,46 @@
+import threading
+import time
+
+from panda_lib.sql_tools.queries.queue import QueueWatcher, notify_queue_changed
+
+
+class Tokens:
+    """A change token that another process bumps"""
+
+    def __init__(self):
+        self.value = (0, None, None, 1)
+        self.reads = 0
+
+    def __call__(self):
+        self.reads += 1
+        return self.value
+
+
+def test_in_process_notification_wakes_immediately():
+    watcher = QueueWatcher(poll_interval=10, token_reader=Tokens())
+    threading.Timer(0.05, notify_queue_changed).start()
+
+    start = time.monotonic()
+    assert watcher.wait(timeout=5) is True
+    assert time.monotonic() - start < 1
+
+
+def test_token_change_from_another_process_wakes_the_watcher():
+    tokens = Tokens()
+    watcher = QueueWatcher(poll_interval=0.02, token_reader=tokens)
+
+    def queue_experiment():
+        tokens.value = (1, 10045, "2025-01-01 12:00:00", 1)
+
+    threading.Timer(0.1, queue_experiment).start()
+    start = time.monotonic()
+    assert watcher.wait(timeout=5) is True
+    assert time.monotonic() - start < 1
+
+
+def test_wait_times_out_without_changes():
+    tokens = Tokens()
+    watcher = QueueWatcher(poll_interval=0.02, token_reader=tokens)
+
+    assert watcher.wait(timeout=0.1) is False
+    assert tokens.reads > 2
@@ -0,0 +1,151 @@
+import importlib.util
+from pathlib import Path
+from types import SimpleNamespace
+
+import sqlalchemy as sa
+from sqlalchemy.dialects import mysql
+from sqlalchemy.orm import Session
+from sqlalchemy.schema import CreateIndex, CreateTable
+
+from panda_lib.sql_tools.models import Base, Vials, VialStatus
+from panda_lib.sql_tools.models.vials import refresh_vial_status
+
+MIGRATION = (
+    Path(__file__).parents[3]
+    / "migrations"
+    / "versions"
+    / "d55e0781076d_state_indexes_vial_status_table.py"
+)
+
+
+def _vial(position, name, volume, updated):
+    return Vials(
+        position=position,
+        category=0,
+        name=name,
+        contents={name: 1.0},
+        viscosity_cp=1.0,
+        concentration=1.0,
+        density=1.0,
+        volume=volume,
+        coordinates={"x": -4, "y": -39, "z": -74},
+        panda_unit_id=1,
+        updated=updated,
+    )
+
+
+def _status(session):
+    rows = session.execute(sa.select(VialStatus).order_by(VialStatus.position))
+    return {row.position: (row.name, row.volume) for row in rows.scalars()}
+
+
+def test_vial_status_table_follows_writes():
+    engine = sa.create_engine("sqlite://")
+    Base.metadata.create_all(engine)
+
+    with Session(engine) as session:
+        session.add_all(
+            [
+                _vial("s0", "edot", 20000.0, "2025-01-01 00:00:00"),
+                _vial("s1", "rinse", 20000.0, "2025-01-01 00:00:00"),
+            ]
+        )
+        session.commit()
+        assert _status(session) == {
+            "s0": ("edot", 20000.0),
+            "s1": ("rinse", 20000.0),
+        }
+
+        # a replacement vial at s0 becomes the current one
+        newer = _vial("s0", "pedot", 15000.0, "2025-01-02 00:00:00")
+        session.add(newer)
+        session.commit()
+        assert _status(session)["s0"] == ("pedot", 15000.0)
+
+        newer.volume = 14000.0
+        session.commit()
+        assert _status(session)["s0"] == ("pedot", 14000.0)
+        current = session.get(VialStatus, "s0")
+        assert current.id == newer.id
+        assert current.top is not None  # generated columns are copied
+
+        session.delete(newer)
+        session.commit()
+        assert _status(session)["s0"] == ("edot", 20000.0)
+
+
+def test_core_writes_need_an_explicit_refresh():
+    engine = sa.create_engine("sqlite://")
+    Base.metadata.create_all(engine)
+
+    with Session(engine) as session:
+        session.add(_vial("s0", "edot", 20000.0, "2025-01-01 00:00:00"))
+        session.commit()
+
+    # Core statements fire no mapper events
+    with engine.begin() as connection:
+        connection.execute(
+            sa.update(Vials.__table__)
+            .where(Vials.__table__.c.position == "s0")
+            .values(volume=5000.0)
+        )
+    with Session(engine) as session:
+        assert _status(session)["s0"] == ("edot", 20000.0)
+
+    with engine.begin() as connection:
+        refresh_vial_status(connection, ["s0"])
+    with Session(engine) as session:
+        assert _status(session)["s0"] == ("edot", 5000.0)
+
+
+def test_vial_status_ddl_compiles_for_mysql():
+    spec = importlib.util.spec_from_file_location("d55e0781076d", MIGRATION)
+    migration = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(migration)
+
+    dialect = mysql.dialect()
+    table = sa.Table(
+        "panda_vial_status",
+        sa.MetaData(),
+        *migration.VIAL_STATUS_COLUMNS,
+    )
+    assert "position VARCHAR(64)" in str(CreateTable(table).compile(dialect=dialect))
+    CreateTable(VialStatus.__table__).compile(dialect=dialect)
+
+    # TEXT columns are indexed by a prefix on MySQL
+    vials = sa.Table(
+        "panda_vials",
+        sa.MetaData(),
+        sa.Column("position", sa.Text),
+        sa.Column("updated", sa.Text),
+    )
+    inspector = SimpleNamespace(
+        get_columns=lambda name: [
+            {"name": column.name, "type": column.type} for column in vials.columns
+        ]
+    )
+    lengths = migration._text_prefix_lengths(
+        inspector, "panda_vials", ["position", "updated"]
+    )
+    index = sa.Index(
+        "ix_vials_position_updated",
+        vials.c.position,
+        vials.c.updated,
+        mysql_length=lengths,
+    )
+    assert "position(64)" in str(CreateIndex(index).compile(dialect=dialect))
+
+
+def test_lookup_indexes_exist():
+    engine = sa.create_engine("sqlite://")
+    Base.metadata.create_all(engine)
+    inspector = sa.inspect(engine)
+
+    def indexes(table):
+        return {index["name"] for index in inspector.get_indexes(table)}
+
+    assert "ix_experiment_parameters_experiment" in indexes(
+        "panda_experiment_parameters"
+    )
+    assert {"ix_well_hx_experiment", "ix_well_hx_status"} <= indexes("panda_well_hx")
+    assert "ix_vials_position_updated" in indexes("panda_vials")
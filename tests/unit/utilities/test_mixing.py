@@ -0,0 +1,55 @@
+from unittest.mock import patch
+
+import pytest
+
+from panda_lib.mixing import MixingSolver
+
+
+def test_vial_at_target_is_used_alone():
+    solver = MixingSolver()
+    by_conc, deviation, by_position = solver.solve({"s1": 0.5, "s2": 1.0}, 120, 1.0)
+    assert by_conc == {1.0: 120.0}
+    assert deviation == 0.0
+    assert by_position == {"s1": 0.0, "s2": 120.0}
+    assert solver.fast == 1
+
+
+def test_two_vial_mix_is_closed_form_without_ilp():
+    solver = MixingSolver()
+    with patch("panda_lib.mixing.solve_vials_ilp") as ilp:
+        by_conc, deviation, by_position = solver.solve(
+            {"A": 1.0, "B": 2.0, "C": 3.0}, 100.0, 2.5
+        )
+    ilp.assert_not_called()
+    assert deviation == 0.0
+    # the pair with the largest smaller draw: B and C at 50 uL each
+    assert by_position == {"A": 0.0, "B": 50.0, "C": 50.0}
+    total = sum(by_position.values())
+    assert total == pytest.approx(100.0)
+    assert sum(c * by_conc[c] for c in by_conc) / total == pytest.approx(2.5)
+
+
+def test_repeated_solve_is_cached_and_copied():
+    solver = MixingSolver()
+    first = solver.solve({"A": 1.0, "B": 3.0}, 100.0, 2.0)
+    first[2]["A"] = -1
+    second = solver.solve({"A": 1.0, "B": 3.0}, 100.0, 2.0)
+    assert second[2] == {"A": 50.0, "B": 50.0}
+    assert (solver.hits, solver.fast, solver.ilp) == (1, 1, 0)
+
+
+def test_mix_needing_three_vials_falls_back_to_ilp():
+    solver = MixingSolver()
+    # 700 uL cannot be drawn from two vials capped at 300 uL each
+    vials = {"A": 1.0, "B": 2.0, "C": 3.0}
+    by_conc, deviation, by_position = solver.solve(vials, 700.0, 2.2)
+    assert solver.ilp == 1
+    assert deviation == pytest.approx(0.0)
+    assert sum(by_position.values()) == pytest.approx(700.0)
+    assert all(v == 0 or 10 <= v <= 300 for v in by_position.values())
+
+
+def test_unreachable_target_returns_none():
+    solver = MixingSolver()
+    assert solver.solve({"A": 1.0}, 100.0, 2.0)[0] is None
+    assert solver.solve({"A": 1.0, "B": 1.5}, 100.0, 2.0) == (None, None, None)